@@ -0,0 +1,191 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Tests of the multi-device brick decompositions.  These only look at
+// brick geometry, so they run on the host without any devices.
+
+#include "../../shared/hipfft_brick.h"
+#include <gtest/gtest.h>
+
+// number of elements in a brick
+static size_t brick_volume(const hipfft_brick& brick)
+{
+    const auto length = brick.length();
+    return std::accumulate(length.begin(), length.end(), size_t(1), std::multiplies<size_t>());
+}
+
+// check that bricks tile a field and have contiguous strides
+static void check_bricks(const std::vector<size_t>& length, const std::vector<hipfft_brick>& bricks)
+{
+    ASSERT_TRUE(bricks_tile_field(length, bricks));
+    for(const auto& brick : bricks)
+        EXPECT_EQ(brick.min_size, brick_volume(brick));
+}
+
+TEST(hipfft_brick, slab_coverage)
+{
+    const std::vector<std::vector<size_t>> lengths = {{64}, {17, 5}, {8, 12, 30}, {3, 3, 7}};
+    for(const auto& length : lengths)
+    {
+        for(size_t batch : {1, 3})
+        {
+            for(size_t count = 1; count <= 5; ++count)
+            {
+                std::vector<size_t> lengthWithBatch = length;
+                lengthWithBatch.push_back(batch);
+
+                // skip decompositions that would leave a brick empty
+                const size_t split_len
+                    = batch > 1 ? batch : lengthWithBatch[lengthWithBatch.size() - 2];
+                if(split_len < count)
+                    continue;
+
+                std::vector<double> weights(count);
+                std::iota(weights.begin(), weights.end(), 1.0);
+                for(const auto& w : {std::vector<double>(), weights})
+                {
+                    std::vector<hipfft_brick> inBricks(count), outBricks(count);
+                    set_io_bricks(length, length, batch, inBricks, outBricks, w);
+                    check_bricks(lengthWithBatch, inBricks);
+                    check_bricks(lengthWithBatch, outBricks);
+                }
+            }
+        }
+    }
+}
+
+TEST(hipfft_brick, pencil_geometry)
+{
+    // {in length, out length}, col-major: the second is an R2C output
+    const std::vector<std::pair<std::vector<size_t>, std::vector<size_t>>> lengths
+        = {{{64, 32, 16}, {64, 32, 16}}, {{7, 9, 11}, {7, 9, 11}}, {{64, 48, 40}, {33, 48, 40}}};
+    const std::vector<std::pair<size_t, size_t>> grids = {{1, 1}, {2, 2}, {2, 3}, {4, 2}, {3, 1}};
+
+    for(const auto& length : lengths)
+    {
+        for(size_t batch : {1, 2})
+        {
+            for(const auto& grid : grids)
+            {
+                const size_t p = grid.first;
+                const size_t q = grid.second;
+
+                std::vector<hipfft_brick> inBricks(p * q), outBricks(p * q);
+                ASSERT_TRUE(set_io_pencil_bricks(
+                    length.first, length.second, batch, inBricks, outBricks, p, q));
+
+                std::vector<size_t> inLengthWithBatch = length.first;
+                inLengthWithBatch.push_back(batch);
+                std::vector<size_t> outLengthWithBatch = length.second;
+                outLengthWithBatch.push_back(batch);
+                check_bricks(inLengthWithBatch, inBricks);
+                check_bricks(outLengthWithBatch, outBricks);
+
+                for(size_t i = 0; i < p * q; ++i)
+                {
+                    const auto inLen  = inBricks[i].length();
+                    const auto outLen = outBricks[i].length();
+
+                    // input pencils span the fastest dim, output
+                    // pencils span the slowest, and every brick has
+                    // all of the batch
+                    EXPECT_EQ(inLen[0], length.first[0]);
+                    EXPECT_EQ(outLen[2], length.second[2]);
+                    EXPECT_EQ(inLen[3], batch);
+                    EXPECT_EQ(outLen[3], batch);
+
+                    // bricks in the same grid row or column share
+                    // bounds along the dim that the row or column splits
+                    const auto& rowStart = inBricks[i / q * q];
+                    const auto& colStart = inBricks[i % q];
+                    EXPECT_EQ(inBricks[i].field_lower[2], rowStart.field_lower[2]);
+                    EXPECT_EQ(inBricks[i].field_lower[1], colStart.field_lower[1]);
+                    EXPECT_EQ(outBricks[i].field_lower[1], outBricks[i / q * q].field_lower[1]);
+                    EXPECT_EQ(outBricks[i].field_lower[0], outBricks[i % q].field_lower[0]);
+
+                    // split is even, except for the last row or column
+                    if(i / q != p - 1)
+                    {
+                        EXPECT_EQ(inLen[2], length.first[2] / p);
+                        EXPECT_EQ(outLen[1], length.second[1] / p);
+                    }
+                    if(i % q != q - 1)
+                    {
+                        EXPECT_EQ(inLen[1], length.first[1] / q);
+                        EXPECT_EQ(outLen[0], length.second[0] / q);
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(hipfft_brick, pencil_invalid)
+{
+    std::vector<hipfft_brick> inBricks(4), outBricks(4);
+
+    // pencils need a 3D transform
+    EXPECT_FALSE(set_io_pencil_bricks({64, 64}, {64, 64}, 1, inBricks, outBricks, 2, 2));
+    // grid doesn't match the number of bricks
+    EXPECT_FALSE(set_io_pencil_bricks({8, 8, 8}, {8, 8, 8}, 1, inBricks, outBricks, 3, 1));
+    // split dims too short for the grid
+    EXPECT_FALSE(set_io_pencil_bricks({8, 8, 1}, {8, 8, 1}, 1, inBricks, outBricks, 2, 2));
+    EXPECT_FALSE(set_io_pencil_bricks({1, 8, 8}, {1, 8, 8}, 1, inBricks, outBricks, 2, 2));
+}
+
+TEST(hipfft_brick, tile_field_invalid)
+{
+    const std::vector<size_t> length = {8, 6, 1};
+
+    std::vector<hipfft_brick> bricks(2);
+    set_bricks(length, bricks, 1);
+    ASSERT_TRUE(bricks_tile_field(length, bricks));
+
+    // overlap
+    auto overlap = bricks;
+    overlap[0].field_upper[1] += 1;
+    EXPECT_FALSE(bricks_tile_field(length, overlap));
+
+    // gap
+    auto gap = bricks;
+    gap[0].field_upper[1] -= 1;
+    EXPECT_FALSE(bricks_tile_field(length, gap));
+
+    // outside the field
+    auto outside = bricks;
+    outside[1].field_upper[0] += 1;
+    EXPECT_FALSE(bricks_tile_field(length, outside));
+
+    // empty brick
+    auto empty = bricks;
+    empty[0].field_upper[1] = empty[0].field_lower[1];
+    EXPECT_FALSE(bricks_tile_field(length, empty));
+
+    // strides that put two elements at the same offset
+    auto aliased = bricks;
+    aliased[0].brick_stride[1] = 4;
+    EXPECT_FALSE(bricks_tile_field(length, aliased));
+
+    // padded and transposed strides are fine
+    auto padded = bricks;
+    padded[0].brick_stride    = {5, 1, 100};
+    padded[1].brick_stride[1] = 10;
+    EXPECT_TRUE(bricks_tile_field(length, padded));
+}
@@ -0,0 +1,276 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Tests of hipfftExtConvolutionPlan.  Convolutions are checked against
+// a direct convolution on the host.
+
+#include "hipfft/hipfft.h"
+#include "hipfft/hipfftXt.h"
+#include <complex>
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "../hipfft_params.h"
+#include "hipfft_test_values.h"
+
+DISABLE_WARNING_PUSH
+DISABLE_WARNING_DEPRECATED_DECLARATIONS
+DISABLE_WARNING_RETURN_TYPE
+#include <hip/hip_runtime_api.h>
+DISABLE_WARNING_POP
+
+static size_t volume(const std::vector<long long int>& length)
+{
+    size_t count = 1;
+    for(auto l : length)
+        count *= l;
+    return count;
+}
+
+// row-major index of a position, or -1 if it's outside length
+static long long int row_major_index(const std::vector<long long int>& position,
+                                     const std::vector<long long int>& length)
+{
+    long long int index = 0;
+    for(size_t d = 0; d < length.size(); ++d)
+    {
+        if(position[d] < 0 || position[d] >= length[d])
+            return -1;
+        index = index * length[d] + position[d];
+    }
+    return index;
+}
+
+// position of a row-major index
+static std::vector<long long int> position_of(size_t                            index,
+                                              const std::vector<long long int>& length)
+{
+    std::vector<long long int> position(length.size());
+    for(size_t d = length.size(); d-- > 0;)
+    {
+        position[d] = index % length[d];
+        index /= length[d];
+    }
+    return position;
+}
+
+// direct convolution of a signal of lengths n with a filter of
+// lengths k, with output lengths n (circular) or n + k - 1 (linear)
+template <typename T>
+static std::vector<std::complex<double>> convolve_reference(const std::vector<long long int>& n,
+                                                            const std::vector<long long int>& k,
+                                                            bool     circular,
+                                                            const T* signal,
+                                                            const T* filter)
+{
+    std::vector<long long int> out_length(n);
+    if(!circular)
+    {
+        for(size_t d = 0; d < n.size(); ++d)
+            out_length[d] += k[d] - 1;
+    }
+
+    std::vector<std::complex<double>> out(volume(out_length));
+    for(size_t o = 0; o < out.size(); ++o)
+    {
+        const auto out_position = position_of(o, out_length);
+        for(size_t j = 0; j < volume(k); ++j)
+        {
+            const auto                 filter_position = position_of(j, k);
+            std::vector<long long int> signal_position(n.size());
+            for(size_t d = 0; d < n.size(); ++d)
+            {
+                signal_position[d] = out_position[d] - filter_position[d];
+                if(circular)
+                    signal_position[d] = (signal_position[d] + n[d]) % n[d];
+            }
+            const auto i = row_major_index(signal_position, n);
+            if(i >= 0)
+                out[o] += to_complex(signal[i]) * to_complex(filter[j]);
+        }
+    }
+    return out;
+}
+
+TEST(hipfft_convolution, reference)
+{
+    const float signal[] = {1.0f, 2.0f, 3.0f};
+    const float filter[] = {1.0f, 1.0f};
+
+    const auto linear = convolve_reference<float>({3}, {2}, false, signal, filter);
+    ASSERT_EQ(linear.size(), 4);
+    EXPECT_EQ(linear[0].real(), 1.0);
+    EXPECT_EQ(linear[1].real(), 3.0);
+    EXPECT_EQ(linear[2].real(), 5.0);
+    EXPECT_EQ(linear[3].real(), 3.0);
+
+    const auto circular = convolve_reference<float>({3}, {2}, true, signal, filter);
+    ASSERT_EQ(circular.size(), 3);
+    EXPECT_EQ(circular[0].real(), 4.0);
+    EXPECT_EQ(circular[1].real(), 3.0);
+    EXPECT_EQ(circular[2].real(), 5.0);
+}
+
+#ifdef __HIP_PLATFORM_AMD__
+
+// convolve a batch of signals with each of a set of filters, and
+// compare every output with the direct convolution
+template <typename T>
+static void check_convolution(hipfftType                 type,
+                              std::vector<long long int> n,
+                              std::vector<long long int> k,
+                              long long int              numFilters,
+                              long long int              batch,
+                              hipfftExtConvolutionMode   mode,
+                              double                     tolerance)
+{
+    const bool circular = mode == HIPFFT_CONVOLUTION_CIRCULAR;
+
+    std::vector<long long int> out_length(n);
+    if(!circular)
+    {
+        for(size_t d = 0; d < n.size(); ++d)
+            out_length[d] += k[d] - 1;
+    }
+    const size_t signal_count = volume(n);
+    const size_t filter_count = volume(k);
+    const size_t out_count    = volume(out_length);
+
+    std::vector<T> signals(batch * signal_count);
+    std::vector<T> filters(numFilters * filter_count);
+    for(size_t i = 0; i < signals.size(); ++i)
+        fill_value(signals[i], i);
+    for(size_t i = 0; i < filters.size(); ++i)
+        fill_value(filters[i], 3 * i + 1);
+
+    T* d_signals = nullptr;
+    T* d_filters = nullptr;
+    T* d_out     = nullptr;
+    ASSERT_EQ(hipMalloc(&d_signals, signals.size() * sizeof(T)), hipSuccess);
+    ASSERT_EQ(hipMalloc(&d_filters, filters.size() * sizeof(T)), hipSuccess);
+    ASSERT_EQ(hipMalloc(&d_out, batch * numFilters * out_count * sizeof(T)), hipSuccess);
+    ASSERT_EQ(
+        hipMemcpy(d_signals, signals.data(), signals.size() * sizeof(T), hipMemcpyHostToDevice),
+        hipSuccess);
+    ASSERT_EQ(
+        hipMemcpy(d_filters, filters.data(), filters.size() * sizeof(T), hipMemcpyHostToDevice),
+        hipSuccess);
+
+    hipfftExtConvolution conv     = nullptr;
+    size_t               workSize = 0;
+    ASSERT_EQ(hipfftExtConvolutionPlan(&conv,
+                                       static_cast<int>(n.size()),
+                                       n.data(),
+                                       k.data(),
+                                       numFilters,
+                                       d_filters,
+                                       batch,
+                                       type,
+                                       mode,
+                                       &workSize),
+              HIPFFT_SUCCESS);
+    EXPECT_GT(workSize, 0);
+
+    // the filters' spectra are cached, so the filters can change
+    ASSERT_EQ(hipMemset(d_filters, 0, filters.size() * sizeof(T)), hipSuccess);
+    ASSERT_EQ(hipfftExtConvolutionExec(conv, d_signals, d_out), HIPFFT_SUCCESS);
+
+    std::vector<T> out(batch * numFilters * out_count);
+    ASSERT_EQ(hipMemcpy(out.data(), d_out, out.size() * sizeof(T), hipMemcpyDeviceToHost),
+              hipSuccess);
+
+    double max_ref = 1.0;
+    double error   = 0.0;
+    for(long long int b = 0; b < batch; ++b)
+    {
+        for(long long int f = 0; f < numFilters; ++f)
+        {
+            const auto ref = convolve_reference(n,
+                                                k,
+                                                circular,
+                                                signals.data() + b * signal_count,
+                                                filters.data() + f * filter_count);
+            const T*   result = out.data() + (b * numFilters + f) * out_count;
+            for(size_t i = 0; i < out_count; ++i)
+            {
+                max_ref = std::max(max_ref, std::abs(ref[i]));
+                error   = std::max(error, std::abs(to_complex(result[i]) - ref[i]));
+            }
+        }
+    }
+    EXPECT_LE(error, tolerance * max_ref);
+
+    ASSERT_EQ(hipfftExtConvolutionDestroy(conv), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipFree(d_signals), hipSuccess);
+    ASSERT_EQ(hipFree(d_filters), hipSuccess);
+    ASSERT_EQ(hipFree(d_out), hipSuccess);
+}
+
+TEST(hipfft_convolution, circular)
+{
+    check_convolution<hipfftComplex>(
+        HIPFFT_C2C, {64}, {64}, 1, 3, HIPFFT_CONVOLUTION_CIRCULAR, 1e-5);
+    check_convolution<hipfftDoubleComplex>(
+        HIPFFT_Z2Z, {12, 20}, {5, 3}, 2, 1, HIPFFT_CONVOLUTION_CIRCULAR, 1e-12);
+    check_convolution<float>(HIPFFT_R2C, {100}, {7}, 3, 2, HIPFFT_CONVOLUTION_CIRCULAR, 1e-5);
+    check_convolution<double>(
+        HIPFFT_D2Z, {8, 6, 10}, {3, 3, 3}, 1, 2, HIPFFT_CONVOLUTION_CIRCULAR, 1e-12);
+}
+
+TEST(hipfft_convolution, linear)
+{
+    check_convolution<hipfftComplex>(HIPFFT_C2C, {50}, {15}, 2, 2, HIPFFT_CONVOLUTION_LINEAR, 1e-5);
+    check_convolution<hipfftDoubleComplex>(
+        HIPFFT_Z2Z, {6, 8, 5}, {2, 3, 4}, 1, 1, HIPFFT_CONVOLUTION_LINEAR, 1e-12);
+    check_convolution<float>(HIPFFT_R2C, {30, 17}, {5, 4}, 4, 1, HIPFFT_CONVOLUTION_LINEAR, 1e-5);
+    check_convolution<double>(HIPFFT_D2Z, {128}, {33}, 1, 3, HIPFFT_CONVOLUTION_LINEAR, 1e-12);
+}
+
+TEST(hipfft_convolution, invalid)
+{
+    long long int n       = 16;
+    float*        filters = nullptr;
+    ASSERT_EQ(hipMalloc(&filters, 2 * n * sizeof(float)), hipSuccess);
+
+    const auto plan = [&](long long int            k,
+                          long long int            numFilters,
+                          const void*              f,
+                          hipfftType               type,
+                          hipfftExtConvolutionMode mode) {
+        hipfftExtConvolution conv     = nullptr;
+        size_t               workSize = 0;
+        return hipfftExtConvolutionPlan(
+            &conv, 1, &n, &k, numFilters, f, 1, type, mode, &workSize);
+    };
+
+    // circular filters can't be longer than the signals
+    EXPECT_EQ(plan(2 * n, 1, filters, HIPFFT_R2C, HIPFFT_CONVOLUTION_CIRCULAR),
+              HIPFFT_INVALID_SIZE);
+    // convolutions go from real to real or complex to complex
+    EXPECT_EQ(plan(n, 1, filters, HIPFFT_C2R, HIPFFT_CONVOLUTION_LINEAR), HIPFFT_INVALID_TYPE);
+    EXPECT_EQ(plan(n, 0, filters, HIPFFT_R2C, HIPFFT_CONVOLUTION_LINEAR), HIPFFT_INVALID_VALUE);
+    EXPECT_EQ(plan(n, 1, nullptr, HIPFFT_R2C, HIPFFT_CONVOLUTION_LINEAR), HIPFFT_INVALID_VALUE);
+    EXPECT_EQ(plan(0, 1, filters, HIPFFT_R2C, HIPFFT_CONVOLUTION_LINEAR), HIPFFT_INVALID_SIZE);
+    EXPECT_EQ(hipfftExtConvolutionExec(nullptr, filters, filters), HIPFFT_INVALID_VALUE);
+
+    ASSERT_EQ(hipFree(filters), hipSuccess);
+}
+
+#endif
@@ -0,0 +1,70 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+#ifndef HIPFFT_TEST_VALUES_H
+#define HIPFFT_TEST_VALUES_H
+
+// Conversions and test data shared by the tests of the library's
+// extensions.
+
+#include "hipfft/hipfft.h"
+#include <cmath>
+#include <complex>
+
+// widen a real or complex element for host references
+inline std::complex<double> to_complex(float v)
+{
+    return v;
+}
+inline std::complex<double> to_complex(double v)
+{
+    return v;
+}
+inline std::complex<double> to_complex(hipfftComplex v)
+{
+    return {v.x, v.y};
+}
+inline std::complex<double> to_complex(hipfftDoubleComplex v)
+{
+    return {v.x, v.y};
+}
+
+// deterministic test data for element i.  A different seed gives
+// different data.
+inline void fill_value(float& v, size_t i, size_t seed = 0)
+{
+    v = std::sin(0.37 * i + seed);
+}
+inline void fill_value(double& v, size_t i, size_t seed = 0)
+{
+    v = std::sin(0.37 * i + seed);
+}
+inline void fill_value(hipfftComplex& v, size_t i, size_t seed = 0)
+{
+    v = hipfftComplex{static_cast<float>(std::sin(0.37 * i + seed)),
+                      static_cast<float>(std::cos(0.11 * i + seed))};
+}
+inline void fill_value(hipfftDoubleComplex& v, size_t i, size_t seed = 0)
+{
+    v = hipfftDoubleComplex{std::sin(0.37 * i + seed), std::cos(0.11 * i + seed)};
+}
+
+#endif
@@ -0,0 +1,809 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+// Tests of the built-in load and store ops.  The host reference is
+// checked against known window values, and the library's fused ops
+// against the reference applied around a plain transform.  Integer
+// input, which is converted by the same load callback, is checked
+// against converting the input before a single-precision transform,
+// and half and bfloat16 data, converted by the load and store
+// callbacks, against a single-precision FFTW transform.
+
+#include "../../shared/hipfft_ops.h"
+#include "hipfft/hipfft.h"
+#include "hipfft/hipfftXt.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+#include "../../shared/fftw_transform.h"
+
+#include "../hipfft_params.h"
+#include "hipfft_test_values.h"
+
+DISABLE_WARNING_PUSH
+DISABLE_WARNING_DEPRECATED_DECLARATIONS
+DISABLE_WARNING_RETURN_TYPE
+#include <hip/hip_runtime_api.h>
+DISABLE_WARNING_POP
+
+TEST(hipfft_op, window_reference)
+{
+    const size_t N = 9;
+
+    // symmetric windows are 0 or nearly 0 at the ends, and 1 in the
+    // middle of an odd length
+    for(auto op : {HIPFFT_OP_WINDOW_HANN, HIPFFT_OP_WINDOW_BLACKMAN})
+    {
+        EXPECT_NEAR(hipfft_op_window(op, 0.0, 0, N), 0.0, 1e-12);
+        EXPECT_NEAR(hipfft_op_window(op, 0.0, N - 1, N), 0.0, 1e-12);
+        EXPECT_NEAR(hipfft_op_window(op, 0.0, N / 2, N), 1.0, 1e-12);
+    }
+    EXPECT_NEAR(hipfft_op_window(HIPFFT_OP_WINDOW_HAMMING, 0.0, 0, N), 0.08, 1e-12);
+    EXPECT_NEAR(hipfft_op_window(HIPFFT_OP_WINDOW_HAMMING, 0.0, N / 2, N), 1.0, 1e-12);
+
+    // Kaiser with beta = 0 is rectangular, and otherwise peaks at 1
+    // and falls to 1 / I0(beta) at the ends
+    for(size_t n = 0; n < N; ++n)
+        EXPECT_NEAR(hipfft_op_window(HIPFFT_OP_WINDOW_KAISER, 0.0, n, N), 1.0, 1e-12);
+    const double beta = 8.6;
+    EXPECT_NEAR(hipfft_op_window(HIPFFT_OP_WINDOW_KAISER, beta, N / 2, N), 1.0, 1e-12);
+    EXPECT_NEAR(hipfft_op_window(HIPFFT_OP_WINDOW_KAISER, beta, 0, N),
+                1.0 / hipfft_op_bessel_i0(beta),
+                1e-12);
+    // I0(1) from tables
+    EXPECT_NEAR(hipfft_op_bessel_i0(1.0), 1.2660658777520082, 1e-14);
+}
+
+TEST(hipfft_op, elementwise_reference)
+{
+    // 2 x 3 complex elements, batch 2, with a gap between batches
+    const std::vector<size_t> length = {2, 3};
+    const std::vector<size_t> stride = {1, 2};
+    const size_t              dist   = 8;
+    const size_t              batch  = 2;
+
+    std::vector<hipfftComplex> in(dist * batch), array(dist * batch);
+    for(size_t i = 0; i < in.size(); ++i)
+    {
+        in[i]    = hipfftComplex{static_cast<float>(i), 1.0f};
+        array[i] = hipfftComplex{0.0f, 2.0f};
+    }
+
+    std::vector<hipfftComplex> out(in.size(), hipfftComplex{-1.0f, -1.0f});
+    const auto                 apply = [&](hipfftExtOp op, double param) {
+        hipfft_op_reference(
+            op, param, array.data(), length, stride, dist, batch, in.data(), out.data());
+    };
+
+    apply(HIPFFT_OP_CONJUGATE, 0.0);
+    EXPECT_EQ(out[9].x, 9.0f);
+    EXPECT_EQ(out[9].y, -1.0f);
+    // elements outside the layout are left alone
+    EXPECT_EQ(out[6].x, -1.0f);
+
+    apply(HIPFFT_OP_MULTIPLY, 0.0);
+    EXPECT_EQ(out[3].x, -2.0f);
+    EXPECT_EQ(out[3].y, 6.0f);
+
+    apply(HIPFFT_OP_SCALE, 0.5);
+    EXPECT_EQ(out[13].x, 6.5f);
+    EXPECT_EQ(out[13].y, 0.5f);
+
+    // magnitudes are real values at the same offsets
+    in[12] = hipfftComplex{3.0f, 4.0f};
+    apply(HIPFFT_OP_MAGNITUDE, 0.0);
+    EXPECT_EQ(reinterpret_cast<const float*>(out.data())[12], 5.0f);
+    apply(HIPFFT_OP_POWER, 0.0);
+    EXPECT_EQ(reinterpret_cast<const float*>(out.data())[12], 25.0f);
+}
+
+TEST(hipfft_op, storage_conversion)
+{
+    const auto bfloat16 = [](float v) { return single_to_storage<storage_bfloat16>(v).bits; };
+
+    // bfloat16 keeps 8 bits of significand, rounding to nearest even
+    EXPECT_EQ(bfloat16(1.0f), 0x3f80);
+    EXPECT_EQ(bfloat16(-2.0f), 0xc000);
+    EXPECT_EQ(bfloat16(1.0f + 1.0f / 256), 0x3f80);
+    EXPECT_EQ(bfloat16(1.0f + 3.0f / 256), 0x3f82);
+    EXPECT_EQ(bfloat16(1.0f + 1.0f / 128 + 1.0f / 1024), 0x3f81);
+    EXPECT_TRUE(std::isnan(storage_to_single(single_to_storage<storage_bfloat16>(NAN))));
+    EXPECT_EQ(storage_to_single(storage_bfloat16{0x3fc0}), 1.5f);
+    EXPECT_NEAR(storage_to_single(single_to_storage<_Float16>(0.1f)), 0.1f, 0.1f / 2048);
+
+    // the mixed-precision reference rounds its single-precision
+    // result: the transform of an impulse is constant
+    std::vector<_Float16> impulse(2 * 8, static_cast<_Float16>(0.0f));
+    impulse[0] = static_cast<_Float16>(3.0f);
+    const auto out = fftw_mixed_precision_transform<_Float16, storage_bfloat16>(
+        {8}, 1, false, false, FFTW_FORWARD, impulse);
+    ASSERT_EQ(out.size(), impulse.size());
+    for(size_t i = 0; i < out.size(); ++i)
+        EXPECT_EQ(storage_to_single(out[i]), i % 2 ? 0.0f : 3.0f);
+}
+
+#ifdef __HIP_PLATFORM_AMD__
+
+template <typename T>
+static std::vector<T> test_data(size_t count, size_t seed)
+{
+    std::vector<T> data(count);
+    for(size_t i = 0; i < count; ++i)
+        fill_value(data[i], i, seed);
+    return data;
+}
+
+// strides of a contiguous col-major layout
+static std::vector<size_t> contiguous_strides(const std::vector<size_t>& length)
+{
+    std::vector<size_t> stride(length.size(), 1);
+    for(size_t i = 1; i < length.size(); ++i)
+        stride[i] = stride[i - 1] * length[i - 1];
+    return stride;
+}
+
+// Execute a transform with an op fused into it, and compare with
+// the reference op applied to the input or output of the same
+// transform without the op.
+template <typename Tin, typename Tout>
+static void check_op(hipfftType       type,
+                     std::vector<int> n,
+                     int              batch,
+                     bool             load,
+                     hipfftExtOp      op,
+                     double           param)
+{
+    typedef typename hipfft_op_real_type<Tout>::type real_type;
+
+    std::vector<size_t> inLength(n.rbegin(), n.rend());
+    std::vector<size_t> outLength = inLength;
+    const bool          r2c       = type == HIPFFT_R2C || type == HIPFFT_D2Z;
+    const bool          c2r       = type == HIPFFT_C2R || type == HIPFFT_Z2D;
+    if(r2c)
+        outLength.front() = outLength.front() / 2 + 1;
+    if(c2r)
+        inLength.front() = inLength.front() / 2 + 1;
+    const auto inStride  = contiguous_strides(inLength);
+    const auto outStride = contiguous_strides(outLength);
+    const auto volume    = [](const std::vector<size_t>& length) {
+        return std::accumulate(
+            length.begin(), length.end(), size_t(1), std::multiplies<size_t>());
+    };
+    const size_t inDist   = volume(inLength);
+    const size_t outDist  = volume(outLength);
+    const size_t inCount  = inDist * batch;
+    const size_t outCount = outDist * batch;
+
+    const auto in       = test_data<Tin>(inCount, 0);
+    const auto inArray  = test_data<Tin>(inCount, 1);
+    const auto outArray = test_data<Tout>(outCount, 2);
+
+    Tin*  d_in    = nullptr;
+    Tout* d_out   = nullptr;
+    void* d_array = nullptr;
+    ASSERT_EQ(hipMalloc(&d_in, inCount * sizeof(Tin)), hipSuccess);
+    ASSERT_EQ(hipMalloc(&d_out, outCount * sizeof(Tout)), hipSuccess);
+    if(load)
+    {
+        ASSERT_EQ(hipMalloc(&d_array, inCount * sizeof(Tin)), hipSuccess);
+        ASSERT_EQ(hipMemcpy(d_array, inArray.data(), inCount * sizeof(Tin), hipMemcpyHostToDevice),
+                  hipSuccess);
+    }
+    else
+    {
+        ASSERT_EQ(hipMalloc(&d_array, outCount * sizeof(Tout)), hipSuccess);
+        ASSERT_EQ(
+            hipMemcpy(d_array, outArray.data(), outCount * sizeof(Tout), hipMemcpyHostToDevice),
+            hipSuccess);
+    }
+
+    hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftPlanMany(&plan,
+                             static_cast<int>(n.size()),
+                             n.data(),
+                             nullptr,
+                             1,
+                             0,
+                             nullptr,
+                             1,
+                             0,
+                             type,
+                             batch),
+              HIPFFT_SUCCESS);
+
+    const int direction = c2r ? HIPFFT_BACKWARD : HIPFFT_FORWARD;
+    const auto run      = [&](const std::vector<Tin>& input) {
+        std::vector<Tout> output(outCount);
+        EXPECT_EQ(hipMemcpy(d_in, input.data(), inCount * sizeof(Tin), hipMemcpyHostToDevice),
+                  hipSuccess);
+        EXPECT_EQ(hipfftXtExec(plan, d_in, d_out, direction), HIPFFT_SUCCESS);
+        EXPECT_EQ(hipMemcpy(output.data(), d_out, outCount * sizeof(Tout), hipMemcpyDeviceToHost),
+                  hipSuccess);
+        return output;
+    };
+
+    ASSERT_EQ(load ? hipfftExtSetLoadOp(plan, op, param, d_array)
+                   : hipfftExtSetStoreOp(plan, op, param, d_array),
+              HIPFFT_SUCCESS);
+    const auto actual = run(in);
+
+    // removing the op gives back the plain transform
+    ASSERT_EQ(load ? hipfftExtSetLoadOp(plan, HIPFFT_OP_NONE, 0.0, nullptr)
+                   : hipfftExtSetStoreOp(plan, HIPFFT_OP_NONE, 0.0, nullptr),
+              HIPFFT_SUCCESS);
+    std::vector<Tout> expected;
+    if(load)
+    {
+        auto opIn = in;
+        hipfft_op_reference(
+            op, param, inArray.data(), inLength, inStride, inDist, batch, in.data(), opIn.data());
+        expected = run(opIn);
+    }
+    else
+    {
+        const auto plain = run(in);
+        expected         = plain;
+        hipfft_op_reference(op,
+                            param,
+                            outArray.data(),
+                            outLength,
+                            outStride,
+                            outDist,
+                            batch,
+                            plain.data(),
+                            expected.data());
+    }
+
+    // magnitude and power only fill the start of the output with
+    // real values
+    const size_t reals = op == HIPFFT_OP_MAGNITUDE || op == HIPFFT_OP_POWER
+                             ? outCount
+                             : outCount * sizeof(Tout) / sizeof(real_type);
+    const auto*  a     = reinterpret_cast<const real_type*>(actual.data());
+    const auto*  e     = reinterpret_cast<const real_type*>(expected.data());
+    double       scale = 1.0;
+    double       error = 0.0;
+    for(size_t i = 0; i < reals; ++i)
+    {
+        scale = std::max(scale, std::abs(static_cast<double>(e[i])));
+        error = std::max(error, std::abs(static_cast<double>(a[i]) - e[i]));
+    }
+    const double tolerance = sizeof(real_type) == sizeof(float) ? 1e-4 : 1e-10;
+    EXPECT_LE(error, tolerance * scale) << "op " << op << (load ? " on load" : " on store");
+
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipFree(d_in), hipSuccess);
+    ASSERT_EQ(hipFree(d_out), hipSuccess);
+    ASSERT_EQ(hipFree(d_array), hipSuccess);
+}
+
+TEST(hipfft_op, load_ops)
+{
+    for(auto op : {HIPFFT_OP_SCALE,
+                   HIPFFT_OP_WINDOW_HANN,
+                   HIPFFT_OP_WINDOW_HAMMING,
+                   HIPFFT_OP_WINDOW_BLACKMAN,
+                   HIPFFT_OP_WINDOW_KAISER,
+                   HIPFFT_OP_CONJUGATE,
+                   HIPFFT_OP_MULTIPLY})
+    {
+        const double param = op == HIPFFT_OP_SCALE ? 0.25 : 6.0;
+        check_op<hipfftComplex, hipfftComplex>(HIPFFT_C2C, {12, 40}, 3, true, op, param);
+        check_op<hipfftDoubleComplex, hipfftDoubleComplex>(
+            HIPFFT_Z2Z, {64}, 2, true, op, param);
+        if(op != HIPFFT_OP_CONJUGATE)
+        {
+            check_op<hipfftReal, hipfftComplex>(HIPFFT_R2C, {6, 30}, 2, true, op, param);
+            check_op<hipfftDoubleReal, hipfftDoubleComplex>(
+                HIPFFT_D2Z, {100}, 1, true, op, param);
+        }
+    }
+}
+
+TEST(hipfft_op, store_ops)
+{
+    for(auto op : {HIPFFT_OP_SCALE,
+                   HIPFFT_OP_WINDOW_HANN,
+                   HIPFFT_OP_WINDOW_KAISER,
+                   HIPFFT_OP_CONJUGATE,
+                   HIPFFT_OP_MULTIPLY,
+                   HIPFFT_OP_MAGNITUDE,
+                   HIPFFT_OP_POWER})
+    {
+        const double param = op == HIPFFT_OP_SCALE ? 0.25 : 6.0;
+        check_op<hipfftComplex, hipfftComplex>(HIPFFT_C2C, {8, 8, 8}, 1, false, op, param);
+        check_op<hipfftReal, hipfftComplex>(HIPFFT_R2C, {256}, 4, false, op, param);
+        if(op != HIPFFT_OP_CONJUGATE)
+        {
+            check_op<hipfftDoubleComplex, hipfftDoubleReal>(
+                HIPFFT_Z2D, {10, 16}, 2, false, op, param);
+        }
+    }
+
+    // magnitudes of complex output are stored in a pass of their
+    // own, so they can't overwrite output that the last of several
+    // kernels hasn't read yet
+    for(auto op : {HIPFFT_OP_MAGNITUDE, HIPFFT_OP_POWER})
+    {
+        check_op<hipfftComplex, hipfftComplex>(HIPFFT_C2C, {512, 1024}, 1, false, op, 0.0);
+        check_op<hipfftReal, hipfftComplex>(HIPFFT_R2C, {64, 64, 64}, 2, false, op, 0.0);
+        check_op<hipfftDoubleComplex, hipfftDoubleComplex>(
+            HIPFFT_Z2Z, {96, 80, 128}, 1, false, op, 0.0);
+    }
+}
+
+TEST(hipfft_op, invalid_ops)
+{
+    hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    // the plan must be made first
+    EXPECT_EQ(hipfftExtSetLoadOp(plan, HIPFFT_OP_SCALE, 2.0, nullptr), HIPFFT_INVALID_PLAN);
+
+    size_t workSize = 0;
+    ASSERT_EQ(hipfftMakePlan1d(plan, 64, HIPFFT_R2C, 1, &workSize), HIPFFT_SUCCESS);
+    EXPECT_EQ(hipfftExtSetLoadOp(plan, HIPFFT_OP_MAGNITUDE, 0.0, nullptr), HIPFFT_INVALID_VALUE);
+    EXPECT_EQ(hipfftExtSetLoadOp(plan, HIPFFT_OP_CONJUGATE, 0.0, nullptr), HIPFFT_INVALID_VALUE);
+    EXPECT_EQ(hipfftExtSetLoadOp(plan, HIPFFT_OP_MULTIPLY, 0.0, nullptr), HIPFFT_INVALID_VALUE);
+    EXPECT_EQ(hipfftExtSetLoadOp(plan, HIPFFT_OP_WINDOW_KAISER, -1.0, nullptr),
+              HIPFFT_INVALID_VALUE);
+    EXPECT_EQ(hipfftExtSetStoreOp(plan, static_cast<hipfftExtOp>(100), 0.0, nullptr),
+              HIPFFT_INVALID_VALUE);
+    // complex output can be conjugated
+    EXPECT_EQ(hipfftExtSetStoreOp(plan, HIPFFT_OP_CONJUGATE, 0.0, nullptr), HIPFFT_SUCCESS);
+
+    // magnitudes of complex output need separate input and output
+    hipfftComplex* d_data = nullptr;
+    ASSERT_EQ(hipMalloc(&d_data, 33 * sizeof(hipfftComplex)), hipSuccess);
+    EXPECT_EQ(hipfftExtSetStoreOp(plan, HIPFFT_OP_MAGNITUDE, 0.0, nullptr), HIPFFT_SUCCESS);
+    EXPECT_EQ(hipfftExecR2C(plan, reinterpret_cast<hipfftReal*>(d_data), d_data),
+              HIPFFT_INVALID_VALUE);
+    ASSERT_EQ(hipFree(d_data), hipSuccess);
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+}
+
+TEST(hipfft_op, serialize_ops)
+{
+    const size_t N     = 64;
+    const size_t batch = 2;
+
+    std::vector<hipfftComplex> in(N * batch);
+    for(size_t i = 0; i < in.size(); ++i)
+        in[i] = hipfftComplex{static_cast<float>(i % 7), static_cast<float>(i % 5) - 2.0f};
+    hipfftComplex* d_in  = nullptr;
+    hipfftComplex* d_out = nullptr;
+    ASSERT_EQ(hipMalloc(&d_in, in.size() * sizeof(hipfftComplex)), hipSuccess);
+    ASSERT_EQ(hipMalloc(&d_out, in.size() * sizeof(hipfftComplex)), hipSuccess);
+    ASSERT_EQ(hipMemcpy(d_in, in.data(), in.size() * sizeof(hipfftComplex), hipMemcpyHostToDevice),
+              hipSuccess);
+
+    auto run = [&](hipfftHandle plan) {
+        std::vector<hipfftComplex> out(in.size());
+        EXPECT_EQ(hipfftExecC2C(plan, d_in, d_out, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+        EXPECT_EQ(
+            hipMemcpy(
+                out.data(), d_out, out.size() * sizeof(hipfftComplex), hipMemcpyDeviceToHost),
+            hipSuccess);
+        return out;
+    };
+
+    hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    size_t workSize = 0;
+    ASSERT_EQ(hipfftMakePlan1d(plan, N, HIPFFT_C2C, batch, &workSize), HIPFFT_SUCCESS);
+
+    // an array's device pointer can't be serialized
+    ASSERT_EQ(hipfftExtSetStoreOp(plan, HIPFFT_OP_MULTIPLY, 0.0, d_in), HIPFFT_SUCCESS);
+    void*  buffer     = nullptr;
+    size_t bufferSize = 0;
+    EXPECT_EQ(hipfftExtPlanSerialize(plan, &buffer, &bufferSize), HIPFFT_NOT_SUPPORTED);
+
+    ASSERT_EQ(hipfftExtSetLoadOp(plan, HIPFFT_OP_WINDOW_KAISER, 4.0, nullptr), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtSetStoreOp(plan, HIPFFT_OP_SCALE, 0.5, nullptr), HIPFFT_SUCCESS);
+    const auto expected = run(plan);
+    ASSERT_EQ(hipfftExtPlanSerialize(plan, &buffer, &bufferSize), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+
+    // the loaded plan applies the same ops
+    hipfftHandle loaded = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&loaded), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtPlanDeserialize(loaded, buffer, bufferSize, nullptr), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtPlanBufferFree(buffer), HIPFFT_SUCCESS);
+    const auto actual = run(loaded);
+    for(size_t i = 0; i < expected.size(); ++i)
+    {
+        EXPECT_NEAR(actual[i].x, expected[i].x, 1e-4 * (1.0 + std::abs(expected[i].x)));
+        EXPECT_NEAR(actual[i].y, expected[i].y, 1e-4 * (1.0 + std::abs(expected[i].y)));
+    }
+
+    ASSERT_EQ(hipfftDestroy(loaded), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipFree(d_in), hipSuccess);
+    ASSERT_EQ(hipFree(d_out), hipSuccess);
+}
+
+// transform integer input of type S, scaled as it's loaded
+template <typename S>
+static void check_integer_input(hipDataType                type,
+                                std::vector<long long int> n,
+                                long long int              batch,
+                                double                     scale)
+{
+    const bool   real       = type == HIP_R_8I || type == HIP_R_16I;
+    const size_t components = real ? 1 : 2;
+    const auto   rank       = static_cast<int>(n.size());
+
+    // n is row-major, so the last length is the fastest
+    size_t inCount  = batch;
+    size_t outCount = batch;
+    for(size_t i = 0; i < n.size(); ++i)
+    {
+        inCount *= n[i];
+        outCount *= real && i + 1 == n.size() ? n[i] / 2 + 1 : n[i];
+    }
+
+    // values spanning most of the range of S, and the same values
+    // converted and scaled
+    std::vector<S>     in(inCount * components);
+    std::vector<float> converted(in.size());
+    for(size_t i = 0; i < in.size(); ++i)
+    {
+        const int value = static_cast<int>(i * 7919 % 251) - 125;
+        in[i]           = static_cast<S>(sizeof(S) == 1 ? value : value * 251);
+        converted[i]    = static_cast<float>(in[i] * scale);
+    }
+
+    S*             d_in        = nullptr;
+    float*         d_converted = nullptr;
+    hipfftComplex* d_out       = nullptr;
+    hipfftComplex* d_ref       = nullptr;
+    ASSERT_EQ(hipMalloc(&d_in, in.size() * sizeof(S)), hipSuccess);
+    ASSERT_EQ(hipMalloc(&d_converted, converted.size() * sizeof(float)), hipSuccess);
+    ASSERT_EQ(hipMalloc(&d_out, outCount * sizeof(hipfftComplex)), hipSuccess);
+    ASSERT_EQ(hipMalloc(&d_ref, outCount * sizeof(hipfftComplex)), hipSuccess);
+    ASSERT_EQ(hipMemcpy(d_in, in.data(), in.size() * sizeof(S), hipMemcpyHostToDevice),
+              hipSuccess);
+    ASSERT_EQ(hipMemcpy(d_converted,
+                        converted.data(),
+                        converted.size() * sizeof(float),
+                        hipMemcpyHostToDevice),
+              hipSuccess);
+
+    hipfftHandle plan     = hipfft_params::INVALID_PLAN_HANDLE;
+    hipfftHandle ref_plan = hipfft_params::INVALID_PLAN_HANDLE;
+    size_t       workSize = 0;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftCreate(&ref_plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtMakePlanMany(plan,
+                                   rank,
+                                   n.data(),
+                                   nullptr,
+                                   1,
+                                   0,
+                                   type,
+                                   nullptr,
+                                   1,
+                                   0,
+                                   HIP_C_32F,
+                                   batch,
+                                   &workSize,
+                                   HIP_C_32F),
+              HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtMakePlanMany(ref_plan,
+                                   rank,
+                                   n.data(),
+                                   nullptr,
+                                   1,
+                                   0,
+                                   real ? HIP_R_32F : HIP_C_32F,
+                                   nullptr,
+                                   1,
+                                   0,
+                                   HIP_C_32F,
+                                   batch,
+                                   &workSize,
+                                   HIP_C_32F),
+              HIPFFT_SUCCESS);
+
+    ASSERT_EQ(hipfftExtSetLoadOp(plan, HIPFFT_OP_SCALE, scale, nullptr), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtExec(plan, d_in, d_out, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtExec(ref_plan, d_converted, d_ref, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+
+    // integer input can't be transformed in place, or have a load
+    // callback of its own
+    EXPECT_EQ(hipfftXtExec(plan, d_in, d_in, HIPFFT_FORWARD), HIPFFT_INVALID_VALUE);
+    const auto cbtype = real ? HIPFFT_CB_LD_REAL : HIPFFT_CB_LD_COMPLEX;
+    EXPECT_EQ(hipfftXtSetCallback(plan, nullptr, cbtype, nullptr), HIPFFT_NOT_SUPPORTED);
+
+    std::vector<hipfftComplex> out(outCount), ref(outCount);
+    ASSERT_EQ(hipMemcpy(out.data(), d_out, outCount * sizeof(hipfftComplex), hipMemcpyDeviceToHost),
+              hipSuccess);
+    ASSERT_EQ(hipMemcpy(ref.data(), d_ref, outCount * sizeof(hipfftComplex), hipMemcpyDeviceToHost),
+              hipSuccess);
+    double max_ref = 1.0;
+    double error   = 0.0;
+    for(size_t i = 0; i < outCount; ++i)
+    {
+        const double ref_x = ref[i].x;
+        const double ref_y = ref[i].y;
+        max_ref            = std::max(max_ref, std::hypot(ref_x, ref_y));
+        error              = std::max(error, std::hypot(out[i].x - ref_x, out[i].y - ref_y));
+    }
+    EXPECT_LE(error, 1e-5 * max_ref) << "input type " << type;
+
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftDestroy(ref_plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipFree(d_in), hipSuccess);
+    ASSERT_EQ(hipFree(d_converted), hipSuccess);
+    ASSERT_EQ(hipFree(d_out), hipSuccess);
+    ASSERT_EQ(hipFree(d_ref), hipSuccess);
+}
+
+// precision of a storage type, relative to the largest value
+template <typename T>
+static double storage_tolerance()
+{
+    return 1e-5;
+}
+template <>
+double storage_tolerance<_Float16>()
+{
+    return 1.0 / 1024;
+}
+template <>
+double storage_tolerance<storage_bfloat16>()
+{
+    return 1.0 / 128;
+}
+
+// transform data stored as Tin to Tout, computed in single
+// precision, and compare with FFTW.  Complex-to-complex transforms
+// are forward.
+template <typename Tin, typename Tout>
+static void check_mixed_precision(hipDataType                inputType,
+                                  hipDataType                outputType,
+                                  std::vector<long long int> n,
+                                  long long int              batch)
+{
+    const bool real_input  = inputType == HIP_R_16F || inputType == HIP_R_16BF;
+    const bool real_output = outputType == HIP_R_16F || outputType == HIP_R_16BF
+                             || outputType == HIP_R_32F;
+    const auto rank        = static_cast<int>(n.size());
+    const int  direction   = real_output ? HIPFFT_BACKWARD : HIPFFT_FORWARD;
+
+    // n is row-major, so the last length is the fastest
+    size_t realCount    = batch;
+    size_t complexCount = batch;
+    for(size_t i = 0; i < n.size(); ++i)
+    {
+        realCount *= n[i];
+        complexCount *= (real_input || real_output) && i + 1 == n.size() ? n[i] / 2 + 1 : n[i];
+    }
+    const size_t inCount  = real_input ? realCount : 2 * complexCount;
+    const size_t outCount = real_output ? realCount : 2 * complexCount;
+
+    const std::vector<int> length(n.begin(), n.end());
+    std::vector<Tin>       in(inCount);
+    if(real_output)
+    {
+        // complex-to-real input needs Hermitian symmetry, so take it
+        // from the transform of real data
+        std::vector<float> signal(realCount);
+        for(size_t i = 0; i < signal.size(); ++i)
+            signal[i] = std::sin(0.37f * i) + 0.25f * std::cos(1.3f * i);
+        in = fftw_mixed_precision_transform<float, Tin>(
+            length, static_cast<int>(batch), true, false, FFTW_FORWARD, signal);
+        ASSERT_EQ(in.size(), inCount);
+    }
+    else
+    {
+        for(size_t i = 0; i < in.size(); ++i)
+            in[i] = single_to_storage<Tin>(std::sin(0.37f * i) + 0.25f * std::cos(1.3f * i));
+    }
+
+    // the buffers only need to hold the data in its storage type
+    void* d_in  = nullptr;
+    void* d_out = nullptr;
+    ASSERT_EQ(hipMalloc(&d_in, inCount * sizeof(Tin)), hipSuccess);
+    ASSERT_EQ(hipMalloc(&d_out, outCount * sizeof(Tout)), hipSuccess);
+    ASSERT_EQ(hipMemcpy(d_in, in.data(), inCount * sizeof(Tin), hipMemcpyHostToDevice),
+              hipSuccess);
+
+    hipfftHandle plan     = hipfft_params::INVALID_PLAN_HANDLE;
+    size_t       workSize = 0;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtMakePlanMany(plan,
+                                   rank,
+                                   n.data(),
+                                   nullptr,
+                                   1,
+                                   0,
+                                   inputType,
+                                   nullptr,
+                                   1,
+                                   0,
+                                   outputType,
+                                   batch,
+                                   &workSize,
+                                   HIP_C_32F),
+              HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtExec(plan, d_in, d_out, direction), HIPFFT_SUCCESS);
+
+    // converted data can't be transformed in place, or have
+    // callbacks of its own
+    EXPECT_EQ(hipfftXtExec(plan, d_in, d_in, direction), HIPFFT_INVALID_VALUE);
+    if(!std::is_same<Tout, float>::value)
+        EXPECT_EQ(hipfftXtSetCallback(plan,
+                                      nullptr,
+                                      real_output ? HIPFFT_CB_ST_REAL : HIPFFT_CB_ST_COMPLEX,
+                                      nullptr),
+                  HIPFFT_NOT_SUPPORTED);
+
+    std::vector<Tout> out(outCount);
+    ASSERT_EQ(hipMemcpy(out.data(), d_out, outCount * sizeof(Tout), hipMemcpyDeviceToHost),
+              hipSuccess);
+
+    // converted input is left as it was, even by complex-to-real
+    // transforms
+    std::vector<Tin> in_after(inCount);
+    ASSERT_EQ(hipMemcpy(in_after.data(), d_in, inCount * sizeof(Tin), hipMemcpyDeviceToHost),
+              hipSuccess);
+    EXPECT_EQ(std::memcmp(in_after.data(), in.data(), inCount * sizeof(Tin)), 0);
+
+    const auto ref = fftw_mixed_precision_transform<Tin, Tout>(
+        length,
+        static_cast<int>(batch),
+        real_input,
+        real_output,
+        real_output ? FFTW_BACKWARD : FFTW_FORWARD,
+        in);
+    ASSERT_EQ(ref.size(), out.size());
+
+    double max_ref = 1.0;
+    double error   = 0.0;
+    for(size_t i = 0; i < outCount; ++i)
+    {
+        const double ref_value = storage_to_single(ref[i]);
+        max_ref                = std::max(max_ref, std::abs(ref_value));
+        error = std::max(error, std::abs(storage_to_single(out[i]) - ref_value));
+    }
+    EXPECT_LE(error, storage_tolerance<Tout>() * max_ref)
+        << "input type " << inputType << ", output type " << outputType;
+
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipFree(d_in), hipSuccess);
+    ASSERT_EQ(hipFree(d_out), hipSuccess);
+}
+
+TEST(hipfft_op, mixed_precision)
+{
+    check_mixed_precision<_Float16, _Float16>(HIP_C_16F, HIP_C_16F, {256}, 2);
+    check_mixed_precision<storage_bfloat16, storage_bfloat16>(
+        HIP_C_16BF, HIP_C_16BF, {16, 24}, 3);
+    check_mixed_precision<_Float16, storage_bfloat16>(HIP_R_16F, HIP_C_16BF, {12, 10, 8}, 1);
+    check_mixed_precision<storage_bfloat16, float>(HIP_R_16BF, HIP_C_32F, {100}, 4);
+    check_mixed_precision<float, _Float16>(HIP_C_32F, HIP_C_16F, {64, 64}, 1);
+    check_mixed_precision<_Float16, float>(HIP_C_16F, HIP_R_32F, {40, 24}, 2);
+
+    // sizes that rocFFT computes in several kernels, which read and
+    // write the output buffer in single precision before the last
+    // one stores the result
+    check_mixed_precision<_Float16, _Float16>(HIP_C_16F, HIP_C_16F, {512, 1024}, 1);
+    check_mixed_precision<storage_bfloat16, _Float16>(HIP_C_16BF, HIP_R_16F, {64, 64, 64}, 1);
+    check_mixed_precision<_Float16, storage_bfloat16>(HIP_R_16F, HIP_C_16BF, {96, 80, 128}, 2);
+
+    // only single precision is computed from narrower storage, and at
+    // least one side is complex
+    hipfftHandle  plan     = hipfft_params::INVALID_PLAN_HANDLE;
+    size_t        workSize = 0;
+    long long int n        = 64;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    const hipDataType invalid[][3] = {{HIP_C_16BF, HIP_C_16BF, HIP_C_16BF},
+                                      {HIP_C_16BF, HIP_C_16F, HIP_C_16F},
+                                      {HIP_C_16F, HIP_C_64F, HIP_C_32F},
+                                      {HIP_R_16F, HIP_R_16BF, HIP_C_32F},
+                                      {HIP_C_16F, HIP_C_8I, HIP_C_32F}};
+    for(const auto& types : invalid)
+        EXPECT_EQ(hipfftXtMakePlanMany(plan,
+                                       1,
+                                       &n,
+                                       nullptr,
+                                       1,
+                                       0,
+                                       types[0],
+                                       nullptr,
+                                       1,
+                                       0,
+                                       types[1],
+                                       1,
+                                       &workSize,
+                                       types[2]),
+                  HIPFFT_INVALID_VALUE);
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+}
+
+TEST(hipfft_op, integer_input)
+{
+    check_integer_input<short>(HIP_C_16I, {256}, 2, 1.0 / 32768);
+    check_integer_input<signed char>(HIP_C_8I, {16, 24}, 3, 1.0 / 128);
+    check_integer_input<short>(HIP_R_16I, {12, 10, 8}, 1, 1.0 / 32768);
+    check_integer_input<signed char>(HIP_R_8I, {100}, 4, 1.0);
+
+    // integer input is only converted to single precision
+    hipfftHandle  plan     = hipfft_params::INVALID_PLAN_HANDLE;
+    size_t        workSize = 0;
+    long long int n        = 64;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    EXPECT_EQ(hipfftXtMakePlanMany(plan,
+                                   1,
+                                   &n,
+                                   nullptr,
+                                   1,
+                                   0,
+                                   HIP_C_16I,
+                                   nullptr,
+                                   1,
+                                   0,
+                                   HIP_C_64F,
+                                   1,
+                                   &workSize,
+                                   HIP_C_64F),
+              HIPFFT_INVALID_VALUE);
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+}
+
+TEST(hipfft_op, converted_estimate)
+{
+    // input, output and execution types of converted transforms, with
+    // a size rocFFT computes in several kernels
+    const hipDataType types[][3] = {{HIP_C_16F, HIP_C_16F, HIP_C_32F},
+                                    {HIP_R_16BF, HIP_C_32F, HIP_C_32F},
+                                    {HIP_C_16I, HIP_C_32F, HIP_C_32F}};
+
+    long long int n[2] = {512, 1024};
+    for(const auto& t : types)
+    {
+        hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+        ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+
+        // estimates don't create plans or compile the conversion ops
+        hipfftExtPlanCacheStats before;
+        ASSERT_EQ(hipfftExtGetPlanCacheStats(&before), HIPFFT_SUCCESS);
+        size_t estimate = 0;
+        ASSERT_EQ(hipfftXtGetSizeMany(
+                      plan, 2, n, nullptr, 1, 0, t[0], nullptr, 1, 0, t[1], 2, &estimate, t[2]),
+                  HIPFFT_SUCCESS);
+        hipfftExtPlanCacheStats after;
+        ASSERT_EQ(hipfftExtGetPlanCacheStats(&after), HIPFFT_SUCCESS);
+        EXPECT_EQ(after.created, before.created);
+        EXPECT_EQ(after.hits + after.misses, before.hits + before.misses);
+
+        size_t workSize = 0;
+        ASSERT_EQ(hipfftXtMakePlanMany(
+                      plan, 2, n, nullptr, 1, 0, t[0], nullptr, 1, 0, t[1], 2, &workSize, t[2]),
+                  HIPFFT_SUCCESS);
+        EXPECT_GE(estimate, workSize);
+        ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    }
+}
+
+#endif
@@ -20,9 +20,12 @@
 
 #include "../../shared/accuracy_test.h"
 #include "../../shared/params_gen.h"
+#include "hipfft/hipfftXt.h"
 #include <algorithm>
 #include <gtest/gtest.h>
 #include <hip/hip_runtime_api.h>
+#include <limits>
+#include <numeric>
 
 static const std::vector<std::vector<size_t>> multi_gpu_sizes = {
     {128, 256},
@@ -85,3 +88,800 @@ INSTANTIATE_TEST_SUITE_P(multi_gpu,
                          accuracy_test,
                          ::testing::ValuesIn(param_generator_multi_gpu()),
                          accuracy_test::TestName);
+
+TEST(multi_gpu, XtMemcpyAsync)
+{
+    int deviceCount = 0;
+    ASSERT_EQ(hipGetDeviceCount(&deviceCount), hipSuccess);
+    if(deviceCount < 2)
+        GTEST_SKIP() << "need multiple devices";
+
+    std::vector<int> gpus(deviceCount);
+    std::iota(gpus.begin(), gpus.end(), 0);
+
+    const int    N     = 256;
+    const int    batch = deviceCount * 4;
+    const size_t total = static_cast<size_t>(N) * batch;
+
+    hipfftHandle plan = nullptr;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtSetGPUs(plan, deviceCount, gpus.data()), HIPFFT_SUCCESS);
+    int                 n[1] = {N};
+    std::vector<size_t> workSize(deviceCount);
+    ASSERT_EQ(hipfftMakePlanMany(
+                  plan, 1, n, nullptr, 1, N, nullptr, 1, N, HIPFFT_C2C, batch, workSize.data()),
+              HIPFFT_SUCCESS);
+
+    // pinned host buffers, so that the copies are really asynchronous
+    void* in_buf  = nullptr;
+    void* out_buf = nullptr;
+    ASSERT_EQ(hipHostMalloc(&in_buf, total * sizeof(hipfftComplex), 0), hipSuccess);
+    ASSERT_EQ(hipHostMalloc(&out_buf, total * sizeof(hipfftComplex), 0), hipSuccess);
+    auto in  = static_cast<hipfftComplex*>(in_buf);
+    auto out = static_cast<hipfftComplex*>(out_buf);
+    for(size_t i = 0; i < total; ++i)
+        in[i] = hipfftComplex{static_cast<float>(i), -static_cast<float>(i)};
+
+    hipStream_t stream;
+    ASSERT_EQ(hipStreamCreate(&stream), hipSuccess);
+
+    hipLibXtDesc* desc = nullptr;
+    ASSERT_EQ(hipfftXtMalloc(plan, &desc, HIPFFT_XT_FORMAT_INPLACE), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtMemcpyAsync(plan, desc, in, HIPFFT_COPY_HOST_TO_DEVICE, stream),
+              HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtMemcpyAsync(plan, out, desc, HIPFFT_COPY_DEVICE_TO_HOST, stream),
+              HIPFFT_SUCCESS);
+    ASSERT_EQ(hipStreamSynchronize(stream), hipSuccess);
+
+    for(size_t i = 0; i < total; ++i)
+    {
+        ASSERT_EQ(out[i].x, in[i].x);
+        ASSERT_EQ(out[i].y, in[i].y);
+    }
+
+    ASSERT_EQ(hipfftXtFree(desc), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipStreamDestroy(stream), hipSuccess);
+    ASSERT_EQ(hipHostFree(in), hipSuccess);
+    ASSERT_EQ(hipHostFree(out), hipSuccess);
+}
+
+TEST(multi_gpu, XtMemcpyStaged)
+{
+    int deviceCount = 0;
+    ASSERT_EQ(hipGetDeviceCount(&deviceCount), hipSuccess);
+    if(deviceCount < 2)
+        GTEST_SKIP() << "need multiple devices";
+
+    std::vector<int> gpus(deviceCount);
+    std::iota(gpus.begin(), gpus.end(), 0);
+
+    const int    N     = 256;
+    const int    batch = deviceCount * 4;
+    const size_t total = static_cast<size_t>(N) * batch;
+
+    hipfftHandle plan = nullptr;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtSetGPUs(plan, deviceCount, gpus.data()), HIPFFT_SUCCESS);
+    int                 n[1] = {N};
+    std::vector<size_t> workSize(deviceCount);
+    ASSERT_EQ(hipfftMakePlanMany(
+                  plan, 1, n, nullptr, 1, N, nullptr, 1, N, HIPFFT_C2C, batch, workSize.data()),
+              HIPFFT_SUCCESS);
+
+    // pageable host buffers, staged through a few small chunks
+    std::vector<hipfftComplex> in(total), out(total);
+    for(size_t i = 0; i < total; ++i)
+        in[i] = hipfftComplex{static_cast<float>(i), -static_cast<float>(i)};
+
+    const size_t chunkBytes = 1000;
+    ASSERT_EQ(hipfftExtSetStagingPool(2 * chunkBytes, chunkBytes), HIPFFT_SUCCESS);
+    hipfftExtStagingStats before;
+    ASSERT_EQ(hipfftExtGetStagingStats(&before), HIPFFT_SUCCESS);
+
+    hipLibXtDesc* desc = nullptr;
+    ASSERT_EQ(hipfftXtMalloc(plan, &desc, HIPFFT_XT_FORMAT_INPLACE), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtMemcpy(plan, desc, in.data(), HIPFFT_COPY_HOST_TO_DEVICE), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtMemcpy(plan, out.data(), desc, HIPFFT_COPY_DEVICE_TO_HOST), HIPFFT_SUCCESS);
+
+    for(size_t i = 0; i < total; ++i)
+    {
+        ASSERT_EQ(out[i].x, in[i].x);
+        ASSERT_EQ(out[i].y, in[i].y);
+    }
+
+    hipfftExtStagingStats after;
+    ASSERT_EQ(hipfftExtGetStagingStats(&after), HIPFFT_SUCCESS);
+    EXPECT_EQ(after.chunkBytes, chunkBytes);
+    EXPECT_LE(after.allocatedBytes, 2 * chunkBytes);
+    EXPECT_EQ(after.hostToDeviceBytes - before.hostToDeviceBytes, total * sizeof(hipfftComplex));
+    EXPECT_EQ(after.deviceToHostBytes - before.deviceToHostBytes, total * sizeof(hipfftComplex));
+    EXPECT_GE(after.chunks - before.chunks, 2 * total * sizeof(hipfftComplex) / chunkBytes);
+
+    // restore the default pool
+    ASSERT_EQ(hipfftExtSetStagingPool(32 << 20, 4 << 20), HIPFFT_SUCCESS);
+
+    ASSERT_EQ(hipfftXtFree(desc), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+}
+
+TEST(multi_gpu, XtMemcpyStrided)
+{
+    int deviceCount = 0;
+    ASSERT_EQ(hipGetDeviceCount(&deviceCount), hipSuccess);
+    if(deviceCount < 2)
+        GTEST_SKIP() << "need multiple devices";
+
+    std::vector<int> gpus(deviceCount);
+    std::iota(gpus.begin(), gpus.end(), 0);
+
+    // padded and strided 3D fields, which don't collapse to a 2D
+    // copy per device
+    const int    rank     = 3;
+    int          n[3]     = {8, 8, 8};
+    int          embed[3] = {8, 9, 10};
+    const int    stride   = 2;
+    const int    dist     = 8 * 9 * 10 * stride + 16;
+    const int    batch    = deviceCount;
+    const size_t span     = static_cast<size_t>(dist) * batch;
+
+    hipfftHandle plan = nullptr;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtSetGPUs(plan, deviceCount, gpus.data()), HIPFFT_SUCCESS);
+    std::vector<size_t> workSize(deviceCount);
+    ASSERT_EQ(hipfftMakePlanMany(plan,
+                                 rank,
+                                 n,
+                                 embed,
+                                 stride,
+                                 dist,
+                                 embed,
+                                 stride,
+                                 dist,
+                                 HIPFFT_C2C,
+                                 batch,
+                                 workSize.data()),
+              HIPFFT_SUCCESS);
+
+    std::vector<hipfftComplex> in(span), out(span, hipfftComplex{-1.0f, -1.0f});
+    for(size_t i = 0; i < span; ++i)
+        in[i] = hipfftComplex{static_cast<float>(i), -static_cast<float>(i)};
+
+    hipLibXtDesc* desc = nullptr;
+    ASSERT_EQ(hipfftXtMalloc(plan, &desc, HIPFFT_XT_FORMAT_INPLACE), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtMemcpy(plan, desc, in.data(), HIPFFT_COPY_HOST_TO_DEVICE), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtMemcpy(plan, out.data(), desc, HIPFFT_COPY_DEVICE_TO_HOST), HIPFFT_SUCCESS);
+
+    // elements of the field are copied back, padding is untouched
+    std::vector<bool> inField(span, false);
+    for(int b = 0; b < batch; ++b)
+        for(int i = 0; i < n[0]; ++i)
+            for(int j = 0; j < n[1]; ++j)
+                for(int k = 0; k < n[2]; ++k)
+                    inField[b * dist + ((i * embed[1] + j) * embed[2] + k) * stride] = true;
+    for(size_t i = 0; i < span; ++i)
+    {
+        if(inField[i])
+        {
+            ASSERT_EQ(out[i].x, in[i].x);
+            ASSERT_EQ(out[i].y, in[i].y);
+        }
+        else
+        {
+            ASSERT_EQ(out[i].x, -1.0f);
+        }
+    }
+
+    ASSERT_EQ(hipfftXtFree(desc), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+}
+
+TEST(multi_gpu, XtRedistribute)
+{
+    int deviceCount = 0;
+    ASSERT_EQ(hipGetDeviceCount(&deviceCount), hipSuccess);
+    if(deviceCount < 2)
+        GTEST_SKIP() << "need multiple devices";
+
+    std::vector<int> gpus(deviceCount);
+    std::iota(gpus.begin(), gpus.end(), 0);
+    std::vector<int> reversed(gpus.rbegin(), gpus.rend());
+
+    // a 2D plan split along its slow dimension, and a batch of 1D
+    // transforms over the same data split on batch among the devices
+    // in the opposite order
+    const int    N     = 64;
+    const int    M     = deviceCount * 3;
+    const size_t total = static_cast<size_t>(N) * M;
+
+    std::vector<size_t> workSize(deviceCount);
+
+    hipfftHandle plan2D = nullptr;
+    ASSERT_EQ(hipfftCreate(&plan2D), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtSetGPUs(plan2D, deviceCount, gpus.data()), HIPFFT_SUCCESS);
+    int n2D[2] = {M, N};
+    ASSERT_EQ(hipfftMakePlanMany(
+                  plan2D, 2, n2D, nullptr, 1, 0, nullptr, 1, 0, HIPFFT_C2C, 1, workSize.data()),
+              HIPFFT_SUCCESS);
+
+    hipfftHandle plan1D = nullptr;
+    ASSERT_EQ(hipfftCreate(&plan1D), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtSetGPUs(plan1D, deviceCount, reversed.data()), HIPFFT_SUCCESS);
+    int n1D[1] = {N};
+    ASSERT_EQ(hipfftMakePlanMany(
+                  plan1D, 1, n1D, nullptr, 1, N, nullptr, 1, N, HIPFFT_C2C, M, workSize.data()),
+              HIPFFT_SUCCESS);
+
+    std::vector<hipfftComplex> in(total), out(total);
+    for(size_t i = 0; i < total; ++i)
+        in[i] = hipfftComplex{static_cast<float>(i), -static_cast<float>(i)};
+
+    hipLibXtDesc* desc2D = nullptr;
+    hipLibXtDesc* desc1D = nullptr;
+    ASSERT_EQ(hipfftXtMalloc(plan2D, &desc2D, HIPFFT_XT_FORMAT_OUTPUT), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtMalloc(plan1D, &desc1D, HIPFFT_XT_FORMAT_INPUT), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtMemcpy(plan2D, desc2D, in.data(), HIPFFT_COPY_HOST_TO_DEVICE),
+              HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtXtRedistribute(plan1D, desc1D, plan2D, desc2D), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtMemcpy(plan1D, out.data(), desc1D, HIPFFT_COPY_DEVICE_TO_HOST),
+              HIPFFT_SUCCESS);
+
+    for(size_t i = 0; i < total; ++i)
+    {
+        ASSERT_EQ(out[i].x, in[i].x);
+        ASSERT_EQ(out[i].y, in[i].y);
+    }
+
+    ASSERT_EQ(hipfftXtFree(desc2D), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtFree(desc1D), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftDestroy(plan2D), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftDestroy(plan1D), HIPFFT_SUCCESS);
+}
+
+TEST(multi_gpu, WeightedDecomposition)
+{
+    int deviceCount = 0;
+    ASSERT_EQ(hipGetDeviceCount(&deviceCount), hipSuccess);
+    if(deviceCount < 2)
+        GTEST_SKIP() << "need multiple devices";
+
+    std::vector<int> gpus(deviceCount);
+    std::iota(gpus.begin(), gpus.end(), 0);
+
+    const int    N     = 256;
+    const int    batch = deviceCount * (deviceCount + 1);
+    const size_t total = static_cast<size_t>(N) * batch;
+
+    // device i gets i + 1 parts of the batch
+    std::vector<double> weights(deviceCount);
+    std::iota(weights.begin(), weights.end(), 1.0);
+
+    hipfftHandle plan = nullptr;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtSetGPUs(plan, deviceCount, gpus.data()), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtXtSetDecomposition(plan, HIPFFT_DECOMPOSITION_WEIGHTED, weights.data()),
+              HIPFFT_SUCCESS);
+    int                 n[1] = {N};
+    std::vector<size_t> workSize(deviceCount);
+    ASSERT_EQ(hipfftMakePlanMany(
+                  plan, 1, n, nullptr, 1, N, nullptr, 1, N, HIPFFT_C2C, batch, workSize.data()),
+              HIPFFT_SUCCESS);
+
+    hipfftExtDecompositionInfo info;
+    ASSERT_EQ(hipfftExtXtGetDecomposition(plan, &info), HIPFFT_SUCCESS);
+    ASSERT_EQ(info.nGPUs, deviceCount);
+    for(int i = 0; i < deviceCount; ++i)
+    {
+        EXPECT_EQ(info.GPUs[i], gpus[i]);
+        EXPECT_EQ(info.inputElements[i], static_cast<size_t>(N) * 2 * (i + 1));
+        EXPECT_EQ(info.outputElements[i], info.inputElements[i]);
+    }
+    EXPECT_NEAR(info.imbalance, 1.0, 1e-9);
+
+    // exact estimates find the cached plans for the weighted bricks
+    std::vector<size_t> exact(deviceCount);
+    ASSERT_EQ(hipfftExtSetEstimateMode(HIPFFT_ESTIMATE_EXACT), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftGetSizeMany(
+                  plan, 1, n, nullptr, 1, N, nullptr, 1, N, HIPFFT_C2C, batch, exact.data()),
+              HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtSetEstimateMode(HIPFFT_ESTIMATE_ANALYTIC), HIPFFT_SUCCESS);
+    EXPECT_EQ(exact.front(), workSize.front());
+
+    // uneven bricks still give the same result as a single device
+    std::vector<hipfftComplex> in(total), out(total), ref(total);
+    for(size_t i = 0; i < total; ++i)
+        in[i] = hipfftComplex{static_cast<float>(i % 7), -static_cast<float>(i % 5)};
+
+    hipLibXtDesc* desc = nullptr;
+    ASSERT_EQ(hipfftXtMalloc(plan, &desc, HIPFFT_XT_FORMAT_INPLACE), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtMemcpy(plan, desc, in.data(), HIPFFT_COPY_HOST_TO_DEVICE), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtExecDescriptor(plan, desc, desc, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtMemcpy(plan, out.data(), desc, HIPFFT_COPY_DEVICE_TO_HOST), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtFree(desc), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+
+    hipfftHandle refPlan = nullptr;
+    ASSERT_EQ(hipfftPlan1d(&refPlan, N, HIPFFT_C2C, batch), HIPFFT_SUCCESS);
+    hipfftComplex* buf = nullptr;
+    ASSERT_EQ(hipMalloc(&buf, total * sizeof(hipfftComplex)), hipSuccess);
+    ASSERT_EQ(hipMemcpy(buf, in.data(), total * sizeof(hipfftComplex), hipMemcpyHostToDevice),
+              hipSuccess);
+    ASSERT_EQ(hipfftExecC2C(refPlan, buf, buf, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipMemcpy(ref.data(), buf, total * sizeof(hipfftComplex), hipMemcpyDeviceToHost),
+              hipSuccess);
+    ASSERT_EQ(hipFree(buf), hipSuccess);
+    ASSERT_EQ(hipfftDestroy(refPlan), HIPFFT_SUCCESS);
+
+    for(size_t i = 0; i < total; ++i)
+    {
+        ASSERT_NEAR(out[i].x, ref[i].x, 1e-3);
+        ASSERT_NEAR(out[i].y, ref[i].y, 1e-3);
+    }
+}
+
+TEST(multi_gpu, UserBricks)
+{
+    int deviceCount = 0;
+    ASSERT_EQ(hipGetDeviceCount(&deviceCount), hipSuccess);
+    if(deviceCount < 2)
+        GTEST_SKIP() << "need multiple devices";
+
+    std::vector<int> gpus(deviceCount);
+    std::iota(gpus.begin(), gpus.end(), 0);
+
+    const int    NX    = 16 * deviceCount;
+    const int    NY    = 24 * deviceCount;
+    const size_t total = static_cast<size_t>(NX) * NY;
+
+    // input is split into slabs of rows, output into slabs of
+    // columns, each stored contiguously on its device
+    const long long             rows = NX / deviceCount;
+    const long long             cols = NY / deviceCount;
+    std::vector<hipfftExtBrick> inBricks(deviceCount), outBricks(deviceCount);
+    for(int i = 0; i < deviceCount; ++i)
+    {
+        inBricks[i]  = {{0, rows * i, 0}, {1, rows * (i + 1), NY}, {rows * NY, NY, 1}};
+        outBricks[i] = {{0, 0, cols * i}, {1, NX, cols * (i + 1)}, {NX * cols, cols, 1}};
+    }
+
+    // bricks that overlap are rejected when the plan is made
+    {
+        auto overlapping         = inBricks;
+        overlapping[0].upper[1] += 1;
+
+        hipfftHandle plan = nullptr;
+        ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipfftExtXtSetBricks(
+                      plan, deviceCount, gpus.data(), overlapping.data(), outBricks.data()),
+                  HIPFFT_SUCCESS);
+        std::vector<size_t> workSize(deviceCount);
+        EXPECT_EQ(hipfftMakePlan2d(plan, NX, NY, HIPFFT_C2C, workSize.data()),
+                  HIPFFT_INVALID_VALUE);
+        ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    }
+
+    hipfftHandle plan = nullptr;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(
+        hipfftExtXtSetBricks(plan, deviceCount, gpus.data(), inBricks.data(), outBricks.data()),
+        HIPFFT_SUCCESS);
+    std::vector<size_t> workSize(deviceCount);
+    ASSERT_EQ(hipfftMakePlan2d(plan, NX, NY, HIPFFT_C2C, workSize.data()), HIPFFT_SUCCESS);
+
+    std::vector<hipfftComplex> in(total), out(total), ref(total);
+    for(size_t i = 0; i < total; ++i)
+        in[i] = hipfftComplex{static_cast<float>(i % 7), -static_cast<float>(i % 5)};
+
+    hipLibXtDesc* inDesc  = nullptr;
+    hipLibXtDesc* outDesc = nullptr;
+    ASSERT_EQ(hipfftXtMalloc(plan, &inDesc, HIPFFT_XT_FORMAT_INPUT), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtMalloc(plan, &outDesc, HIPFFT_XT_FORMAT_OUTPUT), HIPFFT_SUCCESS);
+
+    // each device's slab of rows is stored contiguously
+    ASSERT_EQ(hipfftXtMemcpy(plan, inDesc, in.data(), HIPFFT_COPY_HOST_TO_DEVICE),
+              HIPFFT_SUCCESS);
+    for(int i = 0; i < deviceCount; ++i)
+    {
+        const size_t               slab = total / deviceCount;
+        std::vector<hipfftComplex> deviceIn(slab);
+        ASSERT_EQ(hipSetDevice(gpus[i]), hipSuccess);
+        ASSERT_EQ(hipMemcpy(deviceIn.data(),
+                            inDesc->descriptor->data[i],
+                            slab * sizeof(hipfftComplex),
+                            hipMemcpyDeviceToHost),
+                  hipSuccess);
+        for(size_t j = 0; j < slab; ++j)
+            ASSERT_EQ(deviceIn[j].x, in[slab * i + j].x);
+    }
+
+    ASSERT_EQ(hipfftXtExecDescriptor(plan, inDesc, outDesc, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtMemcpy(plan, out.data(), outDesc, HIPFFT_COPY_DEVICE_TO_HOST),
+              HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtFree(inDesc), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtFree(outDesc), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+
+    hipfftHandle refPlan = nullptr;
+    ASSERT_EQ(hipfftPlan2d(&refPlan, NX, NY, HIPFFT_C2C), HIPFFT_SUCCESS);
+    hipfftComplex* buf = nullptr;
+    ASSERT_EQ(hipMalloc(&buf, total * sizeof(hipfftComplex)), hipSuccess);
+    ASSERT_EQ(hipMemcpy(buf, in.data(), total * sizeof(hipfftComplex), hipMemcpyHostToDevice),
+              hipSuccess);
+    ASSERT_EQ(hipfftExecC2C(refPlan, buf, buf, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipMemcpy(ref.data(), buf, total * sizeof(hipfftComplex), hipMemcpyDeviceToHost),
+              hipSuccess);
+    ASSERT_EQ(hipFree(buf), hipSuccess);
+    ASSERT_EQ(hipfftDestroy(refPlan), HIPFFT_SUCCESS);
+
+    for(size_t i = 0; i < total; ++i)
+    {
+        ASSERT_NEAR(out[i].x, ref[i].x, 1e-2);
+        ASSERT_NEAR(out[i].y, ref[i].y, 1e-2);
+    }
+}
+
+TEST(multi_gpu, PencilDecomposition)
+{
+    int deviceCount = 0;
+    ASSERT_EQ(hipGetDeviceCount(&deviceCount), hipSuccess);
+    if(deviceCount < 2)
+        GTEST_SKIP() << "need multiple devices";
+
+    std::vector<int> gpus(deviceCount);
+    std::iota(gpus.begin(), gpus.end(), 0);
+
+    // use a 2D grid of devices where possible
+    const int columns = deviceCount % 2 == 0 ? 2 : 1;
+    const int rows    = deviceCount / columns;
+
+    const int    N     = 16 * deviceCount;
+    const size_t total = static_cast<size_t>(N) * N * N;
+
+    hipfftHandle plan = nullptr;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtSetGPUs(plan, deviceCount, gpus.data()), HIPFFT_SUCCESS);
+    EXPECT_EQ(hipfftExtXtSetPencilGrid(plan, rows + 1, columns), HIPFFT_INVALID_VALUE);
+    ASSERT_EQ(hipfftExtXtSetPencilGrid(plan, rows, columns), HIPFFT_SUCCESS);
+    std::vector<size_t> workSize(deviceCount);
+    ASSERT_EQ(hipfftMakePlan3d(plan, N, N, N, HIPFFT_C2C, workSize.data()), HIPFFT_SUCCESS);
+
+    // each device gets the same amount of data
+    hipfftExtDecompositionInfo info;
+    ASSERT_EQ(hipfftExtXtGetDecomposition(plan, &info), HIPFFT_SUCCESS);
+    ASSERT_EQ(info.nGPUs, deviceCount);
+    for(int i = 0; i < deviceCount; ++i)
+    {
+        EXPECT_EQ(info.inputElements[i], total / deviceCount);
+        EXPECT_EQ(info.outputElements[i], total / deviceCount);
+    }
+
+    std::vector<hipfftComplex> in(total), out(total), ref(total);
+    for(size_t i = 0; i < total; ++i)
+        in[i] = hipfftComplex{static_cast<float>(i % 7), -static_cast<float>(i % 5)};
+
+    hipLibXtDesc* inDesc  = nullptr;
+    hipLibXtDesc* outDesc = nullptr;
+    ASSERT_EQ(hipfftXtMalloc(plan, &inDesc, HIPFFT_XT_FORMAT_INPUT), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtMalloc(plan, &outDesc, HIPFFT_XT_FORMAT_OUTPUT), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtMemcpy(plan, inDesc, in.data(), HIPFFT_COPY_HOST_TO_DEVICE),
+              HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtExecDescriptor(plan, inDesc, outDesc, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtMemcpy(plan, out.data(), outDesc, HIPFFT_COPY_DEVICE_TO_HOST),
+              HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtFree(inDesc), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtFree(outDesc), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+
+    hipfftHandle refPlan = nullptr;
+    ASSERT_EQ(hipfftPlan3d(&refPlan, N, N, N, HIPFFT_C2C), HIPFFT_SUCCESS);
+    hipfftComplex* buf = nullptr;
+    ASSERT_EQ(hipMalloc(&buf, total * sizeof(hipfftComplex)), hipSuccess);
+    ASSERT_EQ(hipMemcpy(buf, in.data(), total * sizeof(hipfftComplex), hipMemcpyHostToDevice),
+              hipSuccess);
+    ASSERT_EQ(hipfftExecC2C(refPlan, buf, buf, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipMemcpy(ref.data(), buf, total * sizeof(hipfftComplex), hipMemcpyDeviceToHost),
+              hipSuccess);
+    ASSERT_EQ(hipFree(buf), hipSuccess);
+    ASSERT_EQ(hipfftDestroy(refPlan), HIPFFT_SUCCESS);
+
+    for(size_t i = 0; i < total; ++i)
+    {
+        ASSERT_NEAR(out[i].x, ref[i].x, 1e-1);
+        ASSERT_NEAR(out[i].y, ref[i].y, 1e-1);
+    }
+}
+
+TEST(multi_gpu, ShuffledInPlace)
+{
+    int deviceCount = 0;
+    ASSERT_EQ(hipGetDeviceCount(&deviceCount), hipSuccess);
+    if(deviceCount < 2)
+        GTEST_SKIP() << "need multiple devices";
+
+    std::vector<int> gpus(deviceCount);
+    std::iota(gpus.begin(), gpus.end(), 0);
+
+    const int    N     = 16 * deviceCount;
+    const size_t total = static_cast<size_t>(N) * N;
+
+    hipfftHandle plan = nullptr;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtSetGPUs(plan, deviceCount, gpus.data()), HIPFFT_SUCCESS);
+    std::vector<size_t> workSize(deviceCount);
+    ASSERT_EQ(hipfftMakePlan2d(plan, N, N, HIPFFT_C2C, workSize.data()), HIPFFT_SUCCESS);
+
+    std::vector<hipfftComplex> in(total), out(total), ref(total), back(total);
+    for(size_t i = 0; i < total; ++i)
+        in[i] = hipfftComplex{static_cast<float>(i % 7), -static_cast<float>(i % 5)};
+
+    // 1D_INPUT_SHUFFLED is only for 1D plans
+    hipLibXtDesc* desc = nullptr;
+    EXPECT_EQ(hipfftXtMalloc(plan, &desc, HIPFFT_XT_FORMAT_1D_INPUT_SHUFFLED),
+              HIPFFT_INVALID_VALUE);
+
+    ASSERT_EQ(hipfftXtMalloc(plan, &desc, HIPFFT_XT_FORMAT_INPLACE), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtMemcpy(plan, desc, in.data(), HIPFFT_COPY_HOST_TO_DEVICE), HIPFFT_SUCCESS);
+
+    // forward transform leaves the data shuffled if the plan can
+    ASSERT_EQ(hipfftXtExecDescriptor(plan, desc, desc, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    EXPECT_TRUE(desc->subFormat == HIPFFT_XT_FORMAT_INPLACE_SHUFFLED
+                || desc->subFormat == HIPFFT_XT_FORMAT_INPLACE);
+    if(desc->subFormat == HIPFFT_XT_FORMAT_INPLACE_SHUFFLED)
+        EXPECT_EQ(hipfftXtExecDescriptor(plan, desc, desc, HIPFFT_FORWARD), HIPFFT_INVALID_VALUE);
+
+    // copies follow the descriptor's layout
+    ASSERT_EQ(hipfftXtMemcpy(plan, out.data(), desc, HIPFFT_COPY_DEVICE_TO_HOST), HIPFFT_SUCCESS);
+
+    // inverse transform returns the data to the natural layout
+    ASSERT_EQ(hipfftXtExecDescriptor(plan, desc, desc, HIPFFT_BACKWARD), HIPFFT_SUCCESS);
+    EXPECT_EQ(desc->subFormat, HIPFFT_XT_FORMAT_INPLACE);
+    ASSERT_EQ(hipfftXtMemcpy(plan, back.data(), desc, HIPFFT_COPY_DEVICE_TO_HOST),
+              HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtFree(desc), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+
+    hipfftHandle refPlan = nullptr;
+    ASSERT_EQ(hipfftPlan2d(&refPlan, N, N, HIPFFT_C2C), HIPFFT_SUCCESS);
+    hipfftComplex* buf = nullptr;
+    ASSERT_EQ(hipMalloc(&buf, total * sizeof(hipfftComplex)), hipSuccess);
+    ASSERT_EQ(hipMemcpy(buf, in.data(), total * sizeof(hipfftComplex), hipMemcpyHostToDevice),
+              hipSuccess);
+    ASSERT_EQ(hipfftExecC2C(refPlan, buf, buf, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipMemcpy(ref.data(), buf, total * sizeof(hipfftComplex), hipMemcpyDeviceToHost),
+              hipSuccess);
+    ASSERT_EQ(hipFree(buf), hipSuccess);
+    ASSERT_EQ(hipfftDestroy(refPlan), HIPFFT_SUCCESS);
+
+    for(size_t i = 0; i < total; ++i)
+    {
+        ASSERT_NEAR(out[i].x, ref[i].x, 1e-1);
+        ASSERT_NEAR(out[i].y, ref[i].y, 1e-1);
+        // unnormalized round trip
+        ASSERT_NEAR(back[i].x, in[i].x * total, 1e-1 * total);
+        ASSERT_NEAR(back[i].y, in[i].y * total, 1e-1 * total);
+    }
+}
+
+TEST(multi_gpu, RealInPlaceLayout)
+{
+    int deviceCount = 0;
+    ASSERT_EQ(hipGetDeviceCount(&deviceCount), hipSuccess);
+    if(deviceCount < 2)
+        GTEST_SKIP() << "need multiple devices";
+
+    std::vector<int> gpus(deviceCount);
+    std::iota(gpus.begin(), gpus.end(), 0);
+
+    // the complex output's columns don't split evenly among the
+    // devices, so a shuffled layout would need more room than the
+    // natural one
+    const int    N0      = 4 * deviceCount;
+    const int    N1      = 16 * deviceCount;
+    const size_t complex = static_cast<size_t>(N0) * (N1 / 2 + 1);
+
+    hipfftHandle plan = nullptr;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtSetGPUs(plan, deviceCount, gpus.data()), HIPFFT_SUCCESS);
+    std::vector<size_t> workSize(deviceCount);
+    ASSERT_EQ(hipfftMakePlan2d(plan, N0, N1, HIPFFT_R2C, workSize.data()), HIPFFT_SUCCESS);
+
+    // real plans only have the natural layout, split by rows
+    hipLibXtDesc* desc = nullptr;
+    ASSERT_EQ(hipfftXtMalloc(plan, &desc, HIPFFT_XT_FORMAT_INPLACE), HIPFFT_SUCCESS);
+    ASSERT_EQ(desc->descriptor->nGPUs, deviceCount);
+    size_t bytes = 0;
+    for(int i = 0; i < desc->descriptor->nGPUs; ++i)
+        bytes += desc->descriptor->size[i];
+    EXPECT_EQ(bytes, complex * sizeof(hipfftComplex));
+
+    // asking for a shuffled layout gets the same natural split
+    hipLibXtDesc* shuffled = nullptr;
+    ASSERT_EQ(hipfftXtMalloc(plan, &shuffled, HIPFFT_XT_FORMAT_INPLACE_SHUFFLED), HIPFFT_SUCCESS);
+    for(int i = 0; i < desc->descriptor->nGPUs; ++i)
+        EXPECT_EQ(shuffled->descriptor->size[i], desc->descriptor->size[i]);
+    ASSERT_EQ(hipfftXtFree(shuffled), HIPFFT_SUCCESS);
+
+    std::vector<hipfftComplex> in(complex), out(complex);
+    for(size_t i = 0; i < complex; ++i)
+        in[i] = hipfftComplex{static_cast<float>(i), -static_cast<float>(i % 13)};
+    ASSERT_EQ(hipfftXtMemcpy(plan, desc, in.data(), HIPFFT_COPY_HOST_TO_DEVICE), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtMemcpy(plan, out.data(), desc, HIPFFT_COPY_DEVICE_TO_HOST), HIPFFT_SUCCESS);
+    EXPECT_EQ(desc->subFormat, HIPFFT_XT_FORMAT_INPLACE);
+    for(size_t i = 0; i < complex; ++i)
+    {
+        ASSERT_EQ(out[i].x, in[i].x);
+        ASSERT_EQ(out[i].y, in[i].y);
+    }
+
+    ASSERT_EQ(hipfftXtFree(desc), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+}
+
+TEST(multi_gpu, PipelinedExecution)
+{
+    int deviceCount = 0;
+    ASSERT_EQ(hipGetDeviceCount(&deviceCount), hipSuccess);
+    if(deviceCount < 2)
+        GTEST_SKIP() << "need multiple devices";
+
+    std::vector<int> gpus(deviceCount);
+    std::iota(gpus.begin(), gpus.end(), 0);
+
+    const int    chunks = 4;
+    const int    N      = 8 * deviceCount;
+    const size_t total  = static_cast<size_t>(N) * N * N;
+
+    hipfftHandle plan = nullptr;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtSetGPUs(plan, deviceCount, gpus.data()), HIPFFT_SUCCESS);
+    EXPECT_EQ(hipfftExtXtSetPipelineChunks(plan, 0), HIPFFT_INVALID_VALUE);
+    ASSERT_EQ(hipfftExtXtSetPipelineChunks(plan, chunks), HIPFFT_SUCCESS);
+    std::vector<size_t> workSize(deviceCount);
+    ASSERT_EQ(hipfftMakePlan3d(plan, N, N, N, HIPFFT_C2C, workSize.data()), HIPFFT_SUCCESS);
+
+    std::vector<hipfftComplex> in(total), out(total), ref(total);
+    for(size_t i = 0; i < total; ++i)
+        in[i] = hipfftComplex{static_cast<float>(i % 7), -static_cast<float>(i % 5)};
+
+    // no chunked transform has run yet
+    int count = -1;
+    ASSERT_EQ(hipfftExtXtGetPipelineTrace(plan, &count, nullptr, nullptr), HIPFFT_SUCCESS);
+    EXPECT_EQ(count, 0);
+
+    hipLibXtDesc* desc = nullptr;
+    ASSERT_EQ(hipfftXtMalloc(plan, &desc, HIPFFT_XT_FORMAT_INPLACE), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtMemcpy(plan, desc, in.data(), HIPFFT_COPY_HOST_TO_DEVICE), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtExecDescriptor(plan, desc, desc, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    // chunked transforms leave the data in the natural layout
+    EXPECT_EQ(desc->subFormat, HIPFFT_XT_FORMAT_INPLACE);
+    ASSERT_EQ(hipfftXtMemcpy(plan, out.data(), desc, HIPFFT_COPY_DEVICE_TO_HOST), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtFree(desc), HIPFFT_SUCCESS);
+
+    // every device transforms and exchanges each of its chunks twice
+    ASSERT_EQ(hipfftExtXtGetPipelineTrace(plan, &count, nullptr, nullptr), HIPFFT_SUCCESS);
+    ASSERT_EQ(count, deviceCount * chunks * 4);
+    std::vector<hipfftExtPipelineEvent> events(count);
+    double                              overlap = -1.0;
+    ASSERT_EQ(hipfftExtXtGetPipelineTrace(plan, &count, events.data(), &overlap),
+              HIPFFT_SUCCESS);
+    EXPECT_GE(overlap, 0.0);
+    EXPECT_LE(overlap, 1.0);
+    for(const auto& event : events)
+    {
+        EXPECT_GE(event.start, 0.0);
+        EXPECT_LE(event.start, event.end);
+        EXPECT_LT(event.chunk, chunks);
+    }
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+
+    hipfftHandle refPlan = nullptr;
+    ASSERT_EQ(hipfftPlan3d(&refPlan, N, N, N, HIPFFT_C2C), HIPFFT_SUCCESS);
+    hipfftComplex* buf = nullptr;
+    ASSERT_EQ(hipMalloc(&buf, total * sizeof(hipfftComplex)), hipSuccess);
+    ASSERT_EQ(hipMemcpy(buf, in.data(), total * sizeof(hipfftComplex), hipMemcpyHostToDevice),
+              hipSuccess);
+    ASSERT_EQ(hipfftExecC2C(refPlan, buf, buf, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipMemcpy(ref.data(), buf, total * sizeof(hipfftComplex), hipMemcpyDeviceToHost),
+              hipSuccess);
+    ASSERT_EQ(hipFree(buf), hipSuccess);
+    ASSERT_EQ(hipfftDestroy(refPlan), HIPFFT_SUCCESS);
+
+    for(size_t i = 0; i < total; ++i)
+    {
+        ASSERT_NEAR(out[i].x, ref[i].x, 1e-1);
+        ASSERT_NEAR(out[i].y, ref[i].y, 1e-1);
+    }
+}
+
+TEST(multi_gpu, PerDeviceWorkArea)
+{
+    int deviceCount = 0;
+    ASSERT_EQ(hipGetDeviceCount(&deviceCount), hipSuccess);
+    if(deviceCount < 2)
+        GTEST_SKIP() << "need multiple devices";
+
+    std::vector<int> gpus(deviceCount);
+    std::iota(gpus.begin(), gpus.end(), 0);
+
+    const int    N     = 8 * deviceCount;
+    const size_t total = static_cast<size_t>(N) * N * N;
+
+    hipfftHandle plan = nullptr;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtSetGPUs(plan, deviceCount, gpus.data()), HIPFFT_SUCCESS);
+    // work areas can only be set once the plan is made
+    std::vector<void*> workAreas(deviceCount, nullptr);
+    EXPECT_EQ(hipfftXtSetWorkArea(plan, workAreas.data()), HIPFFT_INVALID_PLAN);
+    ASSERT_EQ(hipfftExtXtSetPipelineChunks(plan, 2), HIPFFT_SUCCESS);
+
+    // one size is reported per device
+    const size_t        unset = std::numeric_limits<size_t>::max();
+    std::vector<size_t> workSize(deviceCount, unset);
+    ASSERT_EQ(hipfftMakePlan3d(plan, N, N, N, HIPFFT_C2C, workSize.data()), HIPFFT_SUCCESS);
+    std::vector<size_t> getSize(deviceCount, unset);
+    ASSERT_EQ(hipfftGetSize(plan, getSize.data()), HIPFFT_SUCCESS);
+    EXPECT_EQ(workSize, getSize);
+    for(auto size : workSize)
+        EXPECT_NE(size, unset);
+
+    // give each device a work area of the reported size
+    for(int i = 0; i < deviceCount; ++i)
+    {
+        if(workSize[i] == 0)
+            continue;
+        ASSERT_EQ(hipSetDevice(gpus[i]), hipSuccess);
+        ASSERT_EQ(hipMalloc(&workAreas[i], workSize[i]), hipSuccess);
+    }
+    ASSERT_EQ(hipSetDevice(gpus[0]), hipSuccess);
+    ASSERT_EQ(hipfftXtSetWorkArea(plan, workAreas.data()), HIPFFT_SUCCESS);
+
+    std::vector<hipfftComplex> in(total), out(total), ref(total);
+    for(size_t i = 0; i < total; ++i)
+        in[i] = hipfftComplex{static_cast<float>(i % 11), static_cast<float>(i % 3)};
+
+    hipfftHandle refPlan = nullptr;
+    ASSERT_EQ(hipfftPlan3d(&refPlan, N, N, N, HIPFFT_C2C), HIPFFT_SUCCESS);
+    hipfftComplex* buf = nullptr;
+    ASSERT_EQ(hipMalloc(&buf, total * sizeof(hipfftComplex)), hipSuccess);
+    ASSERT_EQ(hipMemcpy(buf, in.data(), total * sizeof(hipfftComplex), hipMemcpyHostToDevice),
+              hipSuccess);
+    ASSERT_EQ(hipfftExecC2C(refPlan, buf, buf, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipMemcpy(ref.data(), buf, total * sizeof(hipfftComplex), hipMemcpyDeviceToHost),
+              hipSuccess);
+    ASSERT_EQ(hipFree(buf), hipSuccess);
+    ASSERT_EQ(hipfftDestroy(refPlan), HIPFFT_SUCCESS);
+
+    // in-place and out-of-place transforms both run in the given
+    // areas
+    for(auto format : {HIPFFT_XT_FORMAT_INPLACE, HIPFFT_XT_FORMAT_INPUT})
+    {
+        hipLibXtDesc* desc = nullptr;
+        ASSERT_EQ(hipfftXtMalloc(plan, &desc, format), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipfftXtMemcpy(plan, desc, in.data(), HIPFFT_COPY_HOST_TO_DEVICE),
+                  HIPFFT_SUCCESS);
+        hipLibXtDesc* outDesc = desc;
+        if(format == HIPFFT_XT_FORMAT_INPUT)
+            ASSERT_EQ(hipfftXtMalloc(plan, &outDesc, HIPFFT_XT_FORMAT_OUTPUT), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipfftXtExecDescriptor(plan, desc, outDesc, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipfftXtMemcpy(plan, out.data(), outDesc, HIPFFT_COPY_DEVICE_TO_HOST),
+                  HIPFFT_SUCCESS);
+        if(outDesc != desc)
+            ASSERT_EQ(hipfftXtFree(outDesc), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipfftXtFree(desc), HIPFFT_SUCCESS);
+
+        for(size_t i = 0; i < total; ++i)
+        {
+            ASSERT_NEAR(out[i].x, ref[i].x, 1e-1);
+            ASSERT_NEAR(out[i].y, ref[i].y, 1e-1);
+        }
+    }
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+
+    for(int i = 0; i < deviceCount; ++i)
+    {
+        if(!workAreas[i])
+            continue;
+        ASSERT_EQ(hipSetDevice(gpus[i]), hipSuccess);
+        ASSERT_EQ(hipFree(workAreas[i]), hipSuccess);
+    }
+}
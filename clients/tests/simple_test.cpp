@@ -20,9 +20,13 @@
 // THE SOFTWARE.
 
 #include "hipfft/hipfft.h"
+#include "hipfft/hipfftXt.h"
+#include <algorithm>
+#include <atomic>
 #include <fftw3.h>
 #include <gtest/gtest.h>
 #include <hip/hip_vector_types.h>
+#include <thread>
 #include <vector>
 
 #include "../hipfft_params.h"
@@ -495,6 +499,756 @@ TEST(hipfftTest, CheckNullWorkBuffer)
 }
 #endif
 
+#ifdef __HIP_PLATFORM_AMD__
+// lazily-created plans should produce the same results as eagerly
+// created ones, in any placement and direction
+TEST(hipfftTest, LazyPlanCreation)
+{
+    const size_t N = 1024;
+
+    // backend plans created since the start of the test
+    hipfftExtPlanCacheStats start;
+    ASSERT_EQ(hipfftExtGetPlanCacheStats(&start), HIPFFT_SUCCESS);
+    const auto created = [&start]() {
+        hipfftExtPlanCacheStats stats;
+        EXPECT_EQ(hipfftExtGetPlanCacheStats(&stats), HIPFFT_SUCCESS);
+        return stats.created - start.created;
+    };
+
+    hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtPlanLazyCreate(plan, 1), HIPFFT_SUCCESS);
+    size_t workSize = 1;
+    ASSERT_EQ(hipfftMakePlan1d(plan, N, HIPFFT_C2C, 1, &workSize), HIPFFT_SUCCESS);
+    // nothing has been created yet, so no work area is needed
+    EXPECT_EQ(workSize, 0);
+    EXPECT_EQ(created(), 0);
+
+    // forward transform of all ones is N in the first element, zero elsewhere
+    std::vector<hipfftComplex> in(N, hipfftComplex{1.0f, 0.0f});
+    hipfftComplex*             d_in;
+    hipfftComplex*             d_out;
+    ASSERT_EQ(hipMalloc(&d_in, N * sizeof(hipfftComplex)), hipSuccess);
+    ASSERT_EQ(hipMalloc(&d_out, N * sizeof(hipfftComplex)), hipSuccess);
+    ASSERT_EQ(hipMemcpy(d_in, in.data(), N * sizeof(hipfftComplex), hipMemcpyHostToDevice),
+              hipSuccess);
+
+    EXPECT_EQ(hipfftExecC2C(plan, d_in, d_out, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    EXPECT_EQ(created(), 1);
+
+    std::vector<hipfftComplex> out(N);
+    ASSERT_EQ(hipMemcpy(out.data(), d_out, N * sizeof(hipfftComplex), hipMemcpyDeviceToHost),
+              hipSuccess);
+    EXPECT_NEAR(out[0].x, static_cast<float>(N), N * type_epsilon<float>());
+    EXPECT_NEAR(out[0].y, 0.0f, N * type_epsilon<float>());
+    for(size_t i = 1; i < N; ++i)
+    {
+        EXPECT_NEAR(out[i].x, 0.0f, N * type_epsilon<float>());
+        EXPECT_NEAR(out[i].y, 0.0f, N * type_epsilon<float>());
+    }
+
+    // the other direction + placement are created on demand as well,
+    // once each
+    EXPECT_EQ(hipfftExecC2C(plan, d_out, d_out, HIPFFT_BACKWARD), HIPFFT_SUCCESS);
+    EXPECT_EQ(created(), 2);
+    EXPECT_EQ(hipfftExecC2C(plan, d_in, d_out, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    EXPECT_EQ(hipfftExecC2C(plan, d_out, d_out, HIPFFT_BACKWARD), HIPFFT_SUCCESS);
+    EXPECT_EQ(created(), 2);
+    EXPECT_EQ(hipfftExecC2C(plan, d_out, d_out, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    EXPECT_EQ(hipfftExecC2C(plan, d_in, d_out, HIPFFT_BACKWARD), HIPFFT_SUCCESS);
+    EXPECT_EQ(created(), 4);
+
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipFree(d_in), hipSuccess);
+    ASSERT_EQ(hipFree(d_out), hipSuccess);
+}
+
+// lazily-created plans can use a work area sized from hipfftGetSize*
+// before the plan was made
+TEST(hipfftTest, LazyPlanUserWorkArea)
+{
+    // odd-length real transforms need a work area
+    const int N     = 1001;
+    const int batch = 2;
+
+    hipfftReal*    d_in  = nullptr;
+    hipfftComplex* d_out = nullptr;
+    ASSERT_EQ(hipMalloc(&d_in, N * batch * sizeof(hipfftReal)), hipSuccess);
+    ASSERT_EQ(hipMalloc(&d_out, (N / 2 + 1) * batch * sizeof(hipfftComplex)), hipSuccess);
+    ASSERT_EQ(hipMemset(d_in, 0, N * batch * sizeof(hipfftReal)), hipSuccess);
+
+    for(bool sized : {true, false})
+    {
+        hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+        ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipfftExtPlanLazyCreate(plan, 1), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipfftSetAutoAllocation(plan, 0), HIPFFT_SUCCESS);
+
+        size_t estimate = 0;
+        if(sized)
+            ASSERT_EQ(hipfftGetSize1d(plan, N, HIPFFT_R2C, batch, &estimate), HIPFFT_SUCCESS);
+        size_t workSize = 1;
+        ASSERT_EQ(hipfftMakePlan1d(plan, N, HIPFFT_R2C, batch, &workSize), HIPFFT_SUCCESS);
+        EXPECT_EQ(workSize, 0);
+
+        void* workArea = nullptr;
+        ASSERT_EQ(hipMalloc(&workArea, std::max<size_t>(estimate, 1)), hipSuccess);
+        ASSERT_EQ(hipfftSetWorkArea(plan, workArea), HIPFFT_SUCCESS);
+
+        // without a size for the work area, it's too small for the
+        // plan that's created now
+        EXPECT_EQ(hipfftExecR2C(plan, d_in, d_out), sized ? HIPFFT_SUCCESS : HIPFFT_NO_WORKSPACE);
+        ASSERT_EQ(hipDeviceSynchronize(), hipSuccess);
+
+        ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipFree(workArea), hipSuccess);
+    }
+
+    ASSERT_EQ(hipFree(d_in), hipSuccess);
+    ASSERT_EQ(hipFree(d_out), hipSuccess);
+}
+
+TEST(hipfftTest, EstimateExactNeedsAllPlans)
+{
+    // a shape that no other test makes
+    const int N     = 1003;
+    const int batch = 5;
+
+    hipfftReal*    d_in  = nullptr;
+    hipfftComplex* d_out = nullptr;
+    ASSERT_EQ(hipMalloc(&d_in, N * batch * sizeof(hipfftReal)), hipSuccess);
+    ASSERT_EQ(hipMalloc(&d_out, (N / 2 + 1) * batch * sizeof(hipfftComplex)), hipSuccess);
+    ASSERT_EQ(hipMemset(d_in, 0, N * batch * sizeof(hipfftReal)), hipSuccess);
+
+    size_t analytic = 0;
+    ASSERT_EQ(hipfftEstimate1d(N, HIPFFT_R2C, batch, &analytic), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtSetEstimateMode(HIPFFT_ESTIMATE_EXACT), HIPFFT_SUCCESS);
+
+    // a lazy plan that's only executed out of place caches one of the
+    // two plans that an R2C transform needs, which isn't enough for
+    // an exact size
+    hipfftHandle lazy = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&lazy), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtPlanLazyCreate(lazy, 1), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftMakePlan1d(lazy, N, HIPFFT_R2C, batch, nullptr), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExecR2C(lazy, d_in, d_out), HIPFFT_SUCCESS);
+    size_t partial = 0;
+    ASSERT_EQ(hipfftEstimate1d(N, HIPFFT_R2C, batch, &partial), HIPFFT_SUCCESS);
+    EXPECT_EQ(partial, analytic);
+
+    // once every plan is cached, the size is exact
+    hipfftHandle eager    = hipfft_params::INVALID_PLAN_HANDLE;
+    size_t       workSize = 0;
+    ASSERT_EQ(hipfftCreate(&eager), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftMakePlan1d(eager, N, HIPFFT_R2C, batch, &workSize), HIPFFT_SUCCESS);
+    size_t exact = 0;
+    ASSERT_EQ(hipfftEstimate1d(N, HIPFFT_R2C, batch, &exact), HIPFFT_SUCCESS);
+    EXPECT_EQ(exact, workSize);
+
+    // an exact size is enough for the work area of a lazy plan
+    hipfftHandle sized = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&sized), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtPlanLazyCreate(sized, 1), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftSetAutoAllocation(sized, 0), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftGetSize1d(sized, N, HIPFFT_R2C, batch, &exact), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftMakePlan1d(sized, N, HIPFFT_R2C, batch, nullptr), HIPFFT_SUCCESS);
+    void* workArea = nullptr;
+    ASSERT_EQ(hipMalloc(&workArea, std::max<size_t>(exact, 1)), hipSuccess);
+    ASSERT_EQ(hipfftSetWorkArea(sized, workArea), HIPFFT_SUCCESS);
+    EXPECT_EQ(hipfftExecR2C(sized, d_in, d_out), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipDeviceSynchronize(), hipSuccess);
+
+    ASSERT_EQ(hipfftExtSetEstimateMode(HIPFFT_ESTIMATE_ANALYTIC), HIPFFT_SUCCESS);
+    for(auto plan : {lazy, eager, sized})
+        ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipFree(workArea), hipSuccess);
+    ASSERT_EQ(hipFree(d_in), hipSuccess);
+    ASSERT_EQ(hipFree(d_out), hipSuccess);
+}
+#endif
+
+#ifdef __HIP_PLATFORM_AMD__
+// identical plans should share backend plans through the plan cache
+TEST(hipfftTest, PlanCacheSharesIdenticalPlans)
+{
+    const int N = 1000;
+
+    hipfftExtPlanCacheStats before;
+    ASSERT_EQ(hipfftExtGetPlanCacheStats(&before), HIPFFT_SUCCESS);
+
+    hipfftHandle plan1 = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftPlan1d(&plan1, N, HIPFFT_Z2Z, 3), HIPFFT_SUCCESS);
+
+    hipfftExtPlanCacheStats after_first;
+    ASSERT_EQ(hipfftExtGetPlanCacheStats(&after_first), HIPFFT_SUCCESS);
+
+    hipfftHandle plan2 = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftPlan1d(&plan2, N, HIPFFT_Z2Z, 3), HIPFFT_SUCCESS);
+
+    hipfftExtPlanCacheStats after_second;
+    ASSERT_EQ(hipfftExtGetPlanCacheStats(&after_second), HIPFFT_SUCCESS);
+
+    // whatever the first plan had to look up, the second plan found
+    // in the cache
+    const auto first_lookups
+        = (after_first.hits + after_first.misses) - (before.hits + before.misses);
+    EXPECT_GT(first_lookups, 0);
+    EXPECT_EQ(after_second.misses, after_first.misses);
+    EXPECT_EQ(after_second.hits - after_first.hits, first_lookups);
+
+    ASSERT_EQ(hipfftDestroy(plan1), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftDestroy(plan2), HIPFFT_SUCCESS);
+
+    // cached plans that are no longer used must respect the size limit
+    hipfftExtPlanCacheStats after_destroy;
+    ASSERT_EQ(hipfftExtGetPlanCacheStats(&after_destroy), HIPFFT_SUCCESS);
+    EXPECT_LE(after_destroy.idleEntries, after_destroy.capacity);
+}
+
+TEST(hipfftTest, EstimateBoundsWorkSize)
+{
+    // include lengths that need Bluestein's algorithm, and odd real
+    // lengths
+    const std::vector<std::vector<int>> lengths
+        = {{1024}, {1009}, {1001}, {64, 100}, {30, 31, 32}};
+
+    for(auto type : {HIPFFT_C2C, HIPFFT_R2C, HIPFFT_Z2D})
+    {
+        for(auto len : lengths)
+        {
+            const int rank  = static_cast<int>(len.size());
+            const int batch = 3;
+
+            // estimates must not create any plans
+            hipfftExtPlanCacheStats before;
+            ASSERT_EQ(hipfftExtGetPlanCacheStats(&before), HIPFFT_SUCCESS);
+            size_t estimate = 0;
+            ASSERT_EQ(hipfftEstimateMany(
+                          rank, len.data(), nullptr, 1, 0, nullptr, 1, 0, type, batch, &estimate),
+                      HIPFFT_SUCCESS);
+            hipfftExtPlanCacheStats after;
+            ASSERT_EQ(hipfftExtGetPlanCacheStats(&after), HIPFFT_SUCCESS);
+            EXPECT_EQ(after.hits + after.misses, before.hits + before.misses);
+
+            hipfftHandle plan     = hipfft_params::INVALID_PLAN_HANDLE;
+            size_t       workSize = 0;
+            ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+            ASSERT_EQ(hipfftMakePlanMany(plan,
+                                         rank,
+                                         len.data(),
+                                         nullptr,
+                                         1,
+                                         0,
+                                         nullptr,
+                                         1,
+                                         0,
+                                         type,
+                                         batch,
+                                         &workSize),
+                      HIPFFT_SUCCESS);
+            EXPECT_GE(estimate, workSize);
+
+            // the plan is cached now, so exact mode knows its size
+            size_t exact = 0;
+            ASSERT_EQ(hipfftExtSetEstimateMode(HIPFFT_ESTIMATE_EXACT), HIPFFT_SUCCESS);
+            ASSERT_EQ(
+                hipfftGetSizeMany(
+                    plan, rank, len.data(), nullptr, 1, 0, nullptr, 1, 0, type, batch, &exact),
+                HIPFFT_SUCCESS);
+            ASSERT_EQ(hipfftExtSetEstimateMode(HIPFFT_ESTIMATE_ANALYTIC), HIPFFT_SUCCESS);
+            EXPECT_EQ(exact, workSize);
+
+            ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+        }
+    }
+}
+
+TEST(hipfftTest, EstimateBoundsStridedWorkSize)
+{
+    // padded rows and a strided batch, for lengths with and without
+    // Bluestein's algorithm
+    for(int N : {1024, 1009})
+    {
+        int       n[2]     = {N, 64};
+        int       embed[2] = {N, 80};
+        const int stride   = 2;
+        const int dist     = 2 * N * 80 + 16;
+        const int batch    = 3;
+        size_t    estimate = 0;
+        size_t    packed   = 0;
+        size_t    workSize = 0;
+        ASSERT_EQ(hipfftEstimateMany(
+                      2, n, embed, stride, dist, embed, stride, dist, HIPFFT_C2C, batch, &estimate),
+                  HIPFFT_SUCCESS);
+        ASSERT_EQ(
+            hipfftEstimateMany(2, n, nullptr, 1, 0, nullptr, 1, 0, HIPFFT_C2C, batch, &packed),
+            HIPFFT_SUCCESS);
+        EXPECT_GT(estimate, packed);
+
+        hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+        ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipfftMakePlanMany(plan,
+                                     2,
+                                     n,
+                                     embed,
+                                     stride,
+                                     dist,
+                                     embed,
+                                     stride,
+                                     dist,
+                                     HIPFFT_C2C,
+                                     batch,
+                                     &workSize),
+                  HIPFFT_SUCCESS);
+        EXPECT_GE(estimate, workSize);
+        ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    }
+}
+
+TEST(hipfftTest, SharedWorkArea)
+{
+    // odd-length real transforms need a work area
+    const std::vector<size_t> lengths = {1001, 2001};
+    const size_t              maxN    = 2001;
+
+    hipfftExtWorkAreaStats before;
+    ASSERT_EQ(hipfftExtGetWorkAreaStats(&before), HIPFFT_SUCCESS);
+
+    std::vector<hipfftHandle> plans;
+    size_t                    maxWorkSize = 0;
+    for(auto N : lengths)
+    {
+        hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+        ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipfftExtSetWorkAreaPolicy(plan, HIPFFT_WORKAREA_SHARED_PER_STREAM),
+                  HIPFFT_SUCCESS);
+        size_t workSize = 0;
+        ASSERT_EQ(hipfftMakePlan1d(plan, N, HIPFFT_R2C, 1, &workSize), HIPFFT_SUCCESS);
+        EXPECT_GT(workSize, 0);
+        maxWorkSize = std::max(maxWorkSize, workSize);
+        plans.push_back(plan);
+    }
+
+    // forward transform of all ones is N in the first element
+    std::vector<hipfftReal> in(maxN, 1.0f);
+    hipfftReal*             d_in;
+    hipfftComplex*          d_out;
+    ASSERT_EQ(hipMalloc(&d_in, maxN * sizeof(hipfftReal)), hipSuccess);
+    ASSERT_EQ(hipMalloc(&d_out, (maxN / 2 + 1) * sizeof(hipfftComplex)), hipSuccess);
+    ASSERT_EQ(hipMemcpy(d_in, in.data(), maxN * sizeof(hipfftReal), hipMemcpyHostToDevice),
+              hipSuccess);
+
+    for(size_t i = 0; i < plans.size(); ++i)
+    {
+        ASSERT_EQ(hipfftExecR2C(plans[i], d_in, d_out), HIPFFT_SUCCESS);
+        hipfftComplex out;
+        ASSERT_EQ(hipMemcpy(&out, d_out, sizeof(hipfftComplex), hipMemcpyDeviceToHost),
+                  hipSuccess);
+        EXPECT_NEAR(out.x, static_cast<float>(lengths[i]), lengths[i] * type_epsilon<float>());
+    }
+
+    // both plans share one buffer, big enough for either of them
+    hipfftExtWorkAreaStats during;
+    ASSERT_EQ(hipfftExtGetWorkAreaStats(&during), HIPFFT_SUCCESS);
+    EXPECT_EQ(during.handles - before.handles, plans.size());
+    EXPECT_EQ(during.arenas - before.arenas, 1);
+    EXPECT_EQ(during.bytes - before.bytes, maxWorkSize);
+
+    for(auto plan : plans)
+        ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipFree(d_in), hipSuccess);
+    ASSERT_EQ(hipFree(d_out), hipSuccess);
+
+    // the buffer is freed along with the last plan using it
+    hipfftExtWorkAreaStats after;
+    ASSERT_EQ(hipfftExtGetWorkAreaStats(&after), HIPFFT_SUCCESS);
+    EXPECT_EQ(after.arenas, before.arenas);
+    EXPECT_EQ(after.bytes, before.bytes);
+}
+
+TEST(hipfftTest, DeferredWorkAreaTrim)
+{
+    // odd-length real transforms need a work area
+    const size_t N = 1001;
+
+    hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtSetWorkAreaPolicy(plan, HIPFFT_WORKAREA_DEFERRED), HIPFFT_SUCCESS);
+    size_t workSize = 0;
+    ASSERT_EQ(hipfftMakePlan1d(plan, N, HIPFFT_R2C, 1, &workSize), HIPFFT_SUCCESS);
+    EXPECT_GT(workSize, 0);
+
+    // forward transform of all ones is N in the first element
+    std::vector<hipfftReal> in(N, 1.0f);
+    hipfftReal*             d_in;
+    hipfftComplex*          d_out;
+    ASSERT_EQ(hipMalloc(&d_in, N * sizeof(hipfftReal)), hipSuccess);
+    ASSERT_EQ(hipMalloc(&d_out, (N / 2 + 1) * sizeof(hipfftComplex)), hipSuccess);
+    ASSERT_EQ(hipMemcpy(d_in, in.data(), N * sizeof(hipfftReal), hipMemcpyHostToDevice),
+              hipSuccess);
+
+    // the work area is allocated again after each trim
+    for(int i = 0; i < 3; ++i)
+    {
+        ASSERT_EQ(hipMemset(d_out, 0, (N / 2 + 1) * sizeof(hipfftComplex)), hipSuccess);
+        ASSERT_EQ(hipfftExecR2C(plan, d_in, d_out), HIPFFT_SUCCESS);
+        hipfftComplex out;
+        ASSERT_EQ(hipMemcpy(&out, d_out, sizeof(hipfftComplex), hipMemcpyDeviceToHost),
+                  hipSuccess);
+        EXPECT_NEAR(out.x, static_cast<float>(N), N * type_epsilon<float>());
+
+        if(i == 0)
+            ASSERT_EQ(hipfftExtTrimMemory(plan), HIPFFT_SUCCESS);
+        else
+            ASSERT_EQ(hipfftExtTrimAllMemory(0.0), HIPFFT_SUCCESS);
+    }
+
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipFree(d_in), hipSuccess);
+    ASSERT_EQ(hipFree(d_out), hipSuccess);
+}
+
+TEST(hipfftTest, TrimWhileSettingWorkArea)
+{
+    const size_t N = 1001;
+
+    hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtSetWorkAreaPolicy(plan, HIPFFT_WORKAREA_DEFERRED), HIPFFT_SUCCESS);
+    size_t workSize = 0;
+    ASSERT_EQ(hipfftMakePlan1d(plan, N, HIPFFT_R2C, 1, &workSize), HIPFFT_SUCCESS);
+
+    void* workArea;
+    ASSERT_EQ(hipMalloc(&workArea, std::max<size_t>(workSize, 1)), hipSuccess);
+    hipfftReal*    d_in;
+    hipfftComplex* d_out;
+    ASSERT_EQ(hipMalloc(&d_in, N * sizeof(hipfftReal)), hipSuccess);
+    ASSERT_EQ(hipMalloc(&d_out, (N / 2 + 1) * sizeof(hipfftComplex)), hipSuccess);
+
+    // trimming from another thread must not free a buffer the plan
+    // is switching away from
+    std::atomic<bool> done{false};
+    std::thread       trimmer([&]() {
+        while(!done)
+            hipfftExtTrimAllMemory(0.0);
+    });
+    for(int i = 0; i < 100; ++i)
+    {
+        EXPECT_EQ(hipfftSetWorkArea(plan, workArea), HIPFFT_SUCCESS);
+        EXPECT_EQ(hipfftExtSetWorkAreaPolicy(plan, HIPFFT_WORKAREA_DEFERRED), HIPFFT_SUCCESS);
+        EXPECT_EQ(hipfftExecR2C(plan, d_in, d_out), HIPFFT_SUCCESS);
+    }
+    done = true;
+    trimmer.join();
+
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipFree(workArea), hipSuccess);
+    ASSERT_EQ(hipFree(d_in), hipSuccess);
+    ASSERT_EQ(hipFree(d_out), hipSuccess);
+}
+
+TEST(hipfftTest, SerializePlan)
+{
+    const size_t N     = 1000;
+    const double scale = 1.0 / N;
+
+    hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtPlanScaleFactor(plan, scale), HIPFFT_SUCCESS);
+    size_t workSize = 0;
+    ASSERT_EQ(hipfftMakePlan1d(plan, N, HIPFFT_Z2Z, 2, &workSize), HIPFFT_SUCCESS);
+
+    void*  buffer     = nullptr;
+    size_t bufferSize = 0;
+    ASSERT_EQ(hipfftExtPlanSerialize(plan, &buffer, &bufferSize), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+
+    // a truncated buffer is rejected
+    hipfftHandle loaded = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&loaded), HIPFFT_SUCCESS);
+    EXPECT_EQ(hipfftExtPlanDeserialize(loaded, buffer, bufferSize / 2, nullptr),
+              HIPFFT_INVALID_VALUE);
+
+    size_t loadedWorkSize = 0;
+    ASSERT_EQ(hipfftExtPlanDeserialize(loaded, buffer, bufferSize, &loadedWorkSize),
+              HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtPlanBufferFree(buffer), HIPFFT_SUCCESS);
+    EXPECT_EQ(loadedWorkSize, workSize);
+
+    // the scale factor survives: forward transform of all ones is 1
+    // in the first element of each batch
+    std::vector<hipfftDoubleComplex> in(2 * N, hipfftDoubleComplex{1.0, 0.0});
+    hipfftDoubleComplex*             d_data;
+    ASSERT_EQ(hipMalloc(&d_data, in.size() * sizeof(hipfftDoubleComplex)), hipSuccess);
+    ASSERT_EQ(
+        hipMemcpy(
+            d_data, in.data(), in.size() * sizeof(hipfftDoubleComplex), hipMemcpyHostToDevice),
+        hipSuccess);
+    ASSERT_EQ(hipfftExecZ2Z(loaded, d_data, d_data, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    std::vector<hipfftDoubleComplex> out(2 * N);
+    ASSERT_EQ(
+        hipMemcpy(
+            out.data(), d_data, out.size() * sizeof(hipfftDoubleComplex), hipMemcpyDeviceToHost),
+        hipSuccess);
+    for(size_t b = 0; b < 2; ++b)
+    {
+        EXPECT_NEAR(out[b * N].x, 1.0, type_epsilon<double>());
+        for(size_t i = 1; i < N; ++i)
+            EXPECT_NEAR(out[b * N + i].x, 0.0, type_epsilon<double>());
+    }
+
+    ASSERT_EQ(hipfftDestroy(loaded), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipFree(d_data), hipSuccess);
+}
+
+TEST(hipfftTest, SerializeKernelCache)
+{
+    // make a plan so that the backend has kernels to export
+    hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    size_t workSize = 0;
+    ASSERT_EQ(hipfftMakePlan1d(plan, 1000, HIPFFT_Z2Z, 2, &workSize), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+
+    void*  buffer     = nullptr;
+    size_t bufferSize = 0;
+    EXPECT_EQ(hipfftExtKernelCacheSerialize(nullptr, &bufferSize), HIPFFT_INVALID_VALUE);
+    ASSERT_EQ(hipfftExtKernelCacheSerialize(&buffer, &bufferSize), HIPFFT_SUCCESS);
+    EXPECT_GT(bufferSize, 0u);
+
+    // a truncated buffer is rejected
+    EXPECT_EQ(hipfftExtKernelCacheDeserialize(buffer, bufferSize / 2), HIPFFT_INVALID_VALUE);
+    EXPECT_EQ(hipfftExtKernelCacheDeserialize(buffer, bufferSize), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtPlanBufferFree(buffer), HIPFFT_SUCCESS);
+}
+
+TEST(hipfftTest, MakePlansBulk)
+{
+    // six plans over three distinct lengths, so half the specs are
+    // duplicates that should come out of the plan cache
+    const std::vector<long long int> lengths = {64, 300, 1024, 64, 300, 1024};
+
+    std::vector<long long int>     n(lengths);
+    std::vector<hipfftExtPlanSpec> specs(lengths.size());
+    for(size_t i = 0; i < specs.size(); ++i)
+    {
+        hipfftExtPlanSpec& spec = specs[i];
+        spec.plan               = hipfft_params::INVALID_PLAN_HANDLE;
+        ASSERT_EQ(hipfftCreate(&spec.plan), HIPFFT_SUCCESS);
+        spec.rank          = 1;
+        spec.n             = &n[i];
+        spec.inembed       = nullptr;
+        spec.istride       = 1;
+        spec.idist         = n[i];
+        spec.inputType     = HIP_C_32F;
+        spec.onembed       = nullptr;
+        spec.ostride       = 1;
+        spec.odist         = n[i];
+        spec.outputType    = HIP_C_32F;
+        spec.batch         = 1;
+        spec.executionType = HIP_C_32F;
+        spec.workSize      = 0;
+        spec.status        = HIPFFT_INTERNAL_ERROR;
+    }
+
+    ASSERT_EQ(hipfftExtMakePlansBulk(specs.data(), specs.size()), HIPFFT_SUCCESS);
+
+    hipfftComplex* d_data;
+    ASSERT_EQ(hipMalloc(&d_data, 1024 * sizeof(hipfftComplex)), hipSuccess);
+    for(size_t i = 0; i < specs.size(); ++i)
+    {
+        EXPECT_EQ(specs[i].status, HIPFFT_SUCCESS);
+
+        // forward transform of all ones is N in the first element
+        std::vector<hipfftComplex> in(lengths[i], hipfftComplex{1.0f, 0.0f});
+        ASSERT_EQ(
+            hipMemcpy(d_data, in.data(), in.size() * sizeof(hipfftComplex), hipMemcpyHostToDevice),
+            hipSuccess);
+        ASSERT_EQ(hipfftExecC2C(specs[i].plan, d_data, d_data, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+        hipfftComplex first;
+        ASSERT_EQ(hipMemcpy(&first, d_data, sizeof(hipfftComplex), hipMemcpyDeviceToHost),
+                  hipSuccess);
+        EXPECT_NEAR(first.x, static_cast<float>(lengths[i]), lengths[i] * type_epsilon<float>());
+
+        ASSERT_EQ(hipfftDestroy(specs[i].plan), HIPFFT_SUCCESS);
+    }
+    ASSERT_EQ(hipFree(d_data), hipSuccess);
+}
+
+TEST(hipfftTest, MakePlanManyAsync)
+{
+    int n = 1000;
+
+    hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtSetNotReadyPolicy(plan, HIPFFT_NOT_READY_RETURN), HIPFFT_SUCCESS);
+
+    hipfftExtPlanToken token = nullptr;
+    ASSERT_EQ(hipfftExtMakePlanManyAsync(
+                  plan, 1, &n, nullptr, 1, n, nullptr, 1, n, HIPFFT_C2C, 1, &token),
+              HIPFFT_SUCCESS);
+
+    // settings the planning thread reads can't be changed any more
+    int gpu = 0;
+    EXPECT_EQ(hipfftExtPlanScaleFactor(plan, 0.5), HIPFFT_INVALID_PLAN);
+    EXPECT_EQ(hipfftExtPlanLazyCreate(plan, 1), HIPFFT_INVALID_PLAN);
+    EXPECT_EQ(hipfftXtSetGPUs(plan, 1, &gpu), HIPFFT_INVALID_PLAN);
+
+    // upload the input while the plan is being made
+    std::vector<hipfftComplex> in(n, hipfftComplex{1.0f, 0.0f});
+    hipfftComplex*             d_data;
+    ASSERT_EQ(hipMalloc(&d_data, in.size() * sizeof(hipfftComplex)), hipSuccess);
+    ASSERT_EQ(
+        hipMemcpy(d_data, in.data(), in.size() * sizeof(hipfftComplex), hipMemcpyHostToDevice),
+        hipSuccess);
+
+    // the plan may or may not have got ready in the meantime, so
+    // executing it is either refused or done
+    const auto query = hipfftExtPlanTokenQuery(token);
+    EXPECT_TRUE(query == HIPFFT_PLAN_NOT_READY || query == HIPFFT_SUCCESS);
+    const auto early = hipfftExecC2C(plan, d_data, d_data, HIPFFT_FORWARD);
+    EXPECT_TRUE(early == HIPFFT_PLAN_NOT_READY || early == HIPFFT_SUCCESS);
+
+    size_t workSize = 0;
+    ASSERT_EQ(hipfftExtPlanTokenWait(token, &workSize), HIPFFT_SUCCESS);
+    EXPECT_EQ(hipfftExtPlanTokenQuery(token), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtPlanTokenDestroy(token), HIPFFT_SUCCESS);
+
+    size_t planWorkSize = 0;
+    ASSERT_EQ(hipfftGetSize(plan, &planWorkSize), HIPFFT_SUCCESS);
+    EXPECT_EQ(workSize, planWorkSize);
+
+    // forward transform of all ones is N in the first element
+    ASSERT_EQ(
+        hipMemcpy(d_data, in.data(), in.size() * sizeof(hipfftComplex), hipMemcpyHostToDevice),
+        hipSuccess);
+    ASSERT_EQ(hipfftExecC2C(plan, d_data, d_data, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    hipfftComplex first;
+    ASSERT_EQ(hipMemcpy(&first, d_data, sizeof(hipfftComplex), hipMemcpyDeviceToHost), hipSuccess);
+    EXPECT_NEAR(first.x, static_cast<float>(n), n * type_epsilon<float>());
+
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipFree(d_data), hipSuccess);
+}
+
+TEST(hipfftTest, InitializeFinalize)
+{
+    hipfftExtPrewarmSpec invalid = {4, {16, 16, 16}, HIPFFT_C2C, 1};
+    EXPECT_EQ(hipfftExtInitialize(HIPFFT_INIT_DEFAULT, &invalid, 1), HIPFFT_INVALID_VALUE);
+
+    hipfftExtPrewarmSpec prewarm[] = {{1, {1000, 0, 0}, HIPFFT_C2C, 1},
+                                      {2, {64, 96, 0}, HIPFFT_R2C, 2}};
+    ASSERT_EQ(hipfftExtInitialize(HIPFFT_INIT_BACKGROUND, prewarm, 2), HIPFFT_SUCCESS);
+
+    // plans can be made and executed while initialization finishes
+    const size_t N    = 1000;
+    hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    size_t workSize = 0;
+    ASSERT_EQ(hipfftMakePlan1d(plan, N, HIPFFT_C2C, 1, &workSize), HIPFFT_SUCCESS);
+
+    std::vector<hipfftComplex> in(N, hipfftComplex{1.0f, 0.0f});
+    hipfftComplex*             d_data;
+    ASSERT_EQ(hipMalloc(&d_data, N * sizeof(hipfftComplex)), hipSuccess);
+    ASSERT_EQ(hipMemcpy(d_data, in.data(), N * sizeof(hipfftComplex), hipMemcpyHostToDevice),
+              hipSuccess);
+    ASSERT_EQ(hipfftExecC2C(plan, d_data, d_data, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    hipfftComplex first;
+    ASSERT_EQ(hipMemcpy(&first, d_data, sizeof(hipfftComplex), hipMemcpyDeviceToHost), hipSuccess);
+    EXPECT_NEAR(first.x, static_cast<float>(N), N * type_epsilon<float>());
+
+    // finalizing needs all plans to be destroyed first
+    EXPECT_EQ(hipfftExtFinalize(), HIPFFT_INVALID_PLAN);
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    EXPECT_EQ(hipfftExtFinalize(), HIPFFT_SUCCESS);
+
+    // and the library is set up again when it's next used
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftMakePlan1d(plan, N, HIPFFT_C2C, 1, &workSize), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExecC2C(plan, d_data, d_data, HIPFFT_BACKWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipFree(d_data), hipSuccess);
+}
+
+TEST(hipfftTest, ExecContextThreads)
+{
+    const size_t N       = 1024;
+    const size_t threads = 4;
+
+    hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    size_t workSize = 0;
+    ASSERT_EQ(hipfftMakePlan1d(plan, N, HIPFFT_C2C, 1, &workSize), HIPFFT_SUCCESS);
+
+    // contexts can only be created for plans that have been made
+    hipfftHandle         unmade  = hipfft_params::INVALID_PLAN_HANDLE;
+    hipfftExtExecContext context = nullptr;
+    ASSERT_EQ(hipfftCreate(&unmade), HIPFFT_SUCCESS);
+    EXPECT_EQ(hipfftExtExecContextCreate(unmade, &context), HIPFFT_INVALID_PLAN);
+    ASSERT_EQ(hipfftDestroy(unmade), HIPFFT_SUCCESS);
+
+    // each thread executes the shared plan on its own stream, through
+    // its own context
+    std::vector<hipfftResult>  results(threads, HIPFFT_INTERNAL_ERROR);
+    std::vector<hipfftComplex> firsts(threads);
+    std::vector<std::thread>   workers;
+    for(size_t t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&, t]() {
+            hipStream_t          stream;
+            hipfftExtExecContext ctx = nullptr;
+            hipfftComplex*       d_data;
+            if(hipStreamCreate(&stream) != hipSuccess
+               || hipMalloc(&d_data, N * sizeof(hipfftComplex)) != hipSuccess)
+                return;
+
+            // thread t transforms a constant t + 1, so its first
+            // output element is (t + 1) * N
+            const std::vector<hipfftComplex> in(N,
+                                                hipfftComplex{static_cast<float>(t + 1), 0.0f});
+            auto ret = hipfftExtExecContextCreate(plan, &ctx);
+            if(ret == HIPFFT_SUCCESS)
+                ret = hipfftExtExecContextSetStream(ctx, stream);
+            for(int i = 0; i < 10 && ret == HIPFFT_SUCCESS; ++i)
+            {
+                if(hipMemcpyAsync(d_data,
+                                  in.data(),
+                                  N * sizeof(hipfftComplex),
+                                  hipMemcpyHostToDevice,
+                                  stream)
+                   != hipSuccess)
+                    ret = HIPFFT_INTERNAL_ERROR;
+                else
+                    ret = hipfftExtExecWithContext(ctx, d_data, d_data, HIPFFT_FORWARD);
+            }
+            if(ret == HIPFFT_SUCCESS
+               && (hipMemcpyAsync(&firsts[t],
+                                  d_data,
+                                  sizeof(hipfftComplex),
+                                  hipMemcpyDeviceToHost,
+                                  stream)
+                       != hipSuccess
+                   || hipStreamSynchronize(stream) != hipSuccess))
+                ret = HIPFFT_INTERNAL_ERROR;
+            if(ctx && hipfftExtExecContextDestroy(ctx) != HIPFFT_SUCCESS)
+                ret = HIPFFT_INTERNAL_ERROR;
+            if(hipFree(d_data) != hipSuccess || hipStreamDestroy(stream) != hipSuccess)
+                ret = HIPFFT_INTERNAL_ERROR;
+            results[t] = ret;
+        });
+    }
+    for(auto& worker : workers)
+        worker.join();
+
+    for(size_t t = 0; t < threads; ++t)
+    {
+        EXPECT_EQ(results[t], HIPFFT_SUCCESS);
+        EXPECT_NEAR(firsts[t].x, (t + 1.0f) * N, (t + 1) * N * type_epsilon<float>());
+    }
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+}
+#endif
+
 TEST(hipfftTest, RunR2C)
 {
     const size_t N = 4096;
@@ -0,0 +1,328 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Tests of hipfftExtStreamFilter.  Streams are passed in chunks of
+// assorted lengths, and the filtered samples are checked against a
+// direct convolution of the whole stream on the host.
+
+#include "hipfft/hipfft.h"
+#include "hipfft/hipfftXt.h"
+#include <algorithm>
+#include <complex>
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "../hipfft_params.h"
+#include "hipfft_test_values.h"
+
+DISABLE_WARNING_PUSH
+DISABLE_WARNING_DEPRECATED_DECLARATIONS
+DISABLE_WARNING_RETURN_TYPE
+#include <hip/hip_runtime_api.h>
+DISABLE_WARNING_POP
+
+// causal convolution y[t] = sum over k of h[k] * x[t - k] of a
+// stream that is zero before it starts
+template <typename T>
+static std::vector<std::complex<double>> filter_reference(const std::vector<T>& x,
+                                                          const std::vector<T>& h)
+{
+    std::vector<std::complex<double>> y(x.size());
+    for(size_t t = 0; t < x.size(); ++t)
+    {
+        for(size_t k = 0; k < h.size() && k <= t; ++k)
+            y[t] += to_complex(h[k]) * to_complex(x[t - k]);
+    }
+    return y;
+}
+
+TEST(hipfft_stream_filter, reference)
+{
+    // an impulse returns the filter, and a step its running sum
+    const std::vector<double> h = {1.0, -2.0, 0.5};
+
+    const auto impulse = filter_reference(std::vector<double>{1.0, 0.0, 0.0, 0.0}, h);
+    EXPECT_EQ(impulse[0], 1.0);
+    EXPECT_EQ(impulse[1], -2.0);
+    EXPECT_EQ(impulse[2], 0.5);
+    EXPECT_EQ(impulse[3], 0.0);
+
+    const auto step = filter_reference(std::vector<double>{1.0, 1.0, 1.0, 1.0}, h);
+    EXPECT_EQ(step[0], 1.0);
+    EXPECT_EQ(step[1], -1.0);
+    EXPECT_EQ(step[2], -0.5);
+    EXPECT_EQ(step[3], -0.5);
+}
+
+#ifdef __HIP_PLATFORM_AMD__
+
+// pass a stream to a filter in chunks that leave part of a block,
+// complete one or several blocks, are empty, or complete more
+// blocks than fit in a launch, and compare the filtered stream with
+// the direct convolution
+template <typename T>
+static void check_stream_filter(hipfftType                   type,
+                                long long int                taps,
+                                long long int                fftSize,
+                                long long int                blocksPerLaunch,
+                                hipfftExtStreamFilterBackend backend,
+                                double                       tolerance)
+{
+    const bool host = backend == HIPFFT_STREAM_FILTER_HOST;
+
+    std::vector<T> coefficients(taps);
+    for(size_t i = 0; i < coefficients.size(); ++i)
+        fill_value(coefficients[i], 3 * i + 1);
+
+    T* d_coefficients = nullptr;
+    if(!host)
+    {
+        ASSERT_EQ(hipMalloc(&d_coefficients, taps * sizeof(T)), hipSuccess);
+        ASSERT_EQ(hipMemcpy(d_coefficients,
+                            coefficients.data(),
+                            taps * sizeof(T),
+                            hipMemcpyHostToDevice),
+                  hipSuccess);
+    }
+
+    hipfftExtStreamFilter filter = nullptr;
+    ASSERT_EQ(hipfftExtStreamFilterCreate(&filter,
+                                          type,
+                                          taps,
+                                          host ? coefficients.data() : d_coefficients,
+                                          fftSize,
+                                          blocksPerLaunch,
+                                          backend),
+              HIPFFT_SUCCESS);
+    long long int fft_size     = 0;
+    long long int block_length = 0;
+    long long int launch       = 0;
+    ASSERT_EQ(hipfftExtStreamFilterGetSizes(filter, &fft_size, &block_length, &launch),
+              HIPFFT_SUCCESS);
+    ASSERT_EQ(block_length, fft_size - taps + 1);
+
+    // the filter's plans are all made when it's created
+    hipfftExtPlanCacheStats cache_before;
+    ASSERT_EQ(hipfftExtGetPlanCacheStats(&cache_before), HIPFFT_SUCCESS);
+
+    const std::vector<long long int> chunks = {1,
+                                               block_length - 1,
+                                               0,
+                                               2,
+                                               3 * block_length + 5,
+                                               2 * launch * block_length + 7,
+                                               17,
+                                               block_length};
+    long long int total = 0;
+    long long int most  = 0;
+    for(auto c : chunks)
+    {
+        total += c;
+        most = std::max(most, c);
+    }
+    std::vector<T> stream(total);
+    for(size_t i = 0; i < stream.size(); ++i)
+        fill_value(stream[i], i);
+
+    T* d_input  = nullptr;
+    T* d_output = nullptr;
+    if(!host)
+    {
+        ASSERT_EQ(hipMalloc(&d_input, most * sizeof(T)), hipSuccess);
+        ASSERT_EQ(hipMalloc(&d_output, (most + block_length - 1) * sizeof(T)), hipSuccess);
+    }
+
+    std::vector<T> filtered(total + block_length);
+    long long int  consumed = 0;
+    long long int  produced = 0;
+    for(auto c : chunks)
+    {
+        long long int length = -1;
+        if(host)
+        {
+            ASSERT_EQ(hipfftExtStreamFilterExec(filter,
+                                                stream.data() + consumed,
+                                                c,
+                                                filtered.data() + produced,
+                                                &length),
+                      HIPFFT_SUCCESS);
+        }
+        else
+        {
+            ASSERT_EQ(hipMemcpy(d_input,
+                                stream.data() + consumed,
+                                c * sizeof(T),
+                                hipMemcpyHostToDevice),
+                      hipSuccess);
+            ASSERT_EQ(hipfftExtStreamFilterExec(filter, d_input, c, d_output, &length),
+                      HIPFFT_SUCCESS);
+            ASSERT_EQ(hipMemcpy(filtered.data() + produced,
+                                d_output,
+                                length * sizeof(T),
+                                hipMemcpyDeviceToHost),
+                      hipSuccess);
+        }
+        consumed += c;
+        produced += length;
+
+        // every complete block is returned
+        EXPECT_EQ(produced, consumed / block_length * block_length);
+    }
+
+    hipfftExtPlanCacheStats cache_after;
+    ASSERT_EQ(hipfftExtGetPlanCacheStats(&cache_after), HIPFFT_SUCCESS);
+    EXPECT_EQ(cache_after.hits + cache_after.misses, cache_before.hits + cache_before.misses);
+
+    const auto ref     = filter_reference(stream, coefficients);
+    double     max_ref = 1.0;
+    double     error   = 0.0;
+    for(long long int t = 0; t < produced; ++t)
+    {
+        max_ref = std::max(max_ref, std::abs(ref[t]));
+        error   = std::max(error, std::abs(to_complex(filtered[t]) - ref[t]));
+    }
+    EXPECT_LE(error, tolerance * max_ref);
+
+    hipfftExtStreamFilterStats stats;
+    ASSERT_EQ(hipfftExtStreamFilterGetStats(filter, &stats), HIPFFT_SUCCESS);
+    EXPECT_EQ(stats.inputSamples, static_cast<size_t>(total));
+    EXPECT_EQ(stats.outputSamples, static_cast<size_t>(produced));
+    EXPECT_EQ(stats.blocks * block_length, static_cast<size_t>(produced));
+    // the long chunk needs more than one launch, and no launch
+    // filters more than a launch's blocks
+    EXPECT_GE(stats.launches, (stats.blocks + launch - 1) / launch);
+    EXPECT_LT(stats.launches, stats.blocks);
+    EXPECT_GE(stats.seconds, 0.0);
+
+    ASSERT_EQ(hipfftExtStreamFilterDestroy(filter), HIPFFT_SUCCESS);
+    if(!host)
+    {
+        ASSERT_EQ(hipFree(d_coefficients), hipSuccess);
+        ASSERT_EQ(hipFree(d_input), hipSuccess);
+        ASSERT_EQ(hipFree(d_output), hipSuccess);
+    }
+}
+
+TEST(hipfft_stream_filter, host_backend)
+{
+    check_stream_filter<float>(HIPFFT_R2C, 5, 16, 3, HIPFFT_STREAM_FILTER_HOST, 1e-5);
+    check_stream_filter<hipfftComplex>(HIPFFT_C2C, 16, 16, 4, HIPFFT_STREAM_FILTER_HOST, 1e-5);
+    check_stream_filter<double>(HIPFFT_D2Z, 1, 8, 2, HIPFFT_STREAM_FILTER_HOST, 1e-12);
+    check_stream_filter<hipfftDoubleComplex>(
+        HIPFFT_Z2Z, 33, 0, 2, HIPFFT_STREAM_FILTER_HOST, 1e-12);
+}
+
+TEST(hipfft_stream_filter, device)
+{
+    check_stream_filter<float>(HIPFFT_R2C, 5, 16, 3, HIPFFT_STREAM_FILTER_DEVICE, 1e-5);
+    check_stream_filter<hipfftComplex>(HIPFFT_C2C, 16, 16, 4, HIPFFT_STREAM_FILTER_DEVICE, 1e-5);
+    check_stream_filter<double>(HIPFFT_D2Z, 1, 8, 2, HIPFFT_STREAM_FILTER_DEVICE, 1e-12);
+    check_stream_filter<hipfftDoubleComplex>(
+        HIPFFT_Z2Z, 33, 0, 2, HIPFFT_STREAM_FILTER_DEVICE, 1e-12);
+    check_stream_filter<float>(HIPFFT_R2C, 100, 0, 3, HIPFFT_STREAM_FILTER_DEVICE, 1e-5);
+}
+
+TEST(hipfft_stream_filter, fft_size)
+{
+    const auto sizes = [](long long int taps, long long int fftSize, long long int blocks) {
+        std::vector<float>         coefficients(taps, 1.0f);
+        hipfftExtStreamFilter      filter = nullptr;
+        std::vector<long long int> result(3, -1);
+        EXPECT_EQ(hipfftExtStreamFilterCreate(&filter,
+                                              HIPFFT_R2C,
+                                              taps,
+                                              coefficients.data(),
+                                              fftSize,
+                                              blocks,
+                                              HIPFFT_STREAM_FILTER_HOST),
+                  HIPFFT_SUCCESS);
+        EXPECT_EQ(hipfftExtStreamFilterGetSizes(filter, &result[0], &result[1], &result[2]),
+                  HIPFFT_SUCCESS);
+        EXPECT_EQ(hipfftExtStreamFilterDestroy(filter), HIPFFT_SUCCESS);
+        return result;
+    };
+
+    // chosen sizes are powers of two, long enough that most of each
+    // block is filtered samples
+    for(long long int taps : {1, 7, 100, 1000, 5000})
+    {
+        const auto s = sizes(taps, 0, 0);
+        EXPECT_GE(s[0], 2 * taps);
+        EXPECT_EQ(s[0] & (s[0] - 1), 0);
+        EXPECT_EQ(s[1], s[0] - taps + 1);
+        EXPECT_EQ(s[2], std::max<long long int>(1, (1 << 18) / s[0]));
+    }
+    EXPECT_EQ(sizes(1, 0, 0)[0], 256);
+    EXPECT_EQ(sizes(100, 0, 0)[0], 1024);
+
+    // given sizes are kept
+    EXPECT_EQ(sizes(10, 64, 5), (std::vector<long long int>{64, 55, 5}));
+    EXPECT_EQ(sizes(10, 10, 1), (std::vector<long long int>{10, 1, 1}));
+}
+
+TEST(hipfft_stream_filter, invalid)
+{
+    std::vector<float>    coefficients(8, 1.0f);
+    hipfftExtStreamFilter filter = nullptr;
+
+    const auto create = [&](hipfftType                   type,
+                            long long int                taps,
+                            const void*                  c,
+                            long long int                fftSize,
+                            long long int                blocks,
+                            hipfftExtStreamFilterBackend backend) {
+        hipfftExtStreamFilter f = nullptr;
+        return hipfftExtStreamFilterCreate(&f, type, taps, c, fftSize, blocks, backend);
+    };
+
+    const auto host = HIPFFT_STREAM_FILTER_HOST;
+    // filters go from real to real or complex to complex
+    EXPECT_EQ(create(HIPFFT_C2R, 8, coefficients.data(), 0, 0, host), HIPFFT_INVALID_TYPE);
+    // blocks must be at least as long as the filter
+    EXPECT_EQ(create(HIPFFT_R2C, 8, coefficients.data(), 7, 0, host), HIPFFT_INVALID_SIZE);
+    EXPECT_EQ(create(HIPFFT_R2C, 0, coefficients.data(), 0, 0, host), HIPFFT_INVALID_VALUE);
+    EXPECT_EQ(create(HIPFFT_R2C, 8, nullptr, 0, 0, host), HIPFFT_INVALID_VALUE);
+    EXPECT_EQ(create(HIPFFT_R2C, 8, coefficients.data(), 0, -1, host), HIPFFT_INVALID_VALUE);
+    EXPECT_EQ(create(HIPFFT_R2C,
+                     8,
+                     coefficients.data(),
+                     0,
+                     0,
+                     static_cast<hipfftExtStreamFilterBackend>(2)),
+              HIPFFT_INVALID_VALUE);
+
+    ASSERT_EQ(hipfftExtStreamFilterCreate(
+                  &filter, HIPFFT_R2C, 8, coefficients.data(), 16, 1, host),
+              HIPFFT_SUCCESS);
+    float*        data   = coefficients.data();
+    long long int length = 0;
+    EXPECT_EQ(hipfftExtStreamFilterExec(filter, data, -1, data, &length), HIPFFT_INVALID_VALUE);
+    EXPECT_EQ(hipfftExtStreamFilterExec(filter, data, 8, nullptr, &length), HIPFFT_INVALID_VALUE);
+    EXPECT_EQ(hipfftExtStreamFilterExec(filter, data, 8, data, nullptr), HIPFFT_INVALID_VALUE);
+    EXPECT_EQ(hipfftExtStreamFilterExec(nullptr, data, 8, data, &length), HIPFFT_INVALID_VALUE);
+    EXPECT_EQ(hipfftExtStreamFilterGetStats(filter, nullptr), HIPFFT_INVALID_VALUE);
+
+    // an empty chunk filters nothing
+    EXPECT_EQ(hipfftExtStreamFilterExec(filter, nullptr, 0, nullptr, &length), HIPFFT_SUCCESS);
+    EXPECT_EQ(length, 0);
+    ASSERT_EQ(hipfftExtStreamFilterDestroy(filter), HIPFFT_SUCCESS);
+}
+
+#endif
@@ -95,7 +95,9 @@ typedef enum hipfftResult_t
     /*! Function does not implement functionality for parameters given. */
     HIPFFT_NOT_IMPLEMENTED = 14,
     /*! Operation is not supported for parameters given. */
-    HIPFFT_NOT_SUPPORTED = 16
+    HIPFFT_NOT_SUPPORTED = 16,
+    /*! Plan is still being made asynchronously (hipFFT extension) */
+    HIPFFT_PLAN_NOT_READY = 1000
 } hipfftResult;
 
 /*! @brief Transform type
@@ -253,6 +255,437 @@ HIPFFT_EXPORT hipfftResult hipfftCreate(hipfftHandle* plan);
  */
 HIPFFT_EXPORT hipfftResult hipfftExtPlanScaleFactor(hipfftHandle plan, double scalefactor);
 
+/*! @brief Defer creation of backend plans until execution.
+ *
+ *  @details hipFFT is not told the placement (in-place or
+ *  out-of-place) of a transform until it is executed, and
+ *  complex-to-complex plans can be executed in either direction.  So
+ *  by default, plan initialization creates a backend plan for every
+ *  placement and direction that the transform type allows.
+ *
+ *  If lazy creation is enabled, plan initialization only records the
+ *  transform parameters.  Each backend plan is created the first
+ *  time the plan is executed with that placement and direction, and
+ *  the work area is grown to fit the plans actually used.
+ *  Consequently, the work area size reported at plan initialization
+ *  is zero, and invalid transform parameters are only reported when
+ *  the plan is executed.  If automatic work area allocation is
+ *  disabled, a work area given to ::hipfftSetWorkArea is assumed to
+ *  be as large as the largest size reported for the handle, for
+ *  example by ::hipfftGetSizeMany before the plan was made.
+ *  Execution fails with ::HIPFFT_NO_WORKSPACE if a newly created
+ *  backend plan needs more than that.
+ *
+ *  This function must be called after the plan is allocated using
+ *  ::hipfftCreate, but before the plan is initialized by any of the
+ *  "MakePlan" functions.
+ *
+ *  @param[in] plan Handle of the FFT plan.
+ *  @param[in] lazyCreate Nonzero to enable lazy creation, zero to disable it.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtPlanLazyCreate(hipfftHandle plan, int lazyCreate);
+
+/*! @brief Plan cache statistics
+ *
+ *  @details hipFFT keeps a process-wide cache of backend plans.
+ *  Plan handles created with identical parameters on the same device
+ *  share backend plans rather than creating new ones.  Plans that
+ *  are no longer used by any handle are retained until the cache
+ *  holds more plans than the limit given by the
+ *  `HIPFFT_PLAN_CACHE_SIZE` environment variable (default 0), and
+ *  are then destroyed in least-recently-used order.  Values of the
+ *  variable that aren't a non-negative integer are ignored.
+ */
+typedef struct hipfftExtPlanCacheStats_t
+{
+    /*! Number of backend plan requests satisfied from the cache */
+    size_t hits;
+    /*! Number of backend plan requests that created a new plan */
+    size_t misses;
+    /*! Number of unused plans destroyed to stay within the size limit */
+    size_t evictions;
+    /*! Number of plans currently in the cache */
+    size_t entries;
+    /*! Number of cached plans not used by any plan handle */
+    size_t idleEntries;
+    /*! Maximum number of plans retained by the cache */
+    size_t capacity;
+    /*! Number of backend plans created, whether or not through the cache */
+    size_t created;
+} hipfftExtPlanCacheStats;
+
+/*! @brief Get plan cache statistics.
+ *
+ *  @param[out] stats Current statistics of the process-wide plan cache.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtGetPlanCacheStats(hipfftExtPlanCacheStats* stats);
+
+/*! @brief Clear the plan cache.
+ *
+ *  @details Destroys all cached plans that are not used by any plan
+ *  handle, and resets the hit, miss, eviction and creation counters.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtClearPlanCache();
+
+/*! @brief Work area allocation policies */
+typedef enum hipfftExtWorkAreaPolicy_t
+{
+    /*! Each plan allocates its own work area */
+    HIPFFT_WORKAREA_PER_PLAN = 0,
+    /*! Plans executing on the same device and stream share one work
+     *  area, sized to the largest requirement among them */
+    HIPFFT_WORKAREA_SHARED_PER_STREAM = 1,
+    /*! Each plan allocates its own work area when it is first
+     *  executed, and again after the work area is trimmed */
+    HIPFFT_WORKAREA_DEFERRED = 2
+} hipfftExtWorkAreaPolicy;
+
+/*! @brief Set where a plan's automatically-allocated work area comes from.
+ *
+ *  @details Only one transform runs at a time on a stream, so plans
+ *  that execute on the same stream can share a work area.  With
+ *  ::HIPFFT_WORKAREA_SHARED_PER_STREAM, a plan draws its work area at
+ *  execution time from a buffer shared with all other such plans on
+ *  the same device and stream.  The buffer grows as needed, and is
+ *  freed when no plan uses it any more.
+ *
+ *  With ::HIPFFT_WORKAREA_DEFERRED, a plan allocates its own work
+ *  area on first execution rather than when the plan is made, so
+ *  plans that are never executed use no work area memory.
+ *
+ *  Shared and deferred work areas can be released while a plan is
+ *  idle with ::hipfftExtTrimMemory or ::hipfftExtTrimAllMemory.
+ *
+ *  The policy has no effect if the plan's work area is provided with
+ *  ::hipfftSetWorkArea, or if automatic allocation is disabled.
+ *
+ *  @param[in] plan Handle of the FFT plan.
+ *  @param[in] policy Work area allocation policy.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtSetWorkAreaPolicy(hipfftHandle            plan,
+                                                      hipfftExtWorkAreaPolicy policy);
+
+/*! @brief Shared work area statistics */
+typedef struct hipfftExtWorkAreaStats_t
+{
+    /*! Number of shared work areas, one per device and stream in use */
+    size_t arenas;
+    /*! Number of plans currently using a shared work area */
+    size_t handles;
+    /*! Bytes currently allocated for shared work areas */
+    size_t bytes;
+    /*! Largest number of bytes allocated for shared work areas at any time */
+    size_t peakBytes;
+    /*! Total bytes allocated for shared work areas, including freed buffers */
+    size_t totalBytes;
+} hipfftExtWorkAreaStats;
+
+/*! @brief Get shared work area statistics.
+ *
+ *  @param[out] stats Current statistics of the shared work areas.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtGetWorkAreaStats(hipfftExtWorkAreaStats* stats);
+
+/*! @brief Release a plan's work area until it is next executed.
+ *
+ *  @details A deferred work area is freed, and a plan using a shared
+ *  work area stops using it (the shared area is freed if no other
+ *  plan uses it).  Either is set up again when the plan is next
+ *  executed.  Has no effect on plans with other work area policies.
+ *
+ *  @param[in] plan Handle of the FFT plan.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtTrimMemory(hipfftHandle plan);
+
+/*! @brief Release the work areas of all idle plans.
+ *
+ *  @details Calls ::hipfftExtTrimMemory on every plan in the process
+ *  that has not been executed for at least idleSeconds.
+ *
+ *  @param[in] idleSeconds Minimum time since a plan was last executed.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtTrimAllMemory(double idleSeconds);
+
+/*! @brief Serialize a plan.
+ *
+ *  @details Writes the plan's parameters and settings to a binary
+ *  buffer.  The buffer can be stored and passed to
+ *  ::hipfftExtPlanDeserialize to recreate the plan without most of
+ *  the cost of planning.  Kernels the backend has compiled at
+ *  runtime are saved separately, with
+ *  ::hipfftExtKernelCacheSerialize.
+ *
+ *  The buffer is specific to the library versions and device
+ *  architectures it was created with.  It must be freed with
+ *  ::hipfftExtPlanBufferFree.
+ *
+ *  Operations set with ::hipfftExtSetLoadOp and ::hipfftExtSetStoreOp
+ *  are serialized with the plan.  Returns ::HIPFFT_NOT_SUPPORTED if
+ *  the plan has a ::HIPFFT_OP_MULTIPLY operation, whose array is
+ *  only valid in this process.  Callbacks set with
+ *  ::hipfftXtSetCallback are not serialized.
+ *
+ *  @param[in] plan Handle of a plan that has been made.
+ *  @param[out] buffer Pointer to the serialized plan.
+ *  @param[out] bufferSize Size of the serialized plan in bytes.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtPlanSerialize(hipfftHandle plan,
+                                                  void**       buffer,
+                                                  size_t*      bufferSize);
+
+/*! @brief Free a buffer returned by ::hipfftExtPlanSerialize or
+ *  ::hipfftExtKernelCacheSerialize.
+ *
+ *  @param[in] buffer Serialized plan.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtPlanBufferFree(void* buffer);
+
+/*! @brief Make a plan from a serialized plan.
+ *
+ *  @details Like the hipfftMakePlan* functions, assumes that the plan
+ *  has been created already but not made.  Returns
+ *  ::HIPFFT_NOT_SUPPORTED if the buffer was serialized with different
+ *  library versions or device architectures, and
+ *  ::HIPFFT_INVALID_VALUE if the buffer is not a valid serialized
+ *  plan.
+ *
+ *  @param[in] plan Handle of the FFT plan.
+ *  @param[in] buffer Serialized plan.
+ *  @param[in] bufferSize Size of the serialized plan in bytes.
+ *  @param[out] workSize Pointer to work area size (returned value).
+ *  For multi-device plans, one size per device, as for the
+ *  "MakePlan" functions.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtPlanDeserialize(hipfftHandle plan,
+                                                    const void*  buffer,
+                                                    size_t       bufferSize,
+                                                    size_t*      workSize);
+
+/*! @brief Serialize the kernels compiled at runtime.
+ *
+ *  @details Writes the kernels that the backend has compiled at
+ *  runtime, for all plans in the process, to a binary buffer.  The
+ *  buffer can be stored and passed to
+ *  ::hipfftExtKernelCacheDeserialize, before plans are made or
+ *  deserialized, so that their kernels needn't be compiled again.
+ *
+ *  The buffer is specific to the library versions and device
+ *  architecture it was created with.  It must be freed with
+ *  ::hipfftExtPlanBufferFree.
+ *
+ *  @param[out] buffer Pointer to the serialized kernels.
+ *  @param[out] bufferSize Size of the serialized kernels in bytes.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtKernelCacheSerialize(void** buffer, size_t* bufferSize);
+
+/*! @brief Load kernels serialized with ::hipfftExtKernelCacheSerialize.
+ *
+ *  @details Returns ::HIPFFT_NOT_SUPPORTED if the buffer was
+ *  serialized with different library versions or device
+ *  architecture, and ::HIPFFT_INVALID_VALUE if the buffer is not
+ *  valid serialized kernels.
+ *
+ *  @param[in] buffer Serialized kernels.
+ *  @param[in] bufferSize Size of the serialized kernels in bytes.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtKernelCacheDeserialize(const void* buffer,
+                                                           size_t      bufferSize);
+
+/*! @brief Work size estimation modes */
+typedef enum hipfftExtEstimateMode_t
+{
+    /*! Compute an upper bound from the transform dimensions and data
+     *  layout alone */
+    HIPFFT_ESTIMATE_ANALYTIC = 0,
+    /*! Use the exact size of matching plans in the plan cache, if
+     *  all the plans the transform needs are there, otherwise compute
+     *  an upper bound */
+    HIPFFT_ESTIMATE_EXACT = 1
+} hipfftExtEstimateMode;
+
+/*! @brief Set how work area sizes are estimated.
+ *
+ *  @details Controls the process-wide behaviour of hipfftEstimate*
+ *  and hipfftGetSize* (other than ::hipfftGetSize, which returns the
+ *  size required by a plan that has already been made).  Neither
+ *  mode creates any backend plans or allocates device memory.
+ *
+ *  The default, ::HIPFFT_ESTIMATE_ANALYTIC, returns an upper bound
+ *  that may be considerably larger than what a plan actually needs.
+ *  The bound allows for the strides and distances of the data, and
+ *  is larger for strided or padded layouts.
+ *  ::HIPFFT_ESTIMATE_EXACT returns the exact size when all the plans
+ *  that making the transform would create are present in the plan
+ *  cache, and otherwise falls back to the upper bound.  Plans only
+ *  match if they were made with the same settings as the handle
+ *  passed to hipfftGetSize*, including its scale factor and
+ *  multi-device decomposition.
+ *
+ *  @param[in] mode Estimation mode.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtSetEstimateMode(hipfftExtEstimateMode mode);
+
+/*! @brief Completion token for a plan made asynchronously */
+typedef struct hipfftExtPlanToken_t* hipfftExtPlanToken;
+
+/*! @brief What executing a plan that is still being made does */
+typedef enum hipfftExtNotReadyPolicy_t
+{
+    /*! Block until the plan is ready, then execute it */
+    HIPFFT_NOT_READY_WAIT = 0,
+    /*! Return ::HIPFFT_PLAN_NOT_READY without executing */
+    HIPFFT_NOT_READY_RETURN = 1
+} hipfftExtNotReadyPolicy;
+
+/*! @brief Initialize a new batched rank-dimensional FFT plan in the
+ *  background.
+ *
+ *  @details Takes the same parameters as ::hipfftMakePlanMany, but
+ *  returns as soon as the parameters are copied.  The plan is made
+ *  on another host thread, so that planning (including one-time
+ *  library setup on the first plan in the process) can overlap with
+ *  other work on the calling thread.
+ *
+ *  Completion can be polled or waited for through the returned token.
+ *  Executing the plan before it is ready blocks or fails according to
+ *  ::hipfftExtSetNotReadyPolicy.  Other functions that take the plan
+ *  handle, including ::hipfftDestroy, wait for planning to finish,
+ *  except for functions that change settings used to make the plan
+ *  (such as ::hipfftExtPlanScaleFactor, ::hipfftExtPlanLazyCreate and
+ *  hipfftXtSetGPUs), which return ::HIPFFT_INVALID_PLAN.
+ *
+ *  @param[in] plan Handle of the FFT plan.
+ *  @param[in] rank Dimension of FFT transform (1, 2, or 3).
+ *  @param[in] n Number of elements in the x/y/z directions.
+ *  @param[in] inembed Number of elements in the input data in the x/y/z directions.
+ *  @param[in] istride Distance between two successive elements in the input data.
+ *  @param[in] idist Distance between input batches.
+ *  @param[in] onembed Number of elements in the output data in the x/y/z directions.
+ *  @param[in] ostride Distance between two successive elements in the output data.
+ *  @param[in] odist Distance between output batches.
+ *  @param[in] type FFT type.
+ *  @param[in] batch Number of batched transforms to perform.
+ *  @param[out] token Completion token, which must be freed with
+ *  ::hipfftExtPlanTokenDestroy.  May be NULL if the caller doesn't
+ *  need one.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtMakePlanManyAsync(hipfftHandle        plan,
+                                                      int                 rank,
+                                                      int*                n,
+                                                      int*                inembed,
+                                                      int                 istride,
+                                                      int                 idist,
+                                                      int*                onembed,
+                                                      int                 ostride,
+                                                      int                 odist,
+                                                      hipfftType          type,
+                                                      int                 batch,
+                                                      hipfftExtPlanToken* token);
+
+/*! @brief Check whether an asynchronously-made plan is ready.
+ *
+ *  @details Returns ::HIPFFT_PLAN_NOT_READY while the plan is still
+ *  being made, and otherwise the result of making it.
+ *
+ *  @param[in] token Token returned by ::hipfftExtMakePlanManyAsync.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtPlanTokenQuery(hipfftExtPlanToken token);
+
+/*! @brief Wait for an asynchronously-made plan to be ready.
+ *
+ *  @details Returns the result of making the plan.
+ *
+ *  @param[in] token Token returned by ::hipfftExtMakePlanManyAsync.
+ *  @param[out] workSize Pointer to work area size (returned value).
+ *  For multi-device plans, one size per device, as for the
+ *  "MakePlan" functions.
+ *  May be NULL.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtPlanTokenWait(hipfftExtPlanToken token, size_t* workSize);
+
+/*! @brief Free a completion token.
+ *
+ *  @details Does not wait for the plan, which remains usable through
+ *  its handle.
+ *
+ *  @param[in] token Token returned by ::hipfftExtMakePlanManyAsync.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtPlanTokenDestroy(hipfftExtPlanToken token);
+
+/*! @brief Set what executing a plan that is still being made does.
+ *
+ *  @details With the default ::HIPFFT_NOT_READY_WAIT, execution
+ *  blocks until the plan is ready.  With ::HIPFFT_NOT_READY_RETURN,
+ *  execution returns ::HIPFFT_PLAN_NOT_READY immediately instead.
+ *
+ *  @param[in] plan Handle of the FFT plan.
+ *  @param[in] policy What executing the plan before it's ready does.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtSetNotReadyPolicy(hipfftHandle            plan,
+                                                      hipfftExtNotReadyPolicy policy);
+
+/*! @brief Library initialization flags */
+typedef enum hipfftExtInitFlags_t
+{
+    /*! Initialize on the calling thread before returning */
+    HIPFFT_INIT_DEFAULT = 0x0,
+    /*! Initialize on a background thread and return immediately */
+    HIPFFT_INIT_BACKGROUND = 0x1
+} hipfftExtInitFlags;
+
+/*! @brief Transform signature to prewarm during initialization */
+typedef struct hipfftExtPrewarmSpec_t
+{
+    /*! Dimension of the transform (1, 2, or 3) */
+    int rank;
+    /*! Number of elements in the x/y/z directions */
+    int n[3];
+    /*! FFT type */
+    hipfftType type;
+    /*! Number of batched transforms */
+    int batch;
+} hipfftExtPrewarmSpec;
+
+/*! @brief Initialize the library.
+ *
+ *  @details Without explicit initialization, the one-time setup of
+ *  the backend library happens when the first plan in the process is
+ *  made, which adds to the latency of making that plan.  Calling
+ *  this function moves that cost to a time of the application's
+ *  choosing.
+ *
+ *  Plans for each of the given transform signatures are then made and
+ *  destroyed on the current device, so that kernels that need to be
+ *  compiled at runtime are ready before they are first needed.  The
+ *  plans themselves are retained if the plan cache has room for them
+ *  (see the ``HIPFFT_PLAN_CACHE_SIZE`` environment variable).
+ *
+ *  With ::HIPFFT_INIT_BACKGROUND, all of this happens on a background
+ *  thread and the function returns immediately.  Plans made in the
+ *  meantime wait for the setup to finish, but not for prewarming.
+ *  Applications that initialize in the background must call
+ *  ::hipfftExtFinalize before exiting.
+ *
+ *  @param[in] flags Bitwise OR of ::hipfftExtInitFlags values.
+ *  @param[in] prewarm Transform signatures to prewarm.  May be NULL
+ *  if prewarmCount is 0.
+ *  @param[in] prewarmCount Number of transform signatures to prewarm.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtInitialize(unsigned int                flags,
+                                               const hipfftExtPrewarmSpec* prewarm,
+                                               size_t                      prewarmCount);
+
+/*! @brief Finalize the library.
+ *
+ *  @details Waits for any background initialization to finish,
+ *  destroys all cached plans and cleans up the backend library, so
+ *  that teardown happens at a well-defined point rather than at
+ *  process exit.  All plan handles must have been destroyed first,
+ *  otherwise ::HIPFFT_INVALID_PLAN is returned.  The library is set
+ *  up again if it's used after being finalized.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtFinalize();
+
 /*! @brief Initialize a new one-dimensional FFT plan.
  *
  *  @details Assumes that the plan has been created already, and
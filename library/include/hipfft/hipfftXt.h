@@ -125,6 +125,333 @@ HIPFFT_EXPORT hipfftResult hipfftXtSetCallbackSharedSize(hipfftHandle         pl
                                                          hipfftXtCallbackType cbtype,
                                                          size_t               sharedSize);
 
+/*! @brief Built-in operations for ::hipfftExtSetLoadOp and
+ *  ::hipfftExtSetStoreOp
+ *
+ *  Windows are applied along the fastest-varying dimension of the
+ *  data being loaded or stored, using the index n of each element
+ *  along that dimension and that dimension's length N.  They are the
+ *  symmetric forms of each window, with x = n / (N - 1).  Element
+ *  indices come from the strides the plan was made with; plans made
+ *  without strides assume the unpadded layout of an out-of-place
+ *  transform.
+ */
+typedef enum hipfftExtOp_t
+{
+    //! No operation; removes an op that was set before
+    HIPFFT_OP_NONE = 0,
+    //! Multiply each element by param
+    HIPFFT_OP_SCALE = 1,
+    //! Multiply by 0.5 - 0.5 cos(2 pi x)
+    HIPFFT_OP_WINDOW_HANN = 2,
+    //! Multiply by 0.54 - 0.46 cos(2 pi x)
+    HIPFFT_OP_WINDOW_HAMMING = 3,
+    //! Multiply by 0.42 - 0.5 cos(2 pi x) + 0.08 cos(4 pi x)
+    HIPFFT_OP_WINDOW_BLACKMAN = 4,
+    //! Multiply by I0(beta sqrt(1 - (2x - 1)^2)) / I0(beta), where
+    //! I0 is the zeroth-order modified Bessel function of the first
+    //! kind and beta is param
+    HIPFFT_OP_WINDOW_KAISER = 5,
+    //! Complex conjugate.  Only for complex data.
+    HIPFFT_OP_CONJUGATE = 6,
+    //! Multiply pointwise by an array of the same type and layout as
+    //! the data
+    HIPFFT_OP_MULTIPLY = 7,
+    //! Store the magnitude of each element.  Only for stores.
+    HIPFFT_OP_MAGNITUDE = 8,
+    //! Store the squared magnitude of each element.  Only for stores.
+    HIPFFT_OP_POWER = 9,
+} hipfftExtOp;
+
+/*! @brief Fuse a built-in operation into the transform's input.
+ *
+ *  @details Sets a load callback that the library provides, so
+ *  that common pre-processing needs no user device code.  The
+ *  operation replaces any load callback set on the plan with
+ *  ::hipfftXtSetCallback, and is replaced by one set later.
+ *
+ *  The callback is compiled at run time the first time a device
+ *  architecture needs it, and runs on the device that is current
+ *  when the op is set.  For plans whose input is converted to single
+ *  precision, the operation applies to the converted input, and
+ *  ::HIPFFT_OP_NONE leaves just the conversion.  The plan must
+ *  already be made, be on a single device, and be single or double
+ *  precision.
+ *  ::HIPFFT_OP_MAGNITUDE and ::HIPFFT_OP_POWER are only for stores.
+ *
+ *  @param[in] plan The FFT plan.
+ *  @param[in] op Operation to apply to each element as it's loaded.
+ *  @param[in] param Factor for ::HIPFFT_OP_SCALE, and beta (at least
+ *  0) for ::HIPFFT_OP_WINDOW_KAISER.  Ignored by other operations.
+ *  @param[in] array Device array for ::HIPFFT_OP_MULTIPLY, with the
+ *  same type and layout as the transform's input.  It must remain
+ *  valid while the plan executes with this op.  For converted input,
+ *  the array holds single-precision values that multiply the
+ *  converted input.  Ignored by other operations.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtSetLoadOp(hipfftHandle plan,
+                                              hipfftExtOp  op,
+                                              double       param,
+                                              const void*  array);
+
+/*! @brief Fuse a built-in operation into the transform's output.
+ *
+ *  @details Like ::hipfftExtSetLoadOp, but applies the operation to
+ *  each element as it's stored, replacing any store callback.
+ *
+ *  ::HIPFFT_OP_MAGNITUDE and ::HIPFFT_OP_POWER store real values of
+ *  the output's precision, at the same element offsets as the
+ *  output's layout would put each element.  For complex output, the
+ *  output buffer then holds a real array whose strides and distance
+ *  are those of the output layout.  The transform then writes its
+ *  complex output to a buffer that the plan allocates, and the
+ *  magnitudes are stored in a separate pass, so the plan must be
+ *  executed out-of-place and can't be executed through
+ *  ::hipfftExtExecWithContext.
+ *
+ *  @param[in] plan The FFT plan.
+ *  @param[in] op Operation to apply to each element as it's stored.
+ *  @param[in] param Factor for ::HIPFFT_OP_SCALE, and beta (at least
+ *  0) for ::HIPFFT_OP_WINDOW_KAISER.  Ignored by other operations.
+ *  @param[in] array Device array for ::HIPFFT_OP_MULTIPLY, with the
+ *  same type and layout as the transform's output.  Ignored by
+ *  other operations.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtSetStoreOp(hipfftHandle plan,
+                                               hipfftExtOp  op,
+                                               double       param,
+                                               const void*  array);
+
+/*! @brief Kind of convolution computed by a ::hipfftExtConvolution */
+typedef enum hipfftExtConvolutionMode_t
+{
+    //! Signals are periodic, and each output has the signal's lengths
+    HIPFFT_CONVOLUTION_CIRCULAR = 0,
+    //! Signals and filters are zero-padded, and each output has the
+    //! full lengths n + k - 1 of the signal's lengths n and the
+    //! filter's lengths k
+    HIPFFT_CONVOLUTION_LINEAR = 1,
+} hipfftExtConvolutionMode;
+
+/*! @brief Convolution of signals with a set of filters */
+typedef struct hipfftExtConvolution_t* hipfftExtConvolution;
+
+/*! @brief Plan convolutions of signals with one or more filters.
+ *
+ *  @details Each execution convolves every signal in a batch with
+ *  every filter.  The filters' spectra are computed once, when the
+ *  convolution is planned.  Executing then takes a forward transform
+ *  of the signals, and an inverse transform that multiplies by the
+ *  filters' spectra as it loads its input, so the products are never
+ *  written to memory.  Linear convolutions zero-pad the signals as
+ *  the forward transform loads them.
+ *
+ *  Signals, filters and outputs are contiguous, with row-major
+ *  lengths, and each batch follows the one before it.  The outputs
+ *  are ordered by signal and then by filter, so the output for
+ *  signal b and filter f is number b * numFilters + f.  Transforms
+ *  have the lengths of the outputs, so outputs whose lengths factor
+ *  into small primes are fastest.  Results are normalized.
+ *
+ *  The convolution runs on the current device.
+ *
+ *  @param[out] conv The new convolution.
+ *  @param[in] rank Number of dimensions (1, 2, or 3).
+ *  @param[in] n Lengths of each signal.
+ *  @param[in] filterLength Lengths of each filter.  For circular
+ *  convolutions, no longer than the signal's lengths.
+ *  @param[in] numFilters Number of filters.
+ *  @param[in] filters Device pointer to the filters.  Only read
+ *  while the convolution is planned.
+ *  @param[in] batch Number of signals convolved by each execution.
+ *  @param[in] type ::HIPFFT_R2C or ::HIPFFT_D2Z for real signals and
+ *  filters, ::HIPFFT_C2C or ::HIPFFT_Z2Z for complex ones.
+ *  @param[in] mode Circular or linear convolution.
+ *  @param[out] workSize Device memory used by the convolution, in
+ *  bytes.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtConvolutionPlan(hipfftExtConvolution*    conv,
+                                                    int                      rank,
+                                                    long long int*           n,
+                                                    long long int*           filterLength,
+                                                    long long int            numFilters,
+                                                    const void*              filters,
+                                                    long long int            batch,
+                                                    hipfftType               type,
+                                                    hipfftExtConvolutionMode mode,
+                                                    size_t*                  workSize);
+
+/*! @brief Convolve a batch of signals with a convolution's filters.
+ *
+ *  @param[in] conv The convolution.
+ *  @param[in] input Device pointer to the signals.  Not modified.
+ *  @param[out] output Device pointer to the outputs.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtConvolutionExec(hipfftExtConvolution conv,
+                                                    void*                input,
+                                                    void*                output);
+
+/*! @brief Set the stream that a convolution runs on.
+ *
+ *  @param[in] conv The convolution.
+ *  @param[in] stream Stream for subsequent executions.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtConvolutionSetStream(hipfftExtConvolution conv,
+                                                         hipStream_t          stream);
+
+/*! @brief Destroy a convolution and free its device memory.
+ *
+ *  @param[in] conv The convolution.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtConvolutionDestroy(hipfftExtConvolution conv);
+
+/*! @brief Where a ::hipfftExtStreamFilter filters its blocks */
+typedef enum hipfftExtStreamFilterBackend_t
+{
+    //! Blocks are filtered with FFTs on the current device.  Samples
+    //! and filters are in device memory.
+    HIPFFT_STREAM_FILTER_DEVICE = 0,
+    //! Blocks are filtered directly on the host, to check the
+    //! blocking of a stream without a device.  Samples and filters
+    //! are in host memory.
+    HIPFFT_STREAM_FILTER_HOST = 1,
+} hipfftExtStreamFilterBackend;
+
+/*! @brief Filter for a 1D stream of samples of unbounded length */
+typedef struct hipfftExtStreamFilter_t* hipfftExtStreamFilter;
+
+/*! @brief Throughput of a ::hipfftExtStreamFilter.
+ *
+ *  Filled in by ::hipfftExtStreamFilterGetStats.  Counts accumulate
+ *  over the life of the filter.
+ */
+typedef struct hipfftExtStreamFilterStats_t
+{
+    //! Samples passed to ::hipfftExtStreamFilterExec
+    size_t inputSamples;
+    //! Filtered samples returned by ::hipfftExtStreamFilterExec
+    size_t outputSamples;
+    //! Blocks filtered
+    size_t blocks;
+    //! Launches of batches of blocks
+    size_t launches;
+    //! Time spent filtering, measured on the device's stream for
+    //! ::HIPFFT_STREAM_FILTER_DEVICE and on the host for
+    //! ::HIPFFT_STREAM_FILTER_HOST
+    double seconds;
+    //! outputSamples / seconds, or 0 if nothing has been filtered
+    double samplesPerSecond;
+} hipfftExtStreamFilterStats;
+
+/*! @brief Create a filter for a stream of samples.
+ *
+ *  @details The filter computes the causal convolution
+ *  y[t] = sum over k of filter[k] * x[t - k] of a stream x that
+ *  starts at t = 0, with samples before the start taken to be zero.
+ *  The stream is passed to ::hipfftExtStreamFilterExec in chunks of
+ *  any length.
+ *
+ *  Samples are filtered with the overlap-save method, in blocks of
+ *  fftSize samples that each overlap the block before by
+ *  filterLength - 1 samples and yield fftSize - filterLength + 1
+ *  filtered samples.  The overlap and any samples that don't yet
+ *  fill a block are kept by the filter between executions.  Blocks
+ *  are filtered in batches of up to blocksPerLaunch blocks, with a
+ *  forward transform that reads the blocks from the stream as it
+ *  loads them, and an inverse transform that multiplies by the
+ *  filter's spectrum as it loads its input.  These transforms are
+ *  planned when the filter is created, for blocksPerLaunch blocks,
+ *  and launches with fewer blocks still run the whole batch.
+ *
+ *  @param[out] filter The new filter.
+ *  @param[in] type ::HIPFFT_R2C or ::HIPFFT_D2Z for real samples and
+ *  filters, ::HIPFFT_C2C or ::HIPFFT_Z2Z for complex ones.
+ *  @param[in] filterLength Number of filter coefficients.
+ *  @param[in] coefficients Pointer to the filter coefficients.  Only
+ *  read while the filter is created.
+ *  @param[in] fftSize Length of the FFTs that blocks are filtered
+ *  with, at least filterLength.  If 0, the power of two with the
+ *  least work for each filtered sample is chosen.
+ *  @param[in] blocksPerLaunch Most blocks filtered by each launch.
+ *  If 0, enough blocks to transform about 2^18 samples per launch.
+ *  @param[in] backend Whether blocks are filtered on the device or
+ *  on the host.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtStreamFilterCreate(hipfftExtStreamFilter*       filter,
+                                                       hipfftType                   type,
+                                                       long long int                filterLength,
+                                                       const void*                  coefficients,
+                                                       long long int                fftSize,
+                                                       long long int                blocksPerLaunch,
+                                                       hipfftExtStreamFilterBackend backend);
+
+/*! @brief Get the sizes that a stream filter works in.
+ *
+ *  @param[in] filter The filter.
+ *  @param[out] fftSize If not NULL, the length of the FFTs that
+ *  blocks are filtered with.
+ *  @param[out] blockLength If not NULL, the number of filtered
+ *  samples from each block.  Executions return whole blocks.
+ *  @param[out] blocksPerLaunch If not NULL, the most blocks filtered
+ *  by each launch.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtStreamFilterGetSizes(hipfftExtStreamFilter filter,
+                                                         long long int*        fftSize,
+                                                         long long int*        blockLength,
+                                                         long long int*        blocksPerLaunch);
+
+/*! @brief Filter the next chunk of a stream.
+ *
+ *  @details Filters every block that the chunk completes, and
+ *  returns the filtered samples that follow those returned by the
+ *  previous execution.  Samples that don't complete a block are
+ *  kept, and filtered by a later execution.  A chunk may complete
+ *  more blocks than fit in a launch, in which case it's filtered by
+ *  several launches.
+ *
+ *  Device executions are asynchronous on the filter's stream.
+ *
+ *  @param[in] filter The filter.
+ *  @param[in] input Pointer to the chunk's samples.  Not modified.
+ *  @param[in] inputLength Number of samples in the chunk, which may
+ *  be 0.
+ *  @param[out] output Pointer to the filtered samples, with room for
+ *  inputLength + blockLength - 1 samples.
+ *  @param[out] outputLength Number of filtered samples written to
+ *  output, which is a multiple of blockLength.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtStreamFilterExec(hipfftExtStreamFilter filter,
+                                                     const void*           input,
+                                                     long long int         inputLength,
+                                                     void*                 output,
+                                                     long long int*        outputLength);
+
+/*! @brief Get the throughput of a stream filter.
+ *
+ *  Waits for the filter's device executions to finish.
+ *
+ *  @param[in] filter The filter.
+ *  @param[out] stats Counters accumulated since the filter was
+ *  created.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtStreamFilterGetStats(hipfftExtStreamFilter       filter,
+                                                         hipfftExtStreamFilterStats* stats);
+
+/*! @brief Set the stream that a stream filter runs on.
+ *
+ *  @param[in] filter The filter.
+ *  @param[in] stream Stream for subsequent executions.  Ignored by
+ *  ::HIPFFT_STREAM_FILTER_HOST filters.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtStreamFilterSetStream(hipfftExtStreamFilter filter,
+                                                          hipStream_t           stream);
+
+/*! @brief Destroy a stream filter and free its memory.
+ *
+ *  @param[in] filter The filter.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtStreamFilterDestroy(hipfftExtStreamFilter filter);
+
 /*! @brief Initialize a batched rank-dimensional FFT plan with
     advanced data layout and specified input, output, execution data
     types.
@@ -160,6 +487,23 @@ HIPFFT_EXPORT hipfftResult hipfftXtSetCallbackSharedSize(hipfftHandle         pl
    *  must be complex.  A half-precision transform can be requested
    *  by using either the HIP_R_16F or HIP_C_16F types.
    *
+   *  A transform with execution type HIP_C_32F can also read and
+   *  write narrower types, so that data moves in the narrow type
+   *  while the transform is computed in single precision.  The input
+   *  can be half (HIP_R_16F, HIP_C_16F), bfloat16 (HIP_R_16BF,
+   *  HIP_C_16BF), or 8- or 16-bit signed integers (HIP_R_8I,
+   *  HIP_C_8I, HIP_R_16I, HIP_C_16I), converted to single precision
+   *  as it is loaded.  The output can be half or bfloat16, rounded to
+   *  nearest as it is stored.  Such transforms must be out-of-place,
+   *  on a single device.  Converted output, and converted input of
+   *  complex-to-real transforms, go through a single-precision buffer
+   *  that the plan allocates, with the conversion in a separate pass,
+   *  so the user's buffers only need to hold the narrow data.  Such
+   *  plans can't be executed through ::hipfftExtExecWithContext.
+   *  Operations set with ::hipfftExtSetLoadOp and
+   *  ::hipfftExtSetStoreOp are applied along with the conversions,
+   *  and callbacks can't be set on converted input or output.
+   *
    *  @param[out] plan Pointer to the FFT plan handle.
    *  @param[in] rank Dimension of transform (1, 2, or 3).
    *  @param[in] n Number of elements to transform in the x/y/z directions.
@@ -227,6 +571,64 @@ HIPFFT_EXPORT hipfftResult hipfftXtGetSizeMany(hipfftHandle   plan,
                                                size_t*        workSize,
                                                hipDataType    executionType);
 
+/*! @brief Parameters of one plan made by ::hipfftExtMakePlansBulk.
+ *
+ *  @details The parameters are as for ::hipfftXtMakePlanMany.
+ */
+typedef struct hipfftExtPlanSpec_t
+{
+    /*! Handle of the plan, already created but not yet made */
+    hipfftHandle plan;
+    /*! Dimension of transform (1, 2, or 3) */
+    int rank;
+    /*! Number of elements to transform in the x/y/z directions */
+    long long int* n;
+    /*! Number of elements in the input data in the x/y/z directions */
+    long long int* inembed;
+    /*! Distance between two successive elements in the input data */
+    long long int istride;
+    /*! Distance between input batches */
+    long long int idist;
+    /*! Format of FFT input */
+    hipDataType inputType;
+    /*! Number of elements in the output data in the x/y/z directions */
+    long long int* onembed;
+    /*! Distance between two successive elements in the output data */
+    long long int ostride;
+    /*! Distance between output batches */
+    long long int odist;
+    /*! Format of FFT output */
+    hipDataType outputType;
+    /*! Number of batched transforms to perform */
+    long long int batch;
+    /*! Internal data format used by the library during computation */
+    hipDataType executionType;
+    /*! Work area size (returned value).  For multi-device plans,
+     *  the size on the first device; ::hipfftGetSize gives the size
+     *  on each device. */
+    size_t workSize;
+    /*! Result of making this plan (returned value) */
+    hipfftResult status;
+} hipfftExtPlanSpec;
+
+/*! @brief Make many plans in parallel.
+
+ * @details Makes each plan in the specs array as
+ * ::hipfftXtMakePlanMany would, using a pool of host threads.  Specs
+ * with identical parameters are planned once, and the remaining
+ * plans with those parameters share the result.  All plans are made
+ * for the current device.
+ *
+ * The status of each plan is returned in its spec.  Each spec must
+ * have a distinct plan handle.
+ *
+ *  @param[in,out] specs Array of plan specifications.
+ *  @param[in] count Number of plan specifications.
+ *  @return ::HIPFFT_SUCCESS if all plans were made, otherwise the
+ *  status of the first plan that could not be made.
+ *  */
+HIPFFT_EXPORT hipfftResult hipfftExtMakePlansBulk(hipfftExtPlanSpec* specs, size_t count);
+
 /*! @brief Execute an FFT plan for any precision and type.
 
  * @details An in-place transform is performed if the input and
@@ -246,6 +648,94 @@ HIPFFT_EXPORT hipfftResult hipfftXtExec(hipfftHandle plan,
                                         void*        output,
                                         int          direction);
 
+/*! @brief Execution context for a plan */
+typedef struct hipfftExtExecContext_t* hipfftExtExecContext;
+
+/*! @brief Create an execution context for a plan.
+ *
+ *  @details An execution context carries the state that executing a
+ *  plan needs besides the plan itself: a stream, a work area and
+ *  callback bindings.  Contexts start out with the plan's stream and
+ *  callbacks, and allocate their own work area when first used.
+ *
+ *  Executing through a context reads the plan without modifying it,
+ *  so one plan can be executed concurrently from several threads,
+ *  each with its own context.  Plans made with
+ *  ::hipfftExtPlanLazyCreate are the exception: they are locked
+ *  briefly while their backend plans are created on first use.
+ *
+ *  All contexts for a plan must be destroyed before the plan.
+ *
+ *  @param[in] plan Handle of a plan that has been made.
+ *  @param[out] context The new execution context.
+ *  */
+HIPFFT_EXPORT hipfftResult hipfftExtExecContextCreate(hipfftHandle          plan,
+                                                      hipfftExtExecContext* context);
+
+/*! @brief Destroy an execution context.
+ *
+ *  @details Frees the context's work area if the context allocated
+ *  it.
+ *
+ *  @param[in] context Execution context to destroy.
+ *  */
+HIPFFT_EXPORT hipfftResult hipfftExtExecContextDestroy(hipfftExtExecContext context);
+
+/*! @brief Set the stream that transforms run on through a context.
+ *
+ *  @param[in] context Execution context.
+ *  @param[in] stream Stream for subsequent transforms.
+ *  */
+HIPFFT_EXPORT hipfftResult hipfftExtExecContextSetStream(hipfftExtExecContext context,
+                                                         hipStream_t          stream);
+
+/*! @brief Set the work area used by transforms run through a context.
+ *
+ *  @details The work area must be at least as large as the work size
+ *  of the plan.  Passing NULL makes the context allocate its own work
+ *  area again.
+ *
+ *  @param[in] context Execution context.
+ *  @param[in] workArea Pointer to the work area on the device.
+ *  */
+HIPFFT_EXPORT hipfftResult hipfftExtExecContextSetWorkArea(hipfftExtExecContext context,
+                                                           void*                workArea);
+
+/*! @brief Set a callback for transforms run through a context.
+ *
+ *  @details Like ::hipfftXtSetCallback, but only affects the context.
+ *  Shared memory sizes set on the plan with
+ *  ::hipfftXtSetCallbackSharedSize still apply.  Passing NULL
+ *  callbacks clears the callback for the context.
+ *
+ *  @param[in] context Execution context.
+ *  @param[in] callbacks Array of callback function pointers, one per device.
+ *  @param[in] cbtype Type of callback.
+ *  @param[in] callbackData Array of callback data pointers, one per device.
+ *  */
+HIPFFT_EXPORT hipfftResult hipfftExtExecContextSetCallback(hipfftExtExecContext context,
+                                                           void**               callbacks,
+                                                           hipfftXtCallbackType cbtype,
+                                                           void**               callbackData);
+
+/*! @brief Execute an FFT plan through an execution context.
+ *
+ *  @details Like ::hipfftXtExec, but uses the context's stream, work
+ *  area and callbacks instead of the plan's.  Returns
+ *  ::HIPFFT_NOT_SUPPORTED for plans whose conversions or operations
+ *  run in a separate pass through a buffer of the plan's (see
+ *  ::hipfftXtMakePlanMany and ::hipfftExtSetStoreOp).
+ *
+ *  @param[in] context Execution context.
+ *  @param[in] input Pointer to input data for the transform.
+ *  @param[in] output Pointer to output data for the transform.
+ *  @param[in] direction Either `HIPFFT_FORWARD` or `HIPFFT_BACKWARD`.
+ *  */
+HIPFFT_EXPORT hipfftResult hipfftExtExecWithContext(hipfftExtExecContext context,
+                                                    void*                input,
+                                                    void*                output,
+                                                    int                  direction);
+
 /*! @brief Set multiple GPUs on a plan.
  *
  *  Instructs hipFFT to use multiple GPUs for a plan.
@@ -264,12 +754,287 @@ HIPFFT_EXPORT hipfftResult hipfftXtExec(hipfftHandle plan,
  */
 HIPFFT_EXPORT hipfftResult hipfftXtSetGPUs(hipfftHandle plan, int count, int* gpus);
 
+/*! @brief Set the work areas of a multi-device plan.
+ *
+ *  Gives a multi-device plan one work area on each of its devices,
+ *  instead of having the library allocate them.  The "MakePlan"
+ *  functions and ::hipfftGetSize write the size needed on each
+ *  device to their workSize array, in the order the devices were
+ *  given to ::hipfftXtSetGPUs.
+ *
+ *  Each area must be allocated on its device and be at least as
+ *  large as the size reported for it when this function is called.
+ *  A null area is allocated by the library.  The first device's
+ *  area is also set as the plan's work area, as with
+ *  ::hipfftSetWorkArea.
+ *
+ *  If ::hipfftExtXtSetPipelineChunks is later given more chunks,
+ *  execution returns ::HIPFFT_NO_WORKSPACE until work areas of the
+ *  newly reported sizes are set.
+ *
+ * @param[in] plan: multi-device plan handle, after the plan is made
+ * @param[in] workArea: one device pointer per device of the plan
+ */
+HIPFFT_EXPORT hipfftResult hipfftXtSetWorkArea(hipfftHandle plan, void** workArea);
+
+/*! @brief How data is divided among the devices of a multi-device plan */
+typedef enum hipfftExtDecomposition_t
+{
+    //! Each device gets the same share of the data
+    HIPFFT_DECOMPOSITION_EVEN = 0,
+    //! Each device's share is proportional to a user-supplied weight
+    HIPFFT_DECOMPOSITION_WEIGHTED = 1,
+    //! Each device's share is proportional to its throughput,
+    //! estimated from its compute units, clock rate and memory
+    //! bandwidth
+    HIPFFT_DECOMPOSITION_DEVICE_PROPERTIES = 2,
+} hipfftExtDecomposition;
+
+/*! @brief Set how a multi-device plan divides data among devices.
+ *
+ *  Must be called after ::hipfftXtSetGPUs and before the plan is
+ *  made.  Data is split along the same dimension with any policy;
+ *  only the size of each device's share changes.  Plans are split
+ *  evenly by default.
+ *
+ * @param[in] plan: plan handle
+ * @param[in] policy: how to size each device's share
+ * @param[in] weights: for ::HIPFFT_DECOMPOSITION_WEIGHTED, one
+ *  positive weight for each device passed to ::hipfftXtSetGPUs, in
+ *  the same order.  Ignored for other policies.
+ *
+ * @warning Experimental
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtXtSetDecomposition(hipfftHandle           plan,
+                                                       hipfftExtDecomposition policy,
+                                                       const double*          weights);
+
+/*! @brief How a multi-device plan's data is divided among devices.
+ *
+ *  Filled in by ::hipfftExtXtGetDecomposition.  A device's share of
+ *  the data is the fraction of the input or output elements in its
+ *  brick.
+ */
+typedef struct hipfftExtDecompositionInfo_t
+{
+    //! Number of devices the plan is split among
+    int nGPUs;
+    //! Device of each brick
+    int GPUs[MAX_HIP_DESCRIPTOR_GPUS];
+    //! Share of the data each device was meant to get, summing to 1
+    double weights[MAX_HIP_DESCRIPTOR_GPUS];
+    //! Share of throughput of each device, estimated from its
+    //! properties, summing to 1
+    double capability[MAX_HIP_DESCRIPTOR_GPUS];
+    //! Number of input elements on each device
+    size_t inputElements[MAX_HIP_DESCRIPTOR_GPUS];
+    //! Number of output elements on each device
+    size_t outputElements[MAX_HIP_DESCRIPTOR_GPUS];
+    //! Largest ratio of a device's share of the data to its weight.
+    //! 1 means the data is split exactly as intended.
+    double imbalance;
+    //! Largest ratio of a device's share of the data to its share of
+    //! throughput.  The device with the highest ratio is expected to
+    //! finish last.
+    double capabilityImbalance;
+} hipfftExtDecompositionInfo;
+
+/*! @brief Get how a multi-device plan's data is divided among devices.
+ *
+ * @param[in] plan: plan handle, after the plan is made
+ * @param[out] info: decomposition of the plan
+ *
+ * @warning Experimental
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtXtGetDecomposition(hipfftHandle                plan,
+                                                       hipfftExtDecompositionInfo* info);
+
+//! Most dimensions a ::hipfftExtBrick can have: the batch dimension,
+//! plus up to 3 FFT dimensions
+#define HIPFFT_EXT_MAX_BRICK_DIMS 4
+
+/*! @brief Part of a multi-device plan's input or output that lives on
+ *  one device.
+ *
+ *  Indexes and strides are given for the batch dimension first,
+ *  followed by the FFT dimensions in the same order as the lengths
+ *  passed to the "MakePlan" functions.  A plan of rank r uses the
+ *  first r + 1 entries of each array.
+ */
+typedef struct hipfftExtBrick_t
+{
+    //! First index of the brick in each dimension
+    long long int lower[HIPFFT_EXT_MAX_BRICK_DIMS];
+    //! One past the last index of the brick in each dimension
+    long long int upper[HIPFFT_EXT_MAX_BRICK_DIMS];
+    //! Distance in elements between consecutive indexes of each
+    //! dimension, in the brick's memory on its device
+    long long int stride[HIPFFT_EXT_MAX_BRICK_DIMS];
+} hipfftExtBrick;
+
+/*! @brief Set exactly which part of the data each device of a
+ *  multi-device plan holds.
+ *
+ *  Used instead of ::hipfftXtSetGPUs, after ::hipfftCreate and
+ *  before the plan is made, so that data already distributed among
+ *  devices can be transformed where it is.  When the plan is made,
+ *  the input bricks must exactly cover the plan's input (including
+ *  batch) without overlapping, and likewise for the output bricks.
+ *  Otherwise, making the plan fails with ::HIPFFT_INVALID_VALUE.
+ *
+ *  In-place transforms use the output bricks for both input and
+ *  output.  Buffers allocated with ::hipfftXtMalloc are sized for
+ *  the bricks' strides.
+ *
+ * @param[in] plan: plan handle
+ * @param[in] count: number of devices
+ * @param[in] gpus: device of each brick
+ * @param[in] inBricks: array of count input bricks, in the same order
+ *  as gpus
+ * @param[in] outBricks: array of count output bricks, in the same
+ *  order as gpus
+ *
+ * @warning Experimental
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtXtSetBricks(hipfftHandle          plan,
+                                                int                   count,
+                                                const int*            gpus,
+                                                const hipfftExtBrick* inBricks,
+                                                const hipfftExtBrick* outBricks);
+
+/*! @brief Split a multi-device 3D transform into pencils over a grid
+ *  of devices.
+ *
+ *  By default, multi-device plans split data into slabs along one
+ *  dimension, which limits a transform to as many devices as that
+ *  dimension has indexes.  A pencil decomposition splits two
+ *  dimensions over a rows x columns grid of devices instead.  Input
+ *  pencils span the last (fastest) FFT dimension, and output pencils
+ *  span the first.  The plan moves data between the two
+ *  decompositions as the transform requires.
+ *
+ *  Devices passed to ::hipfftXtSetGPUs fill the grid one row at a
+ *  time.  Grid rows split the first FFT dimension of the input and
+ *  the second of the output; grid columns split the second FFT
+ *  dimension of the input and the last of the output.  Must be
+ *  called after ::hipfftXtSetGPUs and before the plan is made.
+ *  Pencils are always split evenly, and making a plan that isn't 3D
+ *  or that has fewer indexes than the grid along a split dimension
+ *  fails with ::HIPFFT_INVALID_VALUE.
+ *
+ * @param[in] plan: plan handle
+ * @param[in] rows: number of rows in the device grid
+ * @param[in] columns: number of columns in the device grid.  rows
+ *  times columns must equal the number of devices.
+ *
+ * @warning Experimental
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtXtSetPencilGrid(hipfftHandle plan, int rows, int columns);
+
+/*! @brief Split the exchanges of a multi-device transform into chunks.
+ *
+ *  A multi-device transform computes FFTs along the dimensions that
+ *  each device holds in full, exchanges data between devices so
+ *  that each device holds the remaining dimension in full, computes
+ *  FFTs along that dimension, and exchanges the data back.  By
+ *  default each of these is a separate phase.  With chunks greater
+ *  than 1, each device's share is split into that many chunks, and
+ *  the exchange of one chunk overlaps the FFTs of the next.
+ *
+ *  Chunking applies to complex-to-complex, unbatched transforms of
+ *  rank 2 or more that are split into slabs, executed with the
+ *  hipfftXtExecDescriptor functions on ::HIPFFT_XT_FORMAT_INPUT and
+ *  ::HIPFFT_XT_FORMAT_OUTPUT descriptors or an
+ *  ::HIPFFT_XT_FORMAT_INPLACE descriptor.  Other transforms execute
+ *  as if chunks were 1.  Chunked transforms leave in-place data in
+ *  the natural layout, and use per-device streams and a buffer for
+ *  the exchanged data that the plan allocates when it's first
+ *  executed this way.  They also need a work area on each device,
+ *  which counts towards the per-device work sizes of the plan and
+ *  can be given with ::hipfftXtSetWorkArea.  Callbacks are not
+ *  supported.
+ *
+ *  Can be called before or after the plan is made.  Chunk plans are
+ *  created when the plan is made, or by this call if the plan was
+ *  already made.
+ *
+ * @param[in] plan: plan handle
+ * @param[in] chunks: number of chunks each device's data is split
+ *  into.  1 disables chunking, which is the default.
+ *
+ * @warning Experimental
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtXtSetPipelineChunks(hipfftHandle plan, int chunks);
+
+/*! @brief Kind of work done by a chunked multi-device transform. */
+typedef enum hipfftExtPipelineStage_t
+{
+    /// FFTs along the dimensions that each device holds in full
+    HIPFFT_PIPELINE_STAGE_FFT = 0,
+    /// Copies to the layout where each device holds the remaining
+    /// dimension in full
+    HIPFFT_PIPELINE_STAGE_EXCHANGE = 1,
+    /// FFTs along the remaining dimension
+    HIPFFT_PIPELINE_STAGE_FFT_LAST = 2,
+    /// Copies back to the plan's layout
+    HIPFFT_PIPELINE_STAGE_EXCHANGE_BACK = 3
+} hipfftExtPipelineStage;
+
+/*! @brief One piece of work done by a chunked multi-device transform.
+ *
+ *  Filled in by ::hipfftExtXtGetPipelineTrace.
+ */
+typedef struct hipfftExtPipelineEvent_t
+{
+    //! Device the work ran on.  Exchanges run on the device that
+    //! sends the data.
+    int device;
+    //! Chunk of the device's data that the work was for
+    int chunk;
+    //! Kind of work
+    hipfftExtPipelineStage stage;
+    //! Seconds from the start of the transform on the device to the
+    //! start of the work
+    double start;
+    //! Seconds from the start of the transform on the device to the
+    //! end of the work
+    double end;
+} hipfftExtPipelineEvent;
+
+/*! @brief Get a timeline of the plan's most recent chunked transform.
+ *
+ *  Waits for the transform to finish, then reports when each chunk's
+ *  FFTs and exchanges ran on each device.  If events is NULL, only
+ *  the number of events is returned.
+ *
+ * @param[in] plan: plan handle
+ * @param[in,out] count: on input, the number of events that fit in
+ *  events.  On output, the number of events in the timeline, which
+ *  is 0 if the plan has not executed a chunked transform.
+ * @param[out] events: timeline of the transform, or NULL.  At most
+ *  the input count of events are written.
+ * @param[out] overlap: if not NULL, the fraction of time spent in
+ *  exchanges that overlapped FFTs on the same device, from 0 to 1
+ *
+ * @warning Experimental
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtXtGetPipelineTrace(hipfftHandle            plan,
+                                                       int*                    count,
+                                                       hipfftExtPipelineEvent* events,
+                                                       double*                 overlap);
+
 typedef enum hipfftXtSubFormat_t
 {
-    HIPFFT_XT_FORMAT_INPUT             = 0x00,
-    HIPFFT_XT_FORMAT_OUTPUT            = 0x01,
-    HIPFFT_XT_FORMAT_INPLACE           = 0x02,
-    HIPFFT_XT_FORMAT_INPLACE_SHUFFLED  = 0x03,
+    /// Input of an out-of-place transform
+    HIPFFT_XT_FORMAT_INPUT = 0x00,
+    /// Output of an out-of-place transform
+    HIPFFT_XT_FORMAT_OUTPUT = 0x01,
+    /// Data of an in-place transform, in the plan's natural layout
+    HIPFFT_XT_FORMAT_INPLACE = 0x02,
+    /// Data of an in-place transform, in the layout that forward
+    /// complex-to-complex transforms leave it in
+    HIPFFT_XT_FORMAT_INPLACE_SHUFFLED = 0x03,
+    /// Input of an in-place 1D transform
     HIPFFT_XT_FORMAT_1D_INPUT_SHUFFLED = 0x04,
     HIPFFT_FORMAT_UNDEFINED            = 0x05
 } hipfftXtSubFormat;
@@ -282,7 +1047,12 @@ typedef enum hipfftXtSubFormat_t
  *  sizes allocated.
  *
  *  The subformat indicates whether the memory will be used for FFT
- *  input or output.
+ *  input or output.  Memory for ::HIPFFT_XT_FORMAT_INPLACE and
+ *  ::HIPFFT_XT_FORMAT_INPLACE_SHUFFLED data is sized for both
+ *  layouts, since transforms move the data between them.
+ *  ::HIPFFT_XT_FORMAT_1D_INPUT_SHUFFLED is only valid for 1D plans,
+ *  whose data is never shuffled between devices; it is laid out
+ *  like ::HIPFFT_XT_FORMAT_INPLACE.
  *
  *  The memory must be freed by calling ::hipfftXtFree.
  *
@@ -300,6 +1070,15 @@ HIPFFT_EXPORT hipfftResult hipfftXtMalloc(hipfftHandle      plan,
  *  - ::HIPFFT_COPY_DEVICE_TO_HOST: src points to a \ref hipLibXtDesc_t structure that describes multi-device memory layout.  dest points to a host memory buffer.
  *  - ::HIPFFT_COPY_DEVICE_TO_DEVICE: Both dest and src point to a \ref hipLibXtDesc_t structure that describes multi-device memory layout.  The two structures must describe memory with the same number of devices and memory sizes.
  *
+ *  Device to device copies between descriptors allocated for plan
+ *  input and output that are split differently among devices
+ *  redistribute the data with direct copies between devices.
+ *
+ *  Host memory is laid out as described by the plan's strides and
+ *  distance.  Layouts that cannot be copied to each device with a
+ *  single 1D, 2D or 3D copy are packed into a contiguous host
+ *  buffer first.
+ *
  * @warning Experimental
  */
 HIPFFT_EXPORT hipfftResult hipfftXtMemcpy(hipfftHandle     plan,
@@ -307,6 +1086,113 @@ HIPFFT_EXPORT hipfftResult hipfftXtMemcpy(hipfftHandle     plan,
                                           void*            src,
                                           hipfftXtCopyType type);
 
+/*! @brief Asynchronously copy data to/from \ref hipLibXtDesc_t descriptors.
+ *
+ *  Like ::hipfftXtMemcpy, but the copies to or from each device are
+ *  enqueued on a stream per device, so that all devices transfer
+ *  data at the same time, and the function returns once all copies
+ *  are enqueued.
+ *
+ *  The copies start after work already enqueued on the given stream,
+ *  and work enqueued on the stream afterwards waits for all of them
+ *  to finish.  The stream must belong to the current device.  Host
+ *  memory must be pinned for the copies to run asynchronously to
+ *  the host, and layouts that need packing are always copied
+ *  synchronously.
+ *
+ * @warning Experimental
+ */
+HIPFFT_EXPORT hipfftResult hipfftXtMemcpyAsync(hipfftHandle     plan,
+                                               void*            dest,
+                                               void*            src,
+                                               hipfftXtCopyType type,
+                                               hipStream_t      stream);
+
+/*! @brief Redistribute data between the multi-device layouts of two plans.
+ *
+ *  Copies the field in src, allocated by ::hipfftXtMalloc for
+ *  srcPlan, to dest, allocated for destPlan, so that the output of
+ *  one plan can be the input of another plan that splits data
+ *  among devices differently.  Both descriptors must describe the
+ *  same field with elements of the same size.  A field with fewer
+ *  dimensions is treated as having extra dimensions of length 1.
+ *
+ *  Each region where a source brick overlaps a destination brick
+ *  is copied directly between the two devices, and copies for all
+ *  regions run at the same time.  The function returns once all
+ *  copies are finished.
+ *
+ * @param[in] destPlan: plan that dest was allocated for
+ * @param[out] dest: destination descriptor
+ * @param[in] srcPlan: plan that src was allocated for
+ * @param[in] src: source descriptor
+ *
+ * @warning Experimental
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtXtRedistribute(hipfftHandle  destPlan,
+                                                   hipLibXtDesc* dest,
+                                                   hipfftHandle  srcPlan,
+                                                   hipLibXtDesc* src);
+
+/*! @brief Statistics about copies staged through pinned host memory.
+ *
+ *  Filled in by ::hipfftExtGetStagingStats.  Byte counts and times
+ *  accumulate over the life of the library.
+ */
+typedef struct hipfftExtStagingStats_t
+{
+    //! Maximum bytes of pinned memory used for staging
+    size_t poolBytes;
+    //! Bytes in each staging buffer
+    size_t chunkBytes;
+    //! Bytes of pinned memory currently allocated for staging
+    size_t allocatedBytes;
+    //! Bytes staged from host to device
+    size_t hostToDeviceBytes;
+    //! Time spent in host to device staged copies
+    double hostToDeviceSeconds;
+    //! Bytes staged from device to host
+    size_t deviceToHostBytes;
+    //! Time spent in device to host staged copies
+    double deviceToHostSeconds;
+    //! Number of staging buffers filled or drained
+    size_t chunks;
+    //! Number of times a copy waited for a free staging buffer
+    size_t waits;
+} hipfftExtStagingStats;
+
+/*! @brief Configure staging of ::hipfftXtMemcpy copies.
+ *
+ *  ::hipfftXtMemcpy copies between pageable host memory and devices
+ *  through page-locked staging buffers, so that packing one buffer
+ *  overlaps with DMA to or from another.  Pinned host memory is
+ *  copied directly.
+ *
+ *  Buffers are allocated on first use, and at most poolBytes of
+ *  pinned memory is allocated in buffers of chunkBytes each.  Idle
+ *  buffers are freed by this call.  Passing 0 for either size
+ *  disables staging.
+ *
+ *  The defaults are 32 MiB in 4 MiB buffers, and can be overridden
+ *  with the HIPFFT_STAGING_POOL_SIZE and HIPFFT_STAGING_CHUNK_SIZE
+ *  environment variables, which take a size in bytes.  Values that
+ *  aren't a non-negative integer are ignored.
+ *
+ * @param[in] poolBytes: maximum bytes of pinned memory to allocate
+ * @param[in] chunkBytes: bytes in each staging buffer
+ *
+ * @warning Experimental
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtSetStagingPool(size_t poolBytes, size_t chunkBytes);
+
+/*! @brief Get statistics about staged ::hipfftXtMemcpy copies.
+ *
+ * @param[out] stats: current staging configuration and throughput
+ *
+ * @warning Experimental
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtGetStagingStats(hipfftExtStagingStats* stats);
+
 /*! @brief Free memory allocated by \ref hipfftXtMalloc.
  *
  * @warning Experimental
@@ -319,6 +1205,18 @@ HIPFFT_EXPORT hipfftResult hipfftXtFree(hipLibXtDesc* desc);
  *  outputs are pointers to \ref hipLibXtDesc_t descriptors.
  *  In-place transforms are performed by passing the same pointer for
  *  input and output.
+ *
+ *  Multi-device in-place complex-to-complex transforms can skip the
+ *  final exchange of data between devices.  A forward transform of
+ *  ::HIPFFT_XT_FORMAT_INPLACE data leaves it in
+ *  ::HIPFFT_XT_FORMAT_INPLACE_SHUFFLED layout, and an inverse
+ *  transform of shuffled data returns it to
+ *  ::HIPFFT_XT_FORMAT_INPLACE layout.  The descriptor's subFormat is
+ *  updated to match, so ::hipfftXtMemcpy copies the data correctly
+ *  in either layout.  Forward or out-of-place transforms of shuffled
+ *  data fail with ::HIPFFT_INVALID_VALUE.  Plans whose data can't be
+ *  shuffled, such as batched or 1D plans, leave data in the natural
+ *  layout.
  * 
  * @warning Experimental
  */
@@ -20,16 +20,45 @@
 
 #include "hipfft/hipfft.h"
 #include "../../../shared/hipfft_brick.h"
+#include "../../../shared/hipfft_ops.h"
 #include "hipfft/hipfftXt.h"
 #include "rocfft/rocfft.h"
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <limits>
+#include <list>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <set>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
 #include <vector>
 
+#include <hip/hiprtc.h>
+
 #include "../../../shared/arithmetic.h"
+#include "../../../shared/concurrency.h"
+#include "../../../shared/environment.h"
 #include "../../../shared/gpubuf.h"
+#include "../../../shared/hip_object_wrapper.h"
 #include "../../../shared/ptrdiff.h"
 #include "../../../shared/rocfft_hip.h"
 
@@ -56,10 +85,14 @@
         auto code = ret;              \
         if(code != HIPFFT_SUCCESS)    \
         {                             \
-            return ret;               \
+            return code;              \
         }                             \
     }
 
+// number of rocFFT plans created by the library, reported with the
+// plan cache statistics
+static std::atomic<size_t> rocfft_plans_created(0);
+
 // check plan creation - some might fail for specific placement, so
 // maintain a count of how many got created, and clean up the plans
 // if some failed.
@@ -69,6 +102,7 @@ void ROC_FFT_CHECK_PLAN_CREATE(rocfft_plan& plan, unsigned int& plans_created, P
     if(rocfft_plan_create(&plan, std::forward<Params>(params)...) == rocfft_status_success)
     {
         ++plans_created;
+        ++rocfft_plans_created;
     }
     else
     {
@@ -81,6 +115,8 @@ struct hipfftIOType
 {
     hipDataType inputType  = HIP_C_32F;
     hipDataType outputType = HIP_C_32F;
+    // complex type that the transform is computed in
+    hipDataType execType = HIP_C_32F;
 
     hipfftIOType() = default;
 
@@ -116,6 +152,7 @@ struct hipfftIOType
         default:
             return HIPFFT_NOT_IMPLEMENTED;
         }
+        execType = storage_type(inputType) == storage_double ? HIP_C_64F : HIP_C_32F;
         return HIPFFT_SUCCESS;
     }
 
@@ -126,16 +163,44 @@ struct hipfftIOType
         //
         // complex input could have complex or real output of same precision.
         // exec type must be complex, same precision
+        //
+        // single-precision transforms can also load narrower types,
+        // converting them to single precision as they're loaded, and
+        // store half or bfloat16 output, converting it as it's stored
+        if(exec == HIP_C_32F)
+        {
+            const auto in_storage  = storage_type(input);
+            const auto out_storage = storage_type(output);
+            if(in_storage == storage_unknown)
+                return HIPFFT_NOT_IMPLEMENTED;
+            if(in_storage == storage_double || out_storage == storage_unknown
+               || out_storage == storage_integer || out_storage == storage_double)
+                return HIPFFT_INVALID_VALUE;
+            // at least one side of the transform is complex
+            if(is_real_type(input) && is_real_type(output))
+                return HIPFFT_INVALID_VALUE;
+
+            inputType  = input;
+            outputType = output;
+            execType   = exec;
+            return HIPFFT_SUCCESS;
+        }
+
         switch(input)
         {
+        case HIP_R_8I:
+        case HIP_R_16I:
+        case HIP_C_8I:
+        case HIP_C_16I:
+        case HIP_R_16BF:
+        case HIP_C_16BF:
+        case HIP_R_32F:
+        case HIP_C_32F:
+            return HIPFFT_INVALID_VALUE;
         case HIP_R_16F:
             if(output != HIP_C_16F || exec != HIP_C_16F)
                 return HIPFFT_INVALID_VALUE;
             break;
-        case HIP_R_32F:
-            if(output != HIP_C_32F || exec != HIP_C_32F)
-                return HIPFFT_INVALID_VALUE;
-            break;
         case HIP_R_64F:
             if(output != HIP_C_64F || exec != HIP_C_64F)
                 return HIPFFT_INVALID_VALUE;
@@ -144,10 +209,6 @@ struct hipfftIOType
             if((output != HIP_C_16F && output != HIP_R_16F) || exec != HIP_C_16F)
                 return HIPFFT_INVALID_VALUE;
             break;
-        case HIP_C_32F:
-            if((output != HIP_C_32F && output != HIP_R_32F) || exec != HIP_C_32F)
-                return HIPFFT_INVALID_VALUE;
-            break;
         case HIP_C_64F:
             if((output != HIP_C_64F && output != HIP_R_64F) || exec != HIP_C_64F)
                 return HIPFFT_INVALID_VALUE;
@@ -158,20 +219,18 @@ struct hipfftIOType
 
         inputType  = input;
         outputType = output;
+        execType   = exec;
         return HIPFFT_SUCCESS;
     }
 
     rocfft_precision precision()
     {
-        switch(inputType)
+        switch(execType)
         {
-        case HIP_R_16F:
         case HIP_C_16F:
             return rocfft_precision_half;
         case HIP_C_32F:
-        case HIP_R_32F:
             return rocfft_precision_single;
-        case HIP_R_64F:
         case HIP_C_64F:
             return rocfft_precision_double;
         default:
@@ -181,43 +240,93 @@ struct hipfftIOType
 
     bool is_real_to_complex()
     {
-        switch(inputType)
+        if(storage_type(inputType) == storage_unknown)
+            throw HIPFFT_NOT_IMPLEMENTED;
+        return is_real_type(inputType);
+    }
+
+    bool is_complex_to_real()
+    {
+        if(storage_type(outputType) == storage_unknown)
+            throw HIPFFT_NOT_IMPLEMENTED;
+        return is_real_type(outputType);
+    }
+
+    bool is_complex_to_complex()
+    {
+        return !is_complex_to_real() && !is_real_to_complex();
+    }
+
+    // true if input is converted to the exec precision as it's loaded
+    bool converts_input()
+    {
+        return storage_type(inputType) != storage_type(execType);
+    }
+
+    // true if output is converted from the exec precision as it's stored
+    bool converts_output()
+    {
+        return storage_type(outputType) != storage_type(execType);
+    }
+
+    bool converts()
+    {
+        return converts_input() || converts_output();
+    }
+
+    // kinds of element storage
+    enum storage_kind
+    {
+        storage_unknown,
+        storage_integer,
+        storage_half,
+        storage_bfloat16,
+        storage_single,
+        storage_double,
+    };
+
+    static storage_kind storage_type(hipDataType t)
+    {
+        switch(t)
         {
+        case HIP_R_8I:
+        case HIP_C_8I:
+        case HIP_R_16I:
+        case HIP_C_16I:
+            return storage_integer;
         case HIP_R_16F:
-        case HIP_R_32F:
-        case HIP_R_64F:
-            return true;
         case HIP_C_16F:
+            return storage_half;
+        case HIP_R_16BF:
+        case HIP_C_16BF:
+            return storage_bfloat16;
+        case HIP_R_32F:
         case HIP_C_32F:
+            return storage_single;
+        case HIP_R_64F:
         case HIP_C_64F:
-            return false;
+            return storage_double;
         default:
-            throw HIPFFT_NOT_IMPLEMENTED;
+            return storage_unknown;
         }
     }
 
-    bool is_complex_to_real()
+    static bool is_real_type(hipDataType t)
     {
-        switch(outputType)
+        switch(t)
         {
+        case HIP_R_8I:
+        case HIP_R_16I:
         case HIP_R_16F:
+        case HIP_R_16BF:
         case HIP_R_32F:
         case HIP_R_64F:
             return true;
-        case HIP_C_16F:
-        case HIP_C_32F:
-        case HIP_C_64F:
-            return false;
         default:
-            throw HIPFFT_NOT_IMPLEMENTED;
+            return false;
         }
     }
 
-    bool is_complex_to_complex()
-    {
-        return !is_complex_to_real() && !is_real_to_complex();
-    }
-
     static bool is_forward(rocfft_transform_type type)
     {
         switch(type)
@@ -250,6 +359,118 @@ struct hipfftIOType
     }
 };
 
+// asynchronous copies to and from one device of a multi-device
+// plan are issued on a stream of their own, which waits for the
+// start event on the caller's stream and records its done event
+// when its copies are enqueued.  Staged copies record an event for
+// each staging buffer, to know when the buffer can be reused.
+static hipError_t create_copy_stream(hipStream_t* stream)
+{
+    return hipStreamCreateWithFlags(stream, hipStreamNonBlocking);
+}
+static hipError_t create_copy_event(hipEvent_t* event)
+{
+    return hipEventCreateWithFlags(event, hipEventDisableTiming);
+}
+struct hipfft_copy_stream
+{
+    hip_object_wrapper_t<hipStream_t, create_copy_stream, hipStreamDestroy> stream;
+    hip_object_wrapper_t<hipEvent_t, create_copy_event, hipEventDestroy>    start;
+    hip_object_wrapper_t<hipEvent_t, create_copy_event, hipEventDestroy>    done;
+    hip_object_wrapper_t<hipEvent_t, create_copy_event, hipEventDestroy>    staged[2];
+};
+
+// state for chunked execution of a multi-device transform on one
+// device.  FFTs run on the device's own stream, and exchanges on its
+// copy stream.  Everything is allocated on first use.
+struct hipfft_pipeline_device
+{
+    int device = 0;
+
+    hip_object_wrapper_t<hipStream_t, create_copy_stream, hipStreamDestroy> stream;
+    rocfft_execution_info                                                   info = nullptr;
+
+    // the device's share of the data in the exchanged layout
+    void*  exchanged      = nullptr;
+    size_t exchangedBytes = 0;
+
+    // work area bound to info, which is either allocated by the
+    // library or given to hipfftXtSetWorkArea.  workSize is what the
+    // device's plans need, which can be more than the bound area
+    // until the next transform binds a bigger one.
+    void*  workBuffer          = nullptr;
+    size_t workBufferSize      = 0;
+    bool   workBufferNeedsFree = false;
+    size_t workSize            = 0;
+
+    // timing events for the most recent transform: begin marks the
+    // start of the transform on the device, and each piece of work
+    // records a pair of events from the pool
+    hipEvent_wrapper_t              begin;
+    std::vector<hipEvent_wrapper_t> events;
+};
+
+// one piece of work in the timeline of a chunked transform.  Times
+// are measured from the device's begin event.
+struct hipfft_pipeline_span
+{
+    int                    device;
+    int                    chunk;
+    hipfftExtPipelineStage stage;
+    hipEvent_t             begin;
+    hipEvent_t             start;
+    hipEvent_t             end;
+};
+
+// chunked multi-device execution, set by hipfftExtXtSetPipelineChunks
+struct hipfft_pipeline
+{
+    size_t chunks = 1;
+
+    // one per brick of the plan
+    std::vector<hipfft_pipeline_device> devices;
+
+    // single-device rocFFT plans for the FFT stages, owned by the
+    // plan cache.  Keyed by brick, stage, placement, direction,
+    // batch and stride.
+    std::map<std::vector<size_t>, rocfft_plan> plans;
+
+    // timeline of the most recent chunked transform
+    std::vector<hipfft_pipeline_span> trace;
+};
+
+// outcome of making a plan with hipfftExtMakePlanManyAsync
+struct hipfft_async_plan
+{
+    hipfftResult status = HIPFFT_SUCCESS;
+    // one size per device for multi-device plans
+    std::vector<size_t> workSize;
+};
+
+// a built-in op set with hipfftExtSetLoadOp or hipfftExtSetStoreOp
+struct hipfft_op
+{
+    // the op and its parameter, as they were set
+    hipfftExtOp op    = HIPFFT_OP_NONE;
+    double      param = 0.0;
+
+    // device address of the callback that applies the op, and a
+    // device copy of its parameters that's passed as callback data
+    void* function = nullptr;
+    void* params   = nullptr;
+
+    // ops that rocFFT can't apply as it loads or stores data run as
+    // a separate pass of this kernel instead, through a buffer that
+    // rocFFT reads its input from or writes its output to
+    hipFunction_t kernel = nullptr;
+    void*         buffer = nullptr;
+};
+
+struct hipfftExtPlanToken_t
+{
+    std::shared_future<hipfft_async_plan> result;
+};
+
 struct hipfftHandle_t
 {
     hipfftIOType type;
@@ -266,6 +487,13 @@ struct hipfftHandle_t
     bool                  autoAllocate        = true;
     bool                  workBufferNeedsFree = false;
 
+    // largest work size reported for the handle, when its plan was
+    // made or by hipfftGetSize*.  A work area given to
+    // hipfftSetWorkArea is assumed to be at least this large, and
+    // lazily created plans are checked against its size.
+    size_t reportedWorkSize = 0;
+    size_t userWorkAreaSize = 0;
+
     void** load_callback_ptrs       = nullptr;
     void** load_callback_data       = nullptr;
     size_t load_callback_lds_bytes  = 0;
@@ -284,9 +512,126 @@ struct hipfftHandle_t
 
     double scale_factor = 1.0;
 
+    // if true, rocFFT plans are only created the first time the
+    // handle is executed with a given placement and direction
+    bool lazy_create = false;
+
+    // set on the temporary handles that estimate work sizes.  Making
+    // a plan on such a handle only records the transform's
+    // dimensions, layout and bricks.
+    bool estimate_only = false;
+
+    // logical FFT lengths, as passed to rocfft_plan_create
+    std::vector<size_t> lengths;
+
+    // data layout requested when the plan was made (array types,
+    // strides and distances, before any recalculation).  Along with
+    // the lengths, types and bricks, this determines the rocFFT plan
+    // descriptions, so it's part of the plan cache key.
+    std::vector<size_t> layout;
+
+    // plan descriptions for each of the rocFFT plans above.  These
+    // are kept until the corresponding plan has been created, which
+    // is at exec time when plan creation is lazy.
+    rocfft_plan_description ip_forward_desc = nullptr;
+    rocfft_plan_description op_forward_desc = nullptr;
+    rocfft_plan_description ip_inverse_desc = nullptr;
+    rocfft_plan_description op_inverse_desc = nullptr;
+
     // brick decomposition for multi-device transforms
     std::vector<hipfft_brick> inBricks;
     std::vector<hipfft_brick> outBricks;
+
+    // how the bricks divide the data.  Weights are user-supplied
+    // before the plan is made, and are the weights that were used
+    // once it's made.  No weights means an even split.
+    hipfftExtDecomposition decomposition = HIPFFT_DECOMPOSITION_EVEN;
+    std::vector<double>    brickWeights;
+
+    // bricks given to hipfftExtXtSetBricks, in the user's order.  If
+    // present, these replace the decomposition above.
+    std::vector<hipfftExtBrick> inUserBricks;
+    std::vector<hipfftExtBrick> outUserBricks;
+
+    // rows x columns of the device grid for a pencil decomposition.
+    // No rows means the data is split into slabs.
+    size_t pencilRows    = 0;
+    size_t pencilColumns = 0;
+
+    // layout that in-place multi-device transforms leave data in
+    // when they skip their last global transpose, if the transform
+    // has one (HIPFFT_XT_FORMAT_INPLACE_SHUFFLED).  Forward in-place
+    // transforms of descriptors end in this layout, and inverse ones
+    // start from it.  These plans are created the first time they're
+    // needed.
+    std::vector<hipfft_brick> shuffledBricks;
+    rocfft_plan               ip_forward_shuffled = nullptr;
+    rocfft_plan               ip_inverse_shuffled = nullptr;
+
+    hipStream_t stream = nullptr;
+
+    // where an auto-allocated work buffer comes from.  With a shared
+    // policy, workBuffer points into the arena for workAreaKey while
+    // the handle is bound to it.
+    hipfftExtWorkAreaPolicy     workAreaPolicy = HIPFFT_WORKAREA_PER_PLAN;
+    bool                        workAreaBound  = false;
+    std::pair<int, hipStream_t> workAreaKey;
+
+    // when the handle was last executed, to find idle work areas
+    std::chrono::steady_clock::time_point lastExec;
+
+    // held while executing, so that other threads can't trim the
+    // work area out from under a transform being launched
+    std::mutex mutex;
+
+    // valid if the plan was made with hipfftExtMakePlanManyAsync.
+    // Until it's ready, the planning thread owns the rest of the
+    // handle.
+    std::shared_future<hipfft_async_plan> pending;
+    hipfftExtNotReadyPolicy               notReadyPolicy = HIPFFT_NOT_READY_WAIT;
+
+    // per-device streams for hipfftXtMemcpyAsync, created on first use
+    std::map<int, hipfft_copy_stream> copyStreams;
+
+    hipfft_pipeline pipeline;
+
+    // work areas given to hipfftXtSetWorkArea, and the sizes that
+    // were reported for them.  A null area is allocated by the
+    // library.
+    std::vector<void*>  xtWorkAreas;
+    std::vector<size_t> xtWorkAreaSizes;
+
+    // ops set with hipfftExtSetLoadOp and hipfftExtSetStoreOp.  The
+    // callback pointers given to rocFFT point into these.
+    hipfft_op loadOp;
+    hipfft_op storeOp;
+};
+
+// true if the plan is still being made on another thread
+static bool plan_pending(hipfftHandle plan)
+{
+    return plan->pending.valid()
+           && plan->pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+}
+
+// wait for a plan being made on another thread to be ready
+static void wait_for_plan(hipfftHandle plan)
+{
+    if(plan->pending.valid())
+        plan->pending.wait();
+}
+
+// All live handles, so that memory can be trimmed process-wide
+struct hipfft_live_handles
+{
+    static hipfft_live_handles& get()
+    {
+        static hipfft_live_handles live;
+        return live;
+    }
+
+    std::mutex             mutex;
+    std::set<hipfftHandle> handles;
 };
 
 struct hipfft_plan_description_t
@@ -309,6 +654,341 @@ struct hipfft_plan_description_t
     }
 };
 
+// Everything that determines a rocFFT plan.  Handles whose keys
+// compare equal can share the same rocfft_plan.
+struct hipfft_plan_key
+{
+    int                     device;
+    rocfft_result_placement placement;
+    rocfft_transform_type   transform_type;
+    rocfft_precision        precision;
+    hipDataType             inputType;
+    hipDataType             outputType;
+    std::vector<size_t>     lengths;
+    size_t                  batch;
+    double                  scale_factor;
+    std::vector<size_t>     layout;
+    // flattened device + lower + upper + stride of each in/out brick
+    std::vector<size_t> bricks;
+
+    bool operator<(const hipfft_plan_key& other) const
+    {
+        return std::tie(device,
+                        placement,
+                        transform_type,
+                        precision,
+                        inputType,
+                        outputType,
+                        lengths,
+                        batch,
+                        scale_factor,
+                        layout,
+                        bricks)
+               < std::tie(other.device,
+                          other.placement,
+                          other.transform_type,
+                          other.precision,
+                          other.inputType,
+                          other.outputType,
+                          other.lengths,
+                          other.batch,
+                          other.scale_factor,
+                          other.layout,
+                          other.bricks);
+    }
+};
+
+// read a size from an environment variable.  Values that aren't a
+// plain non-negative number are ignored, leaving the default.
+static void getenv_size(const char* var, size_t& value)
+{
+    auto env = rocfft_getenv(var);
+    if(env.empty() || !std::isdigit(static_cast<unsigned char>(env[0])))
+        return;
+    char*      end    = nullptr;
+    errno             = 0;
+    const auto parsed = std::strtoull(env.c_str(), &end, 10);
+    if(errno == ERANGE || *end != '\0')
+        return;
+    value = parsed;
+}
+
+// Process-wide cache of rocFFT plans.  Plans are reference-counted
+// so that identical handles share them.  Plans that are no longer
+// referenced by any handle are kept until the cache holds more than
+// HIPFFT_PLAN_CACHE_SIZE plans, and are then evicted in
+// least-recently-used order.
+class hipfft_plan_cache
+{
+public:
+    static hipfft_plan_cache& get()
+    {
+        static hipfft_plan_cache cache;
+        return cache;
+    }
+
+    // return a cached plan for the key, or call create to make one.
+    // Returns nullptr if the plan could not be created.
+    rocfft_plan acquire(const hipfft_plan_key& key, const std::function<rocfft_plan()>& create)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto                        found = entries.find(key);
+            if(found != entries.end())
+            {
+                ++hits;
+                add_ref(found);
+                return found->second.plan;
+            }
+            ++misses;
+        }
+
+        // create outside the lock, plan creation can be slow
+        rocfft_plan created = create();
+        if(!created)
+            return nullptr;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        // another thread might have created the same plan meanwhile
+        auto found = entries.find(key);
+        if(found != entries.end())
+        {
+            rocfft_plan_destroy(created);
+            add_ref(found);
+            return found->second.plan;
+        }
+        evict(capacity ? capacity - 1 : 0);
+        auto inserted = entries.emplace(key, entry{created, 1, idle.end()}).first;
+        by_plan.emplace(created, inserted);
+        return created;
+    }
+
+    // look up the work buffer size of a cached plan, without
+    // creating the plan or counting a hit or miss.  Returns false if
+    // no plan for the key is cached.
+    bool find_work_size(const hipfft_plan_key& key, size_t& workSize)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto                        found = entries.find(key);
+        if(found == entries.end())
+            return false;
+        return rocfft_plan_get_work_buffer_size(found->second.plan, &workSize)
+               == rocfft_status_success;
+    }
+
+    // drop a reference to a plan returned by acquire
+    void release(rocfft_plan plan)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto                        found = by_plan.find(plan);
+        if(found == by_plan.end())
+            return;
+        auto it = found->second;
+        if(--it->second.refcount == 0)
+        {
+            idle.push_back(it);
+            it->second.idle_pos = std::prev(idle.end());
+            evict(capacity);
+        }
+    }
+
+    void get_stats(hipfftExtPlanCacheStats& stats)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.hits        = hits;
+        stats.misses      = misses;
+        stats.evictions   = evictions;
+        stats.entries     = entries.size();
+        stats.idleEntries = idle.size();
+        stats.capacity    = capacity;
+        stats.created     = rocfft_plans_created;
+    }
+
+    // destroy all unreferenced plans and reset counters
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        evict(0);
+        hits                 = 0;
+        misses               = 0;
+        evictions            = 0;
+        rocfft_plans_created = 0;
+    }
+
+    hipfft_plan_cache(const hipfft_plan_cache&) = delete;
+    hipfft_plan_cache& operator=(const hipfft_plan_cache&) = delete;
+
+private:
+    struct entry;
+    typedef std::map<hipfft_plan_key, entry>::iterator entry_iterator;
+    struct entry
+    {
+        rocfft_plan                         plan;
+        size_t                              refcount;
+        std::list<entry_iterator>::iterator idle_pos;
+    };
+
+    hipfft_plan_cache()
+    {
+        getenv_size("HIPFFT_PLAN_CACHE_SIZE", capacity);
+    }
+    ~hipfft_plan_cache()
+    {
+        // plans still referenced by handles belong to those handles
+        evict(0);
+    }
+
+    void add_ref(entry_iterator it)
+    {
+        if(it->second.refcount++ == 0)
+        {
+            idle.erase(it->second.idle_pos);
+            it->second.idle_pos = idle.end();
+        }
+    }
+
+    // destroy least-recently-used idle plans until at most
+    // max_entries plans are cached, or no idle plans remain
+    void evict(size_t max_entries)
+    {
+        while(entries.size() > max_entries && !idle.empty())
+        {
+            auto it = idle.front();
+            idle.pop_front();
+            rocfft_plan_destroy(it->second.plan);
+            by_plan.erase(it->second.plan);
+            entries.erase(it);
+            ++evictions;
+        }
+    }
+
+    std::mutex                            mutex;
+    std::map<hipfft_plan_key, entry>      entries;
+    std::map<rocfft_plan, entry_iterator> by_plan;
+    // idle plans, least recently used first
+    std::list<entry_iterator> idle;
+
+    size_t capacity  = 0;
+    size_t hits      = 0;
+    size_t misses    = 0;
+    size_t evictions = 0;
+};
+
+// Work buffers shared by handles that execute on the same device and
+// stream.  Work on a stream is serialized, so those handles never use
+// their work buffers at the same time, and one buffer that's as large
+// as the largest requirement can serve all of them.
+class hipfft_work_area_arena
+{
+public:
+    typedef std::pair<int, hipStream_t> arena_key;
+
+    static hipfft_work_area_arena& get()
+    {
+        static hipfft_work_area_arena arena;
+        return arena;
+    }
+
+    // add a reference to the arena for the key, creating it if needed
+    void bind(const arena_key& key)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++arenas[key].refcount;
+        ++handles;
+    }
+
+    // drop a reference to an arena, and free its buffer when it's no
+    // longer referenced by any handle
+    void release(const arena_key& key)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto                        found = arenas.find(key);
+        if(found == arenas.end())
+            return;
+        --handles;
+        if(--found->second.refcount == 0)
+        {
+            free_buffer(found->second);
+            arenas.erase(found);
+        }
+    }
+
+    // return the arena's buffer, after growing it to at least size
+    // bytes.  Throws HIPFFT_ALLOC_FAILED if the buffer can't be grown.
+    void* reserve(const arena_key& key, size_t size)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto&                       a = arenas[key];
+        if(a.size < size)
+        {
+            // hipFree waits for outstanding work on the device, so
+            // transforms queued with the old buffer are finished
+            free_buffer(a);
+            if(hipMalloc(&a.buffer, size) != hipSuccess)
+            {
+                a.buffer = nullptr;
+                throw HIPFFT_ALLOC_FAILED;
+            }
+            a.size = size;
+            bytes += size;
+            total_bytes += size;
+            peak_bytes = std::max(peak_bytes, bytes);
+        }
+        return a.buffer;
+    }
+
+    void get_stats(hipfftExtWorkAreaStats& stats)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.arenas     = arenas.size();
+        stats.handles    = handles;
+        stats.bytes      = bytes;
+        stats.peakBytes  = peak_bytes;
+        stats.totalBytes = total_bytes;
+    }
+
+    hipfft_work_area_arena(const hipfft_work_area_arena&) = delete;
+    hipfft_work_area_arena& operator=(const hipfft_work_area_arena&) = delete;
+
+private:
+    struct arena
+    {
+        void*  buffer   = nullptr;
+        size_t size     = 0;
+        size_t refcount = 0;
+    };
+
+    hipfft_work_area_arena() = default;
+
+    void free_buffer(arena& a)
+    {
+        if(a.buffer)
+        {
+            (void)hipFree(a.buffer);
+            bytes -= a.size;
+        }
+        a.buffer = nullptr;
+        a.size   = 0;
+    }
+
+    std::mutex                 mutex;
+    std::map<arena_key, arena> arenas;
+    size_t                     handles     = 0;
+    size_t                     bytes       = 0;
+    size_t                     peak_bytes  = 0;
+    size_t                     total_bytes = 0;
+};
+
+// stop using a shared work area
+static void unbind_work_area(hipfftHandle plan)
+{
+    if(!plan->workAreaBound)
+        return;
+    hipfft_work_area_arena::get().release(plan->workAreaKey);
+    plan->workAreaBound = false;
+    plan->workBuffer    = nullptr;
+}
+
 hipfftResult hipfftPlan1d(hipfftHandle* plan, int nx, hipfftType type, int batch)
 try
 {
@@ -423,56 +1103,647 @@ catch(...)
     return HIPFFT_INTERNAL_ERROR;
 }
 
-hipfftResult hipfftMakePlan_internal(hipfftHandle               plan,
-                                     size_t                     dim,
-                                     size_t*                    lengths,
-                                     hipfftIOType               iotype,
-                                     size_t                     number_of_transforms,
-                                     hipfft_plan_description_t* desc,
-                                     size_t*                    workSize,
-                                     bool                       re_calc_strides_in_desc)
+// create a rocFFT field made of the given bricks
+static rocfft_field create_field(const std::vector<hipfft_brick>& bricks)
 {
-    // magic static to handle rocfft setup/cleanup
-    struct rocfft_initializer
+    rocfft_field field = nullptr;
+    if(rocfft_field_create(&field) != rocfft_status_success)
+        throw std::runtime_error("field create failed");
+
+    for(const auto& brick : bricks)
     {
-        rocfft_initializer()
+        rocfft_brick rbrick = nullptr;
+        if(rocfft_brick_create(&rbrick,
+                               brick.field_lower.data(),
+                               brick.field_upper.data(),
+                               brick.brick_stride.data(),
+                               brick.field_lower.size(),
+                               brick.device)
+           != rocfft_status_success)
         {
-            rocfft_setup();
+            (void)rocfft_field_destroy(field);
+            throw std::runtime_error("create brick failed");
         }
-        ~rocfft_initializer()
+
+        const auto added = rocfft_field_add_brick(field, rbrick);
+        rocfft_brick_destroy(rbrick);
+        if(added != rocfft_status_success)
         {
-            rocfft_cleanup();
+            (void)rocfft_field_destroy(field);
+            throw std::runtime_error("add brick failed");
         }
-    };
-    static rocfft_initializer init;
-
-    rocfft_plan_description ip_forward_desc = nullptr;
-    rocfft_plan_description op_forward_desc = nullptr;
-    rocfft_plan_description ip_inverse_desc = nullptr;
-    rocfft_plan_description op_inverse_desc = nullptr;
-    rocfft_plan_description_create(&ip_forward_desc);
-    rocfft_plan_description_create(&op_forward_desc);
-    rocfft_plan_description_create(&ip_inverse_desc);
-    rocfft_plan_description_create(&op_inverse_desc);
-
-    std::copy_n(lengths, dim, std::back_inserter(plan->inLength));
-    std::copy_n(lengths, dim, std::back_inserter(plan->outLength));
-
-    if(iotype.is_real_to_complex())
-        plan->outLength.front() = plan->outLength.front() / 2 + 1;
-    else if(iotype.is_complex_to_real())
-        plan->inLength.front() = plan->inLength.front() / 2 + 1;
-    plan->batch = number_of_transforms;
+    }
+    return field;
+}
 
-    if(desc != nullptr)
+// destroy the plan descriptions for one direction of the plan
+static void destroy_plan_descs(hipfftHandle plan, bool forward)
+{
+    auto& ip_desc = forward ? plan->ip_forward_desc : plan->ip_inverse_desc;
+    auto& op_desc = forward ? plan->op_forward_desc : plan->op_inverse_desc;
+    for(auto desc : {&ip_desc, &op_desc})
     {
-        size_t i_strides[3] = {desc->inStrides[0], desc->inStrides[1], desc->inStrides[2]};
-        size_t o_strides[3] = {desc->outStrides[0], desc->outStrides[1], desc->outStrides[2]};
+        if(*desc)
+        {
+            rocfft_plan_description_destroy(*desc);
+            *desc = nullptr;
+        }
+    }
+}
 
-        if(re_calc_strides_in_desc)
+// build the plan cache key for the given placement and direction of
+// a plan whose parameters have been set by hipfftMakePlan_internal
+static hipfft_plan_key make_plan_key(hipfftHandle plan, bool inplace, bool forward)
+{
+    rocfft_transform_type type;
+    if(plan->type.is_real_to_complex())
+        type = rocfft_transform_type_real_forward;
+    else if(plan->type.is_complex_to_real())
+        type = rocfft_transform_type_real_inverse;
+    else
+        type = forward ? rocfft_transform_type_complex_forward
+                       : rocfft_transform_type_complex_inverse;
+
+    hipfft_plan_key key;
+    if(hipGetDevice(&key.device) != hipSuccess)
+        throw HIPFFT_INVALID_DEVICE;
+    key.placement      = inplace ? rocfft_placement_inplace : rocfft_placement_notinplace;
+    key.transform_type = type;
+    key.precision      = plan->type.precision();
+    key.inputType      = plan->type.inputType;
+    key.outputType     = plan->type.outputType;
+    key.lengths        = plan->lengths;
+    key.batch          = plan->batch;
+    key.scale_factor   = plan->scale_factor;
+    key.layout         = plan->layout;
+    for(auto bricks : {&plan->inBricks, &plan->outBricks})
+    {
+        key.bricks.push_back(bricks->size());
+        for(const auto& brick : *bricks)
         {
-            if(desc->inArrayType == rocfft_array_type_real) // real-to-complex
-            {
+            key.bricks.push_back(static_cast<size_t>(brick.device));
+            for(auto coords : {&brick.field_lower, &brick.field_upper, &brick.brick_stride})
+                std::copy(coords->begin(), coords->end(), std::back_inserter(key.bricks));
+        }
+    }
+    return key;
+}
+
+// create the rocFFT plan for the given placement and direction, if
+// it hasn't been created already.  Returns true if the plan exists
+// after this call.
+static bool create_exec_plan(hipfftHandle plan, bool inplace, bool forward)
+{
+    auto& rplan = inplace ? (forward ? plan->ip_forward : plan->ip_inverse)
+                          : (forward ? plan->op_forward : plan->op_inverse);
+    auto& rdesc = inplace ? (forward ? plan->ip_forward_desc : plan->ip_inverse_desc)
+                          : (forward ? plan->op_forward_desc : plan->op_inverse_desc);
+    if(rplan)
+        return true;
+    // description was already used up by a previous attempt, or
+    // this direction is not valid for the transform type
+    if(!rdesc)
+        return false;
+
+    auto key = make_plan_key(plan, inplace, forward);
+    rplan = hipfft_plan_cache::get().acquire(key, [&]() {
+        rocfft_plan  created       = nullptr;
+        unsigned int plans_created = 0;
+        ROC_FFT_CHECK_PLAN_CREATE(created,
+                                  plans_created,
+                                  key.placement,
+                                  key.transform_type,
+                                  key.precision,
+                                  plan->lengths.size(),
+                                  plan->lengths.data(),
+                                  plan->batch,
+                                  rdesc);
+        return created;
+    });
+
+    // description is no longer needed, whether or not the plan
+    // could be created
+    rocfft_plan_description_destroy(rdesc);
+    rdesc = nullptr;
+
+    return rplan != nullptr;
+}
+
+// free the work buffer if it was allocated by the plan
+static hipfftResult free_work_buffer(hipfftHandle plan)
+{
+    if(plan->workBuffer && plan->workBufferNeedsFree)
+    {
+        if(hipFree(plan->workBuffer) != hipSuccess)
+            return HIPFFT_ALLOC_FAILED;
+        plan->workBuffer          = nullptr;
+        plan->workBufferNeedsFree = false;
+    }
+    return HIPFFT_SUCCESS;
+}
+
+// allocate a work buffer owned by the plan, replacing any buffer the
+// plan had allocated before.  Multi-device plans keep the buffer on
+// their first device.
+static hipfftResult allocate_work_buffer(hipfftHandle plan, size_t size)
+{
+    HIP_FFT_CHECK_AND_RETURN(free_work_buffer(plan));
+    int device = 0;
+    if(hipGetDevice(&device) != hipSuccess)
+        return HIPFFT_INVALID_DEVICE;
+    if(!plan->inBricks.empty())
+        device = plan->inBricks.front().device;
+
+    rocfft_scoped_device dev(device);
+    if(hipMalloc(&plan->workBuffer, size) != hipSuccess)
+        return HIPFFT_ALLOC_FAILED;
+    plan->workBufferNeedsFree = true;
+    ROC_FFT_CHECK_INVALID_VALUE(
+        rocfft_execution_info_set_work_buffer(plan->info, plan->workBuffer, size));
+    return HIPFFT_SUCCESS;
+}
+
+// compute the work buffer size needed by all of the rocFFT plans
+// created so far, and grow the work buffer if the library is
+// allocating it
+static hipfftResult update_work_buffer(hipfftHandle plan)
+{
+    size_t workBufferSize = 0;
+    size_t tmpBufferSize  = 0;
+
+    for(auto rplan : {plan->ip_forward,
+                      plan->op_forward,
+                      plan->ip_inverse,
+                      plan->op_inverse,
+                      plan->ip_forward_shuffled,
+                      plan->ip_inverse_shuffled})
+    {
+        if(!rplan)
+            continue;
+        ROC_FFT_CHECK_INVALID_VALUE(rocfft_plan_get_work_buffer_size(rplan, &tmpBufferSize));
+        workBufferSize = std::max(workBufferSize, tmpBufferSize);
+    }
+
+    // lazily-created plans can only ever grow the requirement
+    if(plan->lazy_create && workBufferSize <= plan->workBufferSize)
+        return HIPFFT_SUCCESS;
+
+    if(workBufferSize > 0)
+    {
+        if(plan->autoAllocate)
+        {
+            // shared and deferred work areas are set up at exec time
+            switch(plan->workAreaPolicy)
+            {
+            case HIPFFT_WORKAREA_PER_PLAN:
+                HIP_FFT_CHECK_AND_RETURN(allocate_work_buffer(plan, workBufferSize));
+                break;
+            case HIPFFT_WORKAREA_DEFERRED:
+                // drop a buffer that's too small for a new lazily
+                // created plan
+                HIP_FFT_CHECK_AND_RETURN(free_work_buffer(plan));
+                break;
+            case HIPFFT_WORKAREA_SHARED_PER_STREAM:
+                break;
+            }
+        }
+        // a lazily-created plan needs more space than the
+        // user-provided work area that was sized before it existed
+        else if(plan->lazy_create && workBufferSize > plan->userWorkAreaSize)
+            return HIPFFT_NO_WORKSPACE;
+    }
+
+    plan->workBufferSize = workBufferSize;
+    return HIPFFT_SUCCESS;
+}
+
+// create the plans for chunked execution of a multi-device plan,
+// defined along with the chunked execution below
+static void create_pipeline_plans(hipfftHandle plan);
+static hipfftResult
+    apply_op(hipfftHandle plan, bool load, hipfftExtOp op, double param, const void* array);
+static hipfftResult
+    set_op(hipfftHandle plan, bool load, hipfftExtOp op, double param, const void* array);
+static hipfftResult run_op_pass(hipfftHandle plan, bool load, void* src, void* dest);
+
+// work area needed on each device of a multi-device plan, in the
+// order the devices were given to hipfftXtSetGPUs.  The rocFFT
+// plans' work buffer is on the first device, and each device also
+// needs space for the plans that transform its chunks.
+static std::vector<size_t> xt_work_sizes(hipfftHandle plan)
+{
+    std::vector<size_t> sizes(plan->inBricks.size(), 0);
+    const auto&         devices = plan->pipeline.devices;
+    for(size_t i = 0; i < sizes.size() && i < devices.size(); ++i)
+        sizes[i] = devices[i].workSize;
+    if(!sizes.empty())
+        sizes.front() = std::max(sizes.front(), plan->workBufferSize);
+    return sizes;
+}
+
+// write a plan's work area size: one size per device for
+// multi-device plans
+static void report_work_size(hipfftHandle plan, size_t* workSize)
+{
+    if(workSize == nullptr)
+        return;
+    if(plan->inBricks.empty())
+    {
+        *workSize              = plan->workBufferSize;
+        plan->reportedWorkSize = std::max(plan->reportedWorkSize, *workSize);
+    }
+    else
+    {
+        const auto sizes = xt_work_sizes(plan);
+        std::copy(sizes.begin(), sizes.end(), workSize);
+    }
+}
+
+// create the in-place rocFFT plans that end in (forward) and start
+// from (inverse) the shuffled layout, if they haven't been created
+// already.  The shuffled layout is only usable if both plans can be
+// made, so if either fails the layout is dropped and later
+// transforms stay in the natural layout.  Returns true if the plans
+// exist after this call.
+static bool create_shuffled_plans(hipfftHandle plan)
+{
+    if(plan->ip_forward_shuffled && plan->ip_inverse_shuffled)
+        return true;
+    if(plan->shuffledBricks.empty())
+        return false;
+
+    for(bool forward : {true, false})
+    {
+        auto& rplan = forward ? plan->ip_forward_shuffled : plan->ip_inverse_shuffled;
+
+        const auto& inBricks  = forward ? plan->outBricks : plan->shuffledBricks;
+        const auto& outBricks = forward ? plan->shuffledBricks : plan->outBricks;
+
+        // same as the natural in-place plan, except for the layout
+        // at one end
+        auto key = make_plan_key(plan, true, forward);
+        key.bricks.push_back(forward ? 1 : 2);
+        for(const auto& brick : plan->shuffledBricks)
+        {
+            key.bricks.push_back(static_cast<size_t>(brick.device));
+            for(auto coords : {&brick.field_lower, &brick.field_upper, &brick.brick_stride})
+                std::copy(coords->begin(), coords->end(), std::back_inserter(key.bricks));
+        }
+
+        rplan = hipfft_plan_cache::get().acquire(key, [&]() {
+            rocfft_plan_description desc = nullptr;
+            if(rocfft_plan_description_create(&desc) != rocfft_status_success)
+                throw HIPFFT_INTERNAL_ERROR;
+            if(plan->scale_factor != 1.0)
+                rocfft_plan_description_set_scale_factor(desc, plan->scale_factor);
+
+            rocfft_field inField  = create_field(inBricks);
+            rocfft_field outField = create_field(outBricks);
+            rocfft_plan_description_add_infield(desc, inField);
+            rocfft_plan_description_add_outfield(desc, outField);
+            (void)rocfft_field_destroy(inField);
+            (void)rocfft_field_destroy(outField);
+
+            rocfft_plan  created       = nullptr;
+            unsigned int plans_created = 0;
+            ROC_FFT_CHECK_PLAN_CREATE(created,
+                                      plans_created,
+                                      key.placement,
+                                      key.transform_type,
+                                      key.precision,
+                                      plan->lengths.size(),
+                                      plan->lengths.data(),
+                                      plan->batch,
+                                      desc);
+            rocfft_plan_description_destroy(desc);
+            return created;
+        });
+
+        if(!rplan)
+        {
+            // rocFFT can't make this plan, don't try again
+            for(auto shuffled : {&plan->ip_forward_shuffled, &plan->ip_inverse_shuffled})
+            {
+                if(*shuffled)
+                    hipfft_plan_cache::get().release(*shuffled);
+                *shuffled = nullptr;
+            }
+            plan->shuffledBricks.clear();
+            return false;
+        }
+    }
+
+    auto ret = update_work_buffer(plan);
+    if(ret != HIPFFT_SUCCESS)
+        throw ret;
+    return true;
+}
+
+// rocFFT library setup and cleanup.  Setup happens in
+// hipfftExtInitialize, or else when the first plan is made.  Cleanup
+// happens in hipfftExtFinalize, or else at exit.
+class hipfft_library
+{
+public:
+    static hipfft_library& get()
+    {
+        static hipfft_library library;
+        return library;
+    }
+
+    // set up rocFFT if that hasn't been done yet
+    void setup()
+    {
+        if(ready)
+            return;
+        std::lock_guard<std::mutex> lock(mutex);
+        if(ready)
+            return;
+        if(rocfft_setup() != rocfft_status_success)
+            throw HIPFFT_SETUP_FAILED;
+        ready = true;
+    }
+
+    void cleanup()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(!ready)
+            return;
+        rocfft_cleanup();
+        ready = false;
+    }
+
+    // serializes hipfftExtInitialize and hipfftExtFinalize, and
+    // guards the initialization running on another thread, if any
+    std::mutex                init_mutex;
+    std::future<hipfftResult> background;
+
+    hipfft_library(const hipfft_library&) = delete;
+    hipfft_library& operator=(const hipfft_library&) = delete;
+
+private:
+    hipfft_library() = default;
+    ~hipfft_library()
+    {
+        if(background.valid())
+            background.wait();
+        cleanup();
+    }
+
+    std::mutex        mutex;
+    std::atomic<bool> ready{false};
+};
+
+static void setup_rocfft()
+{
+    hipfft_library::get().setup();
+}
+
+// make and destroy a plan for each prewarm signature, so that their
+// kernels are compiled and the plans are left in the plan cache
+static hipfftResult prewarm_plans(const std::vector<hipfftExtPrewarmSpec>& prewarm)
+{
+    hipfftResult ret = HIPFFT_SUCCESS;
+    for(auto spec : prewarm)
+    {
+        hipfftHandle plan = nullptr;
+        auto         spec_ret = hipfftCreate(&plan);
+        if(spec_ret == HIPFFT_SUCCESS)
+            spec_ret = hipfftSetAutoAllocation(plan, 0);
+        size_t workSize = 0;
+        if(spec_ret == HIPFFT_SUCCESS)
+            spec_ret = hipfftMakePlanMany(plan,
+                                          spec.rank,
+                                          spec.n,
+                                          nullptr,
+                                          1,
+                                          0,
+                                          nullptr,
+                                          1,
+                                          0,
+                                          spec.type,
+                                          spec.batch,
+                                          &workSize);
+        if(plan)
+            hipfftDestroy(plan);
+        if(spec_ret != HIPFFT_SUCCESS && ret == HIPFFT_SUCCESS)
+            ret = spec_ret;
+    }
+    return ret;
+}
+
+hipfftResult hipfftExtInitialize(unsigned int                flags,
+                                 const hipfftExtPrewarmSpec* prewarm,
+                                 size_t                      prewarmCount)
+try
+{
+    if(flags & ~static_cast<unsigned int>(HIPFFT_INIT_BACKGROUND))
+        return HIPFFT_INVALID_VALUE;
+    if(prewarmCount && !prewarm)
+        return HIPFFT_INVALID_VALUE;
+    for(size_t i = 0; i < prewarmCount; ++i)
+    {
+        const auto& spec = prewarm[i];
+        if(spec.rank < 1 || spec.rank > 3 || spec.batch < 1)
+            return HIPFFT_INVALID_VALUE;
+        for(int d = 0; d < spec.rank; ++d)
+            if(spec.n[d] < 1)
+                return HIPFFT_INVALID_VALUE;
+    }
+    std::vector<hipfftExtPrewarmSpec> specs(prewarm, prewarm + prewarmCount);
+
+    auto&                       library = hipfft_library::get();
+    std::lock_guard<std::mutex> lock(library.init_mutex);
+    // only one initialization runs in the background at a time
+    if(library.background.valid())
+        library.background.wait();
+
+    if(!(flags & HIPFFT_INIT_BACKGROUND))
+    {
+        library.setup();
+        return prewarm_plans(specs);
+    }
+
+    int device = 0;
+    if(hipGetDevice(&device) != hipSuccess)
+        return HIPFFT_INVALID_DEVICE;
+    library.background = std::async(std::launch::async, [device, specs]() {
+        if(hipSetDevice(device) != hipSuccess)
+            return HIPFFT_INVALID_DEVICE;
+        try
+        {
+            hipfft_library::get().setup();
+        }
+        catch(hipfftResult e)
+        {
+            return e;
+        }
+        return prewarm_plans(specs);
+    });
+    return HIPFFT_SUCCESS;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftExtFinalize()
+try
+{
+    auto&                       library = hipfft_library::get();
+    std::lock_guard<std::mutex> init_lock(library.init_mutex);
+    if(library.background.valid())
+        library.background.wait();
+
+    {
+        auto&                       live = hipfft_live_handles::get();
+        std::lock_guard<std::mutex> lock(live.mutex);
+        if(!live.handles.empty())
+            return HIPFFT_INVALID_PLAN;
+    }
+
+    // cached plans must go before the library is cleaned up
+    hipfft_plan_cache::get().clear();
+    library.cleanup();
+    return HIPFFT_SUCCESS;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+// relative throughput of each brick's device.  FFTs are usually
+// limited by memory bandwidth, but compute matters too, so weigh
+// both equally.
+static std::vector<double> device_weights(const std::vector<hipfft_brick>& bricks)
+{
+    std::vector<double> weights;
+    for(const auto& brick : bricks)
+    {
+        hipDeviceProp_t prop;
+        if(hipGetDeviceProperties(&prop, brick.device) != hipSuccess)
+            throw HIPFFT_INVALID_DEVICE;
+        const double compute   = static_cast<double>(prop.multiProcessorCount) * prop.clockRate;
+        const double bandwidth = static_cast<double>(prop.memoryClockRate) * prop.memoryBusWidth;
+        const double weight    = std::sqrt(compute * bandwidth);
+        weights.push_back(std::isfinite(weight) ? weight : 0.0);
+    }
+
+    // devices that don't report their properties count as average
+    const double total = std::accumulate(weights.begin(), weights.end(), 0.0);
+    const size_t known
+        = std::count_if(weights.begin(), weights.end(), [](double w) { return w > 0.0; });
+    for(auto& weight : weights)
+    {
+        if(weight == 0.0)
+            weight = known ? total / known : 1.0;
+    }
+    return weights;
+}
+
+// fill in bricks from the ones the user gave, which list the batch
+// dimension first and then the FFT dimensions slowest first.  Throws
+// if they don't exactly tile a field of the given (col-major) length.
+static void set_user_bricks(const std::vector<size_t>&         length,
+                            size_t                             batch,
+                            const std::vector<hipfftExtBrick>& userBricks,
+                            std::vector<hipfft_brick>&         bricks)
+{
+    std::vector<size_t> lengthWithBatch = length;
+    lengthWithBatch.push_back(batch);
+    const size_t dim = lengthWithBatch.size();
+    if(dim > HIPFFT_EXT_MAX_BRICK_DIMS || userBricks.size() != bricks.size())
+        throw HIPFFT_INVALID_VALUE;
+
+    for(size_t i = 0; i < bricks.size(); ++i)
+    {
+        const auto& userBrick = userBricks[i];
+        auto&       brick     = bricks[i];
+        brick.field_lower.resize(dim);
+        brick.field_upper.resize(dim);
+        brick.brick_stride.resize(dim);
+        for(size_t d = 0; d < dim; ++d)
+        {
+            const size_t userDim = dim - 1 - d;
+            if(userBrick.lower[userDim] < 0 || userBrick.upper[userDim] < 0
+               || userBrick.stride[userDim] < 0)
+                throw HIPFFT_INVALID_VALUE;
+            brick.field_lower[d]  = static_cast<size_t>(userBrick.lower[userDim]);
+            brick.field_upper[d]  = static_cast<size_t>(userBrick.upper[userDim]);
+            brick.brick_stride[d] = static_cast<size_t>(userBrick.stride[userDim]);
+        }
+    }
+    if(!bricks_tile_field(lengthWithBatch, bricks))
+        throw HIPFFT_INVALID_VALUE;
+
+    for(auto& brick : bricks)
+        brick.min_size = compute_ptrdiff(brick.length(), brick.brick_stride, 0, 0);
+}
+
+// data layout given to each rocFFT plan description of a handle, in
+// the order in-place forward, out-of-place forward, in-place
+// inverse, out-of-place inverse.  Descriptions without a layout keep
+// rocFFT's default one.
+typedef std::array<std::optional<hipfft_plan_description_t>, 4> hipfft_desc_layouts;
+
+// Record the dimensions and data layout of a transform in the
+// handle, and work out the layout of each of its rocFFT plan
+// descriptions.  This makes no rocFFT or HIP calls, so work size
+// estimates can use it on its own.
+static void set_plan_layout(hipfftHandle               plan,
+                            size_t                     dim,
+                            const size_t*              lengths,
+                            hipfftIOType               iotype,
+                            size_t                     number_of_transforms,
+                            hipfft_plan_description_t* desc,
+                            bool                       re_calc_strides_in_desc,
+                            hipfft_desc_layouts&       desc_layouts)
+{
+    std::copy_n(lengths, dim, std::back_inserter(plan->lengths));
+    if(desc != nullptr)
+    {
+        plan->layout = {static_cast<size_t>(re_calc_strides_in_desc),
+                        static_cast<size_t>(desc->inArrayType),
+                        static_cast<size_t>(desc->outArrayType),
+                        desc->inDist,
+                        desc->outDist};
+        std::copy_n(desc->inStrides, dim, std::back_inserter(plan->layout));
+        std::copy_n(desc->outStrides, dim, std::back_inserter(plan->layout));
+    }
+    std::copy_n(lengths, dim, std::back_inserter(plan->inLength));
+    std::copy_n(lengths, dim, std::back_inserter(plan->outLength));
+
+    if(iotype.is_real_to_complex())
+        plan->outLength.front() = plan->outLength.front() / 2 + 1;
+    else if(iotype.is_complex_to_real())
+        plan->inLength.front() = plan->inLength.front() / 2 + 1;
+    plan->batch = number_of_transforms;
+
+    if(desc != nullptr)
+    {
+        size_t i_strides[3] = {desc->inStrides[0], desc->inStrides[1], desc->inStrides[2]};
+        size_t o_strides[3] = {desc->outStrides[0], desc->outStrides[1], desc->outStrides[2]};
+
+        // the layout that's currently in desc and the stride arrays
+        auto current_layout = [&]() {
+            hipfft_plan_description_t layout = *desc;
+            std::copy_n(i_strides, 3, layout.inStrides);
+            std::copy_n(o_strides, 3, layout.outStrides);
+            return layout;
+        };
+
+        if(re_calc_strides_in_desc)
+        {
+            if(desc->inArrayType == rocfft_array_type_real) // real-to-complex
+            {
                 size_t idist = 2 * (1 + lengths[0] / 2);
                 size_t odist = 1 + lengths[0] / 2;
                 for(size_t i = 1; i < dim; i++)
@@ -483,21 +1754,9 @@ hipfftResult hipfftMakePlan_internal(hipfftHandle               plan,
                     odist *= lengths[i];
                 }
 
-                desc->inDist  = idist;
-                desc->outDist = odist;
-
-                ROC_FFT_CHECK_INVALID_VALUE(
-                    rocfft_plan_description_set_data_layout(ip_forward_desc,
-                                                            desc->inArrayType,
-                                                            desc->outArrayType,
-                                                            0,
-                                                            0,
-                                                            dim,
-                                                            i_strides,
-                                                            desc->inDist,
-                                                            dim,
-                                                            o_strides,
-                                                            desc->outDist));
+                desc->inDist    = idist;
+                desc->outDist   = odist;
+                desc_layouts[0] = current_layout();
 
                 idist = lengths[0];
                 odist = 1 + lengths[0] / 2;
@@ -509,21 +1768,9 @@ hipfftResult hipfftMakePlan_internal(hipfftHandle               plan,
                     odist *= lengths[i];
                 }
 
-                desc->inDist  = idist;
-                desc->outDist = odist;
-
-                ROC_FFT_CHECK_INVALID_VALUE(
-                    rocfft_plan_description_set_data_layout(op_forward_desc,
-                                                            desc->inArrayType,
-                                                            desc->outArrayType,
-                                                            0,
-                                                            0,
-                                                            dim,
-                                                            i_strides,
-                                                            desc->inDist,
-                                                            dim,
-                                                            o_strides,
-                                                            desc->outDist));
+                desc->inDist    = idist;
+                desc->outDist   = odist;
+                desc_layouts[1] = current_layout();
             }
             else if(desc->outArrayType == rocfft_array_type_real) // complex-to-real
             {
@@ -537,21 +1784,9 @@ hipfftResult hipfftMakePlan_internal(hipfftHandle               plan,
                     odist *= lengths[i];
                 }
 
-                desc->inDist  = idist;
-                desc->outDist = odist;
-
-                ROC_FFT_CHECK_INVALID_VALUE(
-                    rocfft_plan_description_set_data_layout(ip_inverse_desc,
-                                                            desc->inArrayType,
-                                                            desc->outArrayType,
-                                                            0,
-                                                            0,
-                                                            dim,
-                                                            i_strides,
-                                                            desc->inDist,
-                                                            dim,
-                                                            o_strides,
-                                                            desc->outDist));
+                desc->inDist    = idist;
+                desc->outDist   = odist;
+                desc_layouts[2] = current_layout();
 
                 idist = 1 + lengths[0] / 2;
                 odist = lengths[0];
@@ -563,21 +1798,9 @@ hipfftResult hipfftMakePlan_internal(hipfftHandle               plan,
                     odist *= lengths[i];
                 }
 
-                desc->inDist  = idist;
-                desc->outDist = odist;
-
-                ROC_FFT_CHECK_INVALID_VALUE(
-                    rocfft_plan_description_set_data_layout(op_inverse_desc,
-                                                            desc->inArrayType,
-                                                            desc->outArrayType,
-                                                            0,
-                                                            0,
-                                                            dim,
-                                                            i_strides,
-                                                            desc->inDist,
-                                                            dim,
-                                                            o_strides,
-                                                            desc->outDist));
+                desc->inDist    = idist;
+                desc->outDist   = odist;
+                desc_layouts[3] = current_layout();
             }
             else
             {
@@ -590,104 +1813,11 @@ hipfftResult hipfftMakePlan_internal(hipfftHandle               plan,
 
                 desc->inDist  = dist;
                 desc->outDist = dist;
-
-                ROC_FFT_CHECK_INVALID_VALUE(
-                    rocfft_plan_description_set_data_layout(ip_forward_desc,
-                                                            desc->inArrayType,
-                                                            desc->outArrayType,
-                                                            0,
-                                                            0,
-                                                            dim,
-                                                            i_strides,
-                                                            desc->inDist,
-                                                            dim,
-                                                            o_strides,
-                                                            desc->outDist));
-                ROC_FFT_CHECK_INVALID_VALUE(
-                    rocfft_plan_description_set_data_layout(op_forward_desc,
-                                                            desc->inArrayType,
-                                                            desc->outArrayType,
-                                                            0,
-                                                            0,
-                                                            dim,
-                                                            i_strides,
-                                                            desc->inDist,
-                                                            dim,
-                                                            o_strides,
-                                                            desc->outDist));
-                ROC_FFT_CHECK_INVALID_VALUE(
-                    rocfft_plan_description_set_data_layout(ip_inverse_desc,
-                                                            desc->inArrayType,
-                                                            desc->outArrayType,
-                                                            0,
-                                                            0,
-                                                            dim,
-                                                            i_strides,
-                                                            desc->inDist,
-                                                            dim,
-                                                            o_strides,
-                                                            desc->outDist));
-                ROC_FFT_CHECK_INVALID_VALUE(
-                    rocfft_plan_description_set_data_layout(op_inverse_desc,
-                                                            desc->inArrayType,
-                                                            desc->outArrayType,
-                                                            0,
-                                                            0,
-                                                            dim,
-                                                            i_strides,
-                                                            desc->inDist,
-                                                            dim,
-                                                            o_strides,
-                                                            desc->outDist));
+                desc_layouts.fill(current_layout());
             }
         }
         else
-        {
-            ROC_FFT_CHECK_INVALID_VALUE(rocfft_plan_description_set_data_layout(ip_forward_desc,
-                                                                                desc->inArrayType,
-                                                                                desc->outArrayType,
-                                                                                0,
-                                                                                0,
-                                                                                dim,
-                                                                                i_strides,
-                                                                                desc->inDist,
-                                                                                dim,
-                                                                                o_strides,
-                                                                                desc->outDist));
-            ROC_FFT_CHECK_INVALID_VALUE(rocfft_plan_description_set_data_layout(op_forward_desc,
-                                                                                desc->inArrayType,
-                                                                                desc->outArrayType,
-                                                                                0,
-                                                                                0,
-                                                                                dim,
-                                                                                i_strides,
-                                                                                desc->inDist,
-                                                                                dim,
-                                                                                o_strides,
-                                                                                desc->outDist));
-            ROC_FFT_CHECK_INVALID_VALUE(rocfft_plan_description_set_data_layout(ip_inverse_desc,
-                                                                                desc->inArrayType,
-                                                                                desc->outArrayType,
-                                                                                0,
-                                                                                0,
-                                                                                dim,
-                                                                                i_strides,
-                                                                                desc->inDist,
-                                                                                dim,
-                                                                                o_strides,
-                                                                                desc->outDist));
-            ROC_FFT_CHECK_INVALID_VALUE(rocfft_plan_description_set_data_layout(op_inverse_desc,
-                                                                                desc->inArrayType,
-                                                                                desc->outArrayType,
-                                                                                0,
-                                                                                0,
-                                                                                dim,
-                                                                                i_strides,
-                                                                                desc->inDist,
-                                                                                dim,
-                                                                                o_strides,
-                                                                                desc->outDist));
-        }
+            desc_layouts.fill(current_layout());
 
         // save the computed strides
         std::copy_n(i_strides, dim, std::back_inserter(plan->inStrides));
@@ -710,33 +1840,135 @@ hipfftResult hipfftMakePlan_internal(hipfftHandle               plan,
         plan->iDist = iDist;
         plan->oDist = oDist;
     }
+}
 
-    // problem dimensions and strides are known, set up the bricks for multi-GPU
-    set_io_bricks(plan->inLength, plan->outLength, plan->batch, plan->inBricks, plan->outBricks);
+hipfftResult hipfftMakePlan_internal(hipfftHandle               plan,
+                                     size_t                     dim,
+                                     size_t*                    lengths,
+                                     hipfftIOType               iotype,
+                                     size_t                     number_of_transforms,
+                                     hipfft_plan_description_t* desc,
+                                     size_t*                    workSize,
+                                     bool                       re_calc_strides_in_desc)
+{
+    hipfft_desc_layouts desc_layouts;
+    set_plan_layout(plan,
+                    dim,
+                    lengths,
+                    iotype,
+                    number_of_transforms,
+                    desc,
+                    re_calc_strides_in_desc,
+                    desc_layouts);
 
-    // create fields for the bricks
-    if(!plan->inBricks.empty())
+    // problem dimensions and strides are known, set up the bricks for multi-GPU
+    if(!plan->inUserBricks.empty())
     {
-        rocfft_field inField = nullptr;
-        if(rocfft_field_create(&inField) != rocfft_status_success)
-            throw std::runtime_error("input field create failed");
+        set_user_bricks(plan->inLength, plan->batch, plan->inUserBricks, plan->inBricks);
+        set_user_bricks(plan->outLength, plan->batch, plan->outUserBricks, plan->outBricks);
 
+        // the data was split in proportion to the input bricks' sizes
+        plan->brickWeights.clear();
         for(const auto& brick : plan->inBricks)
         {
-            rocfft_brick rbrick = nullptr;
-            if(rocfft_brick_create(&rbrick,
-                                   brick.field_lower.data(),
-                                   brick.field_upper.data(),
-                                   brick.brick_stride.data(),
-                                   brick.field_lower.size(),
-                                   brick.device)
-               != rocfft_status_success)
-                throw std::runtime_error("create input brick failed");
-
-            if(rocfft_field_add_brick(inField, rbrick) != rocfft_status_success)
-                throw std::runtime_error("add input brick failed");
-            rocfft_brick_destroy(rbrick);
+            const auto length = brick.length();
+            plan->brickWeights.push_back(std::accumulate(
+                length.begin(), length.end(), 1.0, std::multiplies<double>()));
         }
+    }
+    else if(plan->pencilRows != 0)
+    {
+        // pencils are always split evenly
+        if(plan->decomposition != HIPFFT_DECOMPOSITION_EVEN
+           || !set_io_pencil_bricks(plan->inLength,
+                                    plan->outLength,
+                                    plan->batch,
+                                    plan->inBricks,
+                                    plan->outBricks,
+                                    plan->pencilRows,
+                                    plan->pencilColumns))
+            throw HIPFFT_INVALID_VALUE;
+    }
+    else
+    {
+        if(plan->decomposition == HIPFFT_DECOMPOSITION_DEVICE_PROPERTIES)
+            plan->brickWeights = device_weights(plan->inBricks);
+        if(!plan->brickWeights.empty() && plan->brickWeights.size() != plan->inBricks.size())
+            throw HIPFFT_INVALID_VALUE;
+        set_io_bricks(plan->inLength,
+                      plan->outLength,
+                      plan->batch,
+                      plan->inBricks,
+                      plan->outBricks,
+                      plan->brickWeights);
+    }
+
+    // in-place C2C transforms can also leave their output split
+    // along a different dim, which saves rocFFT the final exchange.
+    // plan->type isn't set to this plan's types until below.
+    plan->shuffledBricks.clear();
+    if(plan->inUserBricks.empty() && !plan->outBricks.empty() && iotype.is_complex_to_complex())
+    {
+        plan->shuffledBricks.resize(plan->outBricks.size());
+        for(size_t i = 0; i < plan->outBricks.size(); ++i)
+            plan->shuffledBricks[i].device = plan->outBricks[i].device;
+        if(!set_shuffled_bricks(plan->outLength,
+                                plan->batch,
+                                plan->shuffledBricks,
+                                plan->brickWeights,
+                                plan->pencilRows,
+                                plan->pencilColumns))
+            plan->shuffledBricks.clear();
+    }
+
+    // converted data is only supported on a single device
+    if(iotype.converts() && !plan->inBricks.empty())
+        return HIPFFT_NOT_SUPPORTED;
+
+    // work size estimates only need the dimensions, layout and bricks
+    if(plan->estimate_only)
+    {
+        plan->type = iotype;
+        return HIPFFT_SUCCESS;
+    }
+
+    setup_rocfft();
+
+    // descriptions are owned by the plan, so that they're still
+    // available if plan creation is deferred until exec time
+    auto& ip_forward_desc = plan->ip_forward_desc;
+    auto& op_forward_desc = plan->op_forward_desc;
+    auto& ip_inverse_desc = plan->ip_inverse_desc;
+    auto& op_inverse_desc = plan->op_inverse_desc;
+    rocfft_plan_description_create(&ip_forward_desc);
+    rocfft_plan_description_create(&op_forward_desc);
+    rocfft_plan_description_create(&ip_inverse_desc);
+    rocfft_plan_description_create(&op_inverse_desc);
+
+    const rocfft_plan_description descs[]
+        = {ip_forward_desc, op_forward_desc, ip_inverse_desc, op_inverse_desc};
+    for(size_t i = 0; i < desc_layouts.size(); ++i)
+    {
+        const auto& layout = desc_layouts[i];
+        if(!layout)
+            continue;
+        ROC_FFT_CHECK_INVALID_VALUE(rocfft_plan_description_set_data_layout(descs[i],
+                                                                            layout->inArrayType,
+                                                                            layout->outArrayType,
+                                                                            0,
+                                                                            0,
+                                                                            dim,
+                                                                            layout->inStrides,
+                                                                            layout->inDist,
+                                                                            dim,
+                                                                            layout->outStrides,
+                                                                            layout->outDist));
+    }
+
+    // create fields for the bricks
+    if(!plan->inBricks.empty())
+    {
+        rocfft_field inField = create_field(plan->inBricks);
 
         // inBricks are used for out-of-place transforms
         for(auto rocfft_desc : {op_forward_desc, op_inverse_desc})
@@ -748,26 +1980,7 @@ hipfftResult hipfftMakePlan_internal(hipfftHandle               plan,
     }
     if(!plan->outBricks.empty())
     {
-        rocfft_field outField = nullptr;
-        if(rocfft_field_create(&outField) != rocfft_status_success)
-            throw std::runtime_error("output field create failed");
-
-        for(const auto& brick : plan->outBricks)
-        {
-            rocfft_brick rbrick = nullptr;
-            if(rocfft_brick_create(&rbrick,
-                                   brick.field_lower.data(),
-                                   brick.field_upper.data(),
-                                   brick.brick_stride.data(),
-                                   brick.field_lower.size(),
-                                   brick.device)
-               != rocfft_status_success)
-                throw std::runtime_error("create output brick failed");
-
-            if(rocfft_field_add_brick(outField, rbrick) != rocfft_status_success)
-                throw std::runtime_error("add output brick failed");
-            rocfft_brick_destroy(rbrick);
-        }
+        rocfft_field outField = create_field(plan->outBricks);
 
         // outBricks are used for both sides of in-place transforms,
         // and output of out-of-place transforms
@@ -794,6 +2007,35 @@ hipfftResult hipfftMakePlan_internal(hipfftHandle               plan,
         }
     }
 
+    plan->type = iotype;
+
+    // data stored in a different precision is converted as it's
+    // loaded and stored, by the callbacks that apply load and store
+    // ops
+    if(iotype.converts())
+    {
+        if(iotype.converts_input())
+            HIP_FFT_CHECK_AND_RETURN(apply_op(plan, true, HIPFFT_OP_NONE, 0.0, nullptr));
+        if(iotype.converts_output())
+            HIP_FFT_CHECK_AND_RETURN(apply_op(plan, false, HIPFFT_OP_NONE, 0.0, nullptr));
+    }
+
+    // descriptions for directions that this transform type can't
+    // do will never be used
+    if(iotype.is_real_to_complex())
+        destroy_plan_descs(plan, false);
+    else if(iotype.is_complex_to_real())
+        destroy_plan_descs(plan, true);
+
+    if(plan->lazy_create)
+    {
+        // plans get created on first use, so there's nothing to
+        // allocate yet
+        plan->workBufferSize = 0;
+        report_work_size(plan, workSize);
+        return HIPFFT_SUCCESS;
+    }
+
     // count the number of plans that got created - it's possible to
     // have parameters that are valid for out-place but not for
     // in-place, so some of these rocfft_plan_creates could
@@ -801,103 +2043,24 @@ hipfftResult hipfftMakePlan_internal(hipfftHandle               plan,
     unsigned int plans_created = 0;
     for(auto t : iotype.transform_types())
     {
-        // in-place
-        auto& ip_plan_ptr  = iotype.is_forward(t) ? plan->ip_forward : plan->ip_inverse;
-        auto& ip_plan_desc = iotype.is_forward(t) ? ip_forward_desc : ip_inverse_desc;
-        ROC_FFT_CHECK_PLAN_CREATE(ip_plan_ptr,
-                                  plans_created,
-                                  rocfft_placement_inplace,
-                                  t,
-                                  iotype.precision(),
-                                  dim,
-                                  lengths,
-                                  number_of_transforms,
-                                  ip_plan_desc);
-        // out-of-place
-        auto& op_plan_ptr  = iotype.is_forward(t) ? plan->op_forward : plan->op_inverse;
-        auto& op_plan_desc = iotype.is_forward(t) ? op_forward_desc : op_inverse_desc;
-        ROC_FFT_CHECK_PLAN_CREATE(op_plan_ptr,
-                                  plans_created,
-                                  rocfft_placement_notinplace,
-                                  t,
-                                  iotype.precision(),
-                                  dim,
-                                  lengths,
-                                  number_of_transforms,
-                                  op_plan_desc);
+        const bool forward = iotype.is_forward(t);
+        // converted data can't be transformed in place
+        if(!iotype.converts() && create_exec_plan(plan, true, forward))
+            ++plans_created;
+        if(create_exec_plan(plan, false, forward))
+            ++plans_created;
     }
 
     // if no plans got created, fail
     if(plans_created == 0)
         return HIPFFT_PARSE_ERROR;
-    plan->type = iotype;
 
-    size_t workBufferSize = 0;
-    size_t tmpBufferSize  = 0;
+    HIP_FFT_CHECK_AND_RETURN(update_work_buffer(plan));
+    create_pipeline_plans(plan);
+    report_work_size(plan, workSize);
 
-    bool const has_forward = !iotype.is_complex_to_real();
-    if(has_forward)
-    {
-        if(plan->ip_forward)
-        {
-            ROC_FFT_CHECK_INVALID_VALUE(
-                rocfft_plan_get_work_buffer_size(plan->ip_forward, &tmpBufferSize));
-            workBufferSize = std::max(workBufferSize, tmpBufferSize);
-        }
-        if(plan->op_forward)
-        {
-            ROC_FFT_CHECK_INVALID_VALUE(
-                rocfft_plan_get_work_buffer_size(plan->op_forward, &tmpBufferSize));
-            workBufferSize = std::max(workBufferSize, tmpBufferSize);
-        }
-    }
-
-    bool const has_inverse = !iotype.is_real_to_complex();
-    if(has_inverse)
-    {
-        if(plan->ip_inverse)
-        {
-            ROC_FFT_CHECK_INVALID_VALUE(
-                rocfft_plan_get_work_buffer_size(plan->ip_inverse, &tmpBufferSize));
-            workBufferSize = std::max(workBufferSize, tmpBufferSize);
-        }
-        if(plan->op_inverse)
-        {
-            ROC_FFT_CHECK_INVALID_VALUE(
-                rocfft_plan_get_work_buffer_size(plan->op_inverse, &tmpBufferSize));
-            workBufferSize = std::max(workBufferSize, tmpBufferSize);
-        }
-    }
-
-    if(workBufferSize > 0)
-    {
-        if(plan->autoAllocate)
-        {
-            if(plan->workBuffer && plan->workBufferNeedsFree)
-            {
-                if(hipFree(plan->workBuffer) != hipSuccess)
-                    return HIPFFT_ALLOC_FAILED;
-            }
-            if(hipMalloc(&plan->workBuffer, workBufferSize) != hipSuccess)
-                return HIPFFT_ALLOC_FAILED;
-            plan->workBufferNeedsFree = true;
-            ROC_FFT_CHECK_INVALID_VALUE(rocfft_execution_info_set_work_buffer(
-                plan->info, plan->workBuffer, workBufferSize));
-        }
-    }
-
-    if(workSize != nullptr)
-        *workSize = workBufferSize;
-
-    plan->workBufferSize = workBufferSize;
-
-    rocfft_plan_description_destroy(ip_forward_desc);
-    rocfft_plan_description_destroy(op_forward_desc);
-    rocfft_plan_description_destroy(ip_inverse_desc);
-    rocfft_plan_description_destroy(op_inverse_desc);
-
-    return HIPFFT_SUCCESS;
-}
+    return HIPFFT_SUCCESS;
+}
 
 hipfftResult hipfftCreate(hipfftHandle* plan)
 try
@@ -915,6 +2078,11 @@ try
     // cppcheck-suppress AssignmentAddressToInteger
     hipfftHandle h = new hipfftHandle_t;
     ROC_FFT_CHECK_INVALID_VALUE(rocfft_execution_info_create(&h->info));
+    {
+        auto&                       live = hipfft_live_handles::get();
+        std::lock_guard<std::mutex> lock(live.mutex);
+        live.handles.insert(h);
+    }
     *plan = h;
     return HIPFFT_SUCCESS;
 }
@@ -930,6 +2098,9 @@ catch(...)
 hipfftResult hipfftExtPlanScaleFactor(hipfftHandle plan, double scalefactor)
 try
 {
+    // a plan being made asynchronously is reading the settings
+    if(!plan || plan->pending.valid())
+        return HIPFFT_INVALID_PLAN;
     if(!std::isfinite(scalefactor))
         return HIPFFT_INVALID_VALUE;
     plan->scale_factor = scalefactor;
@@ -944,25 +2115,13 @@ catch(...)
     return HIPFFT_INTERNAL_ERROR;
 }
 
-hipfftResult
-    hipfftMakePlan1d(hipfftHandle plan, int nx, hipfftType type, int batch, size_t* workSize)
+hipfftResult hipfftExtPlanLazyCreate(hipfftHandle plan, int lazyCreate)
 try
 {
-    if(nx < 0 || batch < 0)
-    {
-        return HIPFFT_INVALID_SIZE;
-    }
-
-    size_t lengths[1];
-    lengths[0]                                      = nx;
-    size_t                     number_of_transforms = batch;
-    hipfft_plan_description_t* desc                 = nullptr;
-
-    hipfftIOType iotype;
-    HIP_FFT_CHECK_AND_RETURN(iotype.init(type));
-
-    return hipfftMakePlan_internal(
-        plan, 1, lengths, iotype, number_of_transforms, desc, workSize, false);
+    if(!plan || plan->pending.valid())
+        return HIPFFT_INVALID_PLAN;
+    plan->lazy_create = bool(lazyCreate);
+    return HIPFFT_SUCCESS;
 }
 catch(hipfftResult e)
 {
@@ -973,25 +2132,13 @@ catch(...)
     return HIPFFT_INTERNAL_ERROR;
 }
 
-hipfftResult hipfftMakePlan2d(hipfftHandle plan, int nx, int ny, hipfftType type, size_t* workSize)
+hipfftResult hipfftExtGetPlanCacheStats(hipfftExtPlanCacheStats* stats)
 try
 {
-    if(nx < 0 || ny < 0)
-    {
-        return HIPFFT_INVALID_SIZE;
-    }
-
-    size_t lengths[2];
-    lengths[0]                                      = ny;
-    lengths[1]                                      = nx;
-    size_t                     number_of_transforms = 1;
-    hipfft_plan_description_t* desc                 = nullptr;
-
-    hipfftIOType iotype;
-    HIP_FFT_CHECK_AND_RETURN(iotype.init(type));
-
-    return hipfftMakePlan_internal(
-        plan, 2, lengths, iotype, number_of_transforms, desc, workSize, false);
+    if(!stats)
+        return HIPFFT_INVALID_VALUE;
+    hipfft_plan_cache::get().get_stats(*stats);
+    return HIPFFT_SUCCESS;
 }
 catch(hipfftResult e)
 {
@@ -1002,27 +2149,11 @@ catch(...)
     return HIPFFT_INTERNAL_ERROR;
 }
 
-hipfftResult
-    hipfftMakePlan3d(hipfftHandle plan, int nx, int ny, int nz, hipfftType type, size_t* workSize)
+hipfftResult hipfftExtClearPlanCache()
 try
 {
-    if(nx < 0 || ny < 0 || nz < 0)
-    {
-        return HIPFFT_INVALID_SIZE;
-    }
-
-    size_t lengths[3];
-    lengths[0]                                      = nz;
-    lengths[1]                                      = ny;
-    lengths[2]                                      = nx;
-    size_t                     number_of_transforms = 1;
-    hipfft_plan_description_t* desc                 = nullptr;
-
-    hipfftIOType iotype;
-    HIP_FFT_CHECK_AND_RETURN(iotype.init(type));
-
-    return hipfftMakePlan_internal(
-        plan, 3, lengths, iotype, number_of_transforms, desc, workSize, false);
+    hipfft_plan_cache::get().clear();
+    return HIPFFT_SUCCESS;
 }
 catch(hipfftResult e)
 {
@@ -1033,132 +2164,36 @@ catch(...)
     return HIPFFT_INTERNAL_ERROR;
 }
 
-template <typename T>
-hipfftResult hipfftMakePlanMany_internal(hipfftHandle plan,
-                                         int          rank,
-                                         T*           n,
-                                         T*           inembed,
-                                         T            istride,
-                                         T            idist,
-                                         T*           onembed,
-                                         T            ostride,
-                                         T            odist,
-                                         hipfftIOType type,
-                                         T            batch,
-                                         size_t*      workSize)
+hipfftResult hipfftExtSetWorkAreaPolicy(hipfftHandle plan, hipfftExtWorkAreaPolicy policy)
+try
 {
-    if((inembed != nullptr && onembed == nullptr) || (inembed == nullptr && onembed != nullptr)
-       || (rank < 0) || (istride < 0) || (idist < 0) || (ostride < 0) || (odist < 0)
-       || (std::any_of(n, n + rank, [](T val) { return val < 0; })))
-        return HIPFFT_INVALID_VALUE;
-
-    for(auto ptr : {inembed, onembed})
-    {
-        if(ptr == nullptr)
-            continue;
-        if(std::any_of(ptr, ptr + rank, [](T val) { return val < 0; }))
-            return HIPFFT_INVALID_SIZE;
-    }
-
-    if(batch < 0)
-        return HIPFFT_INVALID_SIZE;
-
-    size_t lengths[3];
-    for(int i = 0; i < rank; i++)
-        lengths[i] = n[rank - 1 - i];
-
-    size_t number_of_transforms = batch;
-
-    // Decide the inArrayType and outArrayType based on the transform type
-    rocfft_array_type in_array_type, out_array_type;
-    if(type.is_real_to_complex())
-    {
-        in_array_type  = rocfft_array_type_real;
-        out_array_type = rocfft_array_type_hermitian_interleaved;
-    }
-    else if(type.is_complex_to_real())
-    {
-        in_array_type  = rocfft_array_type_hermitian_interleaved;
-        out_array_type = rocfft_array_type_real;
-    }
-    else
-    {
-        in_array_type  = rocfft_array_type_complex_interleaved;
-        out_array_type = rocfft_array_type_complex_interleaved;
-    }
-
-    hipfft_plan_description_t desc;
-
-    bool re_calc_strides_in_desc = (inembed == nullptr) || (onembed == nullptr);
-
-    size_t i_strides[3] = {1, 1, 1};
-    size_t o_strides[3] = {1, 1, 1};
-    for(int i = 1; i < rank; i++)
-    {
-        i_strides[i] = lengths[i - 1] * i_strides[i - 1];
-        o_strides[i] = lengths[i - 1] * o_strides[i - 1];
-    }
-
-    if(inembed != nullptr)
-    {
-        i_strides[0] = istride;
-
-        size_t inembed_lengths[3];
-        for(int i = 0; i < rank; i++)
-            inembed_lengths[i] = inembed[rank - 1 - i];
-
-        for(int i = 1; i < rank; i++)
-            i_strides[i] = inembed_lengths[i - 1] * i_strides[i - 1];
-    }
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    wait_for_plan(plan);
+    std::lock_guard<std::mutex> lock(plan->mutex);
+    if(policy == plan->workAreaPolicy)
+        return HIPFFT_SUCCESS;
 
-    if(onembed != nullptr)
+    switch(policy)
     {
-        o_strides[0] = ostride;
-
-        size_t onembed_lengths[3];
-        for(int i = 0; i < rank; i++)
-            onembed_lengths[i] = onembed[rank - 1 - i];
-
-        for(int i = 1; i < rank; i++)
-            o_strides[i] = onembed_lengths[i - 1] * o_strides[i - 1];
+    case HIPFFT_WORKAREA_PER_PLAN:
+        unbind_work_area(plan);
+        plan->workAreaPolicy = policy;
+        if(plan->autoAllocate && plan->workBufferSize > 0 && !plan->workBufferNeedsFree)
+            return allocate_work_buffer(plan, plan->workBufferSize);
+        return HIPFFT_SUCCESS;
+    case HIPFFT_WORKAREA_DEFERRED:
+        // a buffer the plan already has can be kept until trimmed
+        unbind_work_area(plan);
+        plan->workAreaPolicy = policy;
+        return HIPFFT_SUCCESS;
+    case HIPFFT_WORKAREA_SHARED_PER_STREAM:
+        if(plan->autoAllocate)
+            HIP_FFT_CHECK_AND_RETURN(free_work_buffer(plan));
+        plan->workAreaPolicy = policy;
+        return HIPFFT_SUCCESS;
     }
-
-    desc.inArrayType  = in_array_type;
-    desc.outArrayType = out_array_type;
-
-    for(int i = 0; i < rank; i++)
-        desc.inStrides[i] = i_strides[i];
-    desc.inDist = idist;
-
-    for(int i = 0; i < rank; i++)
-        desc.outStrides[i] = o_strides[i];
-    desc.outDist = odist;
-
-    hipfftResult ret = hipfftMakePlan_internal(
-        plan, rank, lengths, type, number_of_transforms, &desc, workSize, re_calc_strides_in_desc);
-
-    return ret;
-}
-
-hipfftResult hipfftMakePlanMany(hipfftHandle plan,
-                                int          rank,
-                                int*         n,
-                                int*         inembed,
-                                int          istride,
-                                int          idist,
-                                int*         onembed,
-                                int          ostride,
-                                int          odist,
-                                hipfftType   type,
-                                int          batch,
-                                size_t*      workSize)
-try
-{
-    hipfftIOType iotype;
-    HIP_FFT_CHECK_AND_RETURN(iotype.init(type));
-
-    return hipfftMakePlanMany_internal<int>(
-        plan, rank, n, inembed, istride, idist, onembed, ostride, odist, iotype, batch, workSize);
+    return HIPFFT_INVALID_VALUE;
 }
 catch(hipfftResult e)
 {
@@ -1169,25 +2204,13 @@ catch(...)
     return HIPFFT_INTERNAL_ERROR;
 }
 
-hipfftResult hipfftMakePlanMany64(hipfftHandle   plan,
-                                  int            rank,
-                                  long long int* n,
-                                  long long int* inembed,
-                                  long long int  istride,
-                                  long long int  idist,
-                                  long long int* onembed,
-                                  long long int  ostride,
-                                  long long int  odist,
-                                  hipfftType     type,
-                                  long long int  batch,
-                                  size_t*        workSize)
+hipfftResult hipfftExtGetWorkAreaStats(hipfftExtWorkAreaStats* stats)
 try
 {
-    hipfftIOType iotype;
-    HIP_FFT_CHECK_AND_RETURN(iotype.init(type));
-
-    return hipfftMakePlanMany_internal<long long int>(
-        plan, rank, n, inembed, istride, idist, onembed, ostride, odist, iotype, batch, workSize);
+    if(!stats)
+        return HIPFFT_INVALID_VALUE;
+    hipfft_work_area_arena::get().get_stats(*stats);
+    return HIPFFT_SUCCESS;
 }
 catch(hipfftResult e)
 {
@@ -1198,12 +2221,33 @@ catch(...)
     return HIPFFT_INTERNAL_ERROR;
 }
 
-hipfftResult hipfftEstimate1d(int nx, hipfftType type, int batch, size_t* workSize)
+// release the work area of a plan whose work area is shared or
+// deferred, so that it's set up again on the next exec
+static hipfftResult trim_work_area(hipfftHandle plan)
+{
+    if(!plan->autoAllocate)
+        return HIPFFT_SUCCESS;
+    switch(plan->workAreaPolicy)
+    {
+    case HIPFFT_WORKAREA_PER_PLAN:
+        break;
+    case HIPFFT_WORKAREA_DEFERRED:
+        return free_work_buffer(plan);
+    case HIPFFT_WORKAREA_SHARED_PER_STREAM:
+        unbind_work_area(plan);
+        break;
+    }
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftExtTrimMemory(hipfftHandle plan)
 try
 {
-    hipfftHandle plan = nullptr;
-    hipfftResult ret  = hipfftGetSize1d(plan, nx, type, batch, workSize);
-    return ret;
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    wait_for_plan(plan);
+    std::lock_guard<std::mutex> lock(plan->mutex);
+    return trim_work_area(plan);
 }
 catch(hipfftResult e)
 {
@@ -1214,27 +2258,30 @@ catch(...)
     return HIPFFT_INTERNAL_ERROR;
 }
 
-hipfftResult hipfftEstimate2d(int nx, int ny, hipfftType type, size_t* workSize)
+hipfftResult hipfftExtTrimAllMemory(double idleSeconds)
 try
 {
-    hipfftHandle plan = nullptr;
-    hipfftResult ret  = hipfftGetSize2d(plan, nx, ny, type, workSize);
-    return ret;
-}
-catch(hipfftResult e)
-{
-    return e;
-}
-catch(...)
-{
-    return HIPFFT_INTERNAL_ERROR;
-}
+    if(!(idleSeconds >= 0.0))
+        return HIPFFT_INVALID_VALUE;
 
-hipfftResult hipfftEstimate3d(int nx, int ny, int nz, hipfftType type, size_t* workSize)
-try
-{
-    hipfftHandle plan = nullptr;
-    hipfftResult ret  = hipfftGetSize3d(plan, nx, ny, nz, type, workSize);
+    const auto now = std::chrono::steady_clock::now();
+
+    auto&                       live = hipfft_live_handles::get();
+    std::lock_guard<std::mutex> live_lock(live.mutex);
+    hipfftResult                ret = HIPFFT_SUCCESS;
+    for(auto plan : live.handles)
+    {
+        // plans still being made have nothing to trim yet
+        if(plan_pending(plan))
+            continue;
+        std::lock_guard<std::mutex>   lock(plan->mutex);
+        std::chrono::duration<double> idle = now - plan->lastExec;
+        if(idle.count() < idleSeconds)
+            continue;
+        auto plan_ret = trim_work_area(plan);
+        if(plan_ret != HIPFFT_SUCCESS)
+            ret = plan_ret;
+    }
     return ret;
 }
 catch(hipfftResult e)
@@ -1246,47 +2293,197 @@ catch(...)
     return HIPFFT_INTERNAL_ERROR;
 }
 
-hipfftResult hipfftEstimateMany(int        rank,
-                                int*       n,
-                                int*       inembed,
-                                int        istride,
-                                int        idist,
-                                int*       onembed,
-                                int        ostride,
-                                int        odist,
-                                hipfftType type,
-                                int        batch,
-                                size_t*    workSize)
-try
-{
-    hipfftHandle plan = nullptr;
-    hipfftResult ret  = hipfftGetSizeMany(
-        plan, rank, n, inembed, istride, idist, onembed, ostride, odist, type, batch, workSize);
-    return ret;
-}
-catch(hipfftResult e)
+// Encoding of plans for hipfftExtPlanSerialize.  Values are written
+// in host byte order - the fingerprint rejects blobs from other
+// systems anyway.
+class hipfft_blob_writer
 {
-    return e;
-}
-catch(...)
+public:
+    template <typename T>
+    void write(const T& val)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "blob values must be trivial");
+        const char* bytes = reinterpret_cast<const char*>(&val);
+        data.insert(data.end(), bytes, bytes + sizeof(T));
+    }
+
+    template <typename T>
+    void write(const std::vector<T>& vals)
+    {
+        write<uint64_t>(vals.size());
+        for(const auto& val : vals)
+            write(val);
+    }
+
+    void write(const std::string& str)
+    {
+        write(std::vector<char>(str.begin(), str.end()));
+    }
+
+    std::vector<char> data;
+};
+
+class hipfft_blob_reader
 {
-    return HIPFFT_INTERNAL_ERROR;
+public:
+    hipfft_blob_reader(const void* buffer, size_t size)
+        : pos(static_cast<const char*>(buffer))
+        , end(pos + size)
+    {
+    }
+
+    // throws HIPFFT_INVALID_VALUE if the blob is truncated
+    template <typename T>
+    T read()
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "blob values must be trivial");
+        if(static_cast<size_t>(end - pos) < sizeof(T))
+            throw HIPFFT_INVALID_VALUE;
+        T val;
+        std::memcpy(&val, pos, sizeof(T));
+        pos += sizeof(T);
+        return val;
+    }
+
+    template <typename T>
+    std::vector<T> read_vector()
+    {
+        const auto count = read<uint64_t>();
+        if(count > static_cast<size_t>(end - pos) / sizeof(T))
+            throw HIPFFT_INVALID_VALUE;
+        std::vector<T> vals;
+        vals.reserve(count);
+        for(size_t i = 0; i < count; ++i)
+            vals.push_back(read<T>());
+        return vals;
+    }
+
+    std::string read_string()
+    {
+        auto chars = read_vector<char>();
+        return std::string(chars.begin(), chars.end());
+    }
+
+    bool at_end() const
+    {
+        return pos == end;
+    }
+
+private:
+    const char* pos;
+    const char* end;
+};
+
+static const uint32_t HIPFFT_PLAN_BLOB_MAGIC     = 0x4c504648; // "HFPL"
+static const uint32_t HIPFFT_PLAN_BLOB_VERSION   = 6;
+static const uint32_t HIPFFT_KERNEL_BLOB_MAGIC   = 0x434b4648; // "HFKC"
+static const uint32_t HIPFFT_KERNEL_BLOB_VERSION = 1;
+
+// Identifies the library versions and device architectures that a
+// serialized plan is valid for: the current device, plus the devices
+// of a multi-device plan.
+static std::string plan_fingerprint(const std::vector<int>& brick_devices)
+{
+    char rocfft_version[256];
+    if(rocfft_get_version_string(rocfft_version, sizeof(rocfft_version)) != rocfft_status_success)
+        throw HIPFFT_INTERNAL_ERROR;
+
+    std::ostringstream fingerprint;
+    fingerprint << "hipfft " << hipfftVersionMajor << "." << hipfftVersionMinor << "."
+                << hipfftVersionPatch << "; rocfft " << rocfft_version;
+
+    int current = 0;
+    if(hipGetDevice(&current) != hipSuccess)
+        throw HIPFFT_INVALID_DEVICE;
+    std::vector<int> devices = {current};
+    devices.insert(devices.end(), brick_devices.begin(), brick_devices.end());
+    for(auto device : devices)
+    {
+        hipDeviceProp_t prop;
+        if(hipGetDeviceProperties(&prop, device) != hipSuccess)
+            throw HIPFFT_INVALID_DEVICE;
+        fingerprint << "; " << prop.gcnArchName;
+    }
+    return fingerprint.str();
 }
 
-hipfftResult
-    hipfftGetSize1d(hipfftHandle plan, int nx, hipfftType type, int batch, size_t* workSize)
-try
+// complex type that a transform with the given precision executes in
+static hipDataType exec_type(rocfft_precision precision)
 {
-    if(nx < 0 || batch < 0)
+    switch(precision)
     {
-        return HIPFFT_INVALID_SIZE;
+    case rocfft_precision_half:
+        return HIP_C_16F;
+    case rocfft_precision_single:
+        return HIP_C_32F;
+    case rocfft_precision_double:
+        return HIP_C_64F;
     }
+    throw HIPFFT_INVALID_VALUE;
+}
 
-    hipfftHandle p;
-    HIP_FFT_CHECK_AND_RETURN(hipfftCreate(&p));
-    HIP_FFT_CHECK_AND_RETURN(hipfftMakePlan1d(p, nx, type, batch, workSize));
-    HIP_FFT_CHECK_AND_RETURN(hipfftDestroy(p));
+hipfftResult hipfftExtPlanSerialize(hipfftHandle plan, void** buffer, size_t* bufferSize)
+try
+{
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    wait_for_plan(plan);
+    if(plan->lengths.empty())
+        return HIPFFT_INVALID_PLAN;
+    if(!buffer || !bufferSize)
+        return HIPFFT_INVALID_VALUE;
 
+    std::vector<int> brick_devices;
+    for(const auto& brick : plan->inBricks)
+        brick_devices.push_back(brick.device);
+
+    // which of the rocFFT plans exist
+    uint32_t placements = 0;
+    if(plan->ip_forward)
+        placements |= 1;
+    if(plan->op_forward)
+        placements |= 2;
+    if(plan->ip_inverse)
+        placements |= 4;
+    if(plan->op_inverse)
+        placements |= 8;
+
+    // ops that multiply by an array hold a device pointer, which
+    // can't be restored in another process
+    if(plan->loadOp.op == HIPFFT_OP_MULTIPLY || plan->storeOp.op == HIPFFT_OP_MULTIPLY)
+        return HIPFFT_NOT_SUPPORTED;
+
+    hipfft_blob_writer blob;
+    blob.write(HIPFFT_PLAN_BLOB_MAGIC);
+    blob.write(HIPFFT_PLAN_BLOB_VERSION);
+    blob.write(plan_fingerprint(brick_devices));
+    blob.write(plan->type.inputType);
+    blob.write(plan->type.outputType);
+    blob.write(exec_type(plan->type.precision()));
+    blob.write(plan->lengths);
+    blob.write(plan->batch);
+    blob.write(plan->layout);
+    blob.write(plan->scale_factor);
+    blob.write(brick_devices);
+    blob.write(plan->brickWeights);
+    blob.write(plan->inUserBricks);
+    blob.write(plan->outUserBricks);
+    blob.write<uint64_t>(plan->pencilRows);
+    blob.write<uint64_t>(plan->pencilColumns);
+    blob.write<uint8_t>(plan->lazy_create);
+    blob.write<uint8_t>(plan->autoAllocate);
+    blob.write<int32_t>(plan->workAreaPolicy);
+    blob.write(placements);
+    blob.write<int32_t>(plan->loadOp.op);
+    blob.write(plan->loadOp.param);
+    blob.write<int32_t>(plan->storeOp.op);
+    blob.write(plan->storeOp.param);
+
+    *buffer = std::malloc(blob.data.size());
+    if(!*buffer)
+        return HIPFFT_ALLOC_FAILED;
+    std::memcpy(*buffer, blob.data.data(), blob.data.size());
+    *bufferSize = blob.data.size();
     return HIPFFT_SUCCESS;
 }
 catch(hipfftResult e)
@@ -1298,19 +2495,10 @@ catch(...)
     return HIPFFT_INTERNAL_ERROR;
 }
 
-hipfftResult hipfftGetSize2d(hipfftHandle plan, int nx, int ny, hipfftType type, size_t* workSize)
+hipfftResult hipfftExtPlanBufferFree(void* buffer)
 try
 {
-    if(nx < 0 || ny < 0)
-    {
-        return HIPFFT_INVALID_SIZE;
-    }
-
-    hipfftHandle p;
-    HIP_FFT_CHECK_AND_RETURN(hipfftCreate(&p));
-    HIP_FFT_CHECK_AND_RETURN(hipfftMakePlan2d(p, nx, ny, type, workSize));
-    HIP_FFT_CHECK_AND_RETURN(hipfftDestroy(p));
-
+    std::free(buffer);
     return HIPFFT_SUCCESS;
 }
 catch(hipfftResult e)
@@ -1322,20 +2510,140 @@ catch(...)
     return HIPFFT_INTERNAL_ERROR;
 }
 
-hipfftResult
-    hipfftGetSize3d(hipfftHandle plan, int nx, int ny, int nz, hipfftType type, size_t* workSize)
+hipfftResult hipfftExtPlanDeserialize(hipfftHandle plan,
+                                      const void*  buffer,
+                                      size_t       bufferSize,
+                                      size_t*      workSize)
 try
 {
-    if(nx < 0 || ny < 0 || nz < 0)
+    // like hipfftMakePlan*, this needs a handle that has no plan yet
+    if(!plan || plan->pending.valid() || !plan->lengths.empty())
+        return HIPFFT_INVALID_PLAN;
+    if(!buffer)
+        return HIPFFT_INVALID_VALUE;
+
+    // read and validate everything before modifying the handle
+    hipfft_blob_reader blob(buffer, bufferSize);
+    if(blob.read<uint32_t>() != HIPFFT_PLAN_BLOB_MAGIC
+       || blob.read<uint32_t>() != HIPFFT_PLAN_BLOB_VERSION)
+        return HIPFFT_INVALID_VALUE;
+    const auto fingerprint   = blob.read_string();
+    const auto inputType     = blob.read<hipDataType>();
+    const auto outputType    = blob.read<hipDataType>();
+    const auto executionType = blob.read<hipDataType>();
+    auto       lengths       = blob.read_vector<size_t>();
+    const auto batch         = blob.read<size_t>();
+    const auto layout        = blob.read_vector<size_t>();
+    const auto scale_factor  = blob.read<double>();
+    const auto brick_devices = blob.read_vector<int>();
+    auto       brick_weights = blob.read_vector<double>();
+    auto       in_user       = blob.read_vector<hipfftExtBrick>();
+    auto       out_user      = blob.read_vector<hipfftExtBrick>();
+    const auto pencil_rows   = blob.read<uint64_t>();
+    const auto pencil_cols   = blob.read<uint64_t>();
+    const bool lazy_create   = blob.read<uint8_t>() != 0;
+    const bool autoAllocate  = blob.read<uint8_t>() != 0;
+    const auto policy        = static_cast<hipfftExtWorkAreaPolicy>(blob.read<int32_t>());
+    const auto placements    = blob.read<uint32_t>();
+    const auto load_op       = static_cast<hipfftExtOp>(blob.read<int32_t>());
+    const auto load_param    = blob.read<double>();
+    const auto store_op      = static_cast<hipfftExtOp>(blob.read<int32_t>());
+    const auto store_param   = blob.read<double>();
+    if(!blob.at_end() || in_user.size() != out_user.size()
+       || (!in_user.empty() && in_user.size() != brick_devices.size()))
+        return HIPFFT_INVALID_VALUE;
+    for(auto op : {load_op, store_op})
     {
-        return HIPFFT_INVALID_SIZE;
+        if(op < HIPFFT_OP_NONE || op > HIPFFT_OP_POWER || op == HIPFFT_OP_MULTIPLY)
+            return HIPFFT_INVALID_VALUE;
+    }
+
+    // blobs from other library versions or devices are stale
+    if(fingerprint != plan_fingerprint(brick_devices))
+        return HIPFFT_NOT_SUPPORTED;
+
+    hipfftIOType iotype;
+    HIP_FFT_CHECK_AND_RETURN(iotype.init(inputType, outputType, executionType));
+
+    switch(policy)
+    {
+    case HIPFFT_WORKAREA_PER_PLAN:
+    case HIPFFT_WORKAREA_SHARED_PER_STREAM:
+    case HIPFFT_WORKAREA_DEFERRED:
+        break;
+    default:
+        return HIPFFT_INVALID_VALUE;
+    }
+
+    const size_t dim = lengths.size();
+    if(dim < 1 || dim > 3)
+        return HIPFFT_INVALID_VALUE;
+
+    // the layout is the description that was passed to
+    // hipfftMakePlan_internal, if any
+    hipfft_plan_description_t  desc;
+    hipfft_plan_description_t* desc_ptr = nullptr;
+    bool                       re_calc  = false;
+    if(!layout.empty())
+    {
+        if(layout.size() != 5 + 2 * dim)
+            return HIPFFT_INVALID_VALUE;
+        re_calc           = layout[0] != 0;
+        desc.inArrayType  = static_cast<rocfft_array_type>(layout[1]);
+        desc.outArrayType = static_cast<rocfft_array_type>(layout[2]);
+        desc.inDist       = layout[3];
+        desc.outDist      = layout[4];
+        std::copy_n(layout.begin() + 5, dim, desc.inStrides);
+        std::copy_n(layout.begin() + 5 + dim, dim, desc.outStrides);
+        desc_ptr = &desc;
     }
 
-    hipfftHandle p;
-    HIP_FFT_CHECK_AND_RETURN(hipfftCreate(&p));
-    HIP_FFT_CHECK_AND_RETURN(hipfftMakePlan3d(p, nx, ny, nz, type, workSize));
-    HIP_FFT_CHECK_AND_RETURN(hipfftDestroy(p));
+    plan->scale_factor   = scale_factor;
+    plan->lazy_create    = lazy_create;
+    plan->autoAllocate   = autoAllocate;
+    plan->workAreaPolicy = policy;
+    plan->inBricks.resize(brick_devices.size());
+    plan->outBricks.resize(brick_devices.size());
+    for(size_t i = 0; i < brick_devices.size(); ++i)
+    {
+        plan->inBricks[i].device  = brick_devices[i];
+        plan->outBricks[i].device = brick_devices[i];
+    }
+    // the weights the plan was made with reproduce its bricks
+    plan->decomposition
+        = brick_weights.empty() ? HIPFFT_DECOMPOSITION_EVEN : HIPFFT_DECOMPOSITION_WEIGHTED;
+    plan->brickWeights  = std::move(brick_weights);
+    plan->inUserBricks  = std::move(in_user);
+    plan->outUserBricks = std::move(out_user);
+    plan->pencilRows    = pencil_rows;
+    plan->pencilColumns = pencil_cols;
+
+    HIP_FFT_CHECK_AND_RETURN(hipfftMakePlan_internal(
+        plan, dim, lengths.data(), iotype, batch, desc_ptr, nullptr, re_calc));
+
+    // ops are validated again as they're set, in case the blob was
+    // altered
+    if(load_op != HIPFFT_OP_NONE)
+        HIP_FFT_CHECK_AND_RETURN(set_op(plan, true, load_op, load_param, nullptr));
+    if(store_op != HIPFFT_OP_NONE)
+        HIP_FFT_CHECK_AND_RETURN(set_op(plan, false, store_op, store_param, nullptr));
+
+    // lazy plans get back the rocFFT plans that had been created
+    // when the plan was serialized
+    if(plan->lazy_create && placements != 0)
+    {
+        if(placements & 1)
+            create_exec_plan(plan, true, true);
+        if(placements & 2)
+            create_exec_plan(plan, false, true);
+        if(placements & 4)
+            create_exec_plan(plan, true, false);
+        if(placements & 8)
+            create_exec_plan(plan, false, false);
+        HIP_FFT_CHECK_AND_RETURN(update_work_buffer(plan));
+    }
 
+    report_work_size(plan, workSize);
     return HIPFFT_SUCCESS;
 }
 catch(hipfftResult e)
@@ -1347,26 +2655,34 @@ catch(...)
     return HIPFFT_INTERNAL_ERROR;
 }
 
-hipfftResult hipfftGetSizeMany(hipfftHandle plan,
-                               int          rank,
-                               int*         n,
-                               int*         inembed,
-                               int          istride,
-                               int          idist,
-                               int*         onembed,
-                               int          ostride,
-                               int          odist,
-                               hipfftType   type,
-                               int          batch,
-                               size_t*      workSize)
+hipfftResult hipfftExtKernelCacheSerialize(void** buffer, size_t* bufferSize)
 try
 {
-    hipfftHandle p;
-    HIP_FFT_CHECK_AND_RETURN(
-        hipfftPlanMany(&p, rank, n, inembed, istride, idist, onembed, ostride, odist, type, batch));
-    *workSize = p->workBufferSize;
-    HIP_FFT_CHECK_AND_RETURN(hipfftDestroy(p));
+    if(!buffer || !bufferSize)
+        return HIPFFT_INVALID_VALUE;
 
+    // rocFFT exports the kernels it has compiled at runtime, for all
+    // plans in the process
+    setup_rocfft();
+    void*  kernel_buffer      = nullptr;
+    size_t kernel_buffer_size = 0;
+    if(rocfft_cache_serialize(&kernel_buffer, &kernel_buffer_size) != rocfft_status_success)
+        return HIPFFT_INTERNAL_ERROR;
+    auto              kernel_bytes = static_cast<const char*>(kernel_buffer);
+    std::vector<char> kernels(kernel_bytes, kernel_bytes + kernel_buffer_size);
+    rocfft_cache_buffer_free(kernel_buffer);
+
+    hipfft_blob_writer blob;
+    blob.write(HIPFFT_KERNEL_BLOB_MAGIC);
+    blob.write(HIPFFT_KERNEL_BLOB_VERSION);
+    blob.write(plan_fingerprint({}));
+    blob.write(kernels);
+
+    *buffer = std::malloc(blob.data.size());
+    if(!*buffer)
+        return HIPFFT_ALLOC_FAILED;
+    std::memcpy(*buffer, blob.data.data(), blob.data.size());
+    *bufferSize = blob.data.size();
     return HIPFFT_SUCCESS;
 }
 catch(hipfftResult e)
@@ -1378,26 +2694,27 @@ catch(...)
     return HIPFFT_INTERNAL_ERROR;
 }
 
-hipfftResult hipfftGetSizeMany64(hipfftHandle   plan,
-                                 int            rank,
-                                 long long int* n,
-                                 long long int* inembed,
-                                 long long int  istride,
-                                 long long int  idist,
-                                 long long int* onembed,
-                                 long long int  ostride,
-                                 long long int  odist,
-                                 hipfftType     type,
-                                 long long int  batch,
-                                 size_t*        workSize)
+hipfftResult hipfftExtKernelCacheDeserialize(const void* buffer, size_t bufferSize)
 try
 {
-    hipfftHandle p = nullptr;
-    HIP_FFT_CHECK_AND_RETURN(hipfftPlanMany64(
-        &p, rank, n, inembed, istride, idist, onembed, ostride, odist, type, batch));
-    *workSize = p->workBufferSize;
-    HIP_FFT_CHECK_AND_RETURN(hipfftDestroy(p));
+    if(!buffer)
+        return HIPFFT_INVALID_VALUE;
+
+    hipfft_blob_reader blob(buffer, bufferSize);
+    if(blob.read<uint32_t>() != HIPFFT_KERNEL_BLOB_MAGIC
+       || blob.read<uint32_t>() != HIPFFT_KERNEL_BLOB_VERSION)
+        return HIPFFT_INVALID_VALUE;
+    const auto fingerprint = blob.read_string();
+    const auto kernels     = blob.read_vector<char>();
+    if(!blob.at_end())
+        return HIPFFT_INVALID_VALUE;
+    if(fingerprint != plan_fingerprint({}))
+        return HIPFFT_NOT_SUPPORTED;
 
+    setup_rocfft();
+    if(!kernels.empty()
+       && rocfft_cache_deserialize(kernels.data(), kernels.size()) != rocfft_status_success)
+        return HIPFFT_INVALID_VALUE;
     return HIPFFT_SUCCESS;
 }
 catch(hipfftResult e)
@@ -1409,11 +2726,25 @@ catch(...)
     return HIPFFT_INTERNAL_ERROR;
 }
 
-hipfftResult hipfftGetSize(hipfftHandle plan, size_t* workSize)
+hipfftResult
+    hipfftMakePlan1d(hipfftHandle plan, int nx, hipfftType type, int batch, size_t* workSize)
 try
 {
-    *workSize = plan->workBufferSize;
-    return HIPFFT_SUCCESS;
+    if(nx < 0 || batch < 0)
+    {
+        return HIPFFT_INVALID_SIZE;
+    }
+
+    size_t lengths[1];
+    lengths[0]                                      = nx;
+    size_t                     number_of_transforms = batch;
+    hipfft_plan_description_t* desc                 = nullptr;
+
+    hipfftIOType iotype;
+    HIP_FFT_CHECK_AND_RETURN(iotype.init(type));
+
+    return hipfftMakePlan_internal(
+        plan, 1, lengths, iotype, number_of_transforms, desc, workSize, false);
 }
 catch(hipfftResult e)
 {
@@ -1424,12 +2755,25 @@ catch(...)
     return HIPFFT_INTERNAL_ERROR;
 }
 
-hipfftResult hipfftSetAutoAllocation(hipfftHandle plan, int autoAllocate)
+hipfftResult hipfftMakePlan2d(hipfftHandle plan, int nx, int ny, hipfftType type, size_t* workSize)
 try
 {
-    if(plan != nullptr)
-        plan->autoAllocate = bool(autoAllocate);
-    return HIPFFT_SUCCESS;
+    if(nx < 0 || ny < 0)
+    {
+        return HIPFFT_INVALID_SIZE;
+    }
+
+    size_t lengths[2];
+    lengths[0]                                      = ny;
+    lengths[1]                                      = nx;
+    size_t                     number_of_transforms = 1;
+    hipfft_plan_description_t* desc                 = nullptr;
+
+    hipfftIOType iotype;
+    HIP_FFT_CHECK_AND_RETURN(iotype.init(type));
+
+    return hipfftMakePlan_internal(
+        plan, 2, lengths, iotype, number_of_transforms, desc, workSize, false);
 }
 catch(hipfftResult e)
 {
@@ -1440,21 +2784,27 @@ catch(...)
     return HIPFFT_INTERNAL_ERROR;
 }
 
-hipfftResult hipfftSetWorkArea(hipfftHandle plan, void* workArea)
+hipfftResult
+    hipfftMakePlan3d(hipfftHandle plan, int nx, int ny, int nz, hipfftType type, size_t* workSize)
 try
 {
-    if(plan->workBuffer && plan->workBufferNeedsFree)
-    {
-        if(hipFree(plan->workBuffer) != hipSuccess)
-            throw std::runtime_error("hipFree(plan->workBuffer) failed");
-    }
-    plan->workBufferNeedsFree = false;
-    if(workArea)
+    if(nx < 0 || ny < 0 || nz < 0)
     {
-        ROC_FFT_CHECK_INVALID_VALUE(
-            rocfft_execution_info_set_work_buffer(plan->info, workArea, plan->workBufferSize));
+        return HIPFFT_INVALID_SIZE;
     }
-    return HIPFFT_SUCCESS;
+
+    size_t lengths[3];
+    lengths[0]                                      = nz;
+    lengths[1]                                      = ny;
+    lengths[2]                                      = nx;
+    size_t                     number_of_transforms = 1;
+    hipfft_plan_description_t* desc                 = nullptr;
+
+    hipfftIOType iotype;
+    HIP_FFT_CHECK_AND_RETURN(iotype.init(type));
+
+    return hipfftMakePlan_internal(
+        plan, 3, lengths, iotype, number_of_transforms, desc, workSize, false);
 }
 catch(hipfftResult e)
 {
@@ -1465,60 +2815,132 @@ catch(...)
     return HIPFFT_INTERNAL_ERROR;
 }
 
-// Find the specific plan to execute - check placement and direction
-static rocfft_plan get_exec_plan(const hipfftHandle plan, const bool inplace, const int direction)
+template <typename T>
+hipfftResult hipfftMakePlanMany_internal(hipfftHandle plan,
+                                         int          rank,
+                                         T*           n,
+                                         T*           inembed,
+                                         T            istride,
+                                         T            idist,
+                                         T*           onembed,
+                                         T            ostride,
+                                         T            odist,
+                                         hipfftIOType type,
+                                         T            batch,
+                                         size_t*      workSize)
 {
-    switch(direction)
+    if((inembed != nullptr && onembed == nullptr) || (inembed == nullptr && onembed != nullptr)
+       || (rank < 0) || (istride < 0) || (idist < 0) || (ostride < 0) || (odist < 0)
+       || (std::any_of(n, n + rank, [](T val) { return val < 0; })))
+        return HIPFFT_INVALID_VALUE;
+
+    for(auto ptr : {inembed, onembed})
     {
-    case HIPFFT_FORWARD:
-        return inplace ? plan->ip_forward : plan->op_forward;
-    case HIPFFT_BACKWARD:
-        return inplace ? plan->ip_inverse : plan->op_inverse;
+        if(ptr == nullptr)
+            continue;
+        if(std::any_of(ptr, ptr + rank, [](T val) { return val < 0; }))
+            return HIPFFT_INVALID_SIZE;
     }
-    return nullptr;
-}
 
-static hipfftResult hipfftExec(const rocfft_plan&           rplan,
-                               const rocfft_execution_info& rinfo,
-                               void*                        idata,
-                               void*                        odata)
-{
-    if(!rplan)
-        return HIPFFT_EXEC_FAILED;
-    if(!idata || !odata)
-        return HIPFFT_EXEC_FAILED;
-    void*      in[1]  = {(void*)idata};
-    void*      out[1] = {(void*)odata};
-    const auto ret    = rocfft_execute(rplan, in, out, rinfo);
-    return ret == rocfft_status_success ? HIPFFT_SUCCESS : HIPFFT_EXEC_FAILED;
-}
+    if(batch < 0)
+        return HIPFFT_INVALID_SIZE;
 
-static hipfftResult hipfftExecForward(hipfftHandle plan, void* idata, void* odata)
-{
-    const bool inplace = idata == odata;
-    const auto rplan   = get_exec_plan(plan, inplace, HIPFFT_FORWARD);
-    return hipfftExec(rplan, plan->info, idata, odata);
-}
+    size_t lengths[3];
+    for(int i = 0; i < rank; i++)
+        lengths[i] = n[rank - 1 - i];
 
-static hipfftResult hipfftExecBackward(hipfftHandle plan, void* idata, void* odata)
-{
-    const bool inplace = idata == odata;
-    const auto rplan   = get_exec_plan(plan, inplace, HIPFFT_BACKWARD);
-    return hipfftExec(rplan, plan->info, idata, odata);
+    size_t number_of_transforms = batch;
+
+    // Decide the inArrayType and outArrayType based on the transform type
+    rocfft_array_type in_array_type, out_array_type;
+    if(type.is_real_to_complex())
+    {
+        in_array_type  = rocfft_array_type_real;
+        out_array_type = rocfft_array_type_hermitian_interleaved;
+    }
+    else if(type.is_complex_to_real())
+    {
+        in_array_type  = rocfft_array_type_hermitian_interleaved;
+        out_array_type = rocfft_array_type_real;
+    }
+    else
+    {
+        in_array_type  = rocfft_array_type_complex_interleaved;
+        out_array_type = rocfft_array_type_complex_interleaved;
+    }
+
+    hipfft_plan_description_t desc;
+
+    bool re_calc_strides_in_desc = (inembed == nullptr) || (onembed == nullptr);
+
+    size_t i_strides[3] = {1, 1, 1};
+    size_t o_strides[3] = {1, 1, 1};
+    for(int i = 1; i < rank; i++)
+    {
+        i_strides[i] = lengths[i - 1] * i_strides[i - 1];
+        o_strides[i] = lengths[i - 1] * o_strides[i - 1];
+    }
+
+    if(inembed != nullptr)
+    {
+        i_strides[0] = istride;
+
+        size_t inembed_lengths[3];
+        for(int i = 0; i < rank; i++)
+            inembed_lengths[i] = inembed[rank - 1 - i];
+
+        for(int i = 1; i < rank; i++)
+            i_strides[i] = inembed_lengths[i - 1] * i_strides[i - 1];
+    }
+
+    if(onembed != nullptr)
+    {
+        o_strides[0] = ostride;
+
+        size_t onembed_lengths[3];
+        for(int i = 0; i < rank; i++)
+            onembed_lengths[i] = onembed[rank - 1 - i];
+
+        for(int i = 1; i < rank; i++)
+            o_strides[i] = onembed_lengths[i - 1] * o_strides[i - 1];
+    }
+
+    desc.inArrayType  = in_array_type;
+    desc.outArrayType = out_array_type;
+
+    for(int i = 0; i < rank; i++)
+        desc.inStrides[i] = i_strides[i];
+    desc.inDist = idist;
+
+    for(int i = 0; i < rank; i++)
+        desc.outStrides[i] = o_strides[i];
+    desc.outDist = odist;
+
+    hipfftResult ret = hipfftMakePlan_internal(
+        plan, rank, lengths, type, number_of_transforms, &desc, workSize, re_calc_strides_in_desc);
+
+    return ret;
 }
 
-hipfftResult
-    hipfftExecC2C(hipfftHandle plan, hipfftComplex* idata, hipfftComplex* odata, int direction)
+hipfftResult hipfftMakePlanMany(hipfftHandle plan,
+                                int          rank,
+                                int*         n,
+                                int*         inembed,
+                                int          istride,
+                                int          idist,
+                                int*         onembed,
+                                int          ostride,
+                                int          odist,
+                                hipfftType   type,
+                                int          batch,
+                                size_t*      workSize)
 try
 {
-    switch(direction)
-    {
-    case HIPFFT_FORWARD:
-        return hipfftExecForward(plan, idata, odata);
-    case HIPFFT_BACKWARD:
-        return hipfftExecBackward(plan, idata, odata);
-    }
-    return HIPFFT_EXEC_FAILED;
+    hipfftIOType iotype;
+    HIP_FFT_CHECK_AND_RETURN(iotype.init(type));
+
+    return hipfftMakePlanMany_internal<int>(
+        plan, rank, n, inembed, istride, idist, onembed, ostride, odist, iotype, batch, workSize);
 }
 catch(hipfftResult e)
 {
@@ -1529,10 +2951,25 @@ catch(...)
     return HIPFFT_INTERNAL_ERROR;
 }
 
-hipfftResult hipfftExecR2C(hipfftHandle plan, hipfftReal* idata, hipfftComplex* odata)
+hipfftResult hipfftMakePlanMany64(hipfftHandle   plan,
+                                  int            rank,
+                                  long long int* n,
+                                  long long int* inembed,
+                                  long long int  istride,
+                                  long long int  idist,
+                                  long long int* onembed,
+                                  long long int  ostride,
+                                  long long int  odist,
+                                  hipfftType     type,
+                                  long long int  batch,
+                                  size_t*        workSize)
 try
 {
-    return hipfftExecForward(plan, idata, odata);
+    hipfftIOType iotype;
+    HIP_FFT_CHECK_AND_RETURN(iotype.init(type));
+
+    return hipfftMakePlanMany_internal<long long int>(
+        plan, rank, n, inembed, istride, idist, onembed, ostride, odist, iotype, batch, workSize);
 }
 catch(hipfftResult e)
 {
@@ -1543,10 +2980,73 @@ catch(...)
     return HIPFFT_INTERNAL_ERROR;
 }
 
-hipfftResult hipfftExecC2R(hipfftHandle plan, hipfftComplex* idata, hipfftReal* odata)
+hipfftResult hipfftExtMakePlanManyAsync(hipfftHandle        plan,
+                                        int                 rank,
+                                        int*                n,
+                                        int*                inembed,
+                                        int                 istride,
+                                        int                 idist,
+                                        int*                onembed,
+                                        int                 ostride,
+                                        int                 odist,
+                                        hipfftType          type,
+                                        int                 batch,
+                                        hipfftExtPlanToken* token)
 try
 {
-    return hipfftExecBackward(plan, idata, odata);
+    if(!plan || plan->pending.valid())
+        return HIPFFT_INVALID_PLAN;
+    if(rank < 1 || rank > 3 || !n)
+        return HIPFFT_INVALID_VALUE;
+
+    // the caller's arrays needn't outlive this call
+    const auto         ranku = static_cast<size_t>(rank);
+    std::vector<int>   n_copy(n, n + ranku);
+    std::vector<int>   inembed_copy, onembed_copy;
+    if(inembed)
+        inembed_copy.assign(inembed, inembed + ranku);
+    if(onembed)
+        onembed_copy.assign(onembed, onembed + ranku);
+
+    // plan on the caller's device
+    int device = 0;
+    if(hipGetDevice(&device) != hipSuccess)
+        return HIPFFT_INVALID_DEVICE;
+
+    auto make = [=]() mutable {
+        hipfft_async_plan result;
+        if(hipSetDevice(device) != hipSuccess)
+        {
+            result.status = HIPFFT_INVALID_DEVICE;
+            return result;
+        }
+        result.workSize.resize(std::max<size_t>(plan->inBricks.size(), 1));
+        result.status = hipfftMakePlanMany(plan,
+                                           rank,
+                                           n_copy.data(),
+                                           inembed ? inembed_copy.data() : nullptr,
+                                           istride,
+                                           idist,
+                                           onembed ? onembed_copy.data() : nullptr,
+                                           ostride,
+                                           odist,
+                                           type,
+                                           batch,
+                                           result.workSize.data());
+        return result;
+    };
+
+    std::unique_ptr<hipfftExtPlanToken_t> new_token;
+    if(token)
+        new_token = std::make_unique<hipfftExtPlanToken_t>();
+
+    plan->pending = std::async(std::launch::async, make).share();
+    if(token)
+    {
+        new_token->result = plan->pending;
+        *token            = new_token.release();
+    }
+    return HIPFFT_SUCCESS;
 }
 catch(hipfftResult e)
 {
@@ -1557,20 +3057,14 @@ catch(...)
     return HIPFFT_INTERNAL_ERROR;
 }
 
-hipfftResult hipfftExecZ2Z(hipfftHandle         plan,
-                           hipfftDoubleComplex* idata,
-                           hipfftDoubleComplex* odata,
-                           int                  direction)
+hipfftResult hipfftExtPlanTokenQuery(hipfftExtPlanToken token)
 try
 {
-    switch(direction)
-    {
-    case HIPFFT_FORWARD:
-        return hipfftExecForward(plan, idata, odata);
-    case HIPFFT_BACKWARD:
-        return hipfftExecBackward(plan, idata, odata);
-    }
-    return HIPFFT_EXEC_FAILED;
+    if(!token)
+        return HIPFFT_INVALID_VALUE;
+    if(token->result.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        return HIPFFT_PLAN_NOT_READY;
+    return token->result.get().status;
 }
 catch(hipfftResult e)
 {
@@ -1581,10 +3075,15 @@ catch(...)
     return HIPFFT_INTERNAL_ERROR;
 }
 
-hipfftResult hipfftExecD2Z(hipfftHandle plan, hipfftDoubleReal* idata, hipfftDoubleComplex* odata)
+hipfftResult hipfftExtPlanTokenWait(hipfftExtPlanToken token, size_t* workSize)
 try
 {
-    return hipfftExecForward(plan, idata, odata);
+    if(!token)
+        return HIPFFT_INVALID_VALUE;
+    const auto& result = token->result.get();
+    if(workSize)
+        std::copy(result.workSize.begin(), result.workSize.end(), workSize);
+    return result.status;
 }
 catch(hipfftResult e)
 {
@@ -1595,10 +3094,11 @@ catch(...)
     return HIPFFT_INTERNAL_ERROR;
 }
 
-hipfftResult hipfftExecZ2D(hipfftHandle plan, hipfftDoubleComplex* idata, hipfftDoubleReal* odata)
+hipfftResult hipfftExtPlanTokenDestroy(hipfftExtPlanToken token)
 try
 {
-    return hipfftExecBackward(plan, idata, odata);
+    delete token;
+    return HIPFFT_SUCCESS;
 }
 catch(hipfftResult e)
 {
@@ -1609,10 +3109,14 @@ catch(...)
     return HIPFFT_INTERNAL_ERROR;
 }
 
-hipfftResult hipfftSetStream(hipfftHandle plan, hipStream_t stream)
+hipfftResult hipfftExtSetNotReadyPolicy(hipfftHandle plan, hipfftExtNotReadyPolicy policy)
 try
 {
-    ROC_FFT_CHECK_INVALID_VALUE(rocfft_execution_info_set_stream(plan->info, stream));
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    if(policy != HIPFFT_NOT_READY_WAIT && policy != HIPFFT_NOT_READY_RETURN)
+        return HIPFFT_INVALID_VALUE;
+    plan->notReadyPolicy = policy;
     return HIPFFT_SUCCESS;
 }
 catch(hipfftResult e)
@@ -1624,33 +3128,185 @@ catch(...)
     return HIPFFT_INTERNAL_ERROR;
 }
 
-hipfftResult hipfftDestroy(hipfftHandle plan)
-try
+// how hipfftEstimate* and hipfftGetSize* compute work sizes
+static std::atomic<hipfftExtEstimateMode> estimate_mode{HIPFFT_ESTIMATE_ANALYTIC};
+
+// rocFFT has kernels for lengths that factor into these primes.
+// Other lengths need Bluestein's algorithm.
+static bool needs_bluestein(size_t length)
 {
-    if(plan != nullptr)
+    if(length <= 1)
+        return false;
+    for(size_t factor : {2, 3, 5, 7, 11, 13, 17})
     {
-        if(plan->ip_forward != nullptr)
-            ROC_FFT_CHECK_INVALID_VALUE(rocfft_plan_destroy(plan->ip_forward));
-        if(plan->op_forward != nullptr)
-            ROC_FFT_CHECK_INVALID_VALUE(rocfft_plan_destroy(plan->op_forward));
-        if(plan->ip_inverse != nullptr)
-            ROC_FFT_CHECK_INVALID_VALUE(rocfft_plan_destroy(plan->ip_inverse));
-        if(plan->op_inverse != nullptr)
-            ROC_FFT_CHECK_INVALID_VALUE(rocfft_plan_destroy(plan->op_inverse));
-
-        if(plan->workBufferNeedsFree)
+        while(length % factor == 0)
+            length /= factor;
+    }
+    return length != 1;
+}
+
+// number of elements spanned by one side of a plan's data layout,
+// from the first element of the first transform to the last element
+// of the last one
+static size_t layout_extent(const std::vector<size_t>& length,
+                            const std::vector<size_t>& stride,
+                            size_t                     dist,
+                            size_t                     batch)
+{
+    if(batch == 0 || std::find(length.begin(), length.end(), 0) != length.end())
+        return 0;
+    size_t extent = (batch - 1) * dist + 1;
+    for(size_t i = 0; i < length.size(); ++i)
+        extent += (length[i] - 1) * stride[i];
+    return extent;
+}
+
+// Upper bound on the work buffer that rocFFT needs for a plan,
+// computed from the problem dimensions and data layout alone.
+// Multi-kernel plans need at most two temporary copies of the complex
+// data.  Bluestein's algorithm pads the affected dimensions to a
+// power of 2 that's at least 2N-1, and needs a third buffer for the
+// chirp.  Strided or padded layouts can need one more copy to gather
+// the data, and the copies are then sized for the larger of the
+// logical data and the span of the user's buffers.
+static size_t analytic_work_size(hipfftHandle plan)
+{
+    size_t elems     = plan->batch;
+    bool   bluestein = false;
+    // real-complex transforms work on about half as many complex
+    // elements, but odd lengths need all of them
+    for(auto length : plan->lengths)
+    {
+        if(needs_bluestein(length))
         {
-            if(hipFree(plan->workBuffer) != hipSuccess)
-                throw std::runtime_error("hipFree(plan->workBuffer) failed");
+            bluestein = true;
+            elems *= size_t(1) << CeilPo2(2 * length - 1);
         }
+        else
+            elems *= length;
+    }
 
-        ROC_FFT_CHECK_INVALID_VALUE(rocfft_execution_info_destroy(plan->info));
+    size_t copies = bluestein ? 3 : 2;
+    for(bool input : {true, false})
+    {
+        const auto& length = input ? plan->inLength : plan->outLength;
+        const auto& stride = input ? plan->inStrides : plan->outStrides;
+        const auto  dist   = input ? plan->iDist : plan->oDist;
+        const auto  extent = layout_extent(length, stride, dist, plan->batch);
+        // packed data can be read and written without a gather
+        if(extent
+           == std::accumulate(length.begin(), length.end(), plan->batch, std::multiplies<>()))
+            continue;
+        copies = bluestein ? 4 : 3;
+        elems  = std::max(elems, extent);
+    }
 
-        delete plan;
+    size_t complex_bytes = 0;
+    switch(plan->type.precision())
+    {
+    case rocfft_precision_half:
+        complex_bytes = 4;
+        break;
+    case rocfft_precision_single:
+        complex_bytes = 8;
+        break;
+    case rocfft_precision_double:
+        complex_bytes = 16;
+        break;
+    }
+    return copies * elems * complex_bytes;
+}
+
+// Find the work size of the plans that hipfftMakePlan_internal
+// creates for a transform, if they're all in the plan cache.
+static bool cached_work_size(hipfftHandle plan, size_t& workSize)
+{
+    workSize = 0;
+    for(auto t : plan->type.transform_types())
+    {
+        const bool forward = plan->type.is_forward(t);
+        for(bool inplace : {true, false})
+        {
+            // converted data can't be transformed in place
+            if(inplace && plan->type.converts())
+                continue;
+            size_t cached = 0;
+            if(!hipfft_plan_cache::get().find_work_size(make_plan_key(plan, inplace, forward),
+                                                        cached))
+                return false;
+            workSize = std::max(workSize, cached);
+        }
     }
+    return true;
+}
+
+// Compute an upper bound on the work size for a transform without
+// creating any rocFFT plans, or the exact size if the plans are
+// already cached.  make_plan sets up a temporary handle with the
+// transform's parameters.  That handle only estimates work sizes, so
+// making the plan records its dimensions, layout and bricks - no
+// rocFFT calls are made, no kernels are compiled and no device
+// memory is allocated.  The handle has no execution info
+// and isn't visible to hipfftExtTrimAllMemory.  Everything else that
+// goes into the plan key, such as the scale factor and the
+// multi-device decomposition, is taken from settings, if it's not
+// null.
+static hipfftResult estimate_work_size(hipfftHandle                                      settings,
+                                       const std::function<hipfftResult(hipfftHandle)>& make_plan,
+                                       size_t*                                           workSize)
+{
+    if(workSize == nullptr)
+        return HIPFFT_INVALID_VALUE;
 
+    hipfftHandle p = new hipfftHandle_t;
+    std::unique_ptr<hipfftHandle_t, decltype(&hipfftDestroy)> p_guard(p, hipfftDestroy);
+    p->estimate_only = true;
+    p->autoAllocate  = false;
+    if(settings != nullptr)
+    {
+        wait_for_plan(settings);
+        p->scale_factor  = settings->scale_factor;
+        p->inBricks      = settings->inBricks;
+        p->outBricks     = settings->outBricks;
+        p->decomposition = settings->decomposition;
+        p->brickWeights  = settings->brickWeights;
+        p->inUserBricks  = settings->inUserBricks;
+        p->outUserBricks = settings->outUserBricks;
+        p->pencilRows    = settings->pencilRows;
+        p->pencilColumns = settings->pencilColumns;
+    }
+    HIP_FFT_CHECK_AND_RETURN(make_plan(p));
+
+    // multi-device plans get one size per device, and the rocFFT
+    // plans' work buffer is on the first device
+    if(!p->inBricks.empty())
+        std::fill_n(workSize, p->inBricks.size(), 0);
+
+    // the exact size needs every plan that making the transform
+    // would create to be cached already, otherwise it could be less
+    // than the plan needs
+    size_t exact = 0;
+    if(estimate_mode == HIPFFT_ESTIMATE_EXACT && cached_work_size(p, exact))
+        *workSize = exact;
+    else
+        *workSize = analytic_work_size(p);
+    if(settings != nullptr && p->inBricks.empty())
+        settings->reportedWorkSize = std::max(settings->reportedWorkSize, *workSize);
     return HIPFFT_SUCCESS;
 }
+
+hipfftResult hipfftExtSetEstimateMode(hipfftExtEstimateMode mode)
+try
+{
+    switch(mode)
+    {
+    case HIPFFT_ESTIMATE_ANALYTIC:
+    case HIPFFT_ESTIMATE_EXACT:
+        estimate_mode = mode;
+        return HIPFFT_SUCCESS;
+    }
+    return HIPFFT_INVALID_VALUE;
+}
 catch(hipfftResult e)
 {
     return e;
@@ -1660,33 +3316,12 @@ catch(...)
     return HIPFFT_INTERNAL_ERROR;
 }
 
-hipfftResult hipfftGetVersion(int* version)
+hipfftResult hipfftEstimate1d(int nx, hipfftType type, int batch, size_t* workSize)
 try
 {
-    char v[256];
-    ROC_FFT_CHECK_INVALID_VALUE(rocfft_get_version_string(v, 256));
-
-    // export major.minor.patch only, ignore tweak
-    std::ostringstream       result;
-    std::vector<std::string> sections;
-
-    std::istringstream iss(v);
-    std::string        tmp_str;
-    while(std::getline(iss, tmp_str, '.'))
-    {
-        sections.push_back(tmp_str);
-    }
-
-    for(size_t i = 0; i < std::min<size_t>(sections.size(), 3); i++)
-    {
-        if(sections[i].size() == 1)
-            result << "0" << sections[i];
-        else
-            result << sections[i];
-    }
-
-    *version = std::stoi(result.str());
-    return HIPFFT_SUCCESS;
+    hipfftHandle plan = nullptr;
+    hipfftResult ret  = hipfftGetSize1d(plan, nx, type, batch, workSize);
+    return ret;
 }
 catch(hipfftResult e)
 {
@@ -1697,26 +3332,28 @@ catch(...)
     return HIPFFT_INTERNAL_ERROR;
 }
 
-hipfftResult hipfftGetProperty(hipfftLibraryPropertyType type, int* value)
+hipfftResult hipfftEstimate2d(int nx, int ny, hipfftType type, size_t* workSize)
 try
 {
-    int full;
-    hipfftGetVersion(&full);
-
-    int major = full / 10000;
-    int minor = (full - major * 10000) / 100;
-    int patch = (full - major * 10000 - minor * 100);
-
-    if(type == HIPFFT_MAJOR_VERSION)
-        *value = major;
-    else if(type == HIPFFT_MINOR_VERSION)
-        *value = minor;
-    else if(type == HIPFFT_PATCH_LEVEL)
-        *value = patch;
-    else
-        return HIPFFT_INVALID_TYPE;
+    hipfftHandle plan = nullptr;
+    hipfftResult ret  = hipfftGetSize2d(plan, nx, ny, type, workSize);
+    return ret;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
 
-    return HIPFFT_SUCCESS;
+hipfftResult hipfftEstimate3d(int nx, int ny, int nz, hipfftType type, size_t* workSize)
+try
+{
+    hipfftHandle plan = nullptr;
+    hipfftResult ret  = hipfftGetSize3d(plan, nx, ny, nz, type, workSize);
+    return ret;
 }
 catch(hipfftResult e)
 {
@@ -1727,96 +3364,46 @@ catch(...)
     return HIPFFT_INTERNAL_ERROR;
 }
 
-hipfftResult hipfftXtSetCallback(hipfftHandle         plan,
-                                 void**               callbacks,
-                                 hipfftXtCallbackType cbtype,
-                                 void**               callbackData)
+hipfftResult hipfftEstimateMany(int        rank,
+                                int*       n,
+                                int*       inembed,
+                                int        istride,
+                                int        idist,
+                                int*       onembed,
+                                int        ostride,
+                                int        odist,
+                                hipfftType type,
+                                int        batch,
+                                size_t*    workSize)
 try
 {
-    if(!plan)
-        return HIPFFT_INVALID_PLAN;
+    hipfftHandle plan = nullptr;
+    hipfftResult ret  = hipfftGetSizeMany(
+        plan, rank, n, inembed, istride, idist, onembed, ostride, odist, type, batch, workSize);
+    return ret;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
 
-    // check that the input/output type matches what's being requested
-    //
-    // NOTE: cufft explicitly does not save shared memory bytes when
-    // you set a new callback, so zero out our number when setting
-    // pointers
-    switch(cbtype)
+hipfftResult
+    hipfftGetSize1d(hipfftHandle plan, int nx, hipfftType type, int batch, size_t* workSize)
+try
+{
+    if(nx < 0 || batch < 0)
     {
-    case HIPFFT_CB_LD_COMPLEX:
-        if(plan->type.precision() != rocfft_precision_single || plan->type.is_real_to_complex())
-            return HIPFFT_INVALID_VALUE;
-        plan->load_callback_ptrs      = callbacks;
-        plan->load_callback_data      = callbackData;
-        plan->load_callback_lds_bytes = 0;
-        break;
-    case HIPFFT_CB_LD_COMPLEX_DOUBLE:
-        if(plan->type.precision() != rocfft_precision_double || plan->type.is_real_to_complex())
-            return HIPFFT_INVALID_VALUE;
-        plan->load_callback_ptrs      = callbacks;
-        plan->load_callback_data      = callbackData;
-        plan->load_callback_lds_bytes = 0;
-        break;
-    case HIPFFT_CB_LD_REAL:
-        if(plan->type.precision() != rocfft_precision_single || !plan->type.is_real_to_complex())
-            return HIPFFT_INVALID_VALUE;
-        plan->load_callback_ptrs      = callbacks;
-        plan->load_callback_data      = callbackData;
-        plan->load_callback_lds_bytes = 0;
-        break;
-    case HIPFFT_CB_LD_REAL_DOUBLE:
-        if(plan->type.precision() != rocfft_precision_double || !plan->type.is_real_to_complex())
-            return HIPFFT_INVALID_VALUE;
-        plan->load_callback_ptrs      = callbacks;
-        plan->load_callback_data      = callbackData;
-        plan->load_callback_lds_bytes = 0;
-        break;
-    case HIPFFT_CB_ST_COMPLEX:
-        if(plan->type.precision() != rocfft_precision_single || plan->type.is_complex_to_real())
-            return HIPFFT_INVALID_VALUE;
-        plan->store_callback_ptrs      = callbacks;
-        plan->store_callback_data      = callbackData;
-        plan->store_callback_lds_bytes = 0;
-        break;
-    case HIPFFT_CB_ST_COMPLEX_DOUBLE:
-        if(plan->type.precision() != rocfft_precision_double || plan->type.is_complex_to_real())
-            return HIPFFT_INVALID_VALUE;
-        plan->store_callback_ptrs      = callbacks;
-        plan->store_callback_data      = callbackData;
-        plan->store_callback_lds_bytes = 0;
-        break;
-    case HIPFFT_CB_ST_REAL:
-        if(plan->type.precision() != rocfft_precision_single || !plan->type.is_complex_to_real())
-            return HIPFFT_INVALID_VALUE;
-        plan->store_callback_ptrs      = callbacks;
-        plan->store_callback_data      = callbackData;
-        plan->store_callback_lds_bytes = 0;
-        break;
-    case HIPFFT_CB_ST_REAL_DOUBLE:
-        if(plan->type.precision() != rocfft_precision_double || !plan->type.is_complex_to_real())
-            return HIPFFT_INVALID_VALUE;
-        plan->store_callback_ptrs      = callbacks;
-        plan->store_callback_data      = callbackData;
-        plan->store_callback_lds_bytes = 0;
-        break;
-    case HIPFFT_CB_UNDEFINED:
-        return HIPFFT_INVALID_VALUE;
+        return HIPFFT_INVALID_SIZE;
     }
 
-    rocfft_status res;
-    res = rocfft_execution_info_set_load_callback(plan->info,
-                                                  plan->load_callback_ptrs,
-                                                  plan->load_callback_data,
-                                                  plan->load_callback_lds_bytes);
-    if(res != rocfft_status_success)
-        return HIPFFT_INVALID_VALUE;
-    res = rocfft_execution_info_set_store_callback(plan->info,
-                                                   plan->store_callback_ptrs,
-                                                   plan->store_callback_data,
-                                                   plan->store_callback_lds_bytes);
-    if(res != rocfft_status_success)
-        return HIPFFT_INVALID_VALUE;
-    return HIPFFT_SUCCESS;
+    return estimate_work_size(
+        plan,
+        [&](hipfftHandle p) { return hipfftMakePlan1d(p, nx, type, batch, nullptr); },
+        workSize);
 }
 catch(hipfftResult e)
 {
@@ -1827,10 +3414,16 @@ catch(...)
     return HIPFFT_INTERNAL_ERROR;
 }
 
-hipfftResult hipfftXtClearCallback(hipfftHandle plan, hipfftXtCallbackType cbtype)
+hipfftResult hipfftGetSize2d(hipfftHandle plan, int nx, int ny, hipfftType type, size_t* workSize)
 try
 {
-    return hipfftXtSetCallback(plan, nullptr, cbtype, nullptr);
+    if(nx < 0 || ny < 0)
+    {
+        return HIPFFT_INVALID_SIZE;
+    }
+
+    return estimate_work_size(
+        plan, [&](hipfftHandle p) { return hipfftMakePlan2d(p, nx, ny, type, nullptr); }, workSize);
 }
 catch(hipfftResult e)
 {
@@ -1842,44 +3435,18 @@ catch(...)
 }
 
 hipfftResult
-    hipfftXtSetCallbackSharedSize(hipfftHandle plan, hipfftXtCallbackType cbtype, size_t sharedSize)
+    hipfftGetSize3d(hipfftHandle plan, int nx, int ny, int nz, hipfftType type, size_t* workSize)
 try
 {
-    if(!plan)
-        return HIPFFT_INVALID_PLAN;
-
-    switch(cbtype)
+    if(nx < 0 || ny < 0 || nz < 0)
     {
-    case HIPFFT_CB_LD_COMPLEX:
-    case HIPFFT_CB_LD_COMPLEX_DOUBLE:
-    case HIPFFT_CB_LD_REAL:
-    case HIPFFT_CB_LD_REAL_DOUBLE:
-        plan->load_callback_lds_bytes = sharedSize;
-        break;
-    case HIPFFT_CB_ST_COMPLEX:
-    case HIPFFT_CB_ST_COMPLEX_DOUBLE:
-    case HIPFFT_CB_ST_REAL:
-    case HIPFFT_CB_ST_REAL_DOUBLE:
-        plan->store_callback_lds_bytes = sharedSize;
-        break;
-    case HIPFFT_CB_UNDEFINED:
-        return HIPFFT_INVALID_VALUE;
+        return HIPFFT_INVALID_SIZE;
     }
 
-    rocfft_status res;
-    res = rocfft_execution_info_set_load_callback(plan->info,
-                                                  plan->load_callback_ptrs,
-                                                  plan->load_callback_data,
-                                                  plan->load_callback_lds_bytes);
-    if(res != rocfft_status_success)
-        return HIPFFT_INVALID_VALUE;
-    res = rocfft_execution_info_set_store_callback(plan->info,
-                                                   plan->store_callback_ptrs,
-                                                   plan->store_callback_data,
-                                                   plan->store_callback_lds_bytes);
-    if(res != rocfft_status_success)
-        return HIPFFT_INVALID_VALUE;
-    return HIPFFT_SUCCESS;
+    return estimate_work_size(
+        plan,
+        [&](hipfftHandle p) { return hipfftMakePlan3d(p, nx, ny, nz, type, nullptr); },
+        workSize);
 }
 catch(hipfftResult e)
 {
@@ -1890,26 +3457,27 @@ catch(...)
     return HIPFFT_INTERNAL_ERROR;
 }
 
-hipfftResult hipfftXtMakePlanMany(hipfftHandle   plan,
-                                  int            rank,
-                                  long long int* n,
-                                  long long int* inembed,
-                                  long long int  istride,
-                                  long long int  idist,
-                                  hipDataType    inputtype,
-                                  long long int* onembed,
-                                  long long int  ostride,
-                                  long long int  odist,
-                                  hipDataType    outputtype,
-                                  long long int  batch,
-                                  size_t*        workSize,
-                                  hipDataType    executiontype)
+hipfftResult hipfftGetSizeMany(hipfftHandle plan,
+                               int          rank,
+                               int*         n,
+                               int*         inembed,
+                               int          istride,
+                               int          idist,
+                               int*         onembed,
+                               int          ostride,
+                               int          odist,
+                               hipfftType   type,
+                               int          batch,
+                               size_t*      workSize)
 try
 {
-    hipfftIOType iotype;
-    HIP_FFT_CHECK_AND_RETURN(iotype.init(inputtype, outputtype, executiontype));
-    return hipfftMakePlanMany_internal<long long int>(
-        plan, rank, n, inembed, istride, idist, onembed, ostride, odist, iotype, batch, workSize);
+    return estimate_work_size(
+        plan,
+        [&](hipfftHandle p) {
+            return hipfftMakePlanMany(
+                p, rank, n, inembed, istride, idist, onembed, ostride, odist, type, batch, nullptr);
+        },
+        workSize);
 }
 catch(hipfftResult e)
 {
@@ -1920,32 +3488,27 @@ catch(...)
     return HIPFFT_INTERNAL_ERROR;
 }
 
-hipfftResult hipfftXtGetSizeMany(hipfftHandle   plan,
+hipfftResult hipfftGetSizeMany64(hipfftHandle   plan,
                                  int            rank,
                                  long long int* n,
                                  long long int* inembed,
                                  long long int  istride,
                                  long long int  idist,
-                                 hipDataType    inputtype,
                                  long long int* onembed,
                                  long long int  ostride,
                                  long long int  odist,
-                                 hipDataType    outputtype,
+                                 hipfftType     type,
                                  long long int  batch,
-                                 size_t*        workSize,
-                                 hipDataType    executiontype)
+                                 size_t*        workSize)
 try
 {
-    hipfftIOType iotype;
-    HIP_FFT_CHECK_AND_RETURN(iotype.init(inputtype, outputtype, executiontype));
-
-    hipfftHandle p;
-    HIP_FFT_CHECK_AND_RETURN(hipfftCreate(&p));
-
-    HIP_FFT_CHECK_AND_RETURN(hipfftMakePlanMany_internal(
-        p, rank, n, inembed, istride, idist, onembed, ostride, odist, iotype, batch, workSize));
-    HIP_FFT_CHECK_AND_RETURN(hipfftDestroy(p));
-    return HIPFFT_SUCCESS;
+    return estimate_work_size(
+        plan,
+        [&](hipfftHandle p) {
+            return hipfftMakePlanMany64(
+                p, rank, n, inembed, istride, idist, onembed, ostride, odist, type, batch, nullptr);
+        },
+        workSize);
 }
 catch(hipfftResult e)
 {
@@ -1956,23 +3519,12 @@ catch(...)
     return HIPFFT_INTERNAL_ERROR;
 }
 
-hipfftResult hipfftXtExec(hipfftHandle plan, void* input, void* output, int direction)
+hipfftResult hipfftGetSize(hipfftHandle plan, size_t* workSize)
 try
 {
-    bool        inplace  = input == output;
-    rocfft_plan plan_ptr = nullptr;
-    if(plan->type.is_real_to_complex() || direction == HIPFFT_FORWARD)
-    {
-        plan_ptr = inplace ? plan->ip_forward : plan->op_forward;
-    }
-    else if(plan->type.is_complex_to_real() || direction == HIPFFT_BACKWARD)
-    {
-        plan_ptr = inplace ? plan->ip_inverse : plan->op_inverse;
-    }
-    if(!plan_ptr)
-        return HIPFFT_INTERNAL_ERROR;
-
-    return hipfftExec(plan_ptr, plan->info, input, output);
+    wait_for_plan(plan);
+    report_work_size(plan, workSize);
+    return HIPFFT_SUCCESS;
 }
 catch(hipfftResult e)
 {
@@ -1983,26 +3535,15 @@ catch(...)
     return HIPFFT_INTERNAL_ERROR;
 }
 
-hipfftResult hipfftXtSetGPUs(hipfftHandle plan, int count, int* gpus)
+hipfftResult hipfftSetAutoAllocation(hipfftHandle plan, int autoAllocate)
 try
 {
-    if(count <= 0)
-        return HIPFFT_INVALID_VALUE;
-
-    // we know how many bricks we will have, but we haven't been told
-    // the problem dimensions yet so we don't know what the bricks
-    // will look like.
-    plan->inBricks.resize(static_cast<size_t>(count));
-    plan->outBricks.resize(static_cast<size_t>(count));
-
-    // but at this point we know devices, so record what the user
-    // gave us
-    for(size_t i = 0; i < static_cast<size_t>(count); ++i)
+    if(plan != nullptr)
     {
-        plan->inBricks[i].device  = gpus[i];
-        plan->outBricks[i].device = gpus[i];
+        wait_for_plan(plan);
+        std::lock_guard<std::mutex> lock(plan->mutex);
+        plan->autoAllocate = bool(autoAllocate);
     }
-
     return HIPFFT_SUCCESS;
 }
 catch(hipfftResult e)
@@ -2014,17 +3555,3211 @@ catch(...)
     return HIPFFT_INTERNAL_ERROR;
 }
 
-// get number of bytes used for elements of a given hipDataType
-static size_t hipDataType_bits(hipDataType t)
+hipfftResult hipfftSetWorkArea(hipfftHandle plan, void* workArea)
+try
 {
-    switch(t)
+    wait_for_plan(plan);
+    // trimming may free the work buffer from another thread
+    std::lock_guard<std::mutex> lock(plan->mutex);
+
+    // a user-provided work area replaces a shared one
+    if(workArea)
     {
-    case HIP_R_16F:
-        // real half
-        return 16;
-    case HIP_C_16F:
+        unbind_work_area(plan);
+        plan->workAreaPolicy = HIPFFT_WORKAREA_PER_PLAN;
+    }
+    if(plan->workBuffer && plan->workBufferNeedsFree)
+    {
+        if(hipFree(plan->workBuffer) != hipSuccess)
+            throw std::runtime_error("hipFree(plan->workBuffer) failed");
+    }
+    plan->workBufferNeedsFree = false;
+    plan->workBuffer          = workArea;
+    plan->userWorkAreaSize
+        = workArea ? std::max(plan->reportedWorkSize, plan->workBufferSize) : 0;
+    if(workArea)
+    {
+        ROC_FFT_CHECK_INVALID_VALUE(
+            rocfft_execution_info_set_work_buffer(plan->info, workArea, plan->userWorkAreaSize));
+    }
+    return HIPFFT_SUCCESS;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+// Find the specific plan to execute - check placement and direction.
+// set up the work area for a plan that's about to be executed, if
+// it's shared or its allocation was deferred
+static void prepare_work_area(hipfftHandle plan)
+{
+    if(!plan->autoAllocate || plan->workBufferSize == 0)
+        return;
+
+    switch(plan->workAreaPolicy)
+    {
+    case HIPFFT_WORKAREA_PER_PLAN:
+        break;
+    case HIPFFT_WORKAREA_DEFERRED:
+        if(!plan->workBuffer)
+        {
+            auto ret = allocate_work_buffer(plan, plan->workBufferSize);
+            if(ret != HIPFFT_SUCCESS)
+                throw ret;
+        }
+        break;
+    case HIPFFT_WORKAREA_SHARED_PER_STREAM:
+    {
+        int device = 0;
+        if(hipGetDevice(&device) != hipSuccess)
+            throw HIPFFT_INVALID_DEVICE;
+        auto& arena = hipfft_work_area_arena::get();
+        const hipfft_work_area_arena::arena_key key{device, plan->stream};
+        if(!plan->workAreaBound || plan->workAreaKey != key)
+        {
+            unbind_work_area(plan);
+            arena.bind(key);
+            plan->workAreaBound = true;
+            plan->workAreaKey   = key;
+        }
+        // other handles might have grown the arena since this handle
+        // last used it
+        void* buffer = arena.reserve(key, plan->workBufferSize);
+        if(buffer != plan->workBuffer)
+        {
+            if(rocfft_execution_info_set_work_buffer(plan->info, buffer, plan->workBufferSize)
+               != rocfft_status_success)
+                throw HIPFFT_INVALID_VALUE;
+            plan->workBuffer = buffer;
+        }
+        break;
+    }
+    }
+}
+
+// wait for a plan being made asynchronously, or throw if the plan
+// isn't ready and the caller doesn't want to wait
+static void check_plan_ready(const hipfftHandle plan)
+{
+    if(plan->pending.valid())
+    {
+        if(plan->notReadyPolicy == HIPFFT_NOT_READY_RETURN && plan_pending(plan))
+            throw HIPFFT_PLAN_NOT_READY;
+        const auto status = plan->pending.get().status;
+        if(status != HIPFFT_SUCCESS)
+            throw status;
+    }
+}
+
+// If plan creation is lazy, this is where the rocFFT plan gets
+// created.
+static rocfft_plan get_exec_plan(const hipfftHandle plan, const bool inplace, const int direction)
+{
+    if(direction != HIPFFT_FORWARD && direction != HIPFFT_BACKWARD)
+        return nullptr;
+    const bool forward = direction == HIPFFT_FORWARD;
+
+    check_plan_ready(plan);
+    // converted data, and ops that run in a pass of their own, need
+    // separate input and output
+    if(inplace && (plan->type.converts() || plan->loadOp.kernel || plan->storeOp.kernel))
+        throw HIPFFT_INVALID_VALUE;
+
+    if(plan->lazy_create && create_exec_plan(plan, inplace, forward))
+    {
+        auto ret = update_work_buffer(plan);
+        if(ret != HIPFFT_SUCCESS)
+            throw ret;
+    }
+
+    prepare_work_area(plan);
+    plan->lastExec = std::chrono::steady_clock::now();
+
+    if(forward)
+        return inplace ? plan->ip_forward : plan->op_forward;
+    else
+        return inplace ? plan->ip_inverse : plan->op_inverse;
+}
+
+static hipfftResult hipfftExec(const rocfft_plan&           rplan,
+                               const rocfft_execution_info& rinfo,
+                               void*                        idata,
+                               void*                        odata)
+{
+    if(!rplan)
+        return HIPFFT_EXEC_FAILED;
+    if(!idata || !odata)
+        return HIPFFT_EXEC_FAILED;
+    void*      in[1]  = {(void*)idata};
+    void*      out[1] = {(void*)odata};
+    const auto ret    = rocfft_execute(rplan, in, out, rinfo);
+    return ret == rocfft_status_success ? HIPFFT_SUCCESS : HIPFFT_EXEC_FAILED;
+}
+
+// execute a handle's transform, with the passes of any ops that run
+// separately before and after it
+static hipfftResult
+    hipfftExecWithOps(hipfftHandle plan, const rocfft_plan& rplan, void* idata, void* odata)
+{
+    if(!rplan || !idata || !odata)
+        return HIPFFT_EXEC_FAILED;
+
+    if(plan->loadOp.kernel)
+    {
+        HIP_FFT_CHECK_AND_RETURN(run_op_pass(plan, true, idata, plan->loadOp.buffer));
+        idata = plan->loadOp.buffer;
+    }
+    if(!plan->storeOp.kernel)
+        return hipfftExec(rplan, plan->info, idata, odata);
+
+    HIP_FFT_CHECK_AND_RETURN(hipfftExec(rplan, plan->info, idata, plan->storeOp.buffer));
+    return run_op_pass(plan, false, plan->storeOp.buffer, odata);
+}
+
+static hipfftResult hipfftExecForward(hipfftHandle plan, void* idata, void* odata)
+{
+    std::lock_guard<std::mutex> lock(plan->mutex);
+
+    const bool inplace = idata == odata;
+    const auto rplan   = get_exec_plan(plan, inplace, HIPFFT_FORWARD);
+    return hipfftExecWithOps(plan, rplan, idata, odata);
+}
+
+static hipfftResult hipfftExecBackward(hipfftHandle plan, void* idata, void* odata)
+{
+    std::lock_guard<std::mutex> lock(plan->mutex);
+
+    const bool inplace = idata == odata;
+    const auto rplan   = get_exec_plan(plan, inplace, HIPFFT_BACKWARD);
+    return hipfftExecWithOps(plan, rplan, idata, odata);
+}
+
+hipfftResult
+    hipfftExecC2C(hipfftHandle plan, hipfftComplex* idata, hipfftComplex* odata, int direction)
+try
+{
+    switch(direction)
+    {
+    case HIPFFT_FORWARD:
+        return hipfftExecForward(plan, idata, odata);
+    case HIPFFT_BACKWARD:
+        return hipfftExecBackward(plan, idata, odata);
+    }
+    return HIPFFT_EXEC_FAILED;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftExecR2C(hipfftHandle plan, hipfftReal* idata, hipfftComplex* odata)
+try
+{
+    return hipfftExecForward(plan, idata, odata);
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftExecC2R(hipfftHandle plan, hipfftComplex* idata, hipfftReal* odata)
+try
+{
+    return hipfftExecBackward(plan, idata, odata);
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftExecZ2Z(hipfftHandle         plan,
+                           hipfftDoubleComplex* idata,
+                           hipfftDoubleComplex* odata,
+                           int                  direction)
+try
+{
+    switch(direction)
+    {
+    case HIPFFT_FORWARD:
+        return hipfftExecForward(plan, idata, odata);
+    case HIPFFT_BACKWARD:
+        return hipfftExecBackward(plan, idata, odata);
+    }
+    return HIPFFT_EXEC_FAILED;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftExecD2Z(hipfftHandle plan, hipfftDoubleReal* idata, hipfftDoubleComplex* odata)
+try
+{
+    return hipfftExecForward(plan, idata, odata);
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftExecZ2D(hipfftHandle plan, hipfftDoubleComplex* idata, hipfftDoubleReal* odata)
+try
+{
+    return hipfftExecBackward(plan, idata, odata);
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftSetStream(hipfftHandle plan, hipStream_t stream)
+try
+{
+    wait_for_plan(plan);
+    std::lock_guard<std::mutex> lock(plan->mutex);
+    ROC_FFT_CHECK_INVALID_VALUE(rocfft_execution_info_set_stream(plan->info, stream));
+    plan->stream = stream;
+    return HIPFFT_SUCCESS;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftDestroy(hipfftHandle plan)
+try
+{
+    if(plan != nullptr)
+    {
+        wait_for_plan(plan);
+
+        {
+            auto&                       live = hipfft_live_handles::get();
+            std::lock_guard<std::mutex> lock(live.mutex);
+            live.handles.erase(plan);
+        }
+
+        // rocFFT plans are owned by the plan cache
+        for(auto rplan : {plan->ip_forward,
+                          plan->op_forward,
+                          plan->ip_inverse,
+                          plan->op_inverse,
+                          plan->ip_forward_shuffled,
+                          plan->ip_inverse_shuffled})
+        {
+            if(rplan != nullptr)
+                hipfft_plan_cache::get().release(rplan);
+        }
+
+        for(const auto& rplan : plan->pipeline.plans)
+            hipfft_plan_cache::get().release(rplan.second);
+
+        destroy_plan_descs(plan, true);
+        destroy_plan_descs(plan, false);
+
+        unbind_work_area(plan);
+        if(plan->workBufferNeedsFree)
+        {
+            if(hipFree(plan->workBuffer) != hipSuccess)
+                throw std::runtime_error("hipFree(plan->workBuffer) failed");
+        }
+
+        // handles made to estimate work sizes have no execution info
+        if(plan->info)
+            ROC_FFT_CHECK_INVALID_VALUE(rocfft_execution_info_destroy(plan->info));
+
+        for(auto& copyStream : plan->copyStreams)
+        {
+            rocfft_scoped_device dev(copyStream.first);
+            copyStream.second.stream.free();
+            copyStream.second.start.free();
+            copyStream.second.done.free();
+            for(auto& staged : copyStream.second.staged)
+                staged.free();
+        }
+
+        for(auto& state : plan->pipeline.devices)
+        {
+            rocfft_scoped_device dev(state.device);
+            if(hipFree(state.exchanged) != hipSuccess)
+                throw std::runtime_error("hipFree failed");
+            if(state.workBufferNeedsFree && hipFree(state.workBuffer) != hipSuccess)
+                throw std::runtime_error("hipFree failed");
+            if(state.info)
+                ROC_FFT_CHECK_INVALID_VALUE(rocfft_execution_info_destroy(state.info));
+            state.stream.free();
+            state.begin.free();
+            state.events.clear();
+        }
+
+        for(auto op : {&plan->loadOp, &plan->storeOp})
+        {
+            if(hipFree(op->params) != hipSuccess || hipFree(op->buffer) != hipSuccess)
+                throw std::runtime_error("hipFree failed");
+        }
+
+        delete plan;
+    }
+
+    return HIPFFT_SUCCESS;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftGetVersion(int* version)
+try
+{
+    char v[256];
+    ROC_FFT_CHECK_INVALID_VALUE(rocfft_get_version_string(v, 256));
+
+    // export major.minor.patch only, ignore tweak
+    std::ostringstream       result;
+    std::vector<std::string> sections;
+
+    std::istringstream iss(v);
+    std::string        tmp_str;
+    while(std::getline(iss, tmp_str, '.'))
+    {
+        sections.push_back(tmp_str);
+    }
+
+    for(size_t i = 0; i < std::min<size_t>(sections.size(), 3); i++)
+    {
+        if(sections[i].size() == 1)
+            result << "0" << sections[i];
+        else
+            result << sections[i];
+    }
+
+    *version = std::stoi(result.str());
+    return HIPFFT_SUCCESS;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftGetProperty(hipfftLibraryPropertyType type, int* value)
+try
+{
+    int full;
+    hipfftGetVersion(&full);
+
+    int major = full / 10000;
+    int minor = (full - major * 10000) / 100;
+    int patch = (full - major * 10000 - minor * 100);
+
+    if(type == HIPFFT_MAJOR_VERSION)
+        *value = major;
+    else if(type == HIPFFT_MINOR_VERSION)
+        *value = minor;
+    else if(type == HIPFFT_PATCH_LEVEL)
+        *value = patch;
+    else
+        return HIPFFT_INVALID_TYPE;
+
+    return HIPFFT_SUCCESS;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+// check that the input/output type of a plan matches what a callback
+// type is for, and return true if it's a load callback
+static bool callback_is_load(hipfftHandle plan, hipfftXtCallbackType cbtype)
+{
+    bool             load;
+    bool             real;
+    rocfft_precision precision;
+    switch(cbtype)
+    {
+    case HIPFFT_CB_LD_COMPLEX:
+        std::tie(load, real, precision) = std::make_tuple(true, false, rocfft_precision_single);
+        break;
+    case HIPFFT_CB_LD_COMPLEX_DOUBLE:
+        std::tie(load, real, precision) = std::make_tuple(true, false, rocfft_precision_double);
+        break;
+    case HIPFFT_CB_LD_REAL:
+        std::tie(load, real, precision) = std::make_tuple(true, true, rocfft_precision_single);
+        break;
+    case HIPFFT_CB_LD_REAL_DOUBLE:
+        std::tie(load, real, precision) = std::make_tuple(true, true, rocfft_precision_double);
+        break;
+    case HIPFFT_CB_ST_COMPLEX:
+        std::tie(load, real, precision) = std::make_tuple(false, false, rocfft_precision_single);
+        break;
+    case HIPFFT_CB_ST_COMPLEX_DOUBLE:
+        std::tie(load, real, precision) = std::make_tuple(false, false, rocfft_precision_double);
+        break;
+    case HIPFFT_CB_ST_REAL:
+        std::tie(load, real, precision) = std::make_tuple(false, true, rocfft_precision_single);
+        break;
+    case HIPFFT_CB_ST_REAL_DOUBLE:
+        std::tie(load, real, precision) = std::make_tuple(false, true, rocfft_precision_double);
+        break;
+    default:
+        throw HIPFFT_INVALID_VALUE;
+    }
+
+    // real data is loaded by real-to-complex transforms and stored by
+    // complex-to-real transforms
+    const bool plan_real = load ? plan->type.is_real_to_complex() : plan->type.is_complex_to_real();
+    if(plan->type.precision() != precision || real != plan_real)
+        throw HIPFFT_INVALID_VALUE;
+    return load;
+}
+
+// set callbacks on a plan and its rocFFT execution info
+static hipfftResult set_plan_callback(hipfftHandle         plan,
+                                      void**               callbacks,
+                                      hipfftXtCallbackType cbtype,
+                                      void**               callbackData)
+{
+    // NOTE: cufft explicitly does not save shared memory bytes when
+    // you set a new callback, so zero out our number when setting
+    // pointers
+    if(callback_is_load(plan, cbtype))
+    {
+        plan->load_callback_ptrs      = callbacks;
+        plan->load_callback_data      = callbackData;
+        plan->load_callback_lds_bytes = 0;
+    }
+    else
+    {
+        plan->store_callback_ptrs      = callbacks;
+        plan->store_callback_data      = callbackData;
+        plan->store_callback_lds_bytes = 0;
+    }
+
+    rocfft_status res;
+    res = rocfft_execution_info_set_load_callback(plan->info,
+                                                  plan->load_callback_ptrs,
+                                                  plan->load_callback_data,
+                                                  plan->load_callback_lds_bytes);
+    if(res != rocfft_status_success)
+        return HIPFFT_INVALID_VALUE;
+    res = rocfft_execution_info_set_store_callback(plan->info,
+                                                   plan->store_callback_ptrs,
+                                                   plan->store_callback_data,
+                                                   plan->store_callback_lds_bytes);
+    if(res != rocfft_status_success)
+        return HIPFFT_INVALID_VALUE;
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftXtSetCallback(hipfftHandle         plan,
+                                 void**               callbacks,
+                                 hipfftXtCallbackType cbtype,
+                                 void**               callbackData)
+try
+{
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    wait_for_plan(plan);
+
+    // converted data is handled by the library's own callbacks
+    const bool load = callback_is_load(plan, cbtype);
+    if(load ? plan->type.converts_input() : plan->type.converts_output())
+        return HIPFFT_NOT_SUPPORTED;
+    HIP_FFT_CHECK_AND_RETURN(set_plan_callback(plan, callbacks, cbtype, callbackData));
+
+    // the callback replaces any op that was set
+    (load ? plan->loadOp : plan->storeOp).op = HIPFFT_OP_NONE;
+    return HIPFFT_SUCCESS;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftXtClearCallback(hipfftHandle plan, hipfftXtCallbackType cbtype)
+try
+{
+    return hipfftXtSetCallback(plan, nullptr, cbtype, nullptr);
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult
+    hipfftXtSetCallbackSharedSize(hipfftHandle plan, hipfftXtCallbackType cbtype, size_t sharedSize)
+try
+{
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+
+    switch(cbtype)
+    {
+    case HIPFFT_CB_LD_COMPLEX:
+    case HIPFFT_CB_LD_COMPLEX_DOUBLE:
+    case HIPFFT_CB_LD_REAL:
+    case HIPFFT_CB_LD_REAL_DOUBLE:
+        plan->load_callback_lds_bytes = sharedSize;
+        break;
+    case HIPFFT_CB_ST_COMPLEX:
+    case HIPFFT_CB_ST_COMPLEX_DOUBLE:
+    case HIPFFT_CB_ST_REAL:
+    case HIPFFT_CB_ST_REAL_DOUBLE:
+        plan->store_callback_lds_bytes = sharedSize;
+        break;
+    case HIPFFT_CB_UNDEFINED:
+        return HIPFFT_INVALID_VALUE;
+    }
+
+    rocfft_status res;
+    res = rocfft_execution_info_set_load_callback(plan->info,
+                                                  plan->load_callback_ptrs,
+                                                  plan->load_callback_data,
+                                                  plan->load_callback_lds_bytes);
+    if(res != rocfft_status_success)
+        return HIPFFT_INVALID_VALUE;
+    res = rocfft_execution_info_set_store_callback(plan->info,
+                                                   plan->store_callback_ptrs,
+                                                   plan->store_callback_data,
+                                                   plan->store_callback_lds_bytes);
+    if(res != rocfft_status_success)
+        return HIPFFT_INVALID_VALUE;
+    return HIPFFT_SUCCESS;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+// Device code for the built-in load and store ops.  The library has
+// no device code of its own, so this is compiled with hiprtc the
+// first time a device architecture needs it.  hipfft_op_params must
+// match the struct of the same name below, and the exported
+// callbacks are in hipfftXtCallbackType order.
+static const char* hipfft_op_device_source = R"(
+#define HIPFFT_OP_MAX_DIMS 4
+
+struct hipfft_op_params
+{
+    int         type;
+    int         storage;
+    double      param;
+    const void* array;
+    double      norm;
+    size_t      length;
+    size_t      fast;
+    size_t      dims;
+    size_t      strides[HIPFFT_OP_MAX_DIMS];
+};
+
+struct hipfft_conv_pad_params
+{
+    size_t dims;
+    size_t length[HIPFFT_OP_MAX_DIMS];
+    size_t padded[HIPFFT_OP_MAX_DIMS];
+    size_t dist;
+    size_t padded_dist;
+};
+
+struct hipfft_conv_multiply_params
+{
+    const void* spectra;
+    const void* filter_spectra;
+    size_t      elements;
+    size_t      filters;
+};
+
+struct hipfft_stream_gather_params
+{
+    const void* window;
+    size_t      fft_size;
+    size_t      block_length;
+};
+
+struct hipfft_op_layout
+{
+    size_t dims;
+    size_t count;
+    size_t length[HIPFFT_OP_MAX_DIMS];
+    size_t stride[HIPFFT_OP_MAX_DIMS];
+};
+
+__device__ double bessel_i0(double x)
+{
+    double sum  = 1.0;
+    double term = 1.0;
+    for(int k = 1; k < 500 && term > 1e-17 * sum; ++k)
+    {
+        const double factor = x / (2.0 * k);
+        term *= factor * factor;
+        sum += term;
+    }
+    return sum;
+}
+
+// window weight of the element at offset, whose index along the
+// fastest dimension is found by dividing the offset by each stride
+// in decreasing order
+__device__ double window(const hipfft_op_params& p, size_t offset)
+{
+    if(p.length < 2)
+        return 1.0;
+    size_t n = 0;
+    for(size_t d = 0; d <= p.fast; ++d)
+    {
+        n = offset / p.strides[d];
+        offset -= n * p.strides[d];
+    }
+
+    const double pi = 3.14159265358979323846;
+    const double x  = static_cast<double>(n) / static_cast<double>(p.length - 1);
+    switch(p.type)
+    {
+    case HIPFFT_OP_WINDOW_HANN:
+        return 0.5 - 0.5 * cos(2.0 * pi * x);
+    case HIPFFT_OP_WINDOW_HAMMING:
+        return 0.54 - 0.46 * cos(2.0 * pi * x);
+    case HIPFFT_OP_WINDOW_BLACKMAN:
+        return 0.42 - 0.5 * cos(2.0 * pi * x) + 0.08 * cos(4.0 * pi * x);
+    case HIPFFT_OP_WINDOW_KAISER:
+    {
+        const double r = 2.0 * x - 1.0;
+        return bessel_i0(p.param * sqrt(fmax(0.0, 1.0 - r * r))) * p.norm;
+    }
+    }
+    return 1.0;
+}
+
+__device__ float scale(float v, double s)
+{
+    return v * s;
+}
+__device__ double scale(double v, double s)
+{
+    return v * s;
+}
+__device__ float2 scale(float2 v, double s)
+{
+    return make_float2(v.x * s, v.y * s);
+}
+__device__ double2 scale(double2 v, double s)
+{
+    return make_double2(v.x * s, v.y * s);
+}
+
+__device__ float conjugate(float v)
+{
+    return v;
+}
+__device__ double conjugate(double v)
+{
+    return v;
+}
+__device__ float2 conjugate(float2 v)
+{
+    return make_float2(v.x, -v.y);
+}
+__device__ double2 conjugate(double2 v)
+{
+    return make_double2(v.x, -v.y);
+}
+
+__device__ float multiply(float a, float b)
+{
+    return a * b;
+}
+__device__ double multiply(double a, double b)
+{
+    return a * b;
+}
+__device__ float2 multiply(float2 a, float2 b)
+{
+    return make_float2(a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x);
+}
+__device__ double2 multiply(double2 a, double2 b)
+{
+    return make_double2(a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x);
+}
+
+__device__ float power(float v)
+{
+    return v * v;
+}
+__device__ double power(double v)
+{
+    return v * v;
+}
+__device__ float power(float2 v)
+{
+    return v.x * v.x + v.y * v.y;
+}
+__device__ double power(double2 v)
+{
+    return v.x * v.x + v.y * v.y;
+}
+
+template <typename T>
+__device__ T apply(T v, size_t offset, const hipfft_op_params& p)
+{
+    switch(p.type)
+    {
+    case HIPFFT_OP_SCALE:
+        return scale(v, p.param);
+    case HIPFFT_OP_WINDOW_HANN:
+    case HIPFFT_OP_WINDOW_HAMMING:
+    case HIPFFT_OP_WINDOW_BLACKMAN:
+    case HIPFFT_OP_WINDOW_KAISER:
+        return scale(v, window(p, offset));
+    case HIPFFT_OP_CONJUGATE:
+        return conjugate(v);
+    case HIPFFT_OP_MULTIPLY:
+        return multiply(v, static_cast<const T*>(p.array)[offset]);
+    }
+    return v;
+}
+
+// bfloat16 values, kept as their bits
+struct bfloat16
+{
+    unsigned short bits;
+
+    __device__ operator float() const
+    {
+        const unsigned int u = static_cast<unsigned int>(bits) << 16;
+        float              v;
+        __builtin_memcpy(&v, &u, sizeof(v));
+        return v;
+    }
+};
+
+// round to the nearest bfloat16, ties to even
+__device__ bfloat16 to_bfloat16(float v)
+{
+    unsigned int u;
+    __builtin_memcpy(&u, &v, sizeof(u));
+    bfloat16 b;
+    if((u & 0x7fffffff) > 0x7f800000)
+        b.bits = static_cast<unsigned short>((u >> 16) | 0x40); // keep NaNs quiet
+    else
+        b.bits = static_cast<unsigned short>((u + 0x7fff + ((u >> 16) & 1)) >> 16);
+    return b;
+}
+
+// read an element of input stored as type S, converted to T
+template <typename S>
+__device__ float load_input(const float* buffer, size_t offset)
+{
+    return reinterpret_cast<const S*>(buffer)[offset];
+}
+template <typename S>
+__device__ double load_input(const double* buffer, size_t offset)
+{
+    return reinterpret_cast<const S*>(buffer)[offset];
+}
+template <typename S>
+__device__ float2 load_input(const float2* buffer, size_t offset)
+{
+    const S* element = reinterpret_cast<const S*>(buffer) + 2 * offset;
+    return make_float2(element[0], element[1]);
+}
+template <typename S>
+__device__ double2 load_input(const double2* buffer, size_t offset)
+{
+    const S* element = reinterpret_cast<const S*>(buffer) + 2 * offset;
+    return make_double2(element[0], element[1]);
+}
+
+// write an element of output as type S, converted from T
+__device__ void store_element(_Float16* element, float v)
+{
+    *element = static_cast<_Float16>(v);
+}
+__device__ void store_element(bfloat16* element, float v)
+{
+    *element = to_bfloat16(v);
+}
+template <typename S>
+__device__ void store_output(float* buffer, size_t offset, float v)
+{
+    store_element(reinterpret_cast<S*>(buffer) + offset, v);
+}
+template <typename S>
+__device__ void store_output(double* buffer, size_t offset, double v)
+{
+    store_element(reinterpret_cast<S*>(buffer) + offset, v);
+}
+template <typename S>
+__device__ void store_output(float2* buffer, size_t offset, float2 v)
+{
+    S* element = reinterpret_cast<S*>(buffer) + 2 * offset;
+    store_element(element, v.x);
+    store_element(element + 1, v.y);
+}
+template <typename S>
+__device__ void store_output(double2* buffer, size_t offset, double2 v)
+{
+    S* element = reinterpret_cast<S*>(buffer) + 2 * offset;
+    store_element(element, v.x);
+    store_element(element + 1, v.y);
+}
+
+template <typename T>
+__device__ T load(const T* buffer, size_t offset, int storage)
+{
+    switch(storage)
+    {
+    case HIPFFT_OP_STORAGE_INT8:
+        return load_input<signed char>(buffer, offset);
+    case HIPFFT_OP_STORAGE_INT16:
+        return load_input<short>(buffer, offset);
+    case HIPFFT_OP_STORAGE_HALF:
+        return load_input<_Float16>(buffer, offset);
+    case HIPFFT_OP_STORAGE_BFLOAT16:
+        return load_input<bfloat16>(buffer, offset);
+    }
+    return buffer[offset];
+}
+
+template <typename T>
+__device__ void store(T* buffer, size_t offset, T v, int storage)
+{
+    switch(storage)
+    {
+    case HIPFFT_OP_STORAGE_HALF:
+        store_output<_Float16>(buffer, offset, v);
+        return;
+    case HIPFFT_OP_STORAGE_BFLOAT16:
+        store_output<bfloat16>(buffer, offset, v);
+        return;
+    }
+    buffer[offset] = v;
+}
+
+template <typename T>
+__device__ T load_op(T* buffer, size_t offset, void* data, void* sharedMem)
+{
+    const hipfft_op_params& p = *static_cast<const hipfft_op_params*>(data);
+    return apply(load(buffer, offset, p.storage), offset, p);
+}
+
+// magnitude and power store values of real type R
+template <typename T, typename R>
+__device__ void store_op(T* buffer, size_t offset, T element, void* data, void* sharedMem)
+{
+    const hipfft_op_params& p = *static_cast<const hipfft_op_params*>(data);
+    if(p.type == HIPFFT_OP_MAGNITUDE)
+        store(reinterpret_cast<R*>(buffer), offset, R(sqrt(power(element))), p.storage);
+    else if(p.type == HIPFFT_OP_POWER)
+        store(reinterpret_cast<R*>(buffer), offset, R(power(element)), p.storage);
+    else
+        store(buffer, offset, apply(element, offset, p), p.storage);
+}
+
+// convolutions zero-pad their input by loading it through a
+// transform of the padded lengths
+template <typename T>
+__device__ T conv_pad(T* buffer, size_t offset, void* data, void* sharedMem)
+{
+    const hipfft_conv_pad_params& p = *static_cast<const hipfft_conv_pad_params*>(data);
+
+    size_t element     = offset % p.padded_dist;
+    size_t data_offset = offset / p.padded_dist * p.dist;
+    size_t data_stride = 1;
+    for(size_t d = p.dims; d-- > 0;)
+    {
+        const size_t index = element % p.padded[d];
+        element /= p.padded[d];
+        if(index >= p.length[d])
+        {
+            T zero;
+            __builtin_memset(&zero, 0, sizeof(zero));
+            return zero;
+        }
+        data_offset += index * data_stride;
+        data_stride *= p.length[d];
+    }
+    return buffer[data_offset];
+}
+
+// and multiply spectra by the filters' spectra as the inverse
+// transform loads them, ignoring its input buffer
+template <typename T>
+__device__ T conv_multiply(T* buffer, size_t offset, void* data, void* sharedMem)
+{
+    const hipfft_conv_multiply_params& p
+        = *static_cast<const hipfft_conv_multiply_params*>(data);
+
+    // the inverse transforms are ordered by signal, then filter
+    const size_t transform = offset / p.elements;
+    const size_t element   = offset % p.elements;
+    const T*     spectrum  = static_cast<const T*>(p.spectra);
+    const T*     filter    = static_cast<const T*>(p.filter_spectra);
+    return multiply(spectrum[transform / p.filters * p.elements + element],
+                    filter[transform % p.filters * p.elements + element]);
+}
+
+// stream filters load overlapping blocks of samples from their
+// window, each block_length samples after the one before
+template <typename T>
+__device__ T stream_gather(T* buffer, size_t offset, void* data, void* sharedMem)
+{
+    const hipfft_stream_gather_params& p
+        = *static_cast<const hipfft_stream_gather_params*>(data);
+    const T* window = static_cast<const T*>(p.window);
+    return window[offset / p.fft_size * p.block_length + offset % p.fft_size];
+}
+
+// offset of the index'th element of a layout, counting along the
+// fastest dimension first
+__device__ size_t layout_offset(const hipfft_op_layout& layout, size_t index)
+{
+    size_t offset = 0;
+    for(size_t d = 0; d < layout.dims; ++d)
+    {
+        offset += index % layout.length[d] * layout.stride[d];
+        index /= layout.length[d];
+    }
+    return offset;
+}
+
+// ops that can't be applied while rocFFT loads or stores its data
+// run as passes of their own, between the user's buffer and one
+// that rocFFT reads or writes in the type it computes in
+template <typename T>
+__device__ void load_pass(T* src, T* dest, void* data, const hipfft_op_layout& layout)
+{
+    const size_t index = blockIdx.x * static_cast<size_t>(blockDim.x) + threadIdx.x;
+    if(index >= layout.count)
+        return;
+    const size_t offset = layout_offset(layout, index);
+    dest[offset]        = load_op(src, offset, data, nullptr);
+}
+
+template <typename T, typename R>
+__device__ void store_pass(T* src, T* dest, void* data, const hipfft_op_layout& layout)
+{
+    const size_t index = blockIdx.x * static_cast<size_t>(blockDim.x) + threadIdx.x;
+    if(index >= layout.count)
+        return;
+    const size_t offset = layout_offset(layout, index);
+    store_op<T, R>(dest, offset, src[offset], data, nullptr);
+}
+
+extern "C" {
+__device__ auto hipfft_op_ld_c = load_op<float2>;
+__device__ auto hipfft_op_ld_z = load_op<double2>;
+__device__ auto hipfft_op_ld_r = load_op<float>;
+__device__ auto hipfft_op_ld_d = load_op<double>;
+__device__ auto hipfft_op_st_c = store_op<float2, float>;
+__device__ auto hipfft_op_st_z = store_op<double2, double>;
+__device__ auto hipfft_op_st_r = store_op<float, float>;
+__device__ auto hipfft_op_st_d = store_op<double, double>;
+__device__ auto hipfft_conv_pad_c      = conv_pad<float2>;
+__device__ auto hipfft_conv_pad_z      = conv_pad<double2>;
+__device__ auto hipfft_conv_pad_r      = conv_pad<float>;
+__device__ auto hipfft_conv_pad_d      = conv_pad<double>;
+__device__ auto hipfft_conv_multiply_c = conv_multiply<float2>;
+__device__ auto hipfft_conv_multiply_z = conv_multiply<double2>;
+__device__ auto hipfft_stream_gather_c = stream_gather<float2>;
+__device__ auto hipfft_stream_gather_z = stream_gather<double2>;
+__device__ auto hipfft_stream_gather_r = stream_gather<float>;
+__device__ auto hipfft_stream_gather_d = stream_gather<double>;
+
+__global__ void hipfft_op_ld_pass_c(float2* src, float2* dest, void* data, hipfft_op_layout layout)
+{
+    load_pass(src, dest, data, layout);
+}
+__global__ void
+    hipfft_op_ld_pass_z(double2* src, double2* dest, void* data, hipfft_op_layout layout)
+{
+    load_pass(src, dest, data, layout);
+}
+__global__ void hipfft_op_ld_pass_r(float* src, float* dest, void* data, hipfft_op_layout layout)
+{
+    load_pass(src, dest, data, layout);
+}
+__global__ void hipfft_op_ld_pass_d(double* src, double* dest, void* data, hipfft_op_layout layout)
+{
+    load_pass(src, dest, data, layout);
+}
+__global__ void hipfft_op_st_pass_c(float2* src, float2* dest, void* data, hipfft_op_layout layout)
+{
+    store_pass<float2, float>(src, dest, data, layout);
+}
+__global__ void
+    hipfft_op_st_pass_z(double2* src, double2* dest, void* data, hipfft_op_layout layout)
+{
+    store_pass<double2, double>(src, dest, data, layout);
+}
+__global__ void hipfft_op_st_pass_r(float* src, float* dest, void* data, hipfft_op_layout layout)
+{
+    store_pass<float, float>(src, dest, data, layout);
+}
+__global__ void hipfft_op_st_pass_d(double* src, double* dest, void* data, hipfft_op_layout layout)
+{
+    store_pass<double, double>(src, dest, data, layout);
+}
+}
+)";
+
+static const size_t HIPFFT_OP_MAX_DIMS = 4;
+
+// how ops read their input or write their output, if it's stored
+// in a different type from the one the transform is computed in
+enum hipfft_op_storage
+{
+    HIPFFT_OP_STORAGE_NATIVE   = 0,
+    HIPFFT_OP_STORAGE_INT8     = 1,
+    HIPFFT_OP_STORAGE_INT16    = 2,
+    HIPFFT_OP_STORAGE_HALF     = 3,
+    HIPFFT_OP_STORAGE_BFLOAT16 = 4,
+};
+
+struct hipfft_op_params
+{
+    int         type;
+    int         storage;
+    double      param;
+    const void* array;
+    // 1 / I0(beta) for Kaiser windows
+    double norm;
+    // length of the fastest dimension, and its index in strides
+    size_t length;
+    size_t fast;
+    // strides of the dimensions longer than 1 (and of the fastest
+    // one) and of the batch, in decreasing order
+    size_t dims;
+    size_t strides[HIPFFT_OP_MAX_DIMS];
+};
+
+// elements that an op pass converts.  Lengths and strides are
+// fastest first, with the batch last.
+struct hipfft_op_layout
+{
+    size_t dims;
+    size_t count;
+    size_t length[HIPFFT_OP_MAX_DIMS];
+    size_t stride[HIPFFT_OP_MAX_DIMS];
+};
+
+// loads of data zero-padded to the lengths of a convolution's
+// transforms.  Lengths are row-major.
+struct hipfft_conv_pad_params
+{
+    size_t dims;
+    size_t length[HIPFFT_OP_MAX_DIMS];
+    size_t padded[HIPFFT_OP_MAX_DIMS];
+    // elements between batches of the data and of the transform
+    size_t dist;
+    size_t padded_dist;
+};
+
+// loads of the products of a convolution's spectra
+struct hipfft_conv_multiply_params
+{
+    const void* spectra;
+    const void* filter_spectra;
+    // complex elements in each spectrum
+    size_t elements;
+    size_t filters;
+};
+
+// loads of a stream filter's blocks from its window of samples
+struct hipfft_stream_gather_params
+{
+    const void* window;
+    // samples in each block, and between the starts of blocks
+    size_t fft_size;
+    size_t block_length;
+};
+
+// hiprtc-compiled callbacks and kernels for the built-in ops.  Code
+// objects are kept per architecture and modules per device, for the
+// life of the process.
+struct hipfft_op_module
+{
+    static hipfft_op_module& get()
+    {
+        static hipfft_op_module module;
+        return module;
+    }
+
+    // address of the named callback or kernel on the current device
+    void* function(const std::string& name)
+    {
+        int device = 0;
+        if(hipGetDevice(&device) != hipSuccess)
+            throw HIPFFT_INTERNAL_ERROR;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        auto                        functions = device_functions.find(device);
+        if(functions == device_functions.end())
+            functions = device_functions.emplace(device, load(device)).first;
+        return functions->second.at(name);
+    }
+
+    // the named kernel on the current device
+    hipFunction_t kernel(const std::string& name)
+    {
+        return static_cast<hipFunction_t>(function(name));
+    }
+
+    // names of the op callbacks, by callback type
+    static const char* op_name(hipfftXtCallbackType cbtype)
+    {
+        const char* names[] = {"hipfft_op_ld_c",
+                               "hipfft_op_ld_z",
+                               "hipfft_op_ld_r",
+                               "hipfft_op_ld_d",
+                               "hipfft_op_st_c",
+                               "hipfft_op_st_z",
+                               "hipfft_op_st_r",
+                               "hipfft_op_st_d"};
+        return names[cbtype];
+    }
+
+    // names of the kernels that run ops as passes of their own
+    static std::string pass_name(hipfftXtCallbackType cbtype)
+    {
+        std::string name = op_name(cbtype);
+        return name.insert(name.size() - 2, "_pass");
+    }
+
+private:
+    std::map<std::string, void*> load(int device)
+    {
+        hipDeviceProp_t prop;
+        if(hipGetDeviceProperties(&prop, device) != hipSuccess)
+            throw HIPFFT_INTERNAL_ERROR;
+        const std::string arch = prop.gcnArchName;
+
+        auto object = code.find(arch);
+        if(object == code.end())
+            object = code.emplace(arch, compile(arch)).first;
+
+        hipModule_t module;
+        if(hipModuleLoadData(&module, object->second.data()) != hipSuccess)
+            throw HIPFFT_INTERNAL_ERROR;
+        modules.push_back(module);
+
+        std::vector<std::string> names;
+        for(int cbtype = 0; cbtype < HIPFFT_CB_UNDEFINED; ++cbtype)
+            names.push_back(op_name(static_cast<hipfftXtCallbackType>(cbtype)));
+        for(const char* type : {"c", "z", "r", "d"})
+            names.push_back(std::string("hipfft_conv_pad_") + type);
+        for(const char* type : {"c", "z"})
+            names.push_back(std::string("hipfft_conv_multiply_") + type);
+        for(const char* type : {"c", "z", "r", "d"})
+            names.push_back(std::string("hipfft_stream_gather_") + type);
+
+        std::map<std::string, void*> functions;
+        for(const auto& name : names)
+        {
+            hipDeviceptr_t symbol = nullptr;
+            size_t         bytes  = 0;
+            void*          f      = nullptr;
+            if(hipModuleGetGlobal(&symbol, &bytes, module, name.c_str()) != hipSuccess
+               || bytes != sizeof(void*)
+               || hipMemcpy(&f, symbol, bytes, hipMemcpyDeviceToHost) != hipSuccess)
+                throw HIPFFT_INTERNAL_ERROR;
+            functions[name] = f;
+        }
+        for(int cbtype = 0; cbtype < HIPFFT_CB_UNDEFINED; ++cbtype)
+        {
+            const auto    name = pass_name(static_cast<hipfftXtCallbackType>(cbtype));
+            hipFunction_t f    = nullptr;
+            if(hipModuleGetFunction(&f, module, name.c_str()) != hipSuccess)
+                throw HIPFFT_INTERNAL_ERROR;
+            functions[name] = f;
+        }
+        return functions;
+    }
+
+    static std::vector<char> compile(const std::string& arch)
+    {
+        // give the device code the op values from the public header,
+        // and the storage types
+        std::string source;
+        const auto  define = [&source](const char* name, int value) {
+            source += std::string("#define ") + name + " " + std::to_string(value) + "\n";
+        };
+        define("HIPFFT_OP_SCALE", HIPFFT_OP_SCALE);
+        define("HIPFFT_OP_WINDOW_HANN", HIPFFT_OP_WINDOW_HANN);
+        define("HIPFFT_OP_WINDOW_HAMMING", HIPFFT_OP_WINDOW_HAMMING);
+        define("HIPFFT_OP_WINDOW_BLACKMAN", HIPFFT_OP_WINDOW_BLACKMAN);
+        define("HIPFFT_OP_WINDOW_KAISER", HIPFFT_OP_WINDOW_KAISER);
+        define("HIPFFT_OP_CONJUGATE", HIPFFT_OP_CONJUGATE);
+        define("HIPFFT_OP_MULTIPLY", HIPFFT_OP_MULTIPLY);
+        define("HIPFFT_OP_MAGNITUDE", HIPFFT_OP_MAGNITUDE);
+        define("HIPFFT_OP_POWER", HIPFFT_OP_POWER);
+        define("HIPFFT_OP_STORAGE_INT8", HIPFFT_OP_STORAGE_INT8);
+        define("HIPFFT_OP_STORAGE_INT16", HIPFFT_OP_STORAGE_INT16);
+        define("HIPFFT_OP_STORAGE_HALF", HIPFFT_OP_STORAGE_HALF);
+        define("HIPFFT_OP_STORAGE_BFLOAT16", HIPFFT_OP_STORAGE_BFLOAT16);
+        source += hipfft_op_device_source;
+
+        hiprtcProgram program;
+        if(hiprtcCreateProgram(&program, source.c_str(), "hipfft_ops.cpp", 0, nullptr, nullptr)
+           != HIPRTC_SUCCESS)
+            throw HIPFFT_INTERNAL_ERROR;
+
+        const std::string archOption = "--gpu-architecture=" + arch;
+        const char*       options[]  = {archOption.c_str(), "-O3"};
+
+        std::vector<char> object;
+        size_t            size = 0;
+        if(hiprtcCompileProgram(program, 2, options) == HIPRTC_SUCCESS
+           && hiprtcGetCodeSize(program, &size) == HIPRTC_SUCCESS)
+        {
+            object.resize(size);
+            if(hiprtcGetCode(program, object.data()) != HIPRTC_SUCCESS)
+                object.clear();
+        }
+        hiprtcDestroyProgram(&program);
+
+        if(object.empty())
+            throw HIPFFT_INTERNAL_ERROR;
+        return object;
+    }
+
+    std::mutex                                  mutex;
+    std::map<std::string, std::vector<char>>    code;
+    std::vector<hipModule_t>                    modules;
+    std::map<int, std::map<std::string, void*>> device_functions;
+};
+
+// storage of data of a type that's converted as it's loaded or
+// stored
+static hipfft_op_storage op_storage(hipDataType type)
+{
+    switch(type)
+    {
+    case HIP_R_8I:
+    case HIP_C_8I:
+        return HIPFFT_OP_STORAGE_INT8;
+    case HIP_R_16I:
+    case HIP_C_16I:
+        return HIPFFT_OP_STORAGE_INT16;
+    case HIP_R_16F:
+    case HIP_C_16F:
+        return HIPFFT_OP_STORAGE_HALF;
+    case HIP_R_16BF:
+    case HIP_C_16BF:
+        return HIPFFT_OP_STORAGE_BFLOAT16;
+    default:
+        return HIPFFT_OP_STORAGE_NATIVE;
+    }
+}
+
+// describe an op over the data layout it's loaded or stored with
+static hipfft_op_params op_params(hipfftHandle plan, bool load, hipfftExtOp op, double param)
+{
+    const auto& length = load ? plan->inLength : plan->outLength;
+    const auto& stride = load ? plan->inStrides : plan->outStrides;
+    const auto  dist   = load ? plan->iDist : plan->oDist;
+    const auto  type   = load ? plan->type.inputType : plan->type.outputType;
+
+    const bool converts = load ? plan->type.converts_input() : plan->type.converts_output();
+
+    hipfft_op_params params = {};
+    params.type             = op;
+    params.storage          = converts ? op_storage(type) : HIPFFT_OP_STORAGE_NATIVE;
+    params.param            = param;
+    params.norm             = 1.0 / hipfft_op_bessel_i0(param);
+    params.length           = length.front();
+
+    // (stride, is fastest dimension) for each dimension that can
+    // contribute to an offset
+    std::vector<std::pair<size_t, bool>> dims;
+    for(size_t i = 0; i < length.size(); ++i)
+    {
+        if(i == 0 || length[i] > 1)
+            dims.emplace_back(stride[i], i == 0);
+    }
+    if(plan->batch > 1)
+        dims.emplace_back(dist, false);
+    std::stable_sort(dims.begin(), dims.end(), [](const auto& a, const auto& b) {
+        return a.first > b.first;
+    });
+
+    params.dims = dims.size();
+    for(size_t i = 0; i < dims.size(); ++i)
+    {
+        params.strides[i] = dims[i].first;
+        if(dims[i].second)
+            params.fast = i;
+    }
+    return params;
+}
+
+// the elements an op pass converts, in the layout they're loaded
+// or stored with
+static hipfft_op_layout op_layout(hipfftHandle plan, bool load)
+{
+    const auto& length = load ? plan->inLength : plan->outLength;
+    const auto& stride = load ? plan->inStrides : plan->outStrides;
+    const auto  dist   = load ? plan->iDist : plan->oDist;
+
+    hipfft_op_layout layout = {};
+    layout.dims             = length.size() + 1;
+    layout.count            = plan->batch;
+    for(size_t i = 0; i < length.size(); ++i)
+    {
+        layout.length[i] = length[i];
+        layout.stride[i] = stride[i];
+        layout.count *= length[i];
+    }
+    layout.length[length.size()] = plan->batch;
+    layout.stride[length.size()] = dist;
+    return layout;
+}
+
+// run an op's pass on the plan's stream, from src to dest
+static hipfftResult run_op_pass(hipfftHandle plan, bool load, void* src, void* dest)
+{
+    hipfft_op& state  = load ? plan->loadOp : plan->storeOp;
+    auto       layout = op_layout(plan, load);
+
+    const unsigned int block = 256;
+    const unsigned int grid  = static_cast<unsigned int>((layout.count + block - 1) / block);
+    void*              args[] = {&src, &dest, &state.params, &layout};
+    if(hipModuleLaunchKernel(
+           state.kernel, grid, 1, 1, block, 1, 1, 0, plan->stream, args, nullptr)
+       != hipSuccess)
+        return HIPFFT_EXEC_FAILED;
+    return HIPFFT_SUCCESS;
+}
+
+static hipfftResult
+    set_op(hipfftHandle plan, bool load, hipfftExtOp op, double param, const void* array)
+{
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    wait_for_plan(plan);
+    // ops need a made, single-device plan
+    if(plan->lengths.empty() || !plan->inBricks.empty())
+        return HIPFFT_INVALID_PLAN;
+
+    const auto precision = plan->type.precision();
+    if(precision != rocfft_precision_single && precision != rocfft_precision_double)
+        return HIPFFT_NOT_SUPPORTED;
+
+    const bool real = load ? plan->type.is_real_to_complex() : plan->type.is_complex_to_real();
+    switch(op)
+    {
+    case HIPFFT_OP_NONE:
+    case HIPFFT_OP_SCALE:
+    case HIPFFT_OP_WINDOW_HANN:
+    case HIPFFT_OP_WINDOW_HAMMING:
+    case HIPFFT_OP_WINDOW_BLACKMAN:
+        break;
+    case HIPFFT_OP_WINDOW_KAISER:
+        if(!(param >= 0.0))
+            return HIPFFT_INVALID_VALUE;
+        break;
+    case HIPFFT_OP_CONJUGATE:
+        if(real)
+            return HIPFFT_INVALID_VALUE;
+        break;
+    case HIPFFT_OP_MULTIPLY:
+        if(!array)
+            return HIPFFT_INVALID_VALUE;
+        break;
+    case HIPFFT_OP_MAGNITUDE:
+    case HIPFFT_OP_POWER:
+        if(load)
+            return HIPFFT_INVALID_VALUE;
+        break;
+    default:
+        return HIPFFT_INVALID_VALUE;
+    }
+    if(plan->inLength.size() + 1 > HIPFFT_OP_MAX_DIMS)
+        return HIPFFT_NOT_SUPPORTED;
+
+    return apply_op(plan, load, op, param, array);
+}
+
+// install the callback for an op, or remove it.  Converted input
+// or output always needs its callback, to convert it.
+static hipfftResult
+    apply_op(hipfftHandle plan, bool load, hipfftExtOp op, double param, const void* array)
+{
+    const bool real = load ? plan->type.is_real_to_complex() : plan->type.is_complex_to_real();
+    const bool double_precision = plan->type.precision() == rocfft_precision_double;
+    const auto cbtype           = static_cast<hipfftXtCallbackType>(
+        (load ? HIPFFT_CB_LD_COMPLEX : HIPFFT_CB_ST_COMPLEX) + (real ? 2 : 0)
+        + (double_precision ? 1 : 0));
+
+    hipfft_op& state = load ? plan->loadOp : plan->storeOp;
+    if(hipFree(state.params) != hipSuccess || hipFree(state.buffer) != hipSuccess)
+        return HIPFFT_INTERNAL_ERROR;
+    state.params = nullptr;
+    state.kernel = nullptr;
+    state.buffer = nullptr;
+    state.op     = op;
+    state.param  = param;
+
+    const bool converts = load ? plan->type.converts_input() : plan->type.converts_output();
+    if(op == HIPFFT_OP_NONE && !converts)
+        return set_plan_callback(plan, nullptr, cbtype, nullptr);
+
+    state.function = hipfft_op_module::get().function(hipfft_op_module::op_name(cbtype));
+
+    auto params  = op_params(plan, load, op, param);
+    params.array = array;
+    if(hipMalloc(&state.params, sizeof(params)) != hipSuccess)
+        return HIPFFT_ALLOC_FAILED;
+    if(hipMemcpy(state.params, &params, sizeof(params), hipMemcpyHostToDevice) != hipSuccess)
+        return HIPFFT_INTERNAL_ERROR;
+
+    // rocFFT's last kernel can read the output buffer while other
+    // threads store to it, and its first kernel can use a
+    // complex-to-real transform's input as scratch space.  A store
+    // callback that writes narrower elements than rocFFT's, or real
+    // magnitudes into complex output, would overwrite data rocFFT
+    // hasn't read yet, and converted complex-to-real input could be
+    // overwritten before it's loaded.  Those ops run as a separate
+    // pass, with rocFFT reading or writing a buffer of its own type.
+    const bool magnitude = op == HIPFFT_OP_MAGNITUDE || op == HIPFFT_OP_POWER;
+    const bool pass      = load ? converts && plan->type.is_complex_to_real()
+                                : converts || (magnitude && !real);
+    if(!pass)
+        return set_plan_callback(plan, &state.function, cbtype, &state.params);
+
+    state.kernel = hipfft_op_module::get().kernel(hipfft_op_module::pass_name(cbtype));
+
+    const auto layout   = op_layout(plan, load);
+    size_t     elements = 1;
+    for(size_t d = 0; d < layout.dims; ++d)
+        elements += (layout.length[d] - 1) * layout.stride[d];
+    const size_t element_bytes = (double_precision ? 8 : 4) * (real ? 1 : 2);
+    if(hipMalloc(&state.buffer, elements * element_bytes) != hipSuccess)
+    {
+        state.buffer = nullptr;
+        return HIPFFT_ALLOC_FAILED;
+    }
+    return set_plan_callback(plan, nullptr, cbtype, nullptr);
+}
+
+hipfftResult hipfftExtSetLoadOp(hipfftHandle plan, hipfftExtOp op, double param, const void* array)
+try
+{
+    return set_op(plan, true, op, param, array);
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult
+    hipfftExtSetStoreOp(hipfftHandle plan, hipfftExtOp op, double param, const void* array)
+try
+{
+    return set_op(plan, false, op, param, array);
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+struct hipfftExtConvolution_t
+{
+    hipfftHandle forward = nullptr;
+    hipfftHandle inverse = nullptr;
+
+    // spectra of the signals and of the filters, and the inverse
+    // transforms' nominal input.  The inverse transforms read the
+    // spectra through their load callback, but rocFFT may still use
+    // their input buffer as scratch space.
+    void* spectra        = nullptr;
+    void* filter_spectra = nullptr;
+    void* scratch        = nullptr;
+
+    // callbacks and their parameters on the device
+    void* pad_function      = nullptr;
+    void* pad_params        = nullptr;
+    void* multiply_function = nullptr;
+    void* multiply_params   = nullptr;
+};
+
+template <typename T>
+static hipfftResult copy_params_to_device(const T& params, void*& device)
+{
+    if(hipMalloc(&device, sizeof(params)) != hipSuccess)
+        return HIPFFT_ALLOC_FAILED;
+    if(hipMemcpy(device, &params, sizeof(params), hipMemcpyHostToDevice) != hipSuccess)
+        return HIPFFT_INTERNAL_ERROR;
+    return HIPFFT_SUCCESS;
+}
+
+static hipfftXtCallbackType conv_load_type(bool real, bool double_precision)
+{
+    return static_cast<hipfftXtCallbackType>(HIPFFT_CB_LD_COMPLEX + (real ? 2 : 0)
+                                             + (double_precision ? 1 : 0));
+}
+
+// make a plan load data of the given lengths, zero-padded to the
+// lengths of its transforms
+static hipfftResult conv_set_pad(hipfftHandle                      plan,
+                                 const std::vector<long long int>& length,
+                                 const std::vector<long long int>& padded,
+                                 bool                              real,
+                                 bool                              double_precision,
+                                 void*&                            function,
+                                 void*&                            params)
+{
+    hipfft_conv_pad_params p = {};
+    p.dims                   = length.size();
+    p.dist                   = 1;
+    p.padded_dist            = 1;
+    for(size_t d = 0; d < length.size(); ++d)
+    {
+        p.length[d] = length[d];
+        p.padded[d] = padded[d];
+        p.dist *= length[d];
+        p.padded_dist *= padded[d];
+    }
+
+    const char* suffix[] = {"c", "z", "r", "d"};
+    const auto  cbtype   = conv_load_type(real, double_precision);
+    function = hipfft_op_module::get().function(std::string("hipfft_conv_pad_") + suffix[cbtype]);
+    HIP_FFT_CHECK_AND_RETURN(copy_params_to_device(p, params));
+    return set_plan_callback(plan, &function, cbtype, &params);
+}
+
+// transform filters zero-padded to the lengths of a convolution's
+// transforms, scaled so that the convolution's outputs are
+// normalized
+static hipfftResult conv_transform_filters(const std::vector<long long int>& filter,
+                                           std::vector<long long int>        padded,
+                                           long long int                     numFilters,
+                                           const void*                       filters,
+                                           hipfftType                        type,
+                                           void*                             filter_spectra,
+                                           size_t*                           workSize)
+{
+    const bool real             = type == HIPFFT_R2C || type == HIPFFT_D2Z;
+    const bool double_precision = type == HIPFFT_D2Z || type == HIPFFT_Z2Z;
+
+    size_t points = 1;
+    for(auto l : padded)
+        points *= l;
+
+    hipfftHandle filter_plan = nullptr;
+    HIP_FFT_CHECK_AND_RETURN(hipfftCreate(&filter_plan));
+    std::unique_ptr<hipfftHandle_t, decltype(&hipfftDestroy)> filter_plan_guard(filter_plan,
+                                                                                hipfftDestroy);
+    HIP_FFT_CHECK_AND_RETURN(hipfftExtPlanScaleFactor(filter_plan, 1.0 / points));
+    HIP_FFT_CHECK_AND_RETURN(hipfftMakePlanMany64(filter_plan,
+                                                  padded.size(),
+                                                  padded.data(),
+                                                  nullptr,
+                                                  1,
+                                                  0,
+                                                  nullptr,
+                                                  1,
+                                                  0,
+                                                  type,
+                                                  numFilters,
+                                                  workSize));
+
+    void* pad_function = nullptr;
+    void* pad_params   = nullptr;
+    auto  result       = HIPFFT_SUCCESS;
+    if(filter != padded)
+        result = conv_set_pad(
+            filter_plan, filter, padded, real, double_precision, pad_function, pad_params);
+    if(result == HIPFFT_SUCCESS)
+        result = hipfftXtExec(
+            filter_plan, const_cast<void*>(filters), filter_spectra, HIPFFT_FORWARD);
+    if(result == HIPFFT_SUCCESS && hipDeviceSynchronize() != hipSuccess)
+        result = HIPFFT_EXEC_FAILED;
+    if(hipFree(pad_params) != hipSuccess)
+        result = HIPFFT_INTERNAL_ERROR;
+    return result;
+}
+
+// type of the inverse of a convolution's forward transforms
+static hipfftResult conv_inverse_type(hipfftType type, hipfftType& inverse_type)
+{
+    switch(type)
+    {
+    case HIPFFT_R2C:
+        inverse_type = HIPFFT_C2R;
+        return HIPFFT_SUCCESS;
+    case HIPFFT_D2Z:
+        inverse_type = HIPFFT_Z2D;
+        return HIPFFT_SUCCESS;
+    case HIPFFT_C2C:
+    case HIPFFT_Z2Z:
+        inverse_type = type;
+        return HIPFFT_SUCCESS;
+    default:
+        return HIPFFT_INVALID_TYPE;
+    }
+}
+
+hipfftResult hipfftExtConvolutionPlan(hipfftExtConvolution*    conv,
+                                      int                      rank,
+                                      long long int*           n,
+                                      long long int*           filterLength,
+                                      long long int            numFilters,
+                                      const void*              filters,
+                                      long long int            batch,
+                                      hipfftType               type,
+                                      hipfftExtConvolutionMode mode,
+                                      size_t*                  workSize)
+try
+{
+    if(!conv || !n || !filterLength || !filters || !workSize)
+        return HIPFFT_INVALID_VALUE;
+    if(rank < 1 || rank > 3 || numFilters < 1 || batch < 1)
+        return HIPFFT_INVALID_VALUE;
+
+    hipfftType inverse_type = HIPFFT_C2C;
+    HIP_FFT_CHECK_AND_RETURN(conv_inverse_type(type, inverse_type));
+    const bool real             = type == HIPFFT_R2C || type == HIPFFT_D2Z;
+    const bool double_precision = type == HIPFFT_D2Z || type == HIPFFT_Z2Z;
+
+    // transforms have the lengths of the outputs
+    const std::vector<long long int> signal(n, n + rank);
+    const std::vector<long long int> filter(filterLength, filterLength + rank);
+    std::vector<long long int>       padded(rank);
+    for(int d = 0; d < rank; ++d)
+    {
+        if(signal[d] < 1 || filter[d] < 1)
+            return HIPFFT_INVALID_SIZE;
+        switch(mode)
+        {
+        case HIPFFT_CONVOLUTION_CIRCULAR:
+            if(filter[d] > signal[d])
+                return HIPFFT_INVALID_SIZE;
+            padded[d] = signal[d];
+            break;
+        case HIPFFT_CONVOLUTION_LINEAR:
+            padded[d] = signal[d] + filter[d] - 1;
+            break;
+        default:
+            return HIPFFT_INVALID_VALUE;
+        }
+    }
+
+    // complex elements in each spectrum
+    size_t elements = 1;
+    for(int d = 0; d < rank; ++d)
+        elements *= real && d + 1 == rank ? padded[d] / 2 + 1 : padded[d];
+    const size_t element_size = double_precision ? 2 * sizeof(double) : 2 * sizeof(float);
+
+    std::unique_ptr<hipfftExtConvolution_t, decltype(&hipfftExtConvolutionDestroy)> c(
+        new hipfftExtConvolution_t, hipfftExtConvolutionDestroy);
+    size_t forward_work = 0;
+    size_t inverse_work = 0;
+    size_t filter_work  = 0;
+    HIP_FFT_CHECK_AND_RETURN(hipfftCreate(&c->forward));
+    HIP_FFT_CHECK_AND_RETURN(hipfftCreate(&c->inverse));
+    HIP_FFT_CHECK_AND_RETURN(hipfftMakePlanMany64(c->forward,
+                                                  rank,
+                                                  padded.data(),
+                                                  nullptr,
+                                                  1,
+                                                  0,
+                                                  nullptr,
+                                                  1,
+                                                  0,
+                                                  type,
+                                                  batch,
+                                                  &forward_work));
+    HIP_FFT_CHECK_AND_RETURN(hipfftMakePlanMany64(c->inverse,
+                                                  rank,
+                                                  padded.data(),
+                                                  nullptr,
+                                                  1,
+                                                  0,
+                                                  nullptr,
+                                                  1,
+                                                  0,
+                                                  inverse_type,
+                                                  batch * numFilters,
+                                                  &inverse_work));
+
+    const size_t spectra_bytes        = batch * elements * element_size;
+    const size_t filter_spectra_bytes = numFilters * elements * element_size;
+    const size_t scratch_bytes        = batch * numFilters * elements * element_size;
+    if(hipMalloc(&c->spectra, spectra_bytes) != hipSuccess
+       || hipMalloc(&c->filter_spectra, filter_spectra_bytes) != hipSuccess
+       || hipMalloc(&c->scratch, scratch_bytes) != hipSuccess)
+        return HIPFFT_ALLOC_FAILED;
+
+    // transform the filters once
+    HIP_FFT_CHECK_AND_RETURN(conv_transform_filters(
+        filter, padded, numFilters, filters, type, c->filter_spectra, &filter_work));
+
+    if(signal != padded)
+        HIP_FFT_CHECK_AND_RETURN(conv_set_pad(
+            c->forward, signal, padded, real, double_precision, c->pad_function, c->pad_params));
+
+    hipfft_conv_multiply_params multiply = {};
+    multiply.spectra                     = c->spectra;
+    multiply.filter_spectra              = c->filter_spectra;
+    multiply.elements                    = elements;
+    multiply.filters                     = numFilters;
+    c->multiply_function                 = hipfft_op_module::get().function(
+        double_precision ? "hipfft_conv_multiply_z" : "hipfft_conv_multiply_c");
+    HIP_FFT_CHECK_AND_RETURN(copy_params_to_device(multiply, c->multiply_params));
+    HIP_FFT_CHECK_AND_RETURN(set_plan_callback(c->inverse,
+                                               &c->multiply_function,
+                                               conv_load_type(false, double_precision),
+                                               &c->multiply_params));
+
+    *workSize = forward_work + inverse_work + spectra_bytes + filter_spectra_bytes + scratch_bytes;
+    *conv     = c.release();
+    return HIPFFT_SUCCESS;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftExtConvolutionExec(hipfftExtConvolution conv, void* input, void* output)
+try
+{
+    if(!conv || !input || !output)
+        return HIPFFT_INVALID_VALUE;
+    HIP_FFT_CHECK_AND_RETURN(hipfftXtExec(conv->forward, input, conv->spectra, HIPFFT_FORWARD));
+    return hipfftXtExec(conv->inverse, conv->scratch, output, HIPFFT_BACKWARD);
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftExtConvolutionSetStream(hipfftExtConvolution conv, hipStream_t stream)
+try
+{
+    if(!conv)
+        return HIPFFT_INVALID_VALUE;
+    HIP_FFT_CHECK_AND_RETURN(hipfftSetStream(conv->forward, stream));
+    return hipfftSetStream(conv->inverse, stream);
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftExtConvolutionDestroy(hipfftExtConvolution conv)
+try
+{
+    if(conv)
+    {
+        if(conv->forward)
+            HIP_FFT_CHECK_AND_RETURN(hipfftDestroy(conv->forward));
+        if(conv->inverse)
+            HIP_FFT_CHECK_AND_RETURN(hipfftDestroy(conv->inverse));
+        for(void* buffer : {conv->spectra,
+                            conv->filter_spectra,
+                            conv->scratch,
+                            conv->pad_params,
+                            conv->multiply_params})
+        {
+            if(hipFree(buffer) != hipSuccess)
+                return HIPFFT_INTERNAL_ERROR;
+        }
+        delete conv;
+    }
+    return HIPFFT_SUCCESS;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+// Stream filters keep a window of samples: the last taps - 1
+// samples of the stream, which the next block overlaps, followed by
+// samples that don't yet complete a block.  Each execution appends
+// its chunk to the window, filters every complete block, and moves
+// what's left to the start of the window.
+struct hipfftExtStreamFilter_t
+{
+    hipfftExtStreamFilterBackend backend;
+    hipfftType                   type;
+    hipfftType                   inverse_type;
+    size_t                       sample_size;
+    size_t                       taps;
+    size_t                       fft_size;
+    size_t                       block_length;
+    size_t                       blocks_per_launch;
+
+    // samples in the window
+    size_t history = 0;
+
+    hipfftExtStreamFilterStats stats = {};
+
+    // device backend.  The window has room for taps - 1 samples and
+    // blocks_per_launch blocks, and what's left of it is moved
+    // through tail if it overlaps its destination.  The inverse
+    // transforms write whole blocks to blocks, which is also the
+    // forward transforms' nominal input, and read the spectra
+    // through their load callback from a nominal input of scratch.
+    hipStream_t stream         = nullptr;
+    void*       window         = nullptr;
+    void*       tail           = nullptr;
+    void*       blocks         = nullptr;
+    void*       spectra        = nullptr;
+    void*       filter_spectra = nullptr;
+    void*       scratch        = nullptr;
+
+    // callbacks and their parameters on the device
+    void* gather_function   = nullptr;
+    void* gather_params     = nullptr;
+    void* multiply_function = nullptr;
+    void* multiply_params   = nullptr;
+
+    // forward and inverse plans for blocks_per_launch blocks.
+    // Launches with fewer blocks run the whole batch, and only the
+    // blocks they need are copied out.
+    hipfftHandle forward_plan = nullptr;
+    hipfftHandle inverse_plan = nullptr;
+
+    // events recorded on the stream around each execution, until
+    // their time is added to the stats, and events to reuse
+    std::list<std::pair<hipEvent_wrapper_t, hipEvent_wrapper_t>> timings;
+    std::list<std::pair<hipEvent_wrapper_t, hipEvent_wrapper_t>> spare_timings;
+
+    // host backend
+    std::vector<char> host_window;
+    std::vector<char> host_filter;
+};
+
+// samples transformed by each launch of a stream filter, unless the
+// number of blocks per launch is given
+static const size_t HIPFFT_STREAM_FILTER_LAUNCH_SAMPLES = size_t(1) << 18;
+
+// FFT length for a stream filter with the given number of taps: the
+// power of two, at least twice the taps and at least 256, that does
+// the least work N log N / (N - taps + 1) for each filtered sample
+static size_t stream_filter_fft_size(size_t taps)
+{
+    const auto cost = [taps](size_t n) {
+        return n * std::log2(static_cast<double>(n)) / (n - taps + 1);
+    };
+
+    size_t n = 256;
+    while(n < 2 * taps)
+        n *= 2;
+    size_t best = n;
+    for(int i = 0; i < 16; ++i)
+    {
+        n *= 2;
+        if(cost(n) < cost(best))
+            best = n;
+    }
+    return best;
+}
+
+static std::complex<double> stream_filter_host_value(hipfftComplex v)
+{
+    return {v.x, v.y};
+}
+static std::complex<double> stream_filter_host_value(hipfftDoubleComplex v)
+{
+    return {v.x, v.y};
+}
+static double stream_filter_host_value(double v)
+{
+    return v;
+}
+static void stream_filter_host_store(float* out, double v)
+{
+    *out = static_cast<float>(v);
+}
+static void stream_filter_host_store(double* out, double v)
+{
+    *out = v;
+}
+static void stream_filter_host_store(hipfftComplex* out, std::complex<double> v)
+{
+    out->x = static_cast<float>(v.real());
+    out->y = static_cast<float>(v.imag());
+}
+static void stream_filter_host_store(hipfftDoubleComplex* out, std::complex<double> v)
+{
+    out->x = v.real();
+    out->y = v.imag();
+}
+
+// filter blocks of the window on the host, directly: filtered
+// sample n of block b is the sum over k of filter[k] times sample
+// b * block_length + taps - 1 + n - k of the window
+template <typename T>
+static void stream_filter_host_blocks(const hipfftExtStreamFilter_t& f, size_t blocks, T* output)
+{
+    const T* window = reinterpret_cast<const T*>(f.host_window.data());
+    const T* filter = reinterpret_cast<const T*>(f.host_filter.data());
+    for(size_t b = 0; b < blocks; ++b)
+    {
+        for(size_t n = 0; n < f.block_length; ++n)
+        {
+            const T* x   = window + b * f.block_length + f.taps - 1 + n;
+            auto     sum = decltype(stream_filter_host_value(*filter))();
+            for(size_t k = 0; k < f.taps; ++k)
+                sum += stream_filter_host_value(filter[k]) * stream_filter_host_value(*(x - k));
+            stream_filter_host_store(output + b * f.block_length + n, sum);
+        }
+    }
+}
+
+static char* stream_filter_window(hipfftExtStreamFilter f)
+{
+    return f->backend == HIPFFT_STREAM_FILTER_HOST ? f->host_window.data()
+                                                   : static_cast<char*>(f->window);
+}
+
+// copy samples into or within a stream filter's window
+static hipfftResult
+    stream_filter_copy(hipfftExtStreamFilter f, void* dst, const void* src, size_t samples)
+{
+    const size_t bytes = samples * f->sample_size;
+    if(bytes == 0)
+        return HIPFFT_SUCCESS;
+    if(f->backend == HIPFFT_STREAM_FILTER_HOST)
+        std::memmove(dst, src, bytes);
+    else if(hipMemcpyAsync(dst, src, bytes, hipMemcpyDeviceToDevice, f->stream) != hipSuccess)
+        return HIPFFT_EXEC_FAILED;
+    return HIPFFT_SUCCESS;
+}
+
+// make the plans that filter a launch of blocks
+static hipfftResult stream_filter_plans(hipfftExtStreamFilter f)
+{
+    const bool real             = f->type == HIPFFT_R2C || f->type == HIPFFT_D2Z;
+    const bool double_precision = f->type == HIPFFT_D2Z || f->type == HIPFFT_Z2Z;
+
+    long long int n      = f->fft_size;
+    long long int blocks = f->blocks_per_launch;
+    size_t        work   = 0;
+
+    // the filter owns the plans as soon as they're created
+    HIP_FFT_CHECK_AND_RETURN(hipfftCreate(&f->forward_plan));
+    HIP_FFT_CHECK_AND_RETURN(hipfftCreate(&f->inverse_plan));
+
+    HIP_FFT_CHECK_AND_RETURN(hipfftMakePlanMany64(
+        f->forward_plan, 1, &n, nullptr, 1, 0, nullptr, 1, 0, f->type, blocks, &work));
+    HIP_FFT_CHECK_AND_RETURN(set_plan_callback(f->forward_plan,
+                                               &f->gather_function,
+                                               conv_load_type(real, double_precision),
+                                               &f->gather_params));
+    HIP_FFT_CHECK_AND_RETURN(hipfftSetStream(f->forward_plan, f->stream));
+
+    HIP_FFT_CHECK_AND_RETURN(hipfftMakePlanMany64(
+        f->inverse_plan, 1, &n, nullptr, 1, 0, nullptr, 1, 0, f->inverse_type, blocks, &work));
+    HIP_FFT_CHECK_AND_RETURN(set_plan_callback(f->inverse_plan,
+                                               &f->multiply_function,
+                                               conv_load_type(false, double_precision),
+                                               &f->multiply_params));
+    HIP_FFT_CHECK_AND_RETURN(hipfftSetStream(f->inverse_plan, f->stream));
+    return HIPFFT_SUCCESS;
+}
+
+// filter blocks at the start of the window, and write their
+// filtered samples to output
+static hipfftResult stream_filter_launch(hipfftExtStreamFilter f, size_t blocks, void* output)
+{
+    if(f->backend == HIPFFT_STREAM_FILTER_HOST)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        switch(f->type)
+        {
+        case HIPFFT_R2C:
+            stream_filter_host_blocks(*f, blocks, static_cast<float*>(output));
+            break;
+        case HIPFFT_D2Z:
+            stream_filter_host_blocks(*f, blocks, static_cast<double*>(output));
+            break;
+        case HIPFFT_C2C:
+            stream_filter_host_blocks(*f, blocks, static_cast<hipfftComplex*>(output));
+            break;
+        default:
+            stream_filter_host_blocks(*f, blocks, static_cast<hipfftDoubleComplex*>(output));
+            break;
+        }
+        f->stats.seconds
+            += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    else
+    {
+        // the plans always filter a whole launch.  Blocks past the
+        // ones that are complete read what's left in the window, and
+        // their output is dropped.
+        HIP_FFT_CHECK_AND_RETURN(
+            hipfftXtExec(f->forward_plan, f->blocks, f->spectra, HIPFFT_FORWARD));
+        HIP_FFT_CHECK_AND_RETURN(
+            hipfftXtExec(f->inverse_plan, f->scratch, f->blocks, HIPFFT_BACKWARD));
+
+        // each block's first taps - 1 samples wrap around, and are
+        // dropped
+        const size_t s = f->sample_size;
+        if(hipMemcpy2DAsync(output,
+                            f->block_length * s,
+                            static_cast<char*>(f->blocks) + (f->taps - 1) * s,
+                            f->fft_size * s,
+                            f->block_length * s,
+                            blocks,
+                            hipMemcpyDeviceToDevice,
+                            f->stream)
+           != hipSuccess)
+            return HIPFFT_EXEC_FAILED;
+    }
+
+    f->stats.blocks += blocks;
+    ++f->stats.launches;
+    return HIPFFT_SUCCESS;
+}
+
+// append a chunk to the window and filter the blocks it completes
+static hipfftResult stream_filter_push(hipfftExtStreamFilter f,
+                                       const char*           input,
+                                       size_t                length,
+                                       char*                 output,
+                                       size_t&               produced)
+{
+    const size_t s        = f->sample_size;
+    const size_t overlap  = f->taps - 1;
+    const size_t capacity = overlap + f->blocks_per_launch * f->block_length;
+    char*        window   = stream_filter_window(f);
+
+    size_t consumed = 0;
+    for(;;)
+    {
+        const size_t take = std::min(length - consumed, capacity - f->history);
+        HIP_FFT_CHECK_AND_RETURN(
+            stream_filter_copy(f, window + f->history * s, input + consumed * s, take));
+        f->history += take;
+        consumed += take;
+
+        const size_t blocks = (f->history - overlap) / f->block_length;
+        if(blocks == 0)
+            return HIPFFT_SUCCESS;
+        HIP_FFT_CHECK_AND_RETURN(stream_filter_launch(f, blocks, output + produced * s));
+        produced += blocks * f->block_length;
+        f->stats.outputSamples += blocks * f->block_length;
+
+        // keep the overlap and the samples that didn't complete a
+        // block
+        const size_t filtered = blocks * f->block_length;
+        const size_t kept     = f->history - filtered;
+        if(f->backend == HIPFFT_STREAM_FILTER_HOST || kept <= filtered)
+        {
+            HIP_FFT_CHECK_AND_RETURN(stream_filter_copy(f, window, window + filtered * s, kept));
+        }
+        else
+        {
+            HIP_FFT_CHECK_AND_RETURN(stream_filter_copy(f, f->tail, window + filtered * s, kept));
+            HIP_FFT_CHECK_AND_RETURN(stream_filter_copy(f, window, f->tail, kept));
+        }
+        f->history = kept;
+    }
+}
+
+// add the times of finished executions to the stats, or of all
+// executions if wait is set
+static hipfftResult stream_filter_collect_timings(hipfftExtStreamFilter f, bool wait)
+{
+    while(!f->timings.empty())
+    {
+        auto& timing = f->timings.front();
+        if(wait)
+        {
+            if(hipEventSynchronize(timing.second) != hipSuccess)
+                return HIPFFT_EXEC_FAILED;
+        }
+        else if(hipEventQuery(timing.second) != hipSuccess)
+            break;
+
+        float ms = 0.0f;
+        if(hipEventElapsedTime(&ms, timing.first, timing.second) != hipSuccess)
+            return HIPFFT_INTERNAL_ERROR;
+        f->stats.seconds += ms / 1000.0;
+        f->spare_timings.splice(f->spare_timings.end(), f->timings, f->timings.begin());
+    }
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftExtStreamFilterCreate(hipfftExtStreamFilter*       filter,
+                                         hipfftType                   type,
+                                         long long int                filterLength,
+                                         const void*                  coefficients,
+                                         long long int                fftSize,
+                                         long long int                blocksPerLaunch,
+                                         hipfftExtStreamFilterBackend backend)
+try
+{
+    if(!filter || !coefficients || filterLength < 1 || fftSize < 0 || blocksPerLaunch < 0)
+        return HIPFFT_INVALID_VALUE;
+    if(fftSize != 0 && fftSize < filterLength)
+        return HIPFFT_INVALID_SIZE;
+    if(backend != HIPFFT_STREAM_FILTER_DEVICE && backend != HIPFFT_STREAM_FILTER_HOST)
+        return HIPFFT_INVALID_VALUE;
+
+    hipfftType inverse_type = HIPFFT_C2C;
+    HIP_FFT_CHECK_AND_RETURN(conv_inverse_type(type, inverse_type));
+    const bool real             = type == HIPFFT_R2C || type == HIPFFT_D2Z;
+    const bool double_precision = type == HIPFFT_D2Z || type == HIPFFT_Z2Z;
+
+    std::unique_ptr<hipfftExtStreamFilter_t, decltype(&hipfftExtStreamFilterDestroy)> f(
+        new hipfftExtStreamFilter_t, hipfftExtStreamFilterDestroy);
+    f->backend           = backend;
+    f->type              = type;
+    f->inverse_type      = inverse_type;
+    f->sample_size       = (double_precision ? sizeof(double) : sizeof(float)) * (real ? 1 : 2);
+    f->taps              = filterLength;
+    f->fft_size          = fftSize ? fftSize : stream_filter_fft_size(f->taps);
+    f->block_length      = f->fft_size - f->taps + 1;
+    f->blocks_per_launch
+        = blocksPerLaunch ? blocksPerLaunch
+                          : std::max<size_t>(1, HIPFFT_STREAM_FILTER_LAUNCH_SAMPLES / f->fft_size);
+
+    // the stream is zero before it starts
+    const size_t overlap        = f->taps - 1;
+    const size_t window_samples = overlap + f->blocks_per_launch * f->block_length;
+    f->history                  = overlap;
+
+    if(backend == HIPFFT_STREAM_FILTER_HOST)
+    {
+        f->host_window.assign(window_samples * f->sample_size, 0);
+        const char* c = static_cast<const char*>(coefficients);
+        f->host_filter.assign(c, c + f->taps * f->sample_size);
+        *filter = f.release();
+        return HIPFFT_SUCCESS;
+    }
+
+    // complex elements in each spectrum
+    const size_t elements      = real ? f->fft_size / 2 + 1 : f->fft_size;
+    const size_t spectrum_size = (double_precision ? 2 * sizeof(double) : 2 * sizeof(float));
+    const size_t s             = f->sample_size;
+    const size_t spectra_bytes = f->blocks_per_launch * elements * spectrum_size;
+    if(hipMalloc(&f->window, window_samples * s) != hipSuccess
+       || hipMalloc(&f->tail, (overlap + f->block_length) * s) != hipSuccess
+       || hipMalloc(&f->blocks, f->blocks_per_launch * f->fft_size * s) != hipSuccess
+       || hipMalloc(&f->spectra, spectra_bytes) != hipSuccess
+       || hipMalloc(&f->filter_spectra, elements * spectrum_size) != hipSuccess
+       || hipMalloc(&f->scratch, spectra_bytes) != hipSuccess)
+        return HIPFFT_ALLOC_FAILED;
+    // the whole window is cleared, so that blocks a launch doesn't
+    // need are filtered from defined samples
+    if(hipMemset(f->window, 0, window_samples * s) != hipSuccess)
+        return HIPFFT_INTERNAL_ERROR;
+
+    size_t filter_work = 0;
+    HIP_FFT_CHECK_AND_RETURN(conv_transform_filters({filterLength},
+                                                    {static_cast<long long int>(f->fft_size)},
+                                                    1,
+                                                    coefficients,
+                                                    type,
+                                                    f->filter_spectra,
+                                                    &filter_work));
+
+    hipfft_stream_gather_params gather = {};
+    gather.window                      = f->window;
+    gather.fft_size                    = f->fft_size;
+    gather.block_length                = f->block_length;
+    const char* suffix[]               = {"c", "z", "r", "d"};
+    f->gather_function                 = hipfft_op_module::get().function(
+        std::string("hipfft_stream_gather_") + suffix[conv_load_type(real, double_precision)]);
+    HIP_FFT_CHECK_AND_RETURN(copy_params_to_device(gather, f->gather_params));
+
+    hipfft_conv_multiply_params multiply = {};
+    multiply.spectra                     = f->spectra;
+    multiply.filter_spectra              = f->filter_spectra;
+    multiply.elements                    = elements;
+    multiply.filters                     = 1;
+    f->multiply_function                 = hipfft_op_module::get().function(
+        double_precision ? "hipfft_conv_multiply_z" : "hipfft_conv_multiply_c");
+    HIP_FFT_CHECK_AND_RETURN(copy_params_to_device(multiply, f->multiply_params));
+
+    HIP_FFT_CHECK_AND_RETURN(stream_filter_plans(f.get()));
+
+    *filter = f.release();
+    return HIPFFT_SUCCESS;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftExtStreamFilterGetSizes(hipfftExtStreamFilter filter,
+                                           long long int*        fftSize,
+                                           long long int*        blockLength,
+                                           long long int*        blocksPerLaunch)
+try
+{
+    if(!filter)
+        return HIPFFT_INVALID_VALUE;
+    if(fftSize)
+        *fftSize = filter->fft_size;
+    if(blockLength)
+        *blockLength = filter->block_length;
+    if(blocksPerLaunch)
+        *blocksPerLaunch = filter->blocks_per_launch;
+    return HIPFFT_SUCCESS;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftExtStreamFilterExec(hipfftExtStreamFilter filter,
+                                       const void*           input,
+                                       long long int         inputLength,
+                                       void*                 output,
+                                       long long int*        outputLength)
+try
+{
+    if(!filter || !outputLength || inputLength < 0 || (inputLength > 0 && (!input || !output)))
+        return HIPFFT_INVALID_VALUE;
+
+    const bool device = filter->backend == HIPFFT_STREAM_FILTER_DEVICE;
+    if(device)
+    {
+        HIP_FFT_CHECK_AND_RETURN(stream_filter_collect_timings(filter, false));
+        if(filter->spare_timings.empty())
+        {
+            filter->spare_timings.emplace_back();
+            filter->spare_timings.back().first.alloc();
+            filter->spare_timings.back().second.alloc();
+        }
+        filter->timings.splice(
+            filter->timings.end(), filter->spare_timings, filter->spare_timings.begin());
+        if(hipEventRecord(filter->timings.back().first, filter->stream) != hipSuccess)
+            return HIPFFT_EXEC_FAILED;
+    }
+
+    size_t produced = 0;
+    auto   result   = stream_filter_push(filter,
+                                     static_cast<const char*>(input),
+                                     inputLength,
+                                     static_cast<char*>(output),
+                                     produced);
+    filter->stats.inputSamples += inputLength;
+    *outputLength = produced;
+
+    // the end is recorded even if filtering failed, so that the
+    // timing can be collected
+    if(device && hipEventRecord(filter->timings.back().second, filter->stream) != hipSuccess
+       && result == HIPFFT_SUCCESS)
+        result = HIPFFT_EXEC_FAILED;
+    return result;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftExtStreamFilterGetStats(hipfftExtStreamFilter       filter,
+                                           hipfftExtStreamFilterStats* stats)
+try
+{
+    if(!filter || !stats)
+        return HIPFFT_INVALID_VALUE;
+    if(filter->backend == HIPFFT_STREAM_FILTER_DEVICE)
+        HIP_FFT_CHECK_AND_RETURN(stream_filter_collect_timings(filter, true));
+
+    *stats = filter->stats;
+    stats->samplesPerSecond
+        = stats->seconds > 0.0 ? stats->outputSamples / stats->seconds : 0.0;
+    return HIPFFT_SUCCESS;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftExtStreamFilterSetStream(hipfftExtStreamFilter filter, hipStream_t stream)
+try
+{
+    if(!filter)
+        return HIPFFT_INVALID_VALUE;
+    filter->stream = stream;
+    for(auto plan : {filter->forward_plan, filter->inverse_plan})
+    {
+        if(plan)
+            HIP_FFT_CHECK_AND_RETURN(hipfftSetStream(plan, stream));
+    }
+    return HIPFFT_SUCCESS;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftExtStreamFilterDestroy(hipfftExtStreamFilter filter)
+try
+{
+    if(filter)
+    {
+        for(auto plan : {filter->forward_plan, filter->inverse_plan})
+            HIP_FFT_CHECK_AND_RETURN(hipfftDestroy(plan));
+        // host filters make no HIP calls, so they work without a
+        // device
+        for(void* buffer : {filter->window,
+                            filter->tail,
+                            filter->blocks,
+                            filter->spectra,
+                            filter->filter_spectra,
+                            filter->scratch,
+                            filter->gather_params,
+                            filter->multiply_params})
+        {
+            if(buffer && hipFree(buffer) != hipSuccess)
+                return HIPFFT_INTERNAL_ERROR;
+        }
+        delete filter;
+    }
+    return HIPFFT_SUCCESS;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftXtMakePlanMany(hipfftHandle   plan,
+                                  int            rank,
+                                  long long int* n,
+                                  long long int* inembed,
+                                  long long int  istride,
+                                  long long int  idist,
+                                  hipDataType    inputtype,
+                                  long long int* onembed,
+                                  long long int  ostride,
+                                  long long int  odist,
+                                  hipDataType    outputtype,
+                                  long long int  batch,
+                                  size_t*        workSize,
+                                  hipDataType    executiontype)
+try
+{
+    hipfftIOType iotype;
+    HIP_FFT_CHECK_AND_RETURN(iotype.init(inputtype, outputtype, executiontype));
+    return hipfftMakePlanMany_internal<long long int>(
+        plan, rank, n, inembed, istride, idist, onembed, ostride, odist, iotype, batch, workSize);
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftXtGetSizeMany(hipfftHandle   plan,
+                                 int            rank,
+                                 long long int* n,
+                                 long long int* inembed,
+                                 long long int  istride,
+                                 long long int  idist,
+                                 hipDataType    inputtype,
+                                 long long int* onembed,
+                                 long long int  ostride,
+                                 long long int  odist,
+                                 hipDataType    outputtype,
+                                 long long int  batch,
+                                 size_t*        workSize,
+                                 hipDataType    executiontype)
+try
+{
+    hipfftIOType iotype;
+    HIP_FFT_CHECK_AND_RETURN(iotype.init(inputtype, outputtype, executiontype));
+
+    return estimate_work_size(
+        plan,
+        [&](hipfftHandle p) {
+            return hipfftMakePlanMany_internal(p,
+                                               rank,
+                                               n,
+                                               inembed,
+                                               istride,
+                                               idist,
+                                               onembed,
+                                               ostride,
+                                               odist,
+                                               iotype,
+                                               batch,
+                                               nullptr);
+        },
+        workSize);
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+// run task(i) for each i in [0, count) on a pool of threads, all
+// using the caller's current device
+static void parallel_for(size_t count, const std::function<void(size_t)>& task)
+{
+    if(count == 0)
+        return;
+
+    int device = 0;
+    if(hipGetDevice(&device) != hipSuccess)
+        throw HIPFFT_INVALID_DEVICE;
+
+    std::atomic<size_t> next{0};
+    auto                worker = [&]() {
+        if(hipSetDevice(device) != hipSuccess)
+            return;
+        for(size_t i = next++; i < count; i = next++)
+            task(i);
+    };
+
+    // the calling thread is one of the workers
+    const size_t num_threads
+        = std::min<size_t>(count, std::max<unsigned int>(rocfft_concurrency(), 1));
+    std::vector<std::thread> threads;
+    for(size_t t = 1; t < num_threads; ++t)
+        threads.emplace_back(worker);
+    worker();
+    for(auto& t : threads)
+        t.join();
+}
+
+// everything in a bulk plan spec that determines the plan, except
+// for the handle
+static std::vector<long long int> bulk_spec_key(const hipfftExtPlanSpec& spec)
+{
+    std::vector<long long int> key = {spec.rank};
+    for(auto dims : {spec.n, spec.inembed, spec.onembed})
+    {
+        key.push_back(dims != nullptr);
+        if(dims != nullptr)
+            key.insert(key.end(), dims, dims + spec.rank);
+    }
+    key.insert(key.end(),
+               {spec.istride,
+                spec.idist,
+                spec.inputType,
+                spec.ostride,
+                spec.odist,
+                spec.outputType,
+                spec.batch,
+                spec.executionType});
+    return key;
+}
+
+hipfftResult hipfftExtMakePlansBulk(hipfftExtPlanSpec* specs, size_t count)
+try
+{
+    if(count == 0)
+        return HIPFFT_SUCCESS;
+    if(!specs)
+        return HIPFFT_INVALID_VALUE;
+
+    // making a plan modifies its handle, so handles can't be shared
+    std::set<hipfftHandle> handles;
+    for(size_t i = 0; i < count; ++i)
+    {
+        if(!specs[i].plan || !handles.insert(specs[i].plan).second)
+            return HIPFFT_INVALID_PLAN;
+    }
+
+    // plan each distinct spec once.  The other plans with the same
+    // spec are made afterwards, and find the rocFFT plans they need
+    // in the plan cache.
+    std::vector<size_t>                          first;
+    std::vector<size_t>                          duplicates;
+    std::map<std::vector<long long int>, size_t> seen;
+    for(size_t i = 0; i < count; ++i)
+    {
+        // invalid ranks are left for hipfftXtMakePlanMany to reject
+        const auto& spec = specs[i];
+        if(spec.rank >= 1 && spec.rank <= 3 && spec.n != nullptr
+           && !seen.emplace(bulk_spec_key(spec), i).second)
+            duplicates.push_back(i);
+        else
+            first.push_back(i);
+    }
+
+    auto make_plan = [specs](size_t i) {
+        auto& spec = specs[i];
+        // a spec only has room for one size, so multi-device plans
+        // report their first device's
+        std::vector<size_t> workSize(std::max<size_t>(spec.plan->inBricks.size(), 1));
+        spec.status = hipfftXtMakePlanMany(spec.plan,
+                                           spec.rank,
+                                           spec.n,
+                                           spec.inembed,
+                                           spec.istride,
+                                           spec.idist,
+                                           spec.inputType,
+                                           spec.onembed,
+                                           spec.ostride,
+                                           spec.odist,
+                                           spec.outputType,
+                                           spec.batch,
+                                           workSize.data(),
+                                           spec.executionType);
+        spec.workSize = workSize.front();
+    };
+    parallel_for(first.size(), [&](size_t i) { make_plan(first[i]); });
+    parallel_for(duplicates.size(), [&](size_t i) { make_plan(duplicates[i]); });
+
+    for(size_t i = 0; i < count; ++i)
+    {
+        if(specs[i].status != HIPFFT_SUCCESS)
+            return specs[i].status;
+    }
+    return HIPFFT_SUCCESS;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftXtExec(hipfftHandle plan, void* input, void* output, int direction)
+try
+{
+    std::lock_guard<std::mutex> lock(plan->mutex);
+
+    bool        inplace  = input == output;
+    rocfft_plan plan_ptr = nullptr;
+    if(plan->type.is_real_to_complex() || direction == HIPFFT_FORWARD)
+    {
+        plan_ptr = get_exec_plan(plan, inplace, HIPFFT_FORWARD);
+    }
+    else if(plan->type.is_complex_to_real() || direction == HIPFFT_BACKWARD)
+    {
+        plan_ptr = get_exec_plan(plan, inplace, HIPFFT_BACKWARD);
+    }
+    if(!plan_ptr)
+        return HIPFFT_INTERNAL_ERROR;
+
+    return hipfftExecWithOps(plan, plan_ptr, input, output);
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+struct hipfftExtExecContext_t
+{
+    hipfftHandle          plan = nullptr;
+    rocfft_execution_info info = nullptr;
+
+    void*  workBuffer          = nullptr;
+    size_t workBufferSize      = 0;
+    bool   workBufferNeedsFree = false;
+
+    void** load_callback_ptrs  = nullptr;
+    void** load_callback_data  = nullptr;
+    void** store_callback_ptrs = nullptr;
+    void** store_callback_data = nullptr;
+};
+
+// free the work buffer if it was allocated by the context
+static hipfftResult free_work_buffer(hipfftExtExecContext context)
+{
+    if(context->workBuffer && context->workBufferNeedsFree)
+    {
+        if(hipFree(context->workBuffer) != hipSuccess)
+            return HIPFFT_ALLOC_FAILED;
+        context->workBufferNeedsFree = false;
+    }
+    context->workBuffer     = nullptr;
+    context->workBufferSize = 0;
+    return HIPFFT_SUCCESS;
+}
+
+static hipfftResult set_context_callbacks(hipfftExtExecContext context)
+{
+    const auto plan = context->plan;
+    ROC_FFT_CHECK_INVALID_VALUE(
+        rocfft_execution_info_set_load_callback(context->info,
+                                                context->load_callback_ptrs,
+                                                context->load_callback_data,
+                                                plan->load_callback_lds_bytes));
+    ROC_FFT_CHECK_INVALID_VALUE(
+        rocfft_execution_info_set_store_callback(context->info,
+                                                 context->store_callback_ptrs,
+                                                 context->store_callback_data,
+                                                 plan->store_callback_lds_bytes));
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftExtExecContextCreate(hipfftHandle plan, hipfftExtExecContext* context)
+try
+{
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    if(!context)
+        return HIPFFT_INVALID_VALUE;
+    wait_for_plan(plan);
+    if(plan->lengths.empty())
+        return HIPFFT_INVALID_PLAN;
+
+    std::unique_ptr<hipfftExtExecContext_t, decltype(&hipfftExtExecContextDestroy)> ctx(
+        new hipfftExtExecContext_t, hipfftExtExecContextDestroy);
+    ctx->plan                = plan;
+    ctx->load_callback_ptrs  = plan->load_callback_ptrs;
+    ctx->load_callback_data  = plan->load_callback_data;
+    ctx->store_callback_ptrs = plan->store_callback_ptrs;
+    ctx->store_callback_data = plan->store_callback_data;
+    ROC_FFT_CHECK_INVALID_VALUE(rocfft_execution_info_create(&ctx->info));
+    ROC_FFT_CHECK_INVALID_VALUE(rocfft_execution_info_set_stream(ctx->info, plan->stream));
+    HIP_FFT_CHECK_AND_RETURN(set_context_callbacks(ctx.get()));
+
+    *context = ctx.release();
+    return HIPFFT_SUCCESS;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftExtExecContextDestroy(hipfftExtExecContext context)
+try
+{
+    if(context)
+    {
+        HIP_FFT_CHECK_AND_RETURN(free_work_buffer(context));
+        if(context->info)
+            ROC_FFT_CHECK_INVALID_VALUE(rocfft_execution_info_destroy(context->info));
+        delete context;
+    }
+    return HIPFFT_SUCCESS;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftExtExecContextSetStream(hipfftExtExecContext context, hipStream_t stream)
+try
+{
+    if(!context)
+        return HIPFFT_INVALID_VALUE;
+    ROC_FFT_CHECK_INVALID_VALUE(rocfft_execution_info_set_stream(context->info, stream));
+    return HIPFFT_SUCCESS;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftExtExecContextSetWorkArea(hipfftExtExecContext context, void* workArea)
+try
+{
+    if(!context)
+        return HIPFFT_INVALID_VALUE;
+    HIP_FFT_CHECK_AND_RETURN(free_work_buffer(context));
+    if(workArea)
+    {
+        // the caller vouches for the size; it's checked against each
+        // plan's requirement at exec time only when allocating
+        context->workBuffer     = workArea;
+        context->workBufferSize = std::numeric_limits<size_t>::max();
+    }
+    return HIPFFT_SUCCESS;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftExtExecContextSetCallback(hipfftExtExecContext context,
+                                             void**               callbacks,
+                                             hipfftXtCallbackType cbtype,
+                                             void**               callbackData)
+try
+{
+    if(!context)
+        return HIPFFT_INVALID_VALUE;
+    if(callback_is_load(context->plan, cbtype))
+    {
+        if(context->plan->type.converts_input())
+            return HIPFFT_NOT_SUPPORTED;
+        context->load_callback_ptrs = callbacks;
+        context->load_callback_data = callbackData;
+    }
+    else
+    {
+        if(context->plan->type.converts_output())
+            return HIPFFT_NOT_SUPPORTED;
+        context->store_callback_ptrs = callbacks;
+        context->store_callback_data = callbackData;
+    }
+    return set_context_callbacks(context);
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftExtExecWithContext(hipfftExtExecContext context,
+                                      void*                input,
+                                      void*                output,
+                                      int                  direction)
+try
+{
+    if(!context)
+        return HIPFFT_INVALID_VALUE;
+    const auto plan = context->plan;
+
+    // ops that run in a pass of their own use buffers that belong to
+    // the handle, so they can't run concurrently
+    if(plan->loadOp.kernel || plan->storeOp.kernel)
+        return HIPFFT_NOT_SUPPORTED;
+
+    if(plan->type.is_real_to_complex())
+        direction = HIPFFT_FORWARD;
+    else if(plan->type.is_complex_to_real())
+        direction = HIPFFT_BACKWARD;
+    if(direction != HIPFFT_FORWARD && direction != HIPFFT_BACKWARD)
+        return HIPFFT_INTERNAL_ERROR;
+    const bool inplace = input == output;
+    const bool forward = direction == HIPFFT_FORWARD;
+
+    // only lazily-created plans are modified by execution, so only
+    // they need to be locked.  The handle's own work buffer is grown
+    // to fit the new plan when the handle itself is next executed.
+    if(plan->lazy_create)
+    {
+        std::lock_guard<std::mutex> lock(plan->mutex);
+        create_exec_plan(plan, inplace, forward);
+    }
+    const auto rplan = inplace ? (forward ? plan->ip_forward : plan->ip_inverse)
+                               : (forward ? plan->op_forward : plan->op_inverse);
+    if(!rplan)
+        return HIPFFT_EXEC_FAILED;
+
+    size_t workSize = 0;
+    ROC_FFT_CHECK_INVALID_VALUE(rocfft_plan_get_work_buffer_size(rplan, &workSize));
+    if(workSize > context->workBufferSize)
+    {
+        HIP_FFT_CHECK_AND_RETURN(free_work_buffer(context));
+        if(hipMalloc(&context->workBuffer, workSize) != hipSuccess)
+        {
+            context->workBuffer = nullptr;
+            return HIPFFT_ALLOC_FAILED;
+        }
+        context->workBufferSize      = workSize;
+        context->workBufferNeedsFree = true;
+    }
+    if(workSize > 0)
+        ROC_FFT_CHECK_INVALID_VALUE(
+            rocfft_execution_info_set_work_buffer(context->info, context->workBuffer, workSize));
+
+    return hipfftExec(rplan, context->info, input, output);
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftXtSetGPUs(hipfftHandle plan, int count, int* gpus)
+try
+{
+    if(!plan || plan->pending.valid())
+        return HIPFFT_INVALID_PLAN;
+    if(count <= 0)
+        return HIPFFT_INVALID_VALUE;
+
+    // we know how many bricks we will have, but we haven't been told
+    // the problem dimensions yet so we don't know what the bricks
+    // will look like.
+    plan->inBricks.resize(static_cast<size_t>(count));
+    plan->outBricks.resize(static_cast<size_t>(count));
+
+    // but at this point we know devices, so record what the user
+    // gave us
+    for(size_t i = 0; i < static_cast<size_t>(count); ++i)
+    {
+        plan->inBricks[i].device  = gpus[i];
+        plan->outBricks[i].device = gpus[i];
+    }
+    plan->inUserBricks.clear();
+    plan->outUserBricks.clear();
+    plan->pencilRows    = 0;
+    plan->pencilColumns = 0;
+
+    return HIPFFT_SUCCESS;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftExtXtSetDecomposition(hipfftHandle           plan,
+                                         hipfftExtDecomposition policy,
+                                         const double*          weights)
+try
+{
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    // decomposition can't change once the plan is made
+    if(!plan->lengths.empty() || plan->pending.valid())
+        return HIPFFT_INVALID_PLAN;
+    // bricks set by the user aren't decomposed any further
+    if(plan->inBricks.empty() || !plan->inUserBricks.empty())
+        return HIPFFT_INVALID_VALUE;
+    // and pencils are split evenly
+    if(plan->pencilRows != 0 && policy != HIPFFT_DECOMPOSITION_EVEN)
+        return HIPFFT_INVALID_VALUE;
+
+    std::vector<double> brickWeights;
+    switch(policy)
+    {
+    case HIPFFT_DECOMPOSITION_EVEN:
+    case HIPFFT_DECOMPOSITION_DEVICE_PROPERTIES:
+        break;
+    case HIPFFT_DECOMPOSITION_WEIGHTED:
+        if(!weights)
+            return HIPFFT_INVALID_VALUE;
+        brickWeights.assign(weights, weights + plan->inBricks.size());
+        for(auto weight : brickWeights)
+        {
+            if(!std::isfinite(weight) || weight <= 0.0)
+                return HIPFFT_INVALID_VALUE;
+        }
+        break;
+    default:
+        return HIPFFT_INVALID_VALUE;
+    }
+
+    plan->decomposition = policy;
+    plan->brickWeights  = std::move(brickWeights);
+    return HIPFFT_SUCCESS;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftExtXtGetDecomposition(hipfftHandle plan, hipfftExtDecompositionInfo* info)
+try
+{
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    wait_for_plan(plan);
+    if(plan->lengths.empty())
+        return HIPFFT_INVALID_PLAN;
+    if(!info || plan->inBricks.empty() || plan->inBricks.size() > MAX_HIP_DESCRIPTOR_GPUS)
+        return HIPFFT_INVALID_VALUE;
+
+    const size_t count = plan->inBricks.size();
+
+    // normalize weights so they sum to 1
+    auto shares = [](std::vector<double> weights) {
+        const double total = std::accumulate(weights.begin(), weights.end(), 0.0);
+        for(auto& weight : weights)
+            weight /= total;
+        return weights;
+    };
+    const auto weights = shares(plan->brickWeights.empty() ? std::vector<double>(count, 1.0)
+                                                           : plan->brickWeights);
+    const auto capability = shares(device_weights(plan->inBricks));
+
+    auto elements = [](const hipfft_brick& brick) {
+        const auto length = brick.length();
+        return std::accumulate(
+            length.begin(), length.end(), size_t(1), std::multiplies<size_t>());
+    };
+    size_t totalIn = 0, totalOut = 0;
+    for(size_t i = 0; i < count; ++i)
+    {
+        totalIn += elements(plan->inBricks[i]);
+        totalOut += elements(plan->outBricks[i]);
+    }
+
+    memset(info, 0, sizeof(*info));
+    info->nGPUs = static_cast<int>(count);
+    for(size_t i = 0; i < count; ++i)
+    {
+        info->GPUs[i]           = plan->inBricks[i].device;
+        info->weights[i]        = weights[i];
+        info->capability[i]     = capability[i];
+        info->inputElements[i]  = elements(plan->inBricks[i]);
+        info->outputElements[i] = elements(plan->outBricks[i]);
+
+        const double share = std::max(static_cast<double>(info->inputElements[i]) / totalIn,
+                                      static_cast<double>(info->outputElements[i]) / totalOut);
+        info->imbalance           = std::max(info->imbalance, share / weights[i]);
+        info->capabilityImbalance = std::max(info->capabilityImbalance, share / capability[i]);
+    }
+    return HIPFFT_SUCCESS;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftExtXtSetBricks(hipfftHandle          plan,
+                                  int                   count,
+                                  const int*            gpus,
+                                  const hipfftExtBrick* inBricks,
+                                  const hipfftExtBrick* outBricks)
+try
+{
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    // bricks can't change once the plan is made
+    if(!plan->lengths.empty() || plan->pending.valid())
+        return HIPFFT_INVALID_PLAN;
+    if(count <= 0 || !gpus || !inBricks || !outBricks)
+        return HIPFFT_INVALID_VALUE;
+
+    // the bricks can only be checked against the problem once the
+    // plan is made
+    plan->inBricks.resize(static_cast<size_t>(count));
+    plan->outBricks.resize(static_cast<size_t>(count));
+    for(size_t i = 0; i < static_cast<size_t>(count); ++i)
+    {
+        plan->inBricks[i].device  = gpus[i];
+        plan->outBricks[i].device = gpus[i];
+    }
+    plan->inUserBricks.assign(inBricks, inBricks + count);
+    plan->outUserBricks.assign(outBricks, outBricks + count);
+    plan->decomposition = HIPFFT_DECOMPOSITION_EVEN;
+    plan->brickWeights.clear();
+    plan->pencilRows    = 0;
+    plan->pencilColumns = 0;
+
+    return HIPFFT_SUCCESS;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftExtXtSetPencilGrid(hipfftHandle plan, int rows, int columns)
+try
+{
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    // the grid can't change once the plan is made
+    if(!plan->lengths.empty() || plan->pending.valid())
+        return HIPFFT_INVALID_PLAN;
+    if(rows <= 0 || columns <= 0
+       || static_cast<size_t>(rows) * static_cast<size_t>(columns) != plan->inBricks.size())
+        return HIPFFT_INVALID_VALUE;
+    // bricks set by the user aren't decomposed any further, and
+    // pencils are split evenly
+    if(!plan->inUserBricks.empty() || plan->decomposition != HIPFFT_DECOMPOSITION_EVEN)
+        return HIPFFT_INVALID_VALUE;
+
+    plan->pencilRows    = static_cast<size_t>(rows);
+    plan->pencilColumns = static_cast<size_t>(columns);
+    return HIPFFT_SUCCESS;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftExtXtSetPipelineChunks(hipfftHandle plan, int chunks)
+try
+{
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    if(chunks < 1)
+        return HIPFFT_INVALID_VALUE;
+    wait_for_plan(plan);
+
+    std::lock_guard<std::mutex> lock(plan->mutex);
+    plan->pipeline.chunks = static_cast<size_t>(chunks);
+    // the work areas of a plan that's already made must also fit
+    // the plans for its new chunks
+    if(!plan->lengths.empty())
+        create_pipeline_plans(plan);
+    return HIPFFT_SUCCESS;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+// get number of bytes used for elements of a given hipDataType
+static size_t hipDataType_bits(hipDataType t)
+{
+    switch(t)
+    {
+    case HIP_R_8I:
+        // real 8-bit integer
+        return 8;
+    case HIP_R_16F:
+    case HIP_R_16BF:
+    case HIP_C_8I:
+    case HIP_R_16I:
+        // real half and bfloat16, complex 8-bit and real 16-bit integer
+        return 16;
+    case HIP_C_16F:
+    case HIP_C_16BF:
     case HIP_R_32F:
-        // complex half and real single
+    case HIP_C_16I:
+        // complex half and bfloat16, real single and complex 16-bit integer
         return 32;
     case HIP_C_32F:
     case HIP_R_64F:
@@ -2034,311 +6769,2061 @@ static size_t hipDataType_bits(hipDataType t)
         // complex double
         return 128;
     default:
-        throw std::runtime_error("unsupported data type");
+        throw std::runtime_error("unsupported data type");
+    }
+}
+
+static size_t hipDataType_bytes(hipDataType t, size_t numElems)
+{
+    return hipDataType_bits(t) * numElems / 8;
+}
+
+hipfftResult hipfftXtMalloc(hipfftHandle plan, hipLibXtDesc** desc, hipfftXtSubFormat format)
+try
+{
+    if(!plan || !desc)
+        return HIPFFT_INVALID_VALUE;
+
+    auto lib_desc = std::make_unique<hipLibXtDesc>();
+    memset(lib_desc.get(), 0, sizeof(hipLibXtDesc));
+
+    lib_desc->version       = 0;
+    lib_desc->library       = HIPLIB_FORMAT_HIPFFT;
+    lib_desc->subFormat     = format;
+    lib_desc->libDescriptor = nullptr;
+
+    auto xt_desc = std::make_unique<hipXtDesc>();
+    memset(xt_desc.get(), 0, sizeof(hipXtDesc));
+    xt_desc->version = 0;
+
+    std::vector<hipfft_brick>* bricks           = nullptr;
+    size_t                     bits_per_element = 0;
+
+    switch(format)
+    {
+    case HIPFFT_XT_FORMAT_INPUT:
+        bricks           = &plan->inBricks;
+        bits_per_element = hipDataType_bits(plan->type.inputType);
+        break;
+    case HIPFFT_XT_FORMAT_OUTPUT:
+        bricks           = &plan->outBricks;
+        bits_per_element = hipDataType_bits(plan->type.outputType);
+        break;
+    case HIPFFT_XT_FORMAT_INPLACE_SHUFFLED:
+    {
+        // settle whether the plan has a shuffled layout before any
+        // data is copied in that layout
+        std::lock_guard<std::mutex> lock(plan->mutex);
+        if(plan->type.is_complex_to_complex())
+            create_shuffled_plans(plan);
+    }
+        [[fallthrough]];
+    case HIPFFT_XT_FORMAT_INPLACE:
+        bricks           = &plan->outBricks;
+        bits_per_element = std::max(hipDataType_bits(plan->type.inputType),
+                                    hipDataType_bits(plan->type.outputType));
+        break;
+    case HIPFFT_XT_FORMAT_1D_INPUT_SHUFFLED:
+        // 1D data is never shuffled between devices, so this is the
+        // same as the natural in-place layout
+        if(plan->lengths.size() != 1)
+            return HIPFFT_INVALID_VALUE;
+        bricks           = &plan->outBricks;
+        bits_per_element = std::max(hipDataType_bits(plan->type.inputType),
+                                    hipDataType_bits(plan->type.outputType));
+        break;
+    default:
+        return HIPFFT_NOT_IMPLEMENTED;
+    }
+
+    // in-place data can move between the natural and shuffled
+    // layouts, so needs room for both
+    const bool shuffles = (format == HIPFFT_XT_FORMAT_INPLACE
+                           || format == HIPFFT_XT_FORMAT_INPLACE_SHUFFLED)
+                          && plan->shuffledBricks.size() == bricks->size();
+
+    xt_desc->nGPUs = static_cast<int>(bricks->size());
+
+    for(size_t i = 0; i < bricks->size(); ++i)
+    {
+        auto& brick = (*bricks)[i];
+
+        rocfft_scoped_device dev(brick.device);
+
+        size_t min_size = brick.min_size;
+        if(shuffles)
+            min_size = std::max(min_size, plan->shuffledBricks[i].min_size);
+
+        xt_desc->GPUs[i] = brick.device;
+        xt_desc->size[i] = min_size * bits_per_element / 8;
+        if(hipMalloc(&(xt_desc->data[i]), xt_desc->size[i]) != hipSuccess)
+            return HIPFFT_INTERNAL_ERROR;
+    }
+
+    lib_desc->descriptor = xt_desc.release();
+    *desc                = lib_desc.release();
+    return HIPFFT_SUCCESS;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_ALLOC_FAILED;
+}
+
+// collapse contiguous dimensions in the specified length + stride -
+// user data might be split on any dimension so if we can simplify to
+// just one split dimension and one contiguous dimension we can more
+// easily map a XtMemcpy to a 2DMemcpy.
+static void collapse_contiguous_dims(std::vector<size_t>& brick_length,
+                                     std::vector<size_t>& brick_stride,
+
+                                     std::vector<size_t>& field_stride)
+{
+    // dimensions of length 1 don't contribute to the layout
+    for(size_t i = brick_length.size(); i-- > 0 && brick_length.size() > 1;)
+    {
+        if(brick_length[i] == 1)
+        {
+            brick_length.erase(brick_length.begin() + i);
+            brick_stride.erase(brick_stride.begin() + i);
+            field_stride.erase(field_stride.begin() + i);
+        }
+    }
+
+    // go backwards from slowest to fastest dims
+    for(size_t i = brick_length.size() - 1; i != 0; --i)
+    {
+        if(brick_length[i - 1] * brick_stride[i - 1] == brick_stride[i]
+           && brick_length[i - 1] * field_stride[i - 1] == field_stride[i])
+        {
+            brick_length[i - 1] *= brick_length[i];
+            brick_length.erase(brick_length.begin() + i);
+            brick_stride.erase(brick_stride.begin() + i);
+            field_stride.erase(field_stride.begin() + i);
+        }
+    }
+}
+
+// copy an N-D region of elem_size elements between two host buffers
+// with different strides.  The slowest dimension is split among
+// threads for large regions.
+static void strided_host_copy(char*                      dst,
+                              const std::vector<size_t>& dst_stride,
+                              const char*                src,
+                              const std::vector<size_t>& src_stride,
+                              const std::vector<size_t>& length,
+                              size_t                     elem_size)
+{
+    const size_t dims     = length.size();
+    const bool   rows     = dst_stride[0] == 1 && src_stride[0] == 1;
+    const size_t row_size = length[0] * elem_size;
+
+    // copy the part of the region where the slowest index is in
+    // [begin, end), or all of it for 1D regions
+    auto copy_slab = [&](size_t begin, size_t end) {
+        std::vector<size_t> idx(dims, 0);
+        if(dims > 1)
+            idx.back() = begin;
+        while(true)
+        {
+            auto d = dst + std::inner_product(idx.begin(), idx.end(), dst_stride.begin(), size_t(0))
+                               * elem_size;
+            auto s = src + std::inner_product(idx.begin(), idx.end(), src_stride.begin(), size_t(0))
+                               * elem_size;
+            if(rows)
+                std::memcpy(d, s, row_size);
+            else
+            {
+                for(size_t i = 0; i < length[0]; ++i)
+                    std::memcpy(d + i * dst_stride[0] * elem_size,
+                                s + i * src_stride[0] * elem_size,
+                                elem_size);
+            }
+
+            // next row, column-major
+            size_t dim = 1;
+            for(; dim < dims; ++dim)
+            {
+                const size_t limit = dim == dims - 1 ? end : length[dim];
+                if(++idx[dim] < limit)
+                    break;
+                if(dim == dims - 1)
+                    return;
+                idx[dim] = 0;
+            }
+            if(dim == dims)
+                return;
+        }
+    };
+
+    if(dims == 1)
+    {
+        copy_slab(0, 1);
+        return;
+    }
+
+    // about a MiB per task is enough to keep threads busy
+    const size_t total
+        = std::accumulate(length.begin(), length.end(), elem_size, std::multiplies<size_t>());
+    const size_t slow   = length.back();
+    const size_t ntasks = std::max<size_t>(1, std::min(slow, total >> 20));
+    parallel_for(ntasks,
+                 [&](size_t task) { copy_slab(slow * task / ntasks, slow * (task + 1) / ntasks); });
+}
+
+// Page-locked host buffers for staging synchronous hipfftXtMemcpy
+// copies to and from pageable host memory, so that packing data into
+// one buffer overlaps with DMA to or from another.  Buffers are
+// allocated on first use, up to HIPFFT_STAGING_POOL_SIZE bytes in
+// buffers of HIPFFT_STAGING_CHUNK_SIZE bytes, and kept until the
+// pool is reconfigured.
+class hipfft_staging_pool
+{
+public:
+    static hipfft_staging_pool& get()
+    {
+        static hipfft_staging_pool pool;
+        return pool;
+    }
+
+    // staging buffers borrowed from the pool, returned on destruction
+    class lease
+    {
+    public:
+        lease() = default;
+        ~lease()
+        {
+            if(!buffers.empty())
+                hipfft_staging_pool::get().release(buffers, generation);
+        }
+        lease(lease&& other)
+            : buffers(std::move(other.buffers))
+            , chunk(other.chunk)
+            , generation(other.generation)
+        {
+            other.buffers.clear();
+        }
+        lease(const lease&) = delete;
+        lease& operator=(const lease&) = delete;
+        lease& operator=(lease&&) = delete;
+
+        std::vector<void*> buffers;
+        size_t             chunk      = 0;
+        unsigned int       generation = 0;
+    };
+
+    // borrow up to count buffers, waiting until at least one is
+    // free.  Returns no buffers if staging is disabled.
+    lease acquire(size_t count)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        lease                        ret;
+        while(enabled())
+        {
+            ret.chunk      = chunk_bytes;
+            ret.generation = generation;
+            while(ret.buffers.size() < count && !idle.empty())
+            {
+                ret.buffers.push_back(idle.back());
+                idle.pop_back();
+            }
+            while(ret.buffers.size() < count && allocated < pool_bytes / chunk_bytes)
+            {
+                void* buffer = nullptr;
+                if(hipHostMalloc(&buffer, chunk_bytes, hipHostMallocPortable) != hipSuccess)
+                    break;
+                ret.buffers.push_back(buffer);
+                ++allocated;
+            }
+            // nothing to wait for if no buffer could be allocated
+            if(!ret.buffers.empty() || allocated == 0)
+                break;
+            ++waits;
+            freed.wait(lock);
+        }
+        return ret;
+    }
+
+    bool active()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return enabled();
+    }
+
+    void configure(size_t new_pool_bytes, size_t new_chunk_bytes)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pool_bytes  = new_pool_bytes;
+        chunk_bytes = new_chunk_bytes;
+        // buffers that are in use are freed when they're returned
+        ++generation;
+        free_idle();
+        freed.notify_all();
+    }
+
+    // account for a staged copy
+    void record(bool to_device, size_t bytes, size_t chunks, double seconds)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(to_device)
+        {
+            h2d_bytes += bytes;
+            h2d_seconds += seconds;
+        }
+        else
+        {
+            d2h_bytes += bytes;
+            d2h_seconds += seconds;
+        }
+        staged_chunks += chunks;
+    }
+
+    void get_stats(hipfftExtStagingStats& stats)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.poolBytes           = pool_bytes;
+        stats.chunkBytes          = chunk_bytes;
+        stats.allocatedBytes      = allocated * chunk_bytes;
+        stats.hostToDeviceBytes   = h2d_bytes;
+        stats.hostToDeviceSeconds = h2d_seconds;
+        stats.deviceToHostBytes   = d2h_bytes;
+        stats.deviceToHostSeconds = d2h_seconds;
+        stats.chunks              = staged_chunks;
+        stats.waits               = waits;
+    }
+
+    hipfft_staging_pool(const hipfft_staging_pool&) = delete;
+    hipfft_staging_pool& operator=(const hipfft_staging_pool&) = delete;
+
+private:
+    hipfft_staging_pool()
+    {
+        getenv_size("HIPFFT_STAGING_POOL_SIZE", pool_bytes);
+        getenv_size("HIPFFT_STAGING_CHUNK_SIZE", chunk_bytes);
+    }
+    ~hipfft_staging_pool()
+    {
+        free_idle();
+    }
+
+    bool enabled() const
+    {
+        return chunk_bytes > 0 && pool_bytes >= chunk_bytes;
+    }
+
+    void release(std::vector<void*>& buffers, unsigned int buffer_generation)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(buffer_generation == generation)
+            idle.insert(idle.end(), buffers.begin(), buffers.end());
+        else
+        {
+            // pool was reconfigured while the buffers were in use
+            for(auto buffer : buffers)
+                (void)hipHostFree(buffer);
+        }
+        buffers.clear();
+        freed.notify_all();
+    }
+
+    void free_idle()
+    {
+        for(auto buffer : idle)
+            (void)hipHostFree(buffer);
+        idle.clear();
+        allocated = 0;
+    }
+
+    std::mutex              mutex;
+    std::condition_variable freed;
+
+    size_t             pool_bytes  = 32 << 20;
+    size_t             chunk_bytes = 4 << 20;
+    unsigned int       generation  = 0;
+    size_t             allocated   = 0;
+    std::vector<void*> idle;
+
+    size_t h2d_bytes     = 0;
+    double h2d_seconds   = 0.0;
+    size_t d2h_bytes     = 0;
+    double d2h_seconds   = 0.0;
+    size_t staged_chunks = 0;
+    size_t waits         = 0;
+};
+
+// let device access peer's memory directly, if the hardware allows
+// it.  Otherwise copies between the two are staged by the runtime.
+static void enable_peer_access(int device, int peer)
+{
+    static std::mutex                    mutex;
+    static std::set<std::pair<int, int>> attempted;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if(!attempted.insert({device, peer}).second)
+        return;
+
+    int canAccess = 0;
+    if(hipDeviceCanAccessPeer(&canAccess, device, peer) != hipSuccess || !canAccess)
+        return;
+    rocfft_scoped_device dev(device);
+    // access may already have been enabled by the application
+    if(hipDeviceEnablePeerAccess(peer, 0) != hipSuccess)
+        (void)hipGetLastError();
+}
+
+// Issues the per-device copies for hipfftXtMemcpy.  Copies either
+// block, or are enqueued on the plan's per-device copy streams so
+// that all devices transfer at the same time.  In that case, the
+// copy streams wait for work already on the caller's stream, and
+// join() makes the caller's stream wait for the copies.
+//
+// Blocking copies between pageable host memory and a device go
+// through the staging pool instead of letting the runtime stage
+// them.
+class hipfft_xt_copier
+{
+public:
+    // synchronous copies
+    explicit hipfft_xt_copier(hipfftHandle plan)
+        : plan(plan)
+    {
+    }
+
+    // asynchronous copies ordered with stream, which belongs to the
+    // current device
+    hipfft_xt_copier(hipfftHandle plan, hipStream_t stream)
+        : plan(plan)
+        , async(true)
+        , stream(stream)
+    {
+        if(hipGetDevice(&stream_device) != hipSuccess)
+            throw HIPFFT_INVALID_DEVICE;
+        auto& start = copy_stream(stream_device).start;
+        if(hipEventRecord(start, stream) != hipSuccess)
+            throw HIPFFT_INTERNAL_ERROR;
+    }
+
+    // copy a region of one brick.  The device must be current.
+    hipError_t memcpy(int device, void* dst, const void* src, size_t count, hipMemcpyKind kind)
+    {
+        if(!async)
+        {
+            if(use_staging(dst, src, kind))
+                return staged_memcpy2D(device, dst, count, src, count, count, 1, kind);
+            return hipMemcpy(dst, src, count, kind);
+        }
+        return hipMemcpyAsync(dst, src, count, kind, device_stream(device));
+    }
+    hipError_t memcpy2D(int           device,
+                        void*         dst,
+                        size_t        dpitch,
+                        const void*   src,
+                        size_t        spitch,
+                        size_t        width,
+                        size_t        height,
+                        hipMemcpyKind kind)
+    {
+        if(!async)
+        {
+            if(use_staging(dst, src, kind))
+                return staged_memcpy2D(device, dst, dpitch, src, spitch, width, height, kind);
+            return hipMemcpy2D(dst, dpitch, src, spitch, width, height, kind);
+        }
+        return hipMemcpy2DAsync(
+            dst, dpitch, src, spitch, width, height, kind, device_stream(device));
+    }
+    // dheight and sheight are the number of rows between slices
+    hipError_t memcpy3D(int           device,
+                        void*         dst,
+                        size_t        dpitch,
+                        size_t        dheight,
+                        const void*   src,
+                        size_t        spitch,
+                        size_t        sheight,
+                        size_t        width,
+                        size_t        height,
+                        size_t        depth,
+                        hipMemcpyKind kind)
+    {
+        if(!async && use_staging(dst, src, kind))
+        {
+            for(size_t z = 0; z < depth; ++z)
+            {
+                auto ret = staged_memcpy2D(device,
+                                           static_cast<char*>(dst) + z * dpitch * dheight,
+                                           dpitch,
+                                           static_cast<const char*>(src) + z * spitch * sheight,
+                                           spitch,
+                                           width,
+                                           height,
+                                           kind);
+                if(ret != hipSuccess)
+                    return ret;
+            }
+            return hipSuccess;
+        }
+
+        hipMemcpy3DParms params = {};
+
+        params.srcPtr = make_hipPitchedPtr(const_cast<void*>(src), spitch, width, sheight);
+        params.dstPtr = make_hipPitchedPtr(dst, dpitch, width, dheight);
+        params.extent = make_hipExtent(width, height, depth);
+        params.kind   = kind;
+        if(!async)
+            return hipMemcpy3D(&params);
+        return hipMemcpy3DAsync(&params, device_stream(device));
+    }
+
+    // copy a brick between device memory and a region of a host
+    // field, given the brick's length and the strides of each side
+    // in elements.  Layouts that collapse to up to three dimensions
+    // with contiguous rows are copied directly.  Anything else is
+    // packed on the host into a buffer laid out like the brick, and
+    // copied in one piece.  The device must be current.
+    hipError_t copy_brick(int                 device,
+                          void*               device_ptr,
+                          void*               host_ptr,
+                          std::vector<size_t> length,
+                          std::vector<size_t> device_stride,
+                          std::vector<size_t> host_stride,
+                          size_t              elem_size,
+                          hipMemcpyKind       kind)
+    {
+        collapse_contiguous_dims(length, device_stride, host_stride);
+
+        const bool to_device  = kind == hipMemcpyHostToDevice;
+        void*      dst        = to_device ? device_ptr : host_ptr;
+        void*      src        = to_device ? host_ptr : device_ptr;
+        const auto dst_stride = to_device ? device_stride : host_stride;
+        const auto src_stride = to_device ? host_stride : device_stride;
+
+        if(device_stride[0] == 1 && host_stride[0] == 1)
+        {
+            const size_t width = length[0] * elem_size;
+            switch(length.size())
+            {
+            case 1:
+                return memcpy(device, dst, src, width, kind);
+            case 2:
+                return memcpy2D(device,
+                                dst,
+                                dst_stride[1] * elem_size,
+                                src,
+                                src_stride[1] * elem_size,
+                                width,
+                                length[1],
+                                kind);
+            case 3:
+                // slices must be a whole number of rows apart
+                if(dst_stride[2] % dst_stride[1] == 0 && src_stride[2] % src_stride[1] == 0
+                   && dst_stride[2] / dst_stride[1] >= length[1]
+                   && src_stride[2] / src_stride[1] >= length[1])
+                    return memcpy3D(device,
+                                    dst,
+                                    dst_stride[1] * elem_size,
+                                    dst_stride[2] / dst_stride[1],
+                                    src,
+                                    src_stride[1] * elem_size,
+                                    src_stride[2] / src_stride[1],
+                                    width,
+                                    length[1],
+                                    length[2],
+                                    kind);
+                break;
+            default:
+                break;
+            }
+        }
+        return memcpy_packed(
+            device, device_ptr, host_ptr, length, device_stride, host_stride, elem_size, kind);
+    }
+
+    // copy a box of elements between two device bricks, given the
+    // box's length and the strides of each brick.  The copies are
+    // enqueued on the source device's copy stream, even for blocking
+    // copiers, so that copies from different devices run at the same
+    // time until join().  The source device must be current.
+    hipError_t copy_region(int                 src_device,
+                           int                 dst_device,
+                           void*               dst,
+                           std::vector<size_t> dst_stride,
+                           const void*         src,
+                           std::vector<size_t> src_stride,
+                           std::vector<size_t> length,
+                           size_t              elem_size)
+    {
+        if(src_device != dst_device)
+            enable_peer_access(src_device, dst_device);
+
+        collapse_contiguous_dims(length, dst_stride, src_stride);
+        // strided fastest dims are copied as rows of one element
+        if(dst_stride[0] != 1 || src_stride[0] != 1)
+        {
+            length.insert(length.begin(), 1);
+            dst_stride.insert(dst_stride.begin(), 1);
+            src_stride.insert(src_stride.begin(), 1);
+        }
+
+        auto         stream = device_stream(src_device);
+        const size_t width  = length[0] * elem_size;
+        if(length.size() == 1)
+            return hipMemcpyAsync(dst, src, width, hipMemcpyDeviceToDevice, stream);
+
+        // copy three dimensions at a time if slices are a whole
+        // number of rows apart, otherwise two.  Slower dimensions
+        // are looped over.
+        const bool copy3D = length.size() > 2 && dst_stride[2] % dst_stride[1] == 0
+                            && src_stride[2] % src_stride[1] == 0
+                            && dst_stride[2] / dst_stride[1] >= length[1]
+                            && src_stride[2] / src_stride[1] >= length[1];
+        const size_t inner = copy3D ? 3 : 2;
+
+        std::vector<size_t> idx(length.size(), 0);
+        while(true)
+        {
+            auto d = static_cast<char*>(dst)
+                     + std::inner_product(idx.begin(), idx.end(), dst_stride.begin(), size_t(0))
+                           * elem_size;
+            auto s = static_cast<const char*>(src)
+                     + std::inner_product(idx.begin(), idx.end(), src_stride.begin(), size_t(0))
+                           * elem_size;
+
+            hipError_t ret;
+            if(copy3D)
+            {
+                hipMemcpy3DParms params = {};
+
+                params.srcPtr = make_hipPitchedPtr(const_cast<char*>(s),
+                                                   src_stride[1] * elem_size,
+                                                   width,
+                                                   src_stride[2] / src_stride[1]);
+                params.dstPtr = make_hipPitchedPtr(
+                    d, dst_stride[1] * elem_size, width, dst_stride[2] / dst_stride[1]);
+                params.extent = make_hipExtent(width, length[1], length[2]);
+                params.kind   = hipMemcpyDeviceToDevice;
+                ret           = hipMemcpy3DAsync(&params, stream);
+            }
+            else
+                ret = hipMemcpy2DAsync(d,
+                                       dst_stride[1] * elem_size,
+                                       s,
+                                       src_stride[1] * elem_size,
+                                       width,
+                                       length[1],
+                                       hipMemcpyDeviceToDevice,
+                                       stream);
+            if(ret != hipSuccess)
+                return ret;
+
+            // next block, column-major
+            size_t dim = inner;
+            for(; dim < length.size(); ++dim)
+            {
+                if(++idx[dim] < length[dim])
+                    break;
+                idx[dim] = 0;
+            }
+            if(dim == length.size())
+                return hipSuccess;
+        }
+    }
+
+    // make a device's later copies wait for an event, or record an
+    // event after its copies so far.  The device must be current.
+    hipError_t wait(int device, hipEvent_t event)
+    {
+        return hipStreamWaitEvent(device_stream(device), event, 0);
+    }
+    hipError_t record(int device, hipEvent_t event)
+    {
+        return hipEventRecord(event, device_stream(device));
+    }
+
+    // event recorded on the caller's stream when an asynchronous
+    // copier was created
+    hipEvent_t start_event()
+    {
+        return copy_stream(stream_device).start;
+    }
+
+    // make the caller's stream wait for all of the copies, or
+    // wait for them if the copier is blocking
+    void join()
+    {
+        if(!async)
+        {
+            for(int device : devices)
+            {
+                rocfft_scoped_device dev(device);
+                if(hipStreamSynchronize(copy_stream(device).stream) != hipSuccess)
+                    throw HIPFFT_INTERNAL_ERROR;
+            }
+            return;
+        }
+        for(int device : devices)
+        {
+            rocfft_scoped_device dev(device);
+            if(hipEventRecord(copy_stream(device).done, copy_stream(device).stream) != hipSuccess)
+                throw HIPFFT_INTERNAL_ERROR;
+        }
+        for(int device : devices)
+        {
+            if(hipStreamWaitEvent(stream, copy_stream(device).done, 0) != hipSuccess)
+                throw HIPFFT_INTERNAL_ERROR;
+        }
+    }
+
+private:
+    hipfft_copy_stream& copy_stream(int device)
+    {
+        auto& copyStream = plan->copyStreams[device];
+        if(!copyStream.stream)
+        {
+            copyStream.stream.alloc();
+            copyStream.start.alloc();
+            copyStream.done.alloc();
+            for(auto& staged : copyStream.staged)
+                staged.alloc();
+        }
+        return copyStream;
+    }
+
+    // get the copy stream for a device, making it wait for the
+    // caller's stream the first time it's used.  Blocking copies
+    // wait for the device's null stream instead, like hipMemcpy.
+    // The device must be current.
+    hipStream_t device_stream(int device)
+    {
+        auto& copyStream = copy_stream(device);
+        if(devices.insert(device).second)
+        {
+            hipEvent_t start = copy_stream(stream_device).start;
+            if(!async)
+            {
+                start = copyStream.start;
+                if(hipEventRecord(start, nullptr) != hipSuccess)
+                    throw HIPFFT_INTERNAL_ERROR;
+            }
+            if(hipStreamWaitEvent(copyStream.stream, start, 0) != hipSuccess)
+                throw HIPFFT_INTERNAL_ERROR;
+        }
+        return copyStream.stream;
+    }
+
+    struct pinned_deleter
+    {
+        void operator()(void* p) const
+        {
+            (void)hipHostFree(p);
+        }
+    };
+
+    // gather or scatter a brick through a pinned host buffer.  Even
+    // asynchronous copies wait for the transfer, since the buffer
+    // has to be packed before and unpacked after it.
+    hipError_t memcpy_packed(int                        device,
+                             void*                      device_ptr,
+                             void*                      host_ptr,
+                             const std::vector<size_t>& length,
+                             const std::vector<size_t>& device_stride,
+                             const std::vector<size_t>& host_stride,
+                             size_t                     elem_size,
+                             hipMemcpyKind              kind)
+    {
+        const bool   to_device = kind == hipMemcpyHostToDevice;
+        const size_t bytes     = compute_ptrdiff(length, device_stride, 0, 0) * elem_size;
+
+        void*      buffer = nullptr;
+        hipError_t ret    = hipHostMalloc(&buffer, bytes, 0);
+        if(ret != hipSuccess)
+            return ret;
+        std::unique_ptr<void, pinned_deleter> packed(buffer);
+
+        // host memory may still be in use by work on the caller's
+        // stream
+        if(async && (ret = hipEventSynchronize(copy_stream(stream_device).start)) != hipSuccess)
+            return ret;
+
+        if(to_device)
+        {
+            strided_host_copy(static_cast<char*>(buffer),
+                              device_stride,
+                              static_cast<const char*>(host_ptr),
+                              host_stride,
+                              length,
+                              elem_size);
+            ret = memcpy(device, device_ptr, buffer, bytes, kind);
+        }
+        else
+            ret = memcpy(device, buffer, device_ptr, bytes, kind);
+
+        if(ret == hipSuccess && async)
+            ret = hipStreamSynchronize(device_stream(device));
+        if(ret == hipSuccess && !to_device)
+            strided_host_copy(static_cast<char*>(host_ptr),
+                              host_stride,
+                              static_cast<const char*>(buffer),
+                              device_stride,
+                              length,
+                              elem_size);
+        return ret;
+    }
+
+    static bool use_staging(void* dst, const void* src, hipMemcpyKind kind)
+    {
+        void* host;
+        if(kind == hipMemcpyHostToDevice)
+            host = const_cast<void*>(src);
+        else if(kind == hipMemcpyDeviceToHost)
+            host = dst;
+        else
+            return false;
+
+        if(!hipfft_staging_pool::get().active())
+            return false;
+
+        // page-locked memory is already fast to copy
+        unsigned int flags = 0;
+        if(hipHostGetFlags(&flags, host) == hipSuccess)
+            return false;
+        // clear the error from querying pageable memory
+        (void)hipGetLastError();
+        return true;
+    }
+
+    // copy height rows of width bytes through staging buffers.  Rows
+    // are packed into a buffer while the previous buffer is copied
+    // on the null stream, so the copy is ordered like hipMemcpy2D.
+    hipError_t staged_memcpy2D(int           device,
+                               void*         dst,
+                               size_t        dpitch,
+                               const void*   src,
+                               size_t        spitch,
+                               size_t        width,
+                               size_t        height,
+                               hipMemcpyKind kind)
+    {
+        auto& pool  = hipfft_staging_pool::get();
+        auto  lease = pool.acquire(2);
+        if(lease.buffers.empty() || width == 0 || height == 0)
+            return hipMemcpy2D(dst, dpitch, src, spitch, width, height, kind);
+
+        const auto start     = std::chrono::steady_clock::now();
+        const bool to_device = kind == hipMemcpyHostToDevice;
+        auto       host      = static_cast<char*>(to_device ? const_cast<void*>(src) : dst);
+        auto       dev       = static_cast<char*>(to_device ? dst : const_cast<void*>(src));
+        const auto hpitch    = to_device ? spitch : dpitch;
+        const auto devpitch  = to_device ? dpitch : spitch;
+
+        // whole rows if they fit in a buffer, otherwise pieces of
+        // one row
+        struct block
+        {
+            size_t row;
+            size_t offset;
+            size_t width;
+            size_t rows;
+        };
+        std::vector<block> blocks;
+        const size_t       block_rows = lease.chunk / width;
+        if(block_rows > 0)
+        {
+            for(size_t row = 0; row < height; row += block_rows)
+                blocks.push_back({row, 0, width, std::min(block_rows, height - row)});
+        }
+        else
+        {
+            for(size_t row = 0; row < height; ++row)
+                for(size_t offset = 0; offset < width; offset += lease.chunk)
+                    blocks.push_back({row, offset, std::min(lease.chunk, width - offset), 1});
+        }
+
+        const size_t nbuf   = lease.buffers.size();
+        auto&        events = copy_stream(device).staged;
+        auto         buffer = [&](size_t i) { return static_cast<char*>(lease.buffers[i % nbuf]); };
+        auto         host_row
+            = [&](const block& b, size_t r) { return host + (b.row + r) * hpitch + b.offset; };
+        auto dev_block = [&](const block& b) { return dev + b.row * devpitch + b.offset; };
+
+        // start the DMA for block i
+        auto issue = [&](size_t i) {
+            const auto& b   = blocks[i];
+            hipError_t  ret = to_device ? hipMemcpy2DAsync(dev_block(b),
+                                                          devpitch,
+                                                          buffer(i),
+                                                          b.width,
+                                                          b.width,
+                                                          b.rows,
+                                                          kind,
+                                                          nullptr)
+                                        : hipMemcpy2DAsync(buffer(i),
+                                                          b.width,
+                                                          dev_block(b),
+                                                          devpitch,
+                                                          b.width,
+                                                          b.rows,
+                                                          kind,
+                                                          nullptr);
+            if(ret != hipSuccess)
+                return ret;
+            return hipEventRecord(events[i % nbuf], nullptr);
+        };
+
+        hipError_t ret = hipSuccess;
+        if(to_device)
+        {
+            for(size_t i = 0; i < blocks.size() && ret == hipSuccess; ++i)
+            {
+                // wait for the buffer's previous DMA before refilling it
+                if(i >= nbuf && (ret = hipEventSynchronize(events[i % nbuf])) != hipSuccess)
+                    break;
+                const auto& b = blocks[i];
+                for(size_t r = 0; r < b.rows; ++r)
+                    std::memcpy(buffer(i) + r * b.width, host_row(b, r), b.width);
+                ret = issue(i);
+            }
+        }
+        else
+        {
+            // unpack block i once its DMA is done
+            auto finish = [&](size_t i) {
+                hipError_t finished = hipEventSynchronize(events[i % nbuf]);
+                if(finished != hipSuccess)
+                    return finished;
+                const auto& b = blocks[i];
+                for(size_t r = 0; r < b.rows; ++r)
+                    std::memcpy(host_row(b, r), buffer(i) + r * b.width, b.width);
+                return hipSuccess;
+            };
+
+            // index of the block copied but not yet unpacked
+            size_t pending = blocks.size();
+            for(size_t i = 0; i < blocks.size() && ret == hipSuccess; ++i)
+            {
+                if(pending != blocks.size() && pending % nbuf == i % nbuf)
+                {
+                    if((ret = finish(pending)) != hipSuccess)
+                        break;
+                    pending = blocks.size();
+                }
+                if((ret = issue(i)) != hipSuccess)
+                    break;
+                if(pending != blocks.size() && (ret = finish(pending)) != hipSuccess)
+                    break;
+                pending = i;
+            }
+            if(ret == hipSuccess && pending != blocks.size())
+                ret = finish(pending);
+        }
+
+        // buffers go back to the pool, so nothing may still be
+        // copying from or to them
+        hipError_t sync = hipStreamSynchronize(nullptr);
+        if(ret != hipSuccess)
+            return ret;
+        if(sync != hipSuccess)
+            return sync;
+
+        pool.record(to_device,
+                    width * height,
+                    blocks.size(),
+                    std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+                        .count());
+        return hipSuccess;
+    }
+
+    hipfftHandle  plan          = nullptr;
+    bool          async         = false;
+    hipStream_t   stream        = nullptr;
+    int           stream_device = 0;
+    std::set<int> devices;
+};
+
+// brick layout and element type of a hipfftXtMalloc subformat, or
+// null if the format isn't a brick layout
+static const std::vector<hipfft_brick>* xt_bricks(hipfftHandle plan, int subFormat)
+{
+    switch(subFormat)
+    {
+    case HIPFFT_XT_FORMAT_INPUT:
+        return &plan->inBricks;
+    case HIPFFT_XT_FORMAT_OUTPUT:
+    case HIPFFT_XT_FORMAT_INPLACE:
+    case HIPFFT_XT_FORMAT_1D_INPUT_SHUFFLED:
+        return &plan->outBricks;
+    case HIPFFT_XT_FORMAT_INPLACE_SHUFFLED:
+        // plans without a shuffled layout leave the data in the
+        // natural one
+        return plan->shuffledBricks.empty() ? &plan->outBricks : &plan->shuffledBricks;
+    default:
+        return nullptr;
     }
 }
 
-static size_t hipDataType_bytes(hipDataType t, size_t numElems)
+static hipDataType xt_data_type(hipfftHandle plan, int subFormat)
 {
-    return hipDataType_bits(t) * numElems / 8;
+    return subFormat == HIPFFT_XT_FORMAT_INPUT ? plan->type.inputType : plan->type.outputType;
 }
 
-hipfftResult hipfftXtMalloc(hipfftHandle plan, hipLibXtDesc** desc, hipfftXtSubFormat format)
-try
+// host layout of data copied to or from a descriptor: its element
+// type and the strides of the field it covers, with the batch
+// stride last.  In-place data is laid out like the output, with
+// elements of the wider of the plan's types, which for R2C plans is
+// the padded real layout viewed as complex.
+static std::pair<hipDataType, std::vector<size_t>>
+    xt_host_layout(hipfftHandle plan, int subFormat, bool input)
 {
-    if(!plan || !desc)
+    std::vector<size_t> stride;
+    hipDataType         type;
+    switch(subFormat)
+    {
+    case HIPFFT_XT_FORMAT_INPLACE:
+    case HIPFFT_XT_FORMAT_INPLACE_SHUFFLED:
+    case HIPFFT_XT_FORMAT_1D_INPUT_SHUFFLED:
+        stride = plan->outStrides;
+        stride.push_back(plan->oDist);
+        type = hipDataType_bits(plan->type.inputType) > hipDataType_bits(plan->type.outputType)
+                   ? plan->type.inputType
+                   : plan->type.outputType;
+        break;
+    default:
+        stride = input ? plan->inStrides : plan->outStrides;
+        stride.push_back(input ? plan->iDist : plan->oDist);
+        type = input ? plan->type.inputType : plan->type.outputType;
+        break;
+    }
+    return {type, stride};
+}
+
+static bool same_brick_layout(const std::vector<hipfft_brick>& a,
+                              const std::vector<hipfft_brick>& b)
+{
+    return std::equal(
+        a.begin(), a.end(), b.begin(), b.end(), [](const hipfft_brick& x, const hipfft_brick& y) {
+            return x.field_lower == y.field_lower && x.field_upper == y.field_upper
+                   && x.brick_stride == y.brick_stride;
+        });
+}
+
+// copy the part of a source brick that overlaps a destination brick
+// directly between their devices, if they overlap.  Bricks must have
+// the same rank.  The source device must be current.
+static hipError_t copy_brick_overlap(hipfft_xt_copier&   copier,
+                                     const hipfft_brick& destBrick,
+                                     int                 destDevice,
+                                     void*               dest,
+                                     const hipfft_brick& srcBrick,
+                                     int                 srcDevice,
+                                     const void*         src,
+                                     size_t              elem_size)
+{
+    const size_t        dims = srcBrick.field_lower.size();
+    std::vector<size_t> length(dims), srcIdx(dims), destIdx(dims);
+    for(size_t i = 0; i < dims; ++i)
+    {
+        const size_t lower = std::max(srcBrick.field_lower[i], destBrick.field_lower[i]);
+        const size_t upper = std::min(srcBrick.field_upper[i], destBrick.field_upper[i]);
+        if(lower >= upper)
+            return hipSuccess;
+        length[i]  = upper - lower;
+        srcIdx[i]  = lower - srcBrick.field_lower[i];
+        destIdx[i] = lower - destBrick.field_lower[i];
+    }
+
+    return copier.copy_region(
+        srcDevice,
+        destDevice,
+        static_cast<char*>(dest) + destBrick.brick_offset(destIdx) * elem_size,
+        destBrick.brick_stride,
+        static_cast<const char*>(src) + srcBrick.brick_offset(srcIdx) * elem_size,
+        srcBrick.brick_stride,
+        length,
+        elem_size);
+}
+
+// copy a field between two multi-device layouts by copying each
+// overlap of a source brick and a destination brick directly
+// between the devices.  Layouts of different rank are compared as
+// if the lower rank one had extra dimensions of length 1.
+static hipfftResult xt_redistribute(hipfft_xt_copier&         copier,
+                                    std::vector<hipfft_brick> destBricks,
+                                    hipLibXtDesc*             dest,
+                                    std::vector<hipfft_brick> srcBricks,
+                                    const hipLibXtDesc*       src,
+                                    size_t                    elem_size)
+{
+    if(destBricks.empty() || srcBricks.empty()
+       || static_cast<size_t>(dest->descriptor->nGPUs) != destBricks.size()
+       || static_cast<size_t>(src->descriptor->nGPUs) != srcBricks.size())
         return HIPFFT_INVALID_VALUE;
 
-    auto lib_desc = std::make_unique<hipLibXtDesc>();
-    memset(lib_desc.get(), 0, sizeof(hipLibXtDesc));
+    const size_t dims = std::max(destBricks.front().field_lower.size(),
+                                 srcBricks.front().field_lower.size());
+    for(auto bricks : {&destBricks, &srcBricks})
+    {
+        for(auto& brick : *bricks)
+        {
+            brick.field_lower.resize(dims, 0);
+            brick.field_upper.resize(dims, 1);
+            brick.brick_stride.resize(dims, 0);
+        }
+    }
 
-    lib_desc->version       = 0;
-    lib_desc->library       = HIPLIB_FORMAT_HIPFFT;
-    lib_desc->subFormat     = format;
-    lib_desc->libDescriptor = nullptr;
+    // both layouts must cover the same field
+    auto field_length = [](const std::vector<hipfft_brick>& bricks) {
+        std::vector<size_t> length = bricks.front().field_upper;
+        for(const auto& brick : bricks)
+        {
+            for(size_t d = 0; d < length.size(); ++d)
+                length[d] = std::max(length[d], brick.field_upper[d]);
+        }
+        return length;
+    };
+    if(field_length(destBricks) != field_length(srcBricks))
+        return HIPFFT_INVALID_VALUE;
 
-    auto xt_desc = std::make_unique<hipXtDesc>();
-    memset(xt_desc.get(), 0, sizeof(hipXtDesc));
-    xt_desc->version = 0;
+    for(size_t s = 0; s < srcBricks.size(); ++s)
+    {
+        const int srcDevice = src->descriptor->GPUs[s];
 
-    std::vector<hipfft_brick>* bricks           = nullptr;
-    size_t                     bits_per_element = 0;
+        rocfft_scoped_device dev(srcDevice);
+        for(size_t d = 0; d < destBricks.size(); ++d)
+        {
+            if(copy_brick_overlap(copier,
+                                  destBricks[d],
+                                  dest->descriptor->GPUs[d],
+                                  dest->descriptor->data[d],
+                                  srcBricks[s],
+                                  srcDevice,
+                                  src->descriptor->data[s],
+                                  elem_size)
+               != hipSuccess)
+                return HIPFFT_INTERNAL_ERROR;
+        }
+    }
+    copier.join();
+    return HIPFFT_SUCCESS;
+}
 
-    switch(format)
+static hipfftResult xt_memcpy(
+    hipfftHandle plan, void* dest, void* src, hipfftXtCopyType cptype, hipfft_xt_copier& copier)
+{
+    if(!dest || !src)
+        return HIPFFT_INVALID_VALUE;
+
+    // get pointer into buf, at the index pointed to by lower
+    // assuming lengths are strided by stride
+    auto offset_buffer = [](void*                      buf,
+                            hipDataType                dtype,
+                            const std::vector<size_t>& lower,
+                            const std::vector<size_t>& stride) {
+        auto offset_elems = std::inner_product(lower.begin(), lower.end(), stride.begin(), 0);
+
+        return static_cast<void*>(static_cast<char*>(buf) + hipDataType_bytes(dtype, offset_elems));
+    };
+
+    auto brick_layout = [plan](int subFormat) -> const std::vector<hipfft_brick>& {
+        auto bricks = xt_bricks(plan, subFormat);
+        if(!bricks)
+            throw HIPFFT_INVALID_VALUE;
+        return *bricks;
+    };
+
+    switch(cptype)
     {
-    case HIPFFT_XT_FORMAT_INPUT:
-        bricks           = &plan->inBricks;
-        bits_per_element = hipDataType_bits(plan->type.inputType);
-        break;
-    case HIPFFT_XT_FORMAT_OUTPUT:
-        bricks           = &plan->outBricks;
-        bits_per_element = hipDataType_bits(plan->type.outputType);
-        break;
-    case HIPFFT_XT_FORMAT_INPLACE:
-        bricks           = &plan->outBricks;
-        bits_per_element = std::max(hipDataType_bits(plan->type.inputType),
-                                    hipDataType_bits(plan->type.outputType));
-        break;
-    default:
+    case HIPFFT_COPY_HOST_TO_DEVICE:
+    {
+        // dest is a hipLibXtDesc
+        auto destDesc = static_cast<hipLibXtDesc*>(dest);
+        if(!destDesc->descriptor)
+            return HIPFFT_INVALID_VALUE;
+
+        const auto layout    = xt_host_layout(plan, destDesc->subFormat, true);
+        const auto srcType   = layout.first;
+        const auto srcStride = layout.second;
+        for(size_t i = 0; i < static_cast<size_t>(destDesc->descriptor->nGPUs); ++i)
+        {
+            rocfft_scoped_device dev(destDesc->descriptor->GPUs[i]);
+
+            const auto& brick = brick_layout(destDesc->subFormat)[i];
+
+            if(copier.copy_brick(destDesc->descriptor->GPUs[i],
+                                 destDesc->descriptor->data[i],
+                                 offset_buffer(src, srcType, brick.field_lower, srcStride),
+                                 brick.length(),
+                                 brick.brick_stride,
+                                 srcStride,
+                                 hipDataType_bytes(srcType, 1),
+                                 hipMemcpyHostToDevice)
+               != hipSuccess)
+                return HIPFFT_INTERNAL_ERROR;
+        }
+        copier.join();
+        return HIPFFT_SUCCESS;
+    }
+    case HIPFFT_COPY_DEVICE_TO_HOST:
+    {
+        // src is a hipLibXtDesc
+        auto srcDesc = static_cast<const hipLibXtDesc*>(src);
+        if(!srcDesc->descriptor)
+            return HIPFFT_INVALID_VALUE;
+
+        const auto layout     = xt_host_layout(plan, srcDesc->subFormat, false);
+        const auto destType   = layout.first;
+        const auto destStride = layout.second;
+        for(size_t i = 0; i < static_cast<size_t>(srcDesc->descriptor->nGPUs); ++i)
+        {
+            rocfft_scoped_device dev(srcDesc->descriptor->GPUs[i]);
+
+            const auto& brick = brick_layout(srcDesc->subFormat)[i];
+
+            if(copier.copy_brick(srcDesc->descriptor->GPUs[i],
+                                 srcDesc->descriptor->data[i],
+                                 offset_buffer(dest, destType, brick.field_lower, destStride),
+                                 brick.length(),
+                                 brick.brick_stride,
+                                 destStride,
+                                 hipDataType_bytes(destType, 1),
+                                 hipMemcpyDeviceToHost)
+               != hipSuccess)
+                return HIPFFT_INTERNAL_ERROR;
+        }
+        copier.join();
+        return HIPFFT_SUCCESS;
+    }
+    case HIPFFT_COPY_DEVICE_TO_DEVICE:
+    {
+        // src and dest are both hipLibXtDescs
+        auto srcDesc  = static_cast<const hipLibXtDesc*>(src);
+        auto destDesc = static_cast<hipLibXtDesc*>(dest);
+        if(!srcDesc->descriptor || !destDesc->descriptor)
+            return HIPFFT_INVALID_VALUE;
+
+        // descriptors with different brick layouts need their data
+        // redistributed
+        auto srcBricks  = xt_bricks(plan, srcDesc->subFormat);
+        auto destBricks = xt_bricks(plan, destDesc->subFormat);
+        if(srcBricks && destBricks && !same_brick_layout(*srcBricks, *destBricks))
+        {
+            if(hipDataType_bits(xt_data_type(plan, srcDesc->subFormat))
+               != hipDataType_bits(xt_data_type(plan, destDesc->subFormat)))
+                return HIPFFT_INVALID_VALUE;
+            return xt_redistribute(copier,
+                                   *destBricks,
+                                   destDesc,
+                                   *srcBricks,
+                                   srcDesc,
+                                   hipDataType_bytes(xt_data_type(plan, srcDesc->subFormat), 1));
+        }
+
+        if(srcDesc->descriptor->nGPUs != destDesc->descriptor->nGPUs)
+            return HIPFFT_INVALID_VALUE;
+
+        for(size_t i = 0; i < static_cast<size_t>(srcDesc->descriptor->nGPUs); ++i)
+        {
+            rocfft_scoped_device dev(srcDesc->descriptor->GPUs[i]);
+            if(copier.memcpy(srcDesc->descriptor->GPUs[i],
+                             destDesc->descriptor->data[i],
+                             srcDesc->descriptor->data[i],
+                             std::min(srcDesc->descriptor->size[i],
+                                      destDesc->descriptor->size[i]),
+                             hipMemcpyDeviceToDevice)
+               != hipSuccess)
+                return HIPFFT_INTERNAL_ERROR;
+        }
+        copier.join();
+        return HIPFFT_SUCCESS;
+    }
+    case HIPFFT_COPY_UNDEFINED:
         return HIPFFT_NOT_IMPLEMENTED;
+    default:
+        throw HIPFFT_INVALID_VALUE;
     }
+}
 
-    xt_desc->nGPUs = static_cast<int>(bricks->size());
+hipfftResult hipfftXtMemcpy(hipfftHandle plan, void* dest, void* src, hipfftXtCopyType cptype)
+try
+{
+    if(!plan)
+        return HIPFFT_INVALID_VALUE;
+    wait_for_plan(plan);
 
-    for(size_t i = 0; i < bricks->size(); ++i)
+    // the plan's copy streams are shared by all callers
+    std::lock_guard<std::mutex> lock(plan->mutex);
+    hipfft_xt_copier            copier(plan);
+    return xt_memcpy(plan, dest, src, cptype, copier);
+}
+catch(hipfftResult err)
+{
+    return err;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftXtMemcpyAsync(
+    hipfftHandle plan, void* dest, void* src, hipfftXtCopyType cptype, hipStream_t stream)
+try
+{
+    if(!plan)
+        return HIPFFT_INVALID_VALUE;
+    wait_for_plan(plan);
+
+    // the plan's copy streams are shared by all callers
+    std::lock_guard<std::mutex> lock(plan->mutex);
+    hipfft_xt_copier            copier(plan, stream);
+    return xt_memcpy(plan, dest, src, cptype, copier);
+}
+catch(hipfftResult err)
+{
+    return err;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftExtXtRedistribute(hipfftHandle  destPlan,
+                                     hipLibXtDesc* dest,
+                                     hipfftHandle  srcPlan,
+                                     hipLibXtDesc* src)
+try
+{
+    if(!destPlan || !srcPlan || !dest || !src || !dest->descriptor || !src->descriptor)
+        return HIPFFT_INVALID_VALUE;
+    wait_for_plan(destPlan);
+    wait_for_plan(srcPlan);
+
+    auto destBricks = xt_bricks(destPlan, dest->subFormat);
+    auto srcBricks  = xt_bricks(srcPlan, src->subFormat);
+    if(!destBricks || !srcBricks)
+        return HIPFFT_INVALID_VALUE;
+    const auto destType = xt_data_type(destPlan, dest->subFormat);
+    if(hipDataType_bits(destType) != hipDataType_bits(xt_data_type(srcPlan, src->subFormat)))
+        return HIPFFT_INVALID_VALUE;
+
+    // the copies use the destination plan's copy streams
+    std::lock_guard<std::mutex> lock(destPlan->mutex);
+    hipfft_xt_copier            copier(destPlan);
+    return xt_redistribute(
+        copier, *destBricks, dest, *srcBricks, src, hipDataType_bytes(destType, 1));
+}
+catch(hipfftResult err)
+{
+    return err;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftExtSetStagingPool(size_t poolBytes, size_t chunkBytes)
+try
+{
+    hipfft_staging_pool::get().configure(poolBytes, chunkBytes);
+    return HIPFFT_SUCCESS;
+}
+catch(hipfftResult err)
+{
+    return err;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftExtGetStagingStats(hipfftExtStagingStats* stats)
+try
+{
+    if(!stats)
+        return HIPFFT_INVALID_VALUE;
+    hipfft_staging_pool::get().get_stats(*stats);
+    return HIPFFT_SUCCESS;
+}
+catch(hipfftResult err)
+{
+    return err;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftXtFree(hipLibXtDesc* desc)
+try
+{
+    if(desc && desc->descriptor)
     {
-        auto& brick = (*bricks)[i];
+        for(size_t i = 0; i < static_cast<size_t>(desc->descriptor->nGPUs); ++i)
+        {
+            rocfft_scoped_device dev(desc->descriptor->GPUs[i]);
+            (void)hipFree(desc->descriptor->data[i]);
+        }
+        delete desc->descriptor;
+    }
+    delete desc;
+    return HIPFFT_SUCCESS;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+// true if the plan's transforms can be executed in chunks: an
+// unbatched C2C transform of rank 2 or more, split into slabs
+static bool pipeline_plan_supported(hipfftHandle plan)
+{
+    if(plan->pipeline.chunks < 2 || plan->outBricks.size() < 2)
+        return false;
+    if(!plan->type.is_complex_to_complex() || plan->batch != 1 || plan->lengths.size() < 2)
+        return false;
+    if(!plan->inUserBricks.empty() || plan->pencilRows != 0)
+        return false;
+    if(plan->load_callback_ptrs || plan->store_callback_ptrs)
+        return false;
+    return same_brick_layout(plan->inBricks, plan->outBricks);
+}
+
+// true if a transform of these descriptors can be executed in
+// chunks, with both descriptors in the plan's natural layout
+static bool pipeline_supported(hipfftHandle        plan,
+                               const hipLibXtDesc* input,
+                               const hipLibXtDesc* output)
+{
+    if(!pipeline_plan_supported(plan))
+        return false;
+    if(input == output)
+    {
+        if(input->subFormat != HIPFFT_XT_FORMAT_INPLACE)
+            return false;
+    }
+    else if(input->subFormat != HIPFFT_XT_FORMAT_INPUT
+            || output->subFormat != HIPFFT_XT_FORMAT_OUTPUT)
+        return false;
+    for(auto desc : {input, output})
+    {
+        if(!desc->descriptor
+           || static_cast<size_t>(desc->descriptor->nGPUs) != plan->outBricks.size())
+            return false;
+    }
+    return true;
+}
+
+// single-device rocFFT plan for one FFT stage of a chunked
+// transform.  The first stage transforms all but the slowest FFT
+// dimension of contiguous data.  The last stage transforms the
+// slowest dimension, whose elements are stride apart, with batches
+// 1 element apart.  The plan is created on first use, and counts
+// towards the work area needed on its device.
+static rocfft_plan pipeline_plan(hipfftHandle           plan,
+                                 size_t                 brick,
+                                 hipfftExtPipelineStage stage,
+                                 bool                   inplace,
+                                 bool                   forward,
+                                 size_t                 batch,
+                                 size_t                 stride)
+{
+    const bool                last   = stage == HIPFFT_PIPELINE_STAGE_FFT_LAST;
+    const int                 device = plan->outBricks[brick].device;
+    const std::vector<size_t> id     = {brick,
+                                        static_cast<size_t>(stage),
+                                        static_cast<size_t>(inplace),
+                                        static_cast<size_t>(forward),
+                                        batch,
+                                        stride};
+
+    auto found = plan->pipeline.plans.find(id);
+    if(found != plan->pipeline.plans.end())
+        return found->second;
+
+    hipfft_plan_key key;
+    key.device         = device;
+    key.placement      = inplace ? rocfft_placement_inplace : rocfft_placement_notinplace;
+    key.transform_type = forward ? rocfft_transform_type_complex_forward
+                                 : rocfft_transform_type_complex_inverse;
+    key.precision      = plan->type.precision();
+    key.inputType      = plan->type.inputType;
+    key.outputType     = plan->type.outputType;
+    if(last)
+        key.lengths = {plan->lengths.back()};
+    else
+        key.lengths.assign(plan->lengths.begin(), plan->lengths.end() - 1);
+    key.batch = batch;
+    // scale once, at the end
+    key.scale_factor = last ? plan->scale_factor : 1.0;
+    // same layout as a plan made with these strides
+    if(last)
+        key.layout = {0,
+                      static_cast<size_t>(rocfft_array_type_complex_interleaved),
+                      static_cast<size_t>(rocfft_array_type_complex_interleaved),
+                      1,
+                      1,
+                      stride,
+                      stride};
+
+    rocfft_scoped_device dev(device);
+    auto                 rplan = hipfft_plan_cache::get().acquire(key, [&]() {
+        rocfft_plan_description desc = nullptr;
+        if(rocfft_plan_description_create(&desc) != rocfft_status_success)
+            throw HIPFFT_INTERNAL_ERROR;
+        if(key.scale_factor != 1.0)
+            rocfft_plan_description_set_scale_factor(desc, key.scale_factor);
+        if(last)
+            rocfft_plan_description_set_data_layout(desc,
+                                                    rocfft_array_type_complex_interleaved,
+                                                    rocfft_array_type_complex_interleaved,
+                                                    nullptr,
+                                                    nullptr,
+                                                    1,
+                                                    &stride,
+                                                    1,
+                                                    1,
+                                                    &stride,
+                                                    1);
+
+        rocfft_plan  created       = nullptr;
+        unsigned int plans_created = 0;
+        ROC_FFT_CHECK_PLAN_CREATE(created,
+                                  plans_created,
+                                  key.placement,
+                                  key.transform_type,
+                                  key.precision,
+                                  key.lengths.size(),
+                                  key.lengths.data(),
+                                  batch,
+                                  desc);
+        rocfft_plan_description_destroy(desc);
+        return created;
+    });
+    if(!rplan)
+        throw HIPFFT_EXEC_FAILED;
+    plan->pipeline.plans.emplace(id, rplan);
+
+    auto&  state    = plan->pipeline.devices[brick];
+    size_t workSize = 0;
+    if(rocfft_plan_get_work_buffer_size(rplan, &workSize) != rocfft_status_success)
+        throw HIPFFT_INTERNAL_ERROR;
+    state.workSize = std::max(state.workSize, workSize);
+    return rplan;
+}
 
-        rocfft_scoped_device dev(brick.device);
+// free a device's work area for chunked transforms, if the library
+// allocated it
+static void free_pipeline_work_area(hipfft_pipeline_device& state)
+{
+    if(state.workBuffer && state.workBufferNeedsFree)
+    {
+        rocfft_scoped_device dev(state.device);
+        if(hipFree(state.workBuffer) != hipSuccess)
+            throw HIPFFT_INTERNAL_ERROR;
+    }
+    state.workBuffer          = nullptr;
+    state.workBufferSize      = 0;
+    state.workBufferNeedsFree = false;
+}
 
-        xt_desc->GPUs[i] = brick.device;
-        xt_desc->size[i] = brick.min_size * bits_per_element / 8;
-        if(hipMalloc(&(xt_desc->data[i]), xt_desc->size[i]) != hipSuccess)
-            return HIPFFT_INTERNAL_ERROR;
+// bind a work area for a device's chunk plans to its execution
+// info: the one given to hipfftXtSetWorkArea for the device, if
+// any, or else one allocated by the library.  The device must be
+// current.
+static void bind_pipeline_work_area(hipfftHandle plan, size_t brick)
+{
+    auto& state = plan->pipeline.devices[brick];
+    void* area  = brick < plan->xtWorkAreas.size() ? plan->xtWorkAreas[brick] : nullptr;
+    if(area)
+    {
+        // the caller's area only has the size that was reported
+        // for it
+        const size_t areaSize = plan->xtWorkAreaSizes[brick];
+        if(state.workSize > areaSize)
+            throw HIPFFT_NO_WORKSPACE;
+        if(state.workBuffer == area)
+            return;
+        free_pipeline_work_area(state);
+        state.workBuffer     = area;
+        state.workBufferSize = areaSize;
+    }
+    else
+    {
+        if(state.workSize <= state.workBufferSize && state.workBufferNeedsFree)
+            return;
+        free_pipeline_work_area(state);
+        if(state.workSize == 0)
+            return;
+        if(hipMalloc(&state.workBuffer, state.workSize) != hipSuccess)
+            throw HIPFFT_ALLOC_FAILED;
+        state.workBufferSize      = state.workSize;
+        state.workBufferNeedsFree = true;
     }
+    if(rocfft_execution_info_set_work_buffer(state.info, state.workBuffer, state.workBufferSize)
+       != rocfft_status_success)
+        throw HIPFFT_INTERNAL_ERROR;
+}
 
-    lib_desc->descriptor = xt_desc.release();
-    *desc                = lib_desc.release();
-    return HIPFFT_SUCCESS;
+// copy of a brick, narrowed to [lower, upper) along one dimension,
+// counted from the brick's own lower bound
+static hipfft_brick sub_brick(const hipfft_brick& brick, size_t dim, size_t lower, size_t upper)
+{
+    hipfft_brick sub     = brick;
+    sub.field_lower[dim] = brick.field_lower[dim] + lower;
+    sub.field_upper[dim] = brick.field_lower[dim] + upper;
+    return sub;
 }
-catch(hipfftResult e)
+
+// how a chunked transform divides each device's data: the bricks
+// of the exchanged layout, and the bounds of each device's chunks
+// along the chunked dimension of each layout
+struct hipfft_pipeline_layout
 {
-    return e;
+    std::vector<hipfft_brick>        exchangedBricks;
+    std::vector<std::vector<size_t>> slabChunks;
+    std::vector<std::vector<size_t>> exchangedChunks;
+};
+
+// col-major dimensions that chunks are split on: slabs are split on
+// the slowest FFT dimension, and the exchanged layout is chunked
+// along the next slowest
+static size_t pipeline_slab_dim(hipfftHandle plan)
+{
+    return plan->lengths.size() - 1;
 }
-catch(...)
+static size_t pipeline_chunk_dim(hipfftHandle plan)
 {
-    return HIPFFT_ALLOC_FAILED;
+    return plan->lengths.size() - 2;
 }
 
-// collapse contiguous dimensions in the specified length + stride -
-// user data might be split on any dimension so if we can simplify to
-// just one split dimension and one contiguous dimension we can more
-// easily map a XtMemcpy to a 2DMemcpy.
-static void collapse_contiguous_dims(std::vector<size_t>& brick_length,
-                                     std::vector<size_t>& brick_stride,
+// work out how the plan's data is chunked.  Returns false if the
+// data can't be split into the exchanged layout.
+static bool pipeline_layout(hipfftHandle plan, hipfft_pipeline_layout& layout)
+{
+    const auto&  bricks = plan->outBricks;
+    const size_t count  = bricks.size();
 
-                                     std::vector<size_t>& field_stride)
+    layout.exchangedBricks.assign(count, hipfft_brick());
+    for(size_t i = 0; i < count; ++i)
+        layout.exchangedBricks[i].device = bricks[i].device;
+    if(!set_shuffled_bricks(
+           plan->outLength, plan->batch, layout.exchangedBricks, plan->brickWeights))
+        return false;
+
+    auto chunk_bounds = [&](const hipfft_brick& brick, size_t dim) {
+        const size_t length = brick.field_upper[dim] - brick.field_lower[dim];
+        return split_bounds(length, std::min(plan->pipeline.chunks, length));
+    };
+    layout.slabChunks.resize(count);
+    layout.exchangedChunks.resize(count);
+    for(size_t i = 0; i < count; ++i)
+    {
+        layout.slabChunks[i] = chunk_bounds(bricks[i], pipeline_slab_dim(plan));
+        layout.exchangedChunks[i]
+            = chunk_bounds(layout.exchangedBricks[i], pipeline_chunk_dim(plan));
+    }
+    return true;
+}
+
+// create the single-device plans that transform each device's
+// chunks in one placement and direction
+static void create_pipeline_plans(hipfftHandle                  plan,
+                                  const hipfft_pipeline_layout& layout,
+                                  bool                          inplace,
+                                  bool                          forward)
 {
-    // go backwards from slowest to fastest dims
-    for(size_t i = brick_length.size() - 1; i != 0; --i)
+    const size_t slab_dim  = pipeline_slab_dim(plan);
+    const size_t chunk_dim = pipeline_chunk_dim(plan);
+
+    plan->pipeline.devices.resize(plan->outBricks.size());
+    for(size_t i = 0; i < plan->outBricks.size(); ++i)
     {
-        if(brick_length[i - 1] * brick_stride[i - 1] == brick_stride[i]
-           && brick_length[i - 1] * field_stride[i - 1] == field_stride[i])
-        {
-            brick_length[i - 1] *= brick_length[i];
-            brick_length.erase(brick_length.begin() + i);
-            brick_stride.erase(brick_stride.begin() + i);
-            field_stride.erase(field_stride.begin() + i);
-        }
+        plan->pipeline.devices[i].device = plan->outBricks[i].device;
+
+        const auto& slab = layout.slabChunks[i];
+        for(size_t k = 0; k + 1 < slab.size(); ++k)
+            pipeline_plan(
+                plan, i, HIPFFT_PIPELINE_STAGE_FFT, inplace, forward, slab[k + 1] - slab[k], 0);
+
+        const auto& brick     = layout.exchangedBricks[i];
+        const auto& exchanged = layout.exchangedChunks[i];
+        for(size_t k = 0; k + 1 < exchanged.size(); ++k)
+            pipeline_plan(plan,
+                          i,
+                          HIPFFT_PIPELINE_STAGE_FFT_LAST,
+                          true,
+                          forward,
+                          (exchanged[k + 1] - exchanged[k]) * brick.brick_stride[chunk_dim],
+                          brick.brick_stride[slab_dim]);
     }
-    // we should be splitting on exactly one dimension, so we
-    // should end up with at most two dimensions after
-    // collapsing
-    if(brick_length.size() > 2 || brick_stride.size() > 2 || field_stride.size() > 2)
-        throw std::runtime_error("should have at most 2 dims after collapsing");
-    // fastest dim is expected to be contiguous
-    if(brick_stride.front() != 1 || field_stride.front() != 1)
-        throw std::runtime_error("fastest dim not contiguous after collapsing");
 }
 
-hipfftResult hipfftXtMemcpy(hipfftHandle plan, void* dest, void* src, hipfftXtCopyType cptype)
-try
+// create the plans for every transform the plan can execute in
+// chunks, so that their work areas are known when the plan is made
+// or its chunks change
+static void create_pipeline_plans(hipfftHandle plan)
 {
-    if(!plan || !dest || !src)
+    if(plan->lazy_create || !pipeline_plan_supported(plan))
+        return;
+    hipfft_pipeline_layout layout;
+    if(!pipeline_layout(plan, layout))
+        return;
+    for(bool inplace : {true, false})
+    {
+        for(bool forward : {true, false})
+            create_pipeline_plans(plan, layout, inplace, forward);
+    }
+}
+
+// execute a multi-device transform in chunks, so that the exchange
+// of each chunk between devices overlaps the FFTs of the next.
+//
+// Each device's slab holds every dimension but the slowest in full.
+// Devices first transform those dimensions one chunk of their slab
+// at a time, sending each chunk on to a buffer in the exchanged
+// layout (split along the fastest dimension) as soon as it's done.
+// Once all devices have sent their data, each device transforms the
+// slowest dimension one chunk at a time, and sends each chunk back
+// to the slabs.
+static hipfftResult hipfftXtExecPipelined(hipfftHandle  plan,
+                                          hipLibXtDesc* input,
+                                          hipLibXtDesc* output,
+                                          int           direction)
+{
+    if(direction != HIPFFT_FORWARD && direction != HIPFFT_BACKWARD)
+        return HIPFFT_EXEC_FAILED;
+    const bool forward = direction == HIPFFT_FORWARD;
+    const bool inplace = input == output;
+
+    const auto&  bricks    = plan->outBricks;
+    const size_t count     = bricks.size();
+    const size_t elem_size = hipDataType_bytes(plan->type.outputType, 1);
+    const size_t slab_dim  = pipeline_slab_dim(plan);
+    const size_t chunk_dim = pipeline_chunk_dim(plan);
+
+    hipfft_pipeline_layout layout;
+    if(!pipeline_layout(plan, layout))
         return HIPFFT_INVALID_VALUE;
+    const auto& exchangedBricks = layout.exchangedBricks;
+    const auto& slabChunks      = layout.slabChunks;
+    const auto& exchangedChunks = layout.exchangedChunks;
+
+    // create the plans before any work is enqueued, so that the work
+    // areas are big enough for them
+    auto& pipeline = plan->pipeline;
+    create_pipeline_plans(plan, layout, inplace, forward);
+    pipeline.trace.clear();
+
+    // set up each device
+    for(size_t i = 0; i < count; ++i)
+    {
+        auto& state = pipeline.devices[i];
 
-    // get pointer into buf, at the index pointed to by lower
-    // assuming lengths are strided by stride
-    auto offset_buffer = [](void*                      buf,
-                            hipDataType                dtype,
-                            const std::vector<size_t>& lower,
-                            const std::vector<size_t>& stride) {
-        auto offset_elems = std::inner_product(lower.begin(), lower.end(), stride.begin(), 0);
+        rocfft_scoped_device dev(state.device);
+        state.stream.alloc();
+        state.begin.alloc();
+        if(!state.info)
+        {
+            if(rocfft_execution_info_create(&state.info) != rocfft_status_success
+               || rocfft_execution_info_set_stream(state.info, state.stream)
+                      != rocfft_status_success)
+                throw HIPFFT_INTERNAL_ERROR;
+        }
 
-        return static_cast<void*>(static_cast<char*>(buf) + hipDataType_bytes(dtype, offset_elems));
-    };
+        const size_t exchangedBytes = exchangedBricks[i].min_size * elem_size;
+        if(exchangedBytes > state.exchangedBytes)
+        {
+            if(hipFree(state.exchanged) != hipSuccess)
+                throw HIPFFT_INTERNAL_ERROR;
+            state.exchanged      = nullptr;
+            state.exchangedBytes = 0;
+            if(hipMalloc(&state.exchanged, exchangedBytes) != hipSuccess)
+                return HIPFFT_ALLOC_FAILED;
+            state.exchangedBytes = exchangedBytes;
+        }
 
-    auto brick_layout = [plan](int subFormat) -> const std::vector<hipfft_brick>& {
-        switch(subFormat)
+        bind_pipeline_work_area(plan, i);
+    }
+
+    // timing events are reused from each device's pool.  The device
+    // must be current.
+    std::vector<size_t> eventsUsed(count, 0);
+    auto                next_event = [&](size_t i) -> hipEvent_t {
+        auto& pool = pipeline.devices[i].events;
+        if(eventsUsed[i] == pool.size())
         {
-        case HIPFFT_XT_FORMAT_INPUT:
-            return plan->inBricks;
-        case HIPFFT_XT_FORMAT_OUTPUT:
-        case HIPFFT_XT_FORMAT_INPLACE:
-            return plan->outBricks;
-        default:
-            throw HIPFFT_INVALID_VALUE;
+            pool.emplace_back();
+            pool.back().alloc();
         }
+        return pool[eventsUsed[i]++];
+    };
+    auto add_span = [&](size_t i, size_t chunk, hipfftExtPipelineStage stage) {
+        pipeline.trace.push_back({bricks[i].device,
+                                  static_cast<int>(chunk),
+                                  stage,
+                                  pipeline.devices[i].begin,
+                                  next_event(i),
+                                  next_event(i)});
+        return pipeline.trace.back();
     };
 
-    switch(cptype)
-    {
-    case HIPFFT_COPY_HOST_TO_DEVICE:
+    // FFTs run on each device's stream and exchanges on its copy
+    // stream, all starting once work already on the caller's stream
+    // is done
+    hipfft_xt_copier copier(plan, plan->stream);
+    for(size_t i = 0; i < count; ++i)
     {
-        // dest is a hipLibXtDesc
-        auto destDesc = static_cast<hipLibXtDesc*>(dest);
-        if(!destDesc->descriptor)
-            return HIPFFT_INVALID_VALUE;
+        auto&                state = pipeline.devices[i];
+        rocfft_scoped_device dev(state.device);
+        if(hipStreamWaitEvent(state.stream, copier.start_event(), 0) != hipSuccess
+           || hipEventRecord(state.begin, state.stream) != hipSuccess)
+            throw HIPFFT_INTERNAL_ERROR;
+    }
 
-        std::vector<size_t> srcStride = plan->inStrides;
-        srcStride.push_back(plan->iDist);
-        for(size_t i = 0; i < static_cast<size_t>(destDesc->descriptor->nGPUs); ++i)
+    // run one chunk's FFT on a device's stream
+    auto fft = [&](size_t                      i,
+                   const hipfft_pipeline_span& span,
+                   rocfft_plan                 rplan,
+                   void*                       in,
+                   void*                       out) {
+        auto& state          = pipeline.devices[i];
+        void* in_buffers[1]  = {in};
+        void* out_buffers[1] = {out};
+        if(hipEventRecord(span.start, state.stream) != hipSuccess)
+            throw HIPFFT_INTERNAL_ERROR;
+        if(rocfft_execute(rplan, in_buffers, out_buffers, state.info) != rocfft_status_success)
+            throw HIPFFT_EXEC_FAILED;
+        if(hipEventRecord(span.end, state.stream) != hipSuccess)
+            throw HIPFFT_INTERNAL_ERROR;
+    };
+    // once a chunk's FFT is done, copy it to every brick it overlaps
+    auto exchange = [&](size_t                           i,
+                        const hipfft_pipeline_span&      fftSpan,
+                        const hipfft_pipeline_span&      span,
+                        const hipfft_brick&              chunkBrick,
+                        const void*                      chunkData,
+                        const std::vector<hipfft_brick>& destBricks,
+                        const std::vector<void*>&        destData) {
+        const int device = bricks[i].device;
+        if(copier.wait(device, fftSpan.end) != hipSuccess
+           || copier.record(device, span.start) != hipSuccess)
+            throw HIPFFT_INTERNAL_ERROR;
+        for(size_t j = 0; j < count; ++j)
         {
-            rocfft_scoped_device dev(destDesc->descriptor->GPUs[i]);
+            if(copy_brick_overlap(copier,
+                                  destBricks[j],
+                                  destBricks[j].device,
+                                  destData[j],
+                                  chunkBrick,
+                                  device,
+                                  chunkData,
+                                  elem_size)
+               != hipSuccess)
+                throw HIPFFT_INTERNAL_ERROR;
+        }
+        if(copier.record(device, span.end) != hipSuccess)
+            throw HIPFFT_INTERNAL_ERROR;
+    };
 
-            const auto& brick = brick_layout(destDesc->subFormat)[i];
+    std::vector<void*> slabData(output->descriptor->data, output->descriptor->data + count);
+    std::vector<void*> exchangedData(count);
+    for(size_t i = 0; i < count; ++i)
+        exchangedData[i] = pipeline.devices[i].exchanged;
 
-            auto brick_length = brick.length();
-            auto brick_stride = brick.brick_stride;
-            auto field_stride = srcStride;
-            collapse_contiguous_dims(brick_length, brick_stride, field_stride);
+    // transform the slabs and send them to the exchanged layout
+    for(size_t i = 0; i < count; ++i)
+    {
+        rocfft_scoped_device dev(bricks[i].device);
 
-            // if we can do a 1D memcpy, just do that
-            if(brick_length.size() == 1)
-            {
-                if(hipMemcpy(destDesc->descriptor->data[i],
-                             offset_buffer(src, plan->type.inputType, brick.field_lower, srcStride),
-                             destDesc->descriptor->size[i],
-                             hipMemcpyHostToDevice)
-                   != hipSuccess)
-                    return HIPFFT_INTERNAL_ERROR;
-            }
-            else
-            {
-                if(hipMemcpy2D(
-                       destDesc->descriptor->data[i],
-                       hipDataType_bytes(plan->type.inputType, brick_stride[1]),
-                       offset_buffer(src, plan->type.inputType, brick.field_lower, srcStride),
-                       hipDataType_bytes(plan->type.inputType, field_stride[1]),
-                       hipDataType_bytes(plan->type.inputType, brick_length[0]),
-                       brick_length[1],
-                       hipMemcpyHostToDevice)
-                   != hipSuccess)
-                    return HIPFFT_INTERNAL_ERROR;
-            }
+        const auto&  slab   = slabChunks[i];
+        const size_t stride = bricks[i].brick_stride[slab_dim];
+        for(size_t k = 0; k + 1 < slab.size(); ++k)
+        {
+            const size_t rows   = slab[k + 1] - slab[k];
+            const size_t offset = slab[k] * stride * elem_size;
+            auto         in     = static_cast<char*>(input->descriptor->data[i]) + offset;
+            auto         out    = static_cast<char*>(output->descriptor->data[i]) + offset;
+
+            const auto fftSpan = add_span(i, k, HIPFFT_PIPELINE_STAGE_FFT);
+            fft(i,
+                fftSpan,
+                pipeline_plan(plan, i, HIPFFT_PIPELINE_STAGE_FFT, inplace, forward, rows, 0),
+                in,
+                out);
+            exchange(i,
+                     fftSpan,
+                     add_span(i, k, HIPFFT_PIPELINE_STAGE_EXCHANGE),
+                     sub_brick(bricks[i], slab_dim, slab[k], slab[k + 1]),
+                     out,
+                     exchangedBricks,
+                     exchangedData);
         }
-        return HIPFFT_SUCCESS;
     }
-    case HIPFFT_COPY_DEVICE_TO_HOST:
-    {
-        // src is a hipLibXtDesc
-        auto srcDesc = static_cast<const hipLibXtDesc*>(src);
-        if(!srcDesc->descriptor)
-            return HIPFFT_INVALID_VALUE;
 
-        std::vector<size_t> destStride = plan->outStrides;
-        destStride.push_back(plan->oDist);
-        for(size_t i = 0; i < static_cast<size_t>(srcDesc->descriptor->nGPUs); ++i)
+    // the last FFTs need data from every device, and sending data
+    // back overwrites the slabs, so wait for all exchanges
+    std::vector<hipEvent_t> exchangedEvents(count);
+    for(size_t i = 0; i < count; ++i)
+    {
+        rocfft_scoped_device dev(bricks[i].device);
+        exchangedEvents[i] = next_event(i);
+        if(copier.record(bricks[i].device, exchangedEvents[i]) != hipSuccess)
+            throw HIPFFT_INTERNAL_ERROR;
+    }
+    for(size_t i = 0; i < count; ++i)
+    {
+        rocfft_scoped_device dev(bricks[i].device);
+        for(auto event : exchangedEvents)
         {
-            rocfft_scoped_device dev(srcDesc->descriptor->GPUs[i]);
-
-            const auto& brick = brick_layout(srcDesc->subFormat)[i];
-
-            auto brick_length = brick.length();
-            auto brick_stride = brick.brick_stride;
-            auto field_stride = destStride;
-            collapse_contiguous_dims(brick_length, brick_stride, field_stride);
-
-            // if we can do a 1D memcpy, just do that
-            if(brick_length.size() == 1)
-            {
-                if(hipMemcpy(
-                       offset_buffer(dest, plan->type.outputType, brick.field_lower, destStride),
-                       srcDesc->descriptor->data[i],
-                       srcDesc->descriptor->size[i],
-                       hipMemcpyDeviceToHost)
-                   != hipSuccess)
-                    return HIPFFT_INTERNAL_ERROR;
-            }
-            else
-            {
-                if(hipMemcpy2D(
-                       offset_buffer(dest, plan->type.outputType, brick.field_lower, destStride),
-                       hipDataType_bytes(plan->type.outputType, field_stride[1]),
-                       srcDesc->descriptor->data[i],
-                       hipDataType_bytes(plan->type.outputType, brick_stride[1]),
-                       hipDataType_bytes(plan->type.outputType, brick_length[0]),
-                       brick_length[1],
-                       hipMemcpyDeviceToHost)
-                   != hipSuccess)
-                    return HIPFFT_INTERNAL_ERROR;
-            }
+            if(hipStreamWaitEvent(pipeline.devices[i].stream, event, 0) != hipSuccess)
+                throw HIPFFT_INTERNAL_ERROR;
         }
-        return HIPFFT_SUCCESS;
     }
-    case HIPFFT_COPY_DEVICE_TO_DEVICE:
+
+    // transform the slowest dimension and send the data back
+    for(size_t i = 0; i < count; ++i)
     {
-        // src and dest are both hipLibXtDescs
-        auto srcDesc  = static_cast<const hipLibXtDesc*>(src);
-        auto destDesc = static_cast<hipLibXtDesc*>(dest);
-        if(!srcDesc->descriptor || !destDesc->descriptor
-           || srcDesc->descriptor->nGPUs != destDesc->descriptor->nGPUs)
-            return HIPFFT_INVALID_VALUE;
+        rocfft_scoped_device dev(bricks[i].device);
 
-        for(size_t i = 0; i < static_cast<size_t>(srcDesc->descriptor->nGPUs); ++i)
+        const auto&  brick     = exchangedBricks[i];
+        const auto&  exchanged = exchangedChunks[i];
+        const size_t inner     = brick.brick_stride[chunk_dim];
+        for(size_t k = 0; k + 1 < exchanged.size(); ++k)
         {
-            rocfft_scoped_device dev(srcDesc->descriptor->GPUs[i]);
-            if(hipMemcpy(destDesc->descriptor->data[i],
-                         srcDesc->descriptor->data[i],
-                         srcDesc->descriptor->size[i],
-                         hipMemcpyDeviceToDevice)
-               != hipSuccess)
-                return HIPFFT_INTERNAL_ERROR;
+            const size_t width = exchanged[k + 1] - exchanged[k];
+            auto         data
+                = static_cast<char*>(exchangedData[i]) + exchanged[k] * inner * elem_size;
+
+            const auto fftSpan = add_span(i, k, HIPFFT_PIPELINE_STAGE_FFT_LAST);
+            fft(i,
+                fftSpan,
+                pipeline_plan(plan,
+                              i,
+                              HIPFFT_PIPELINE_STAGE_FFT_LAST,
+                              true,
+                              forward,
+                              width * inner,
+                              brick.brick_stride[slab_dim]),
+                data,
+                data);
+            exchange(i,
+                     fftSpan,
+                     add_span(i, k, HIPFFT_PIPELINE_STAGE_EXCHANGE_BACK),
+                     sub_brick(brick, chunk_dim, exchanged[k], exchanged[k + 1]),
+                     data,
+                     bricks,
+                     slabData);
         }
-        return HIPFFT_SUCCESS;
-    }
-    case HIPFFT_COPY_UNDEFINED:
-        return HIPFFT_NOT_IMPLEMENTED;
-    default:
-        throw HIPFFT_INVALID_VALUE;
     }
-}
-catch(hipfftResult err)
-{
-    return err;
-}
-catch(...)
-{
-    return HIPFFT_INTERNAL_ERROR;
+
+    // the caller's stream waits for the last copies, which come
+    // after each device's last FFT
+    copier.join();
+    return HIPFFT_SUCCESS;
 }
 
-hipfftResult hipfftXtFree(hipLibXtDesc* desc)
-try
+// fraction of the time spent exchanging data that overlapped FFTs
+// on the same device
+static double pipeline_overlap(const std::vector<hipfftExtPipelineEvent>& timeline)
 {
-    if(desc && desc->descriptor)
+    typedef std::vector<std::pair<double, double>> intervals;
+
+    // union of a set of intervals, as sorted disjoint intervals
+    auto merge = [](intervals spans) {
+        std::sort(spans.begin(), spans.end());
+        intervals merged;
+        for(const auto& span : spans)
+        {
+            if(!merged.empty() && span.first <= merged.back().second)
+                merged.back().second = std::max(merged.back().second, span.second);
+            else
+                merged.push_back(span);
+        }
+        return merged;
+    };
+
+    std::map<int, intervals> ffts, exchanges;
+    for(const auto& event : timeline)
     {
-        for(size_t i = 0; i < static_cast<size_t>(desc->descriptor->nGPUs); ++i)
+        const bool fft = event.stage == HIPFFT_PIPELINE_STAGE_FFT
+                         || event.stage == HIPFFT_PIPELINE_STAGE_FFT_LAST;
+        (fft ? ffts : exchanges)[event.device].emplace_back(event.start, event.end);
+    }
+
+    double exchanging = 0.0;
+    double overlapped = 0.0;
+    for(const auto& device : exchanges)
+    {
+        const auto deviceFFTs = merge(ffts[device.first]);
+        for(const auto& exchange : merge(device.second))
         {
-            rocfft_scoped_device dev(desc->descriptor->GPUs[i]);
-            (void)hipFree(desc->descriptor->data[i]);
+            exchanging += exchange.second - exchange.first;
+            for(const auto& fft : deviceFFTs)
+                overlapped += std::max(0.0,
+                                       std::min(exchange.second, fft.second)
+                                           - std::max(exchange.first, fft.first));
         }
-        delete desc->descriptor;
     }
-    delete desc;
-    return HIPFFT_SUCCESS;
-}
-catch(hipfftResult e)
-{
-    return e;
-}
-catch(...)
-{
-    return HIPFFT_INTERNAL_ERROR;
+    return exchanging > 0.0 ? overlapped / exchanging : 0.0;
 }
 
-static hipfftResult hipfftXtExecDescriptorBase(const rocfft_plan&           rplan,
-                                               const rocfft_execution_info& rinfo,
-                                               hipLibXtDesc*                input,
-                                               hipLibXtDesc*                output)
+// run a transform on Xt descriptors.  In-place C2C transforms leave
+// the data in the shuffled layout where the plan has one: forward
+// transforms of INPLACE data end in INPLACE_SHUFFLED, and inverse
+// transforms of INPLACE_SHUFFLED data end back in INPLACE.
+static hipfftResult hipfftXtExecDescriptorBase(hipfftHandle  plan,
+                                               hipLibXtDesc* input,
+                                               hipLibXtDesc* output,
+                                               int           direction)
 {
-    if(!rplan)
-        return HIPFFT_EXEC_FAILED;
     if(!input || !output)
         return HIPFFT_EXEC_FAILED;
 
+    check_plan_ready(plan);
+    if(pipeline_supported(plan, input, output))
+    {
+        plan->lastExec = std::chrono::steady_clock::now();
+        return hipfftXtExecPipelined(plan, input, output, direction);
+    }
+
+    const bool inplace  = input == output;
+    auto       rplan    = get_exec_plan(plan, inplace, direction);
+    const bool shuffled = input->subFormat == HIPFFT_XT_FORMAT_INPLACE_SHUFFLED;
+
+    // shuffled data can only be transformed back, in place
+    if(shuffled && (direction == HIPFFT_FORWARD || !inplace))
+        return HIPFFT_INVALID_VALUE;
+
+    const bool shuffle
+        = shuffled || (inplace && input->subFormat == HIPFFT_XT_FORMAT_INPLACE
+                       && direction == HIPFFT_FORWARD && plan->type.is_complex_to_complex());
+
+    int subFormat = output->subFormat;
+    if(shuffle && create_shuffled_plans(plan))
+    {
+        rplan     = shuffled ? plan->ip_inverse_shuffled : plan->ip_forward_shuffled;
+        subFormat = shuffled ? HIPFFT_XT_FORMAT_INPLACE : HIPFFT_XT_FORMAT_INPLACE_SHUFFLED;
+    }
+    else if(shuffled)
+    {
+        // plan has no shuffled layout, so the data is in the
+        // natural one
+        subFormat = HIPFFT_XT_FORMAT_INPLACE;
+    }
+
+    if(!rplan)
+        return HIPFFT_EXEC_FAILED;
+
     const auto ret
-        = rocfft_execute(rplan, input->descriptor->data, output->descriptor->data, rinfo);
-    return ret == rocfft_status_success ? HIPFFT_SUCCESS : HIPFFT_EXEC_FAILED;
+        = rocfft_execute(rplan, input->descriptor->data, output->descriptor->data, plan->info);
+    if(ret != rocfft_status_success)
+        return HIPFFT_EXEC_FAILED;
+    output->subFormat = subFormat;
+    return HIPFFT_SUCCESS;
 }
 
 hipfftResult hipfftXtExecDescriptorC2C(hipfftHandle  plan,
@@ -2350,10 +8835,9 @@ try
     if(!plan)
         return HIPFFT_INVALID_PLAN;
 
-    const bool inplace = input == output;
-    const auto rplan   = get_exec_plan(plan, inplace, direction);
+    std::lock_guard<std::mutex> lock(plan->mutex);
 
-    return hipfftXtExecDescriptorBase(rplan, plan->info, input, output);
+    return hipfftXtExecDescriptorBase(plan, input, output, direction);
 }
 catch(hipfftResult e)
 {
@@ -2370,10 +8854,9 @@ try
     if(!plan)
         return HIPFFT_INVALID_PLAN;
 
-    const bool inplace = input == output;
-    const auto rplan   = get_exec_plan(plan, inplace, HIPFFT_FORWARD);
+    std::lock_guard<std::mutex> lock(plan->mutex);
 
-    return hipfftXtExecDescriptorBase(rplan, plan->info, input, output);
+    return hipfftXtExecDescriptorBase(plan, input, output, HIPFFT_FORWARD);
 }
 catch(hipfftResult e)
 {
@@ -2390,10 +8873,9 @@ try
     if(!plan)
         return HIPFFT_INVALID_PLAN;
 
-    const bool inplace = input == output;
-    const auto rplan   = get_exec_plan(plan, inplace, HIPFFT_BACKWARD);
+    std::lock_guard<std::mutex> lock(plan->mutex);
 
-    return hipfftXtExecDescriptorBase(rplan, plan->info, input, output);
+    return hipfftXtExecDescriptorBase(plan, input, output, HIPFFT_BACKWARD);
 }
 catch(hipfftResult e)
 {
@@ -2413,10 +8895,9 @@ try
     if(!plan)
         return HIPFFT_INVALID_PLAN;
 
-    const bool inplace = input == output;
-    const auto rplan   = get_exec_plan(plan, inplace, direction);
+    std::lock_guard<std::mutex> lock(plan->mutex);
 
-    return hipfftXtExecDescriptorBase(rplan, plan->info, input, output);
+    return hipfftXtExecDescriptorBase(plan, input, output, direction);
 }
 catch(hipfftResult e)
 {
@@ -2433,10 +8914,9 @@ try
     if(!plan)
         return HIPFFT_INVALID_PLAN;
 
-    const bool inplace = input == output;
-    const auto rplan   = get_exec_plan(plan, inplace, HIPFFT_FORWARD);
+    std::lock_guard<std::mutex> lock(plan->mutex);
 
-    return hipfftXtExecDescriptorBase(rplan, plan->info, input, output);
+    return hipfftXtExecDescriptorBase(plan, input, output, HIPFFT_FORWARD);
 }
 catch(hipfftResult e)
 {
@@ -2453,10 +8933,9 @@ try
     if(!plan)
         return HIPFFT_INVALID_PLAN;
 
-    const bool inplace = input == output;
-    const auto rplan   = get_exec_plan(plan, inplace, HIPFFT_BACKWARD);
+    std::lock_guard<std::mutex> lock(plan->mutex);
 
-    return hipfftXtExecDescriptorBase(rplan, plan->info, input, output);
+    return hipfftXtExecDescriptorBase(plan, input, output, HIPFFT_BACKWARD);
 }
 catch(hipfftResult e)
 {
@@ -2476,10 +8955,92 @@ try
     if(!plan)
         return HIPFFT_INVALID_PLAN;
 
-    const bool inplace = input == output;
-    const auto rplan   = get_exec_plan(plan, inplace, direction);
+    std::lock_guard<std::mutex> lock(plan->mutex);
+
+    return hipfftXtExecDescriptorBase(plan, input, output, direction);
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftExtXtGetPipelineTrace(hipfftHandle            plan,
+                                         int*                    count,
+                                         hipfftExtPipelineEvent* events,
+                                         double*                 overlap)
+try
+{
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    if(!count || (events && *count < 0))
+        return HIPFFT_INVALID_VALUE;
+
+    std::lock_guard<std::mutex> lock(plan->mutex);
+
+    std::vector<hipfftExtPipelineEvent> timeline;
+    for(const auto& span : plan->pipeline.trace)
+    {
+        rocfft_scoped_device dev(span.device);
+        if(hipEventSynchronize(span.end) != hipSuccess)
+            return HIPFFT_INTERNAL_ERROR;
+
+        float start = 0.0f;
+        float end   = 0.0f;
+        if(hipEventElapsedTime(&start, span.begin, span.start) != hipSuccess
+           || hipEventElapsedTime(&end, span.begin, span.end) != hipSuccess)
+            return HIPFFT_INTERNAL_ERROR;
+        timeline.push_back({span.device, span.chunk, span.stage, start / 1000.0, end / 1000.0});
+    }
+
+    if(overlap)
+        *overlap = pipeline_overlap(timeline);
+    if(events)
+        std::copy_n(timeline.begin(),
+                    std::min(timeline.size(), static_cast<size_t>(*count)),
+                    events);
+    *count = static_cast<int>(timeline.size());
+    return HIPFFT_SUCCESS;
+}
+catch(hipfftResult e)
+{
+    return e;
+}
+catch(...)
+{
+    return HIPFFT_INTERNAL_ERROR;
+}
+
+hipfftResult hipfftXtSetWorkArea(hipfftHandle plan, void** workArea)
+try
+{
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    wait_for_plan(plan);
+    // only multi-device plans that have been made have per-device
+    // work areas
+    if(plan->inBricks.empty() || plan->lengths.empty())
+        return HIPFFT_INVALID_PLAN;
+    if(!workArea)
+        return HIPFFT_INVALID_VALUE;
 
-    return hipfftXtExecDescriptorBase(rplan, plan->info, input, output);
+    // the first device's area also serves as the work buffer of the
+    // rocFFT plans
+    if(workArea[0])
+        HIP_FFT_CHECK_AND_RETURN(hipfftSetWorkArea(plan, workArea[0]));
+
+    std::lock_guard<std::mutex> lock(plan->mutex);
+
+    plan->xtWorkAreas.assign(workArea, workArea + plan->inBricks.size());
+    plan->xtWorkAreaSizes = xt_work_sizes(plan);
+
+    // chunked transforms bind the new areas when they next execute
+    for(auto& state : plan->pipeline.devices)
+        free_pipeline_work_area(state);
+    return HIPFFT_SUCCESS;
 }
 catch(hipfftResult e)
 {
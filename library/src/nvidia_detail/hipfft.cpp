@@ -307,6 +307,122 @@ hipfftResult hipfftExtPlanScaleFactor(hipfftHandle plan, double scalefactor)
     return HIPFFT_NOT_IMPLEMENTED;
 }
 
+hipfftResult hipfftExtPlanLazyCreate(hipfftHandle plan, int lazyCreate)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtGetPlanCacheStats(hipfftExtPlanCacheStats* stats)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtClearPlanCache()
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtSetWorkAreaPolicy(hipfftHandle plan, hipfftExtWorkAreaPolicy policy)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtGetWorkAreaStats(hipfftExtWorkAreaStats* stats)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtTrimMemory(hipfftHandle plan)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtTrimAllMemory(double idleSeconds)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtPlanSerialize(hipfftHandle plan, void** buffer, size_t* bufferSize)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtPlanBufferFree(void* buffer)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtPlanDeserialize(hipfftHandle plan,
+                                      const void*  buffer,
+                                      size_t       bufferSize,
+                                      size_t*      workSize)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtKernelCacheSerialize(void** buffer, size_t* bufferSize)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtKernelCacheDeserialize(const void* buffer, size_t bufferSize)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtSetEstimateMode(hipfftExtEstimateMode mode)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtMakePlanManyAsync(hipfftHandle        plan,
+                                        int                 rank,
+                                        int*                n,
+                                        int*                inembed,
+                                        int                 istride,
+                                        int                 idist,
+                                        int*                onembed,
+                                        int                 ostride,
+                                        int                 odist,
+                                        hipfftType          type,
+                                        int                 batch,
+                                        hipfftExtPlanToken* token)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtPlanTokenQuery(hipfftExtPlanToken token)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtPlanTokenWait(hipfftExtPlanToken token, size_t* workSize)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtPlanTokenDestroy(hipfftExtPlanToken token)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtSetNotReadyPolicy(hipfftHandle plan, hipfftExtNotReadyPolicy policy)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtInitialize(unsigned int                flags,
+                                 const hipfftExtPrewarmSpec* prewarm,
+                                 size_t                      prewarmCount)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtFinalize()
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
 hipfftResult
     hipfftMakePlan1d(hipfftHandle plan, int nx, hipfftType type, int batch, size_t* workSize)
 {
@@ -611,6 +727,90 @@ hipfftResult
         plan, hipfftCallbackTypeToCufftCallbackType(cbtype), sharedSize));
 }
 
+hipfftResult hipfftExtSetLoadOp(hipfftHandle plan, hipfftExtOp op, double param, const void* array)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult
+    hipfftExtSetStoreOp(hipfftHandle plan, hipfftExtOp op, double param, const void* array)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtConvolutionPlan(hipfftExtConvolution*    conv,
+                                      int                      rank,
+                                      long long int*           n,
+                                      long long int*           filterLength,
+                                      long long int            numFilters,
+                                      const void*              filters,
+                                      long long int            batch,
+                                      hipfftType               type,
+                                      hipfftExtConvolutionMode mode,
+                                      size_t*                  workSize)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtConvolutionExec(hipfftExtConvolution conv, void* input, void* output)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtConvolutionSetStream(hipfftExtConvolution conv, hipStream_t stream)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtConvolutionDestroy(hipfftExtConvolution conv)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtStreamFilterCreate(hipfftExtStreamFilter*       filter,
+                                         hipfftType                   type,
+                                         long long int                filterLength,
+                                         const void*                  coefficients,
+                                         long long int                fftSize,
+                                         long long int                blocksPerLaunch,
+                                         hipfftExtStreamFilterBackend backend)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtStreamFilterGetSizes(hipfftExtStreamFilter filter,
+                                           long long int*        fftSize,
+                                           long long int*        blockLength,
+                                           long long int*        blocksPerLaunch)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtStreamFilterExec(hipfftExtStreamFilter filter,
+                                       const void*           input,
+                                       long long int         inputLength,
+                                       void*                 output,
+                                       long long int*        outputLength)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtStreamFilterGetStats(hipfftExtStreamFilter       filter,
+                                           hipfftExtStreamFilterStats* stats)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtStreamFilterSetStream(hipfftExtStreamFilter filter, hipStream_t stream)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtStreamFilterDestroy(hipfftExtStreamFilter filter)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
 hipfftResult hipfftXtMakePlanMany(hipfftHandle   plan,
                                   int            rank,
                                   long long int* n,
@@ -673,16 +873,125 @@ hipfftResult hipfftXtGetSizeMany(hipfftHandle   plan,
                                                      executiontype));
 }
 
+hipfftResult hipfftExtMakePlansBulk(hipfftExtPlanSpec* specs, size_t count)
+{
+    if(count && !specs)
+        return HIPFFT_INVALID_VALUE;
+
+    hipfftResult ret = HIPFFT_SUCCESS;
+    for(size_t i = 0; i < count; ++i)
+    {
+        auto& spec  = specs[i];
+        spec.status = hipfftXtMakePlanMany(spec.plan,
+                                           spec.rank,
+                                           spec.n,
+                                           spec.inembed,
+                                           spec.istride,
+                                           spec.idist,
+                                           spec.inputType,
+                                           spec.onembed,
+                                           spec.ostride,
+                                           spec.odist,
+                                           spec.outputType,
+                                           spec.batch,
+                                           &spec.workSize,
+                                           spec.executionType);
+        if(spec.status != HIPFFT_SUCCESS && ret == HIPFFT_SUCCESS)
+            ret = spec.status;
+    }
+    return ret;
+}
+
 hipfftResult hipfftXtExec(hipfftHandle plan, void* input, void* output, int direction)
 {
     return cufftResultToHipResult(cufftXtExec(plan, input, output, direction));
 }
 
+hipfftResult hipfftExtExecContextCreate(hipfftHandle plan, hipfftExtExecContext* context)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtExecContextDestroy(hipfftExtExecContext context)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtExecContextSetStream(hipfftExtExecContext context, hipStream_t stream)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtExecContextSetWorkArea(hipfftExtExecContext context, void* workArea)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtExecContextSetCallback(hipfftExtExecContext context,
+                                             void**               callbacks,
+                                             hipfftXtCallbackType cbtype,
+                                             void**               callbackData)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtExecWithContext(hipfftExtExecContext context,
+                                      void*                input,
+                                      void*                output,
+                                      int                  direction)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
 hipfftResult hipfftXtSetGPUs(hipfftHandle plan, int count, int* gpus)
 {
     return cufftResultToHipResult(cufftXtSetGPUs(plan, count, gpus));
 }
 
+hipfftResult hipfftXtSetWorkArea(hipfftHandle plan, void** workArea)
+{
+    return cufftResultToHipResult(cufftXtSetWorkArea(plan, workArea));
+}
+
+hipfftResult hipfftExtXtSetDecomposition(hipfftHandle           plan,
+                                         hipfftExtDecomposition policy,
+                                         const double*          weights)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtXtGetDecomposition(hipfftHandle plan, hipfftExtDecompositionInfo* info)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtXtSetBricks(hipfftHandle          plan,
+                                  int                   count,
+                                  const int*            gpus,
+                                  const hipfftExtBrick* inBricks,
+                                  const hipfftExtBrick* outBricks)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtXtSetPencilGrid(hipfftHandle plan, int rows, int columns)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtXtSetPipelineChunks(hipfftHandle plan, int chunks)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtXtGetPipelineTrace(hipfftHandle            plan,
+                                         int*                    count,
+                                         hipfftExtPipelineEvent* events,
+                                         double*                 overlap)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
 hipfftResult hipfftXtMalloc(hipfftHandle plan, hipLibXtDesc** desc, hipfftXtSubFormat format)
 {
     try
@@ -711,6 +1020,34 @@ hipfftResult hipfftXtMemcpy(hipfftHandle plan, void* dest, void* src, hipfftXtCo
     }
 }
 
+hipfftResult hipfftXtMemcpyAsync(
+    hipfftHandle plan, void* dest, void* src, hipfftXtCopyType type, hipStream_t stream)
+{
+    // cuFFT has no asynchronous equivalent, so copy synchronously
+    // after work already on the stream
+    if(hipStreamSynchronize(stream) != hipSuccess)
+        return HIPFFT_INTERNAL_ERROR;
+    return hipfftXtMemcpy(plan, dest, src, type);
+}
+
+hipfftResult hipfftExtXtRedistribute(hipfftHandle  destPlan,
+                                     hipLibXtDesc* dest,
+                                     hipfftHandle  srcPlan,
+                                     hipLibXtDesc* src)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtSetStagingPool(size_t poolBytes, size_t chunkBytes)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtGetStagingStats(hipfftExtStagingStats* stats)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
 hipfftResult hipfftXtFree(hipLibXtDesc* desc)
 {
     auto cufftret = cufftXtFree(reinterpret_cast<cudaLibXtDesc*>(desc));
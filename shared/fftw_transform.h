@@ -25,6 +25,8 @@
 #include "hostbuf.h"
 #include "rocfft_complex.h"
 #include "test_params.h"
+#include <cstdint>
+#include <cstring>
 #include <fftw3.h>
 #include <vector>
 
@@ -469,6 +471,152 @@ inline void fftw_plan_execute_c2r<double>(typename fftw_trait<double>::fftw_plan
                          reinterpret_cast<double*>(out.front().data()));
 }
 
+// bfloat16 storage for mixed-precision transforms.  The host has no
+// bfloat16 arithmetic, so values are kept as their bits.
+struct storage_bfloat16
+{
+    uint16_t bits;
+};
+
+// widen a value of a storage type to single precision
+inline float storage_to_single(float v)
+{
+    return v;
+}
+inline float storage_to_single(_Float16 v)
+{
+    return static_cast<float>(v);
+}
+inline float storage_to_single(storage_bfloat16 v)
+{
+    const uint32_t u = static_cast<uint32_t>(v.bits) << 16;
+    float          f;
+    std::memcpy(&f, &u, sizeof(f));
+    return f;
+}
+inline float storage_to_single(int8_t v)
+{
+    return v;
+}
+inline float storage_to_single(int16_t v)
+{
+    return v;
+}
+
+// round a single-precision value to a storage type, to nearest even
+template <typename Tstorage>
+inline Tstorage single_to_storage(float v);
+template <>
+inline float single_to_storage<float>(float v)
+{
+    return v;
+}
+template <>
+inline _Float16 single_to_storage<_Float16>(float v)
+{
+    return static_cast<_Float16>(v);
+}
+template <>
+inline storage_bfloat16 single_to_storage<storage_bfloat16>(float v)
+{
+    uint32_t u;
+    std::memcpy(&u, &v, sizeof(u));
+    storage_bfloat16 b;
+    if((u & 0x7fffffff) > 0x7f800000)
+        b.bits = static_cast<uint16_t>((u >> 16) | 0x40); // keep NaNs quiet
+    else
+        b.bits = static_cast<uint16_t>((u + 0x7fff + ((u >> 16) & 1)) >> 16);
+    return b;
+}
+
+// Reference for a mixed-precision transform: input stored as Tin is
+// widened to single precision, transformed by FFTW in single
+// precision, and the output is rounded to Tout.  Lengths are
+// row-major, data is contiguous with batches one after another, and
+// complex data is interleaved, so each complex element is two values
+// of its storage type.  The transform is real-to-complex if
+// real_input is set, complex-to-real if real_output is set, and
+// otherwise complex-to-complex in the direction given by sign
+// (FFTW_FORWARD or FFTW_BACKWARD).  Results are unnormalized.
+template <typename Tin, typename Tout>
+std::vector<Tout> fftw_mixed_precision_transform(const std::vector<int>& length,
+                                                 int                     batch,
+                                                 bool                    real_input,
+                                                 bool                    real_output,
+                                                 int                     sign,
+                                                 const std::vector<Tin>& in)
+{
+    size_t real_count    = 1;
+    size_t complex_count = 1;
+    for(size_t i = 0; i < length.size(); ++i)
+    {
+        real_count *= length[i];
+        complex_count *= i + 1 == length.size() ? length[i] / 2 + 1 : length[i];
+    }
+    if(!real_input && !real_output)
+        complex_count = real_count;
+
+    std::vector<float> in_single(in.size());
+    for(size_t i = 0; i < in.size(); ++i)
+        in_single[i] = storage_to_single(in[i]);
+    std::vector<float> out_single(batch * (real_output ? real_count : 2 * complex_count));
+
+    const int  rank        = static_cast<int>(length.size());
+    const int  rdist       = static_cast<int>(real_count);
+    const int  cdist       = static_cast<int>(complex_count);
+    const auto in_complex  = reinterpret_cast<fftwf_complex*>(in_single.data());
+    const auto out_complex = reinterpret_cast<fftwf_complex*>(out_single.data());
+
+    fftwf_plan plan;
+    if(real_input)
+        plan = fftwf_plan_many_dft_r2c(rank,
+                                       length.data(),
+                                       batch,
+                                       in_single.data(),
+                                       nullptr,
+                                       1,
+                                       rdist,
+                                       out_complex,
+                                       nullptr,
+                                       1,
+                                       cdist,
+                                       FFTW_ESTIMATE);
+    else if(real_output)
+        plan = fftwf_plan_many_dft_c2r(rank,
+                                       length.data(),
+                                       batch,
+                                       in_complex,
+                                       nullptr,
+                                       1,
+                                       cdist,
+                                       out_single.data(),
+                                       nullptr,
+                                       1,
+                                       rdist,
+                                       FFTW_ESTIMATE);
+    else
+        plan = fftwf_plan_many_dft(rank,
+                                   length.data(),
+                                   batch,
+                                   in_complex,
+                                   nullptr,
+                                   1,
+                                   cdist,
+                                   out_complex,
+                                   nullptr,
+                                   1,
+                                   cdist,
+                                   sign,
+                                   FFTW_ESTIMATE);
+    fftwf_execute(plan);
+    fftwf_destroy_plan(plan);
+
+    std::vector<Tout> out(out_single.size());
+    for(size_t i = 0; i < out.size(); ++i)
+        out[i] = single_to_storage<Tout>(out_single[i]);
+    return out;
+}
+
 #ifdef FFTW_HAVE_SPRINT_PLAN
 // Template wrappers for FFTW print plan:
 template <typename Tfloat>
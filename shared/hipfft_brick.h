@@ -25,7 +25,9 @@
 
 #include <algorithm>
 #include <array>
+#include <functional>
 #include <numeric>
+#include <utility>
 #include <vector>
 
 // column-major ordering on indexes + strides, since these get passed
@@ -80,35 +82,139 @@ struct hipfft_brick
     }
 };
 
+// split length elements into weights.size() parts, in proportion to
+// the weights.  Every part gets at least one element if there are
+// enough to go around.
+static inline std::vector<size_t> weighted_split(size_t length, const std::vector<double>& weights)
+{
+    const double total = std::accumulate(weights.begin(), weights.end(), 0.0);
+
+    // round each part down, then hand out what's left to the parts
+    // that were rounded down the most
+    std::vector<size_t>                    parts(weights.size());
+    std::vector<std::pair<double, size_t>> remainders;
+    size_t                                 assigned = 0;
+    for(size_t i = 0; i < weights.size(); ++i)
+    {
+        const double exact = length * weights[i] / total;
+        parts[i]           = std::min(static_cast<size_t>(exact), length - assigned);
+        assigned += parts[i];
+        remainders.emplace_back(exact - parts[i], i);
+    }
+    std::stable_sort(remainders.begin(),
+                     remainders.end(),
+                     [](const std::pair<double, size_t>& a, const std::pair<double, size_t>& b) {
+                         return a.first > b.first;
+                     });
+    for(size_t i = 0; assigned < length; i = (i + 1) % remainders.size())
+    {
+        ++parts[remainders[i].second];
+        ++assigned;
+    }
+
+    if(length >= parts.size())
+    {
+        for(auto& part : parts)
+        {
+            if(part == 0)
+            {
+                --*std::max_element(parts.begin(), parts.end());
+                part = 1;
+            }
+        }
+    }
+    return parts;
+}
+
+// bounds of count parts of length elements: part i is
+// [bounds[i], bounds[i + 1]).  With no weights, the parts are the
+// same size, with any remainder going to the last.  Otherwise
+// they're sized in proportion to the weights.
+static inline std::vector<size_t>
+    split_bounds(size_t length, size_t count, const std::vector<double>& weights = {})
+{
+    std::vector<size_t> bounds(count + 1, 0);
+    if(weights.empty())
+    {
+        const size_t split_len = length / count;
+        for(size_t i = 0; i < count; ++i)
+            bounds[i] = split_len * i;
+    }
+    else
+    {
+        const auto parts = weighted_split(length, weights);
+        std::partial_sum(parts.begin(), parts.end(), bounds.begin() + 1);
+    }
+    bounds.back() = length;
+    return bounds;
+}
+
+// start a brick off spanning the whole field, for the caller to
+// narrow down
+static inline void set_full_brick(const std::vector<size_t>& length, hipfft_brick& brick)
+{
+    brick.field_lower.resize(length.size());
+    std::fill(brick.field_lower.begin(), brick.field_lower.end(), 0);
+    brick.field_upper = length;
+}
+
+// set contiguous strides on a brick whose bounds are set, and work
+// out how big a buffer it needs
+static inline void finish_brick(hipfft_brick& brick)
+{
+    brick.set_contiguous_stride();
+    brick.min_size
+        = std::max(brick.min_size, compute_ptrdiff(brick.length(), brick.brick_stride, 0, 0));
+}
+
 // lengths include batch dimension (col-major), split_dim is counted with 0 = fastest dim.
+// With no weights, the bricks are the same size along split_dim,
+// with any remainder going to the last.  Otherwise they're sized in
+// proportion to the weights.
 static void set_bricks(const std::vector<size_t>& length,
                        std::vector<hipfft_brick>& bricks,
-                       const size_t               split_dim)
+                       const size_t               split_dim,
+                       const std::vector<double>& weights = {})
 {
-    const size_t dim = length.size();
+    if(bricks.empty())
+        return;
 
+    const auto bounds = split_bounds(length[split_dim], bricks.size(), weights);
     for(size_t i = 0; i < bricks.size(); ++i)
     {
         auto& brick = bricks[i];
 
         // lower idx starts at origin, upper is one-past-the-end
-        brick.field_lower.resize(dim);
-        std::fill(brick.field_lower.begin(), brick.field_lower.end(), 0);
-        brick.field_upper = length;
-
-        // length of the brick along the split dimension
-        size_t split_len             = length[split_dim] / bricks.size();
-        brick.field_lower[split_dim] = split_len * i;
-        if(i != bricks.size() - 1)
-            brick.field_upper[split_dim] = brick.field_lower[split_dim] + split_len;
-        brick.set_contiguous_stride();
-
-        // work out how big a buffer we need to allocate
-        std::vector<size_t> brick_len(dim);
-        for(size_t d = 0; d < dim; ++d)
-            brick_len[d] = brick.field_upper[d] - brick.field_lower[d];
-        brick.min_size
-            = std::max(brick.min_size, compute_ptrdiff(brick_len, brick.brick_stride, 0, 0));
+        set_full_brick(length, brick);
+        brick.field_lower[split_dim] = bounds[i];
+        brick.field_upper[split_dim] = bounds[i + 1];
+        finish_brick(brick);
+    }
+}
+
+// split two dimensions of a field (col-major lengths including
+// batch) over a p x q grid of bricks.  Brick i is at row i / q and
+// column i % q of the grid; rows split p_dim and columns split
+// q_dim, evenly with any remainder going to the last.
+static inline void set_pencil_bricks(const std::vector<size_t>& length,
+                                     std::vector<hipfft_brick>& bricks,
+                                     size_t                     p_dim,
+                                     size_t                     q_dim,
+                                     size_t                     p,
+                                     size_t                     q)
+{
+    const auto p_bounds = split_bounds(length[p_dim], p);
+    const auto q_bounds = split_bounds(length[q_dim], q);
+    for(size_t i = 0; i < bricks.size(); ++i)
+    {
+        auto& brick = bricks[i];
+
+        set_full_brick(length, brick);
+        brick.field_lower[p_dim] = p_bounds[i / q];
+        brick.field_upper[p_dim] = p_bounds[i / q + 1];
+        brick.field_lower[q_dim] = q_bounds[i % q];
+        brick.field_upper[q_dim] = q_bounds[i % q + 1];
+        finish_brick(brick);
     }
 }
 
@@ -119,7 +225,8 @@ static void set_io_bricks(const std::vector<size_t>& inLength,
                           const std::vector<size_t>& outLength,
                           size_t                     batch,
                           std::vector<hipfft_brick>& inBricks,
-                          std::vector<hipfft_brick>& outBricks)
+                          std::vector<hipfft_brick>& outBricks,
+                          const std::vector<double>& weights = {})
 {
     std::vector<size_t> inLengthWithBatch = inLength;
     inLengthWithBatch.push_back(batch);
@@ -133,8 +240,138 @@ static void set_io_bricks(const std::vector<size_t>& inLength,
     const size_t out_split_dim
         = batch > 1 ? outLengthWithBatch.size() - 1 : outLengthWithBatch.size() - 2;
 
-    set_bricks(inLengthWithBatch, inBricks, in_split_dim);
-    set_bricks(outLengthWithBatch, outBricks, out_split_dim);
+    set_bricks(inLengthWithBatch, inBricks, in_split_dim, weights);
+    set_bricks(outLengthWithBatch, outBricks, out_split_dim, weights);
+}
+
+// pencil decomposition of a 3D FFT over a p x q grid of bricks.
+// Input pencils span the fastest FFT dim and output pencils span
+// the slowest, so each end of the transform has one dimension
+// entirely on each device.  The grid's rows split the slower of the
+// two split dims.  Returns false if a split dim is shorter than its
+// side of the grid, since that would leave bricks empty.
+static inline bool set_io_pencil_bricks(const std::vector<size_t>& inLength,
+                                        const std::vector<size_t>& outLength,
+                                        size_t                     batch,
+                                        std::vector<hipfft_brick>& inBricks,
+                                        std::vector<hipfft_brick>& outBricks,
+                                        size_t                     p,
+                                        size_t                     q)
+{
+    if(inLength.size() != 3 || outLength.size() != 3 || p * q != inBricks.size()
+       || p * q != outBricks.size())
+        return false;
+    if(inLength[2] < p || inLength[1] < q || outLength[1] < p || outLength[0] < q)
+        return false;
+
+    std::vector<size_t> inLengthWithBatch = inLength;
+    inLengthWithBatch.push_back(batch);
+    std::vector<size_t> outLengthWithBatch = outLength;
+    outLengthWithBatch.push_back(batch);
+
+    set_pencil_bricks(inLengthWithBatch, inBricks, 2, 1, p, q);
+    set_pencil_bricks(outLengthWithBatch, outBricks, 1, 0, p, q);
+    return true;
+}
+
+// shuffled layout of an in-place multi-device transform's data,
+// i.e. the layout that the transform's last global transpose would
+// turn into its natural layout.  Slabs are split on the fastest FFT
+// dim instead of the slowest, and pencils span the fastest FFT dim
+// instead of the slowest.  p and q are the pencil grid, or zero for
+// slabs.  Returns false if the transform has no shuffled layout:
+// batched and 1D transforms are split without global transposes.
+static inline bool set_shuffled_bricks(const std::vector<size_t>& length,
+                                       size_t                     batch,
+                                       std::vector<hipfft_brick>& bricks,
+                                       const std::vector<double>& weights = {},
+                                       size_t                     p       = 0,
+                                       size_t                     q       = 0)
+{
+    if(bricks.size() < 2 || batch > 1 || length.size() < 2)
+        return false;
+
+    std::vector<size_t> lengthWithBatch = length;
+    lengthWithBatch.push_back(batch);
+
+    if(p != 0)
+    {
+        if(length.size() != 3 || p * q != bricks.size() || length[2] < p || length[1] < q)
+            return false;
+        set_pencil_bricks(lengthWithBatch, bricks, 2, 1, p, q);
+    }
+    else
+    {
+        if(length[0] < bricks.size())
+            return false;
+        set_bricks(lengthWithBatch, bricks, 0, weights);
+    }
+    return true;
+}
+
+// check that bricks exactly tile a field of the given (col-major)
+// length: each brick lies inside the field, no two bricks overlap,
+// and together they cover every index.  Also checks that each
+// brick's strides don't put two of its elements at the same offset.
+static inline bool bricks_tile_field(const std::vector<size_t>&       length,
+                                     const std::vector<hipfft_brick>& bricks)
+{
+    const size_t dim = length.size();
+
+    size_t covered = 0;
+    for(size_t i = 0; i < bricks.size(); ++i)
+    {
+        const auto& brick = bricks[i];
+        if(brick.field_lower.size() != dim || brick.field_upper.size() != dim
+           || brick.brick_stride.size() != dim)
+            return false;
+
+        size_t elements = 1;
+        for(size_t d = 0; d < dim; ++d)
+        {
+            if(brick.field_lower[d] >= brick.field_upper[d] || brick.field_upper[d] > length[d])
+                return false;
+            elements *= brick.field_upper[d] - brick.field_lower[d];
+        }
+        covered += elements;
+
+        // visiting dimensions from smallest stride to largest, each
+        // stride has to step past everything the previous ones reach
+        const auto          brick_len = brick.length();
+        std::vector<size_t> order(dim);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return brick.brick_stride[a] < brick.brick_stride[b];
+        });
+        size_t span = 1;
+        for(auto d : order)
+        {
+            if(brick_len[d] == 1)
+                continue;
+            if(brick.brick_stride[d] < span)
+                return false;
+            span += (brick_len[d] - 1) * brick.brick_stride[d];
+        }
+
+        for(size_t j = 0; j < i; ++j)
+        {
+            const auto& other    = bricks[j];
+            bool        disjoint = false;
+            for(size_t d = 0; d < dim; ++d)
+            {
+                if(std::max(brick.field_lower[d], other.field_lower[d])
+                   >= std::min(brick.field_upper[d], other.field_upper[d]))
+                    disjoint = true;
+            }
+            if(!disjoint)
+                return false;
+        }
+    }
+
+    // bricks are inside the field and don't overlap, so they cover
+    // it if they have as many elements as it does
+    return covered
+           == std::accumulate(length.begin(), length.end(), size_t(1), std::multiplies<size_t>());
 }
 
 #endif
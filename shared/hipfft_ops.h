@@ -0,0 +1,245 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef HIPFFT_OPS_H
+#define HIPFFT_OPS_H
+
+// Host reference implementations of the built-in load and store ops
+// set with hipfftExtSetLoadOp and hipfftExtSetStoreOp, so that their
+// results can be checked without a GPU.  The library computes the
+// same thing in device code; these are deliberately written
+// separately.
+
+#include "hipfft/hipfftXt.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// zeroth-order modified Bessel function of the first kind, summed
+// until the terms stop contributing
+static double hipfft_op_bessel_i0(double x)
+{
+    double sum  = 1.0;
+    double term = 1.0;
+    for(int k = 1; k < 500 && term > 1e-17 * sum; ++k)
+    {
+        const double factor = x / (2.0 * k);
+        term *= factor * factor;
+        sum += term;
+    }
+    return sum;
+}
+
+// weight of index n of a window of length N
+static double hipfft_op_window(hipfftExtOp op, double param, size_t n, size_t N)
+{
+    if(N < 2)
+        return 1.0;
+    const double pi = 3.14159265358979323846;
+    const double x  = static_cast<double>(n) / static_cast<double>(N - 1);
+    switch(op)
+    {
+    case HIPFFT_OP_WINDOW_HANN:
+        return 0.5 - 0.5 * std::cos(2.0 * pi * x);
+    case HIPFFT_OP_WINDOW_HAMMING:
+        return 0.54 - 0.46 * std::cos(2.0 * pi * x);
+    case HIPFFT_OP_WINDOW_BLACKMAN:
+        return 0.42 - 0.5 * std::cos(2.0 * pi * x) + 0.08 * std::cos(4.0 * pi * x);
+    case HIPFFT_OP_WINDOW_KAISER:
+    {
+        const double r = 2.0 * x - 1.0;
+        return hipfft_op_bessel_i0(param * std::sqrt(std::max(0.0, 1.0 - r * r)))
+               / hipfft_op_bessel_i0(param);
+    }
+    default:
+        return 1.0;
+    }
+}
+
+// element arithmetic for the data types that ops apply to
+template <typename T>
+struct hipfft_op_real_type;
+template <>
+struct hipfft_op_real_type<float>
+{
+    typedef float type;
+};
+template <>
+struct hipfft_op_real_type<double>
+{
+    typedef double type;
+};
+template <>
+struct hipfft_op_real_type<hipfftComplex>
+{
+    typedef float type;
+};
+template <>
+struct hipfft_op_real_type<hipfftDoubleComplex>
+{
+    typedef double type;
+};
+
+template <typename T>
+static T hipfft_op_scale(T v, double s)
+{
+    return static_cast<T>(v * s);
+}
+template <typename T>
+static T hipfft_op_scale_complex(T v, double s)
+{
+    v.x *= s;
+    v.y *= s;
+    return v;
+}
+static hipfftComplex hipfft_op_scale(hipfftComplex v, double s)
+{
+    return hipfft_op_scale_complex(v, s);
+}
+static hipfftDoubleComplex hipfft_op_scale(hipfftDoubleComplex v, double s)
+{
+    return hipfft_op_scale_complex(v, s);
+}
+
+template <typename T>
+static T hipfft_op_multiply(T a, T b)
+{
+    return a * b;
+}
+template <typename T>
+static T hipfft_op_multiply_complex(T a, T b)
+{
+    T c;
+    c.x = a.x * b.x - a.y * b.y;
+    c.y = a.x * b.y + a.y * b.x;
+    return c;
+}
+static hipfftComplex hipfft_op_multiply(hipfftComplex a, hipfftComplex b)
+{
+    return hipfft_op_multiply_complex(a, b);
+}
+static hipfftDoubleComplex hipfft_op_multiply(hipfftDoubleComplex a, hipfftDoubleComplex b)
+{
+    return hipfft_op_multiply_complex(a, b);
+}
+
+template <typename T>
+static T hipfft_op_conjugate(T v)
+{
+    v.y = -v.y;
+    return v;
+}
+static float hipfft_op_conjugate(float v)
+{
+    return v;
+}
+static double hipfft_op_conjugate(double v)
+{
+    return v;
+}
+
+template <typename T>
+static double hipfft_op_power(T v)
+{
+    return static_cast<double>(v) * v;
+}
+static double hipfft_op_power(hipfftComplex v)
+{
+    return static_cast<double>(v.x) * v.x + static_cast<double>(v.y) * v.y;
+}
+static double hipfft_op_power(hipfftDoubleComplex v)
+{
+    return v.x * v.x + v.y * v.y;
+}
+
+// Apply an op to each element of in, with col-major lengths and
+// strides and batch transforms dist elements apart, and write the
+// results to the same offsets of out.  HIPFFT_OP_MAGNITUDE and
+// HIPFFT_OP_POWER write real values at those offsets of out viewed
+// as a real array.  array is the host copy of the array for
+// HIPFFT_OP_MULTIPLY.  Windows apply along the fastest dimension.
+template <typename T>
+void hipfft_op_reference(hipfftExtOp                op,
+                         double                     param,
+                         const T*                   array,
+                         const std::vector<size_t>& length,
+                         const std::vector<size_t>& stride,
+                         size_t                     dist,
+                         size_t                     batch,
+                         const T*                   in,
+                         T*                         out)
+{
+    typedef typename hipfft_op_real_type<T>::type real_type;
+
+    std::vector<size_t> index(length.size(), 0);
+    for(size_t b = 0; b < batch; ++b)
+    {
+        for(bool more = true; more;)
+        {
+            size_t offset = b * dist;
+            for(size_t d = 0; d < length.size(); ++d)
+                offset += index[d] * stride[d];
+
+            const T v = in[offset];
+            switch(op)
+            {
+            case HIPFFT_OP_NONE:
+                out[offset] = v;
+                break;
+            case HIPFFT_OP_SCALE:
+                out[offset] = hipfft_op_scale(v, param);
+                break;
+            case HIPFFT_OP_WINDOW_HANN:
+            case HIPFFT_OP_WINDOW_HAMMING:
+            case HIPFFT_OP_WINDOW_BLACKMAN:
+            case HIPFFT_OP_WINDOW_KAISER:
+                out[offset]
+                    = hipfft_op_scale(v, hipfft_op_window(op, param, index[0], length[0]));
+                break;
+            case HIPFFT_OP_CONJUGATE:
+                out[offset] = hipfft_op_conjugate(v);
+                break;
+            case HIPFFT_OP_MULTIPLY:
+                out[offset] = hipfft_op_multiply(v, array[offset]);
+                break;
+            case HIPFFT_OP_MAGNITUDE:
+                reinterpret_cast<real_type*>(out)[offset]
+                    = static_cast<real_type>(std::sqrt(hipfft_op_power(v)));
+                break;
+            case HIPFFT_OP_POWER:
+                reinterpret_cast<real_type*>(out)[offset]
+                    = static_cast<real_type>(hipfft_op_power(v));
+                break;
+            }
+
+            // next index, fastest dimension first
+            more = false;
+            for(size_t d = 0; d < length.size() && !more; ++d)
+            {
+                more = ++index[d] < length[d];
+                if(!more)
+                    index[d] = 0;
+            }
+        }
+    }
+}
+
+#endif
@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <vector>
 
 // Compute the farthest point from the original pointer.